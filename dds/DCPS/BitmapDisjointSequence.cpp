@@ -0,0 +1,533 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#include "BitmapDisjointSequence.h"
+
+#include "ace/Log_Msg.h"
+
+#ifndef __ACE_INLINE__
+# include "BitmapDisjointSequence.inl"
+#endif /* __ACE_INLINE__ */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+namespace {
+  const ACE_UINT32 ALL_ONES = 0xFFFFFFFFu;
+  const ACE_UINT32 MSB = 0x80000000u;
+
+  /// Number of consecutive 1 bits starting at the msb.
+  size_t leading_ones(ACE_UINT32 x)
+  {
+#ifdef __GNUC__
+    return x == ALL_ONES ? 32 : __builtin_clz(~x);
+#else
+    size_t n = 0;
+    for (; x & MSB; x <<= 1) {
+      ++n;
+    }
+    return n;
+#endif
+  }
+
+  /// Index (counting from the msb) of the last 1 bit.
+  /// Precondition: x != 0
+  size_t last_bit(ACE_UINT32 x)
+  {
+#ifdef __GNUC__
+    return 31 - __builtin_ctz(x);
+#else
+    size_t n = 31;
+    for (; !(x & 1); x >>= 1) {
+      --n;
+    }
+    return n;
+#endif
+  }
+}
+
+SequenceNumber
+BitmapDisjointSequence::high() const
+{
+  if (!overflow_.empty()) {
+    return overflow_.high();
+  }
+  const int hb = highest_bit();
+  return hb < 0 ? base_ : SequenceNumber(base_.getValue() + 1 + hb);
+}
+
+SequenceNumber
+BitmapDisjointSequence::last_ack() const
+{
+  if (empty_) {
+    return SequenceNumber::SEQUENCENUMBER_UNKNOWN();
+  }
+
+  size_t start = 0;
+  if (!overflow_.empty()) {
+    const SequenceNumber last = overflow_.last_ack();
+    if (last.getValue() != window_high() + 1 || !bit(WINDOW_BITS - 1)) {
+      return last;
+    }
+    start = WINDOW_BITS - 1;
+  } else {
+    const int hb = highest_bit();
+    if (hb < 0) {
+      return low_;
+    }
+    start = hb;
+  }
+
+  // The run can't reach bit 0 since it's never set.
+  while (bit(start - 1)) {
+    --start;
+  }
+  return base_.getValue() + 1 + SequenceNumber::Value(start);
+}
+
+bool
+BitmapDisjointSequence::contains(SequenceNumber value) const
+{
+  if (empty_ || value < low_) {
+    return false;
+  }
+  if (value <= base_) {
+    return true;
+  }
+  const SequenceNumber::Value offset = value.getValue() - base_.getValue() - 1;
+  if (offset < WINDOW_BITS) {
+    return bit(static_cast<size_t>(offset));
+  }
+  return overflow_.contains(value);
+}
+
+int
+BitmapDisjointSequence::highest_bit() const
+{
+  for (size_t i = WINDOW_WORDS; i > 0; --i) {
+    if (window_[i - 1]) {
+      return static_cast<int>((i - 1) * 32 + last_bit(window_[i - 1]));
+    }
+  }
+  return -1;
+}
+
+bool
+BitmapDisjointSequence::insert_i(const SequenceRange& range,
+                                 OPENDDS_VECTOR(SequenceRange)* added)
+{
+  DisjointSequence::validate(range);
+
+  if (empty_) {
+    empty_ = false;
+    low_ = range.first;
+    base_ = range.second;
+    if (added) {
+      added->push_back(range);
+    }
+    return true;
+  }
+
+  if (range.first < low_) {
+    return insert_below_i(range, added);
+  }
+
+  const SequenceNumber::Value first = std::max(range.first.getValue(), base_.getValue() + 1),
+    last = range.second.getValue(),
+    high = window_high();
+  if (first > last) {
+    return false;
+  }
+
+  bool inserted = false;
+  const size_t prior = added ? added->size() : 0;
+  if (first <= high) {
+    const SequenceNumber::Value base = base_.getValue() + 1;
+    inserted = set_bits(static_cast<size_t>(first - base),
+                        static_cast<size_t>(std::min(last, high) - base), added);
+  }
+  if (last > high) {
+    const size_t in_window = added ? added->size() : 0;
+    const SequenceRange beyond(std::max(first, high + 1), last);
+    if (added ? overflow_.insert(beyond, *added) : overflow_.insert(beyond)) {
+      inserted = true;
+    }
+    if (added && in_window > prior && added->size() > in_window
+        && (*added)[in_window - 1].second.getValue() + 1
+           == (*added)[in_window].first.getValue()) {
+      // join the ranges added on both sides of the window's end
+      (*added)[in_window - 1].second = (*added)[in_window].second;
+      added->erase(added->begin() + in_window);
+    }
+  }
+
+  if (bit(0)) {
+    slide();
+  }
+  return inserted;
+}
+
+bool
+BitmapDisjointSequence::insert_below_i(const SequenceRange& range,
+                                       OPENDDS_VECTOR(SequenceRange)* added)
+{
+  if (range.second.getValue() + 1 >= low_.getValue()) {
+    // Extends the lowest range downward.
+    if (added) {
+      added->push_back(SequenceRange(range.first, low_.previous()));
+    }
+    low_ = range.first;
+    if (range.second > base_) {
+      insert_i(SequenceRange(base_.getValue() + 1, range.second), added);
+    }
+    return true;
+  }
+
+  // A new lowest range, everything that was there moves up.
+  const OPENDDS_VECTOR(SequenceRange) present = present_sequence_ranges();
+  reset();
+  insert_i(range);
+  for (size_t i = 0; i < present.size(); ++i) {
+    insert_i(present[i]);
+  }
+  if (added) {
+    added->push_back(range);
+  }
+  return true;
+}
+
+bool
+BitmapDisjointSequence::insert(SequenceNumber value, CORBA::ULong num_bits,
+                               const CORBA::Long bits[])
+{
+  if (num_bits == 0) {
+    return false;
+  }
+
+  const SequenceNumber::Value val = value.getValue(),
+    last = val + num_bits - 1;
+
+  if (!empty_ && val >= low_.getValue() && last <= window_high()) {
+    // The bitmap has the same layout as the window, OR it in a word at a
+    // time.  Bits at or below base_ are already present and are dropped.
+    bool inserted = false;
+    const SequenceNumber::Value offset = val - base_.getValue() - 1;
+    for (CORBA::ULong i = 0; i < (num_bits + 31) / 32; ++i) {
+      ACE_UINT32 x = static_cast<ACE_UINT32>(bits[i]);
+      const CORBA::ULong valid = num_bits - i * 32;
+      if (valid < 32) {
+        x &= ~(ALL_ONES >> valid);
+      }
+      if (!x) {
+        continue;
+      }
+      const SequenceNumber::Value pos = offset + SequenceNumber::Value(i) * 32;
+      const SequenceNumber::Value word = pos >= 0 ? pos / 32 : -((31 - pos) / 32);
+      const unsigned shift = static_cast<unsigned>(pos - word * 32);
+      const ACE_UINT32 parts[2] = { x >> shift, shift ? x << (32 - shift) : 0 };
+      for (int p = 0; p < 2; ++p) {
+        const SequenceNumber::Value w = word + p;
+        if (w >= 0 && w < WINDOW_WORDS && (parts[p] & ~window_[w])) {
+          window_[w] |= parts[p];
+          inserted = true;
+        }
+      }
+    }
+    if (bit(0)) {
+      slide();
+    }
+    return inserted;
+  }
+
+  // See RTPS v2.1 section 9.4.2.6 SequenceNumberSet
+  bool inserted = false;
+  bool in_run = false;
+  CORBA::ULong run_start = 0;
+  for (CORBA::ULong i = 0; i < num_bits;) {
+    const ACE_UINT32 x = static_cast<ACE_UINT32>(bits[i / 32]);
+    if (i % 32 == 0 && (x == 0 || x == ALL_ONES) && i + 32 <= num_bits) {
+      // skip an entire Long if it's all 0's or all 1's
+      if (x && !in_run) {
+        in_run = true;
+        run_start = i;
+      } else if (!x && in_run) {
+        in_run = false;
+        inserted |= insert_i(SequenceRange(val + run_start, val + i - 1));
+      }
+      i += 32;
+      continue;
+    }
+    const bool set = (x & (MSB >> (i % 32))) != 0;
+    if (set && !in_run) {
+      in_run = true;
+      run_start = i;
+    } else if (!set && in_run) {
+      in_run = false;
+      inserted |= insert_i(SequenceRange(val + run_start, val + i - 1));
+    }
+    ++i;
+  }
+  if (in_run) {
+    inserted |= insert_i(SequenceRange(val + run_start, last));
+  }
+  return inserted;
+}
+
+bool
+BitmapDisjointSequence::set_bits(size_t low, size_t high,
+                                 OPENDDS_VECTOR(SequenceRange)* added)
+{
+  const size_t prior = added ? added->size() : 0;
+  const SequenceNumber::Value base = base_.getValue() + 1;
+  bool changed = false;
+  for (size_t w = low / 32; w <= high / 32; ++w) {
+    const size_t lo = w == low / 32 ? low % 32 : 0,
+      hi = w == high / 32 ? high % 32 : 31;
+    const ACE_UINT32 fresh = (ALL_ONES >> lo) & (ALL_ONES << (31 - hi)) & ~window_[w];
+    if (!fresh) {
+      continue;
+    }
+    changed = true;
+    window_[w] |= fresh;
+
+    if (added) {
+      for (size_t b = lo; b <= hi; ++b) {
+        if (fresh & (MSB >> b)) {
+          const SequenceNumber::Value value = base + SequenceNumber::Value(w * 32 + b);
+          if (added->size() > prior && added->back().second.getValue() + 1 == value) {
+            added->back().second = value;
+          } else {
+            added->push_back(SequenceRange(value, value));
+          }
+        }
+      }
+    }
+  }
+  return changed;
+}
+
+void
+BitmapDisjointSequence::window_ranges(size_t limit, bool invert,
+                                      OPENDDS_VECTOR(SequenceRange)& ranges) const
+{
+  const SequenceNumber::Value base = base_.getValue() + 1;
+  bool in_run = false;
+  size_t run_start = 0;
+  for (size_t i = 0; i < limit;) {
+    const ACE_UINT32 x = invert ? ~window_[i / 32] : window_[i / 32];
+    bool set;
+    size_t step = 1;
+    if (i % 32 == 0 && (x == 0 || x == ALL_ONES) && i + 32 <= limit) {
+      set = x != 0;
+      step = 32;
+    } else {
+      set = (x & (MSB >> (i % 32))) != 0;
+    }
+    if (set && !in_run) {
+      in_run = true;
+      run_start = i;
+    } else if (!set && in_run) {
+      in_run = false;
+      ranges.push_back(SequenceRange(base + SequenceNumber::Value(run_start),
+                                      base + SequenceNumber::Value(i) - 1));
+    }
+    i += step;
+  }
+  if (in_run) {
+    ranges.push_back(SequenceRange(base + SequenceNumber::Value(run_start),
+                                    base + SequenceNumber::Value(limit) - 1));
+  }
+}
+
+void
+BitmapDisjointSequence::slide()
+{
+  while (bit(0)) {
+    size_t ones = 0;
+    for (size_t w = 0; w < WINDOW_WORDS; ++w) {
+      const size_t n = leading_ones(window_[w]);
+      ones += n;
+      if (n < 32) {
+        break;
+      }
+    }
+    base_ = base_.getValue() + ones;
+    shift_window(ones);
+
+    // Everything in overflow_ is above the old window, so it's above the
+    // new base_ as well.
+    const SequenceNumber::Value high = window_high(),
+      base = base_.getValue() + 1;
+    DisjointSequence::RangeSet& ranges = overflow_.sequences_;
+    while (!ranges.empty() && ranges.begin()->first.getValue() <= high) {
+      const SequenceRange range = *ranges.begin();
+      ranges.erase(ranges.begin());
+      set_bits(static_cast<size_t>(range.first.getValue() - base),
+               static_cast<size_t>(std::min(range.second.getValue(), high) - base), 0);
+      if (range.second.getValue() > high) {
+        ranges.insert(SequenceRange(high + 1, range.second));
+        break;
+      }
+    }
+  }
+}
+
+void
+BitmapDisjointSequence::shift_window(size_t bits)
+{
+  const size_t words = bits / 32, rem = bits % 32;
+  for (size_t i = 0; i < WINDOW_WORDS; ++i) {
+    const size_t src = i + words;
+    ACE_UINT32 x = src < WINDOW_WORDS ? window_[src] << rem : 0;
+    if (rem && src + 1 < WINDOW_WORDS) {
+      x |= window_[src + 1] >> (32 - rem);
+    }
+    window_[i] = x;
+  }
+}
+
+bool
+BitmapDisjointSequence::to_bitmap(CORBA::Long bitmap[], CORBA::ULong length,
+                                  CORBA::ULong& num_bits, bool invert) const
+{
+  // num_bits will be 1 more than the index of the last bit we wrote
+  num_bits = 0;
+  if (!disjoint()) {
+    return true;
+  }
+
+  // Bits of the window that are part of the result.  If overflow_ is empty
+  // the highest set bit ends the window, and there's nothing missing above
+  // it.
+  size_t limit = WINDOW_BITS;
+  if (overflow_.empty()) {
+    const size_t hb = static_cast<size_t>(highest_bit());
+    limit = invert ? hb : hb + 1;
+  }
+
+  const size_t words = std::min(size_t(length), (limit + 31) / 32);
+  for (size_t i = 0; i < words; ++i) {
+    bitmap[i] = invert ? ~window_[i] : window_[i];
+  }
+  if (words && words * 32 > limit) {
+    bitmap[words - 1] &= ~(ALL_ONES >> (limit - (words - 1) * 32));
+  }
+  for (size_t i = words; i > 0; --i) {
+    const ACE_UINT32 x = static_cast<ACE_UINT32>(bitmap[i - 1]);
+    if (x) {
+      num_bits = static_cast<CORBA::ULong>((i - 1) * 32 + last_bit(x) + 1);
+      break;
+    }
+  }
+
+  if (words * 32 < limit) {
+    // Didn't fit, check for anything that was cut off.
+    for (size_t i = words * 32; i < limit; ++i) {
+      if (bit(i) != invert) {
+        return false;
+      }
+    }
+  }
+
+  if (overflow_.empty()) {
+    return true;
+  }
+
+  const SequenceNumber::Value base = base_.getValue() + 1;
+  OPENDDS_VECTOR(SequenceRange) ranges;
+  if (invert) {
+    const SequenceNumber::Value high = window_high(),
+      over = overflow_.low().getValue();
+    if (over > high + 1) {
+      ranges.push_back(SequenceRange(high + 1, over - 1));
+    }
+    const OPENDDS_VECTOR(SequenceRange) missing = overflow_.missing_sequence_ranges();
+    ranges.insert(ranges.end(), missing.begin(), missing.end());
+  } else {
+    ranges = overflow_.present_sequence_ranges();
+  }
+
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (!DisjointSequence::fill_bitmap_range(
+          CORBA::ULong(ranges[i].first.getValue() - base),
+          CORBA::ULong(ranges[i].second.getValue() - base),
+          bitmap, length, num_bits)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+OPENDDS_VECTOR(SequenceRange)
+BitmapDisjointSequence::missing_sequence_ranges() const
+{
+  OPENDDS_VECTOR(SequenceRange) missing;
+  if (!disjoint()) {
+    return missing;
+  }
+
+  if (overflow_.empty()) {
+    window_ranges(highest_bit(), true, missing);
+    return missing;
+  }
+
+  window_ranges(WINDOW_BITS, true, missing);
+  const SequenceNumber::Value high = window_high(),
+    over = overflow_.low().getValue();
+  if (over > high + 1) {
+    if (!missing.empty() && missing.back().second.getValue() == high) {
+      missing.back().second = over - 1;
+    } else {
+      missing.push_back(SequenceRange(high + 1, over - 1));
+    }
+  }
+  const OPENDDS_VECTOR(SequenceRange) beyond = overflow_.missing_sequence_ranges();
+  missing.insert(missing.end(), beyond.begin(), beyond.end());
+  return missing;
+}
+
+OPENDDS_VECTOR(SequenceRange)
+BitmapDisjointSequence::present_sequence_ranges() const
+{
+  OPENDDS_VECTOR(SequenceRange) present;
+  if (empty_) {
+    return present;
+  }
+
+  present.push_back(SequenceRange(low_, base_));
+  window_ranges(static_cast<size_t>(highest_bit() + 1), false, present);
+
+  const OPENDDS_VECTOR(SequenceRange) beyond = overflow_.present_sequence_ranges();
+  OPENDDS_VECTOR(SequenceRange)::const_iterator iter = beyond.begin();
+  if (iter != beyond.end()
+      && present.back().second.getValue() + 1 == iter->first.getValue()) {
+    present.back().second = iter++->second;
+  }
+  present.insert(present.end(), iter, beyond.end());
+  return present;
+}
+
+void
+BitmapDisjointSequence::dump() const
+{
+  ACE_DEBUG((LM_DEBUG, "(%P|%t) BitmapDisjointSequence[%X]::dump included ranges of "
+                       "SequenceNumbers:\n", this));
+  const OPENDDS_VECTOR(SequenceRange) present = present_sequence_ranges();
+  for (size_t i = 0; i < present.size(); ++i) {
+    ACE_DEBUG((LM_DEBUG, "(%P|%t) BitmapDisjointSequence[%X]::dump\t%q-%q\n",
+               this, present[i].first.getValue(), present[i].second.getValue()));
+  }
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
@@ -0,0 +1,139 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef DCPS_BITMAPDISJOINTSEQUENCE_H
+#define DCPS_BITMAPDISJOINTSEQUENCE_H
+
+#include "dcps_export.h"
+#include "Definitions.h"
+#include "DisjointSequence.h"
+#include "SequenceNumber.h"
+
+#include "PoolAllocator.h"
+
+#include <algorithm>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/// Set of SequenceNumbers with the same interface as DisjointSequence,
+/// optimized for the common case of a receiver that sees (mostly) dense
+/// sequence numbers with a few gaps close to the cumulative ack.
+///
+/// The lowest contiguous range is kept as a pair of numbers, the next
+/// WINDOW_BITS sequence numbers above cumulative_ack() are kept in a
+/// bitmap laid out like an RTPS SequenceNumberSet (msb of the first word
+/// is cumulative_ack() + 1), and anything beyond the window is kept in a
+/// DisjointSequence.  Inserting a sequence number in the window is a bit
+/// operation, to_bitmap() is a copy of the window, and the window slides
+/// when the cumulative ack advances.  Inserting below low() is supported
+/// but slow.
+class OpenDDS_Dcps_Export BitmapDisjointSequence {
+public:
+  enum {
+    WINDOW_WORDS = 8,
+    WINDOW_BITS = WINDOW_WORDS * 32
+  };
+
+  BitmapDisjointSequence();
+  void reset();
+
+  bool empty() const;
+
+  /// Lowest SequenceNumber in the set.
+  /// Precondition: !empty()
+  SequenceNumber low() const;
+
+  /// Highest SequenceNumber in the set.
+  /// Precondition: !empty()
+  SequenceNumber high() const;
+
+  /// See DisjointSequence::cumulative_ack()
+  SequenceNumber cumulative_ack() const;
+
+  /// See DisjointSequence::last_ack()
+  SequenceNumber last_ack() const;
+
+  bool disjoint() const;
+
+  bool contains(SequenceNumber value) const;
+
+  /// See DisjointSequence::insert(const SequenceRange&, OPENDDS_VECTOR(SequenceRange)&)
+  bool insert(const SequenceRange& range, OPENDDS_VECTOR(SequenceRange)& added);
+
+  bool insert(const SequenceRange& range);
+
+  bool insert(SequenceNumber value);
+
+  /// See DisjointSequence::insert(SequenceNumber, CORBA::ULong, const CORBA::Long[])
+  bool insert(SequenceNumber value,
+              CORBA::ULong num_bits,
+              const CORBA::Long bits[]);
+
+  /// See DisjointSequence::to_bitmap()
+  bool to_bitmap(CORBA::Long bitmap[],
+                 CORBA::ULong length,
+                 CORBA::ULong& num_bits,
+                 bool invert = false) const;
+
+  OPENDDS_VECTOR(SequenceRange) missing_sequence_ranges() const;
+
+  OPENDDS_VECTOR(SequenceRange) present_sequence_ranges() const;
+
+  void dump() const;
+
+private:
+  /// Highest sequence number the window can hold.
+  SequenceNumber::Value window_high() const;
+
+  bool bit(size_t index) const;
+  bool window_empty() const;
+  /// Index of the highest bit set in the window, or -1.
+  int highest_bit() const;
+
+  /// Set bits [low, high] of the window, appending the newly set ranges
+  /// to "added" if it's not null.  Returns true if any bit changed.
+  bool set_bits(size_t low, size_t high, OPENDDS_VECTOR(SequenceRange)* added);
+
+  /// Append the runs of set (or clear, if "invert") bits in [0, limit)
+  /// to "ranges".
+  void window_ranges(size_t limit, bool invert,
+                     OPENDDS_VECTOR(SequenceRange)& ranges) const;
+
+  /// Advance cumulative_ack() over the leading set bits of the window and
+  /// move anything in overflow_ that now fits into the window.
+  void slide();
+  void shift_window(size_t bits);
+
+  bool insert_i(const SequenceRange& range,
+                OPENDDS_VECTOR(SequenceRange)* added = 0);
+  bool insert_below_i(const SequenceRange& range,
+                      OPENDDS_VECTOR(SequenceRange)* added);
+
+  bool empty_;
+  SequenceNumber low_;
+  /// cumulative_ack(), the high end of the lowest contiguous range.
+  SequenceNumber base_;
+  /// Bit i (msb first) is base_ + 1 + i.  Bit 0 is never set since base_
+  /// would have been advanced over it.
+  ACE_UINT32 window_[WINDOW_WORDS];
+  /// Members above window_high().
+  DisjointSequence overflow_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#ifdef __ACE_INLINE__
+# include "BitmapDisjointSequence.inl"
+#endif /* __ACE_INLINE__ */
+
+#endif  /* DCPS_BITMAPDISJOINTSEQUENCE_H */
@@ -0,0 +1,117 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+ACE_INLINE
+BitmapDisjointSequence::BitmapDisjointSequence()
+  : empty_(true)
+{
+  std::fill(window_, window_ + WINDOW_WORDS, ACE_UINT32(0));
+}
+
+ACE_INLINE void
+BitmapDisjointSequence::reset()
+{
+  empty_ = true;
+  std::fill(window_, window_ + WINDOW_WORDS, ACE_UINT32(0));
+  overflow_.reset();
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::empty() const
+{
+  return empty_;
+}
+
+ACE_INLINE SequenceNumber
+BitmapDisjointSequence::low() const
+{
+  return low_;
+}
+
+ACE_INLINE SequenceNumber
+BitmapDisjointSequence::cumulative_ack() const
+{
+  return empty_ ? SequenceNumber::SEQUENCENUMBER_UNKNOWN() : base_;
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::disjoint() const
+{
+  // Bit 0 of the window is never set, so anything above base_ is
+  // separated from the lowest range by a gap.
+  return !empty_ && (!overflow_.empty() || !window_empty());
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::insert(SequenceNumber value)
+{
+  if (!empty_ && value > base_) {
+    const SequenceNumber::Value offset = value.getValue() - base_.getValue() - 1;
+    if (offset == 0 && overflow_.empty() && window_empty()) {
+      // Common case of the next sequence number received in order.
+      base_ = value;
+      return true;
+    }
+    if (offset > 0 && offset < WINDOW_BITS) {
+      // Common case of a sequence number received out of order.
+      const size_t index = static_cast<size_t>(offset);
+      const ACE_UINT32 mask = 0x80000000u >> (index % 32);
+      if (window_[index / 32] & mask) {
+        return false;
+      }
+      window_[index / 32] |= mask;
+      return true;
+    }
+  }
+  return insert_i(SequenceRange(value, value));
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::insert(const SequenceRange& range)
+{
+  return insert_i(range);
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::insert(const SequenceRange& range,
+                               OPENDDS_VECTOR(SequenceRange)& added)
+{
+  return insert_i(range, &added);
+}
+
+ACE_INLINE SequenceNumber::Value
+BitmapDisjointSequence::window_high() const
+{
+  return base_.getValue() + WINDOW_BITS;
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::bit(size_t index) const
+{
+  return (window_[index / 32] & (0x80000000u >> (index % 32))) != 0;
+}
+
+ACE_INLINE bool
+BitmapDisjointSequence::window_empty() const
+{
+  for (size_t i = 0; i < WINDOW_WORDS; ++i) {
+    if (window_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
@@ -40,6 +40,9 @@ namespace DCPS {
 * If the free list is empty then memory is allocated from the heap.
 * This way the allocations will not fail but may be slower.
 *
+* Freed chunks are reused last in, first out so that a steady
+* allocate/free cycle keeps touching the same, cache-warm chunks.
+*
 */
 template <class T, class ACE_LOCK>
 class Cached_Allocator_With_Overflow : public ACE_New_Allocator, public PoolAllocationBase {
@@ -51,6 +54,7 @@ public:
       allocs_from_pool_(0),
       frees_to_heap_(0),
       frees_to_pool_(0),
+      n_chunks_(n_chunks),
       free_list_(ACE_PURE_FREE_LIST) {
     // To maintain alignment requirements, make sure that each element
     // inserted into the free list is aligned properly for the platform.
@@ -71,9 +75,11 @@ public:
     end_ = begin_ + n_chunks * chunk_size;
 
     // Put into free list using placement contructor, no real memory
-    // allocation in the <new> below.
-    for (size_t c = 0; c < n_chunks; c++) {
-      void* placement = begin_ + c * chunk_size;
+    // allocation in the <new> below.  The free list is a stack, adding
+    // the chunks from the end makes the first allocations ascend through
+    // the pool.
+    for (size_t c = n_chunks; c > 0; --c) {
+      void* placement = begin_ + (c - 1) * chunk_size;
       this->free_list_.add(new(placement) ACE_Cached_Mem_Pool_Node<T>);
     }
   }
@@ -212,12 +218,31 @@ public:
     return free_list_.size();
   };
 
+  /// How many chunks were preallocated.
+  size_t n_chunks() const {
+    return n_chunks_;
+  }
+
+  /// How many preallocated chunks are allocated at this time.
+  size_t in_use() {
+    return n_chunks_ - available();
+  }
+
+  /// How many chunks allocated from the heap, because the pool was
+  /// exhausted, haven't been freed yet.
+  size_t heap_outstanding() const {
+    return allocs_from_heap_.value() - frees_to_heap_.value();
+  }
+
   ACE_Atomic_Op<ACE_Thread_Mutex, unsigned long> allocs_from_heap_;
   ACE_Atomic_Op<ACE_Thread_Mutex, unsigned long> allocs_from_pool_;
   ACE_Atomic_Op<ACE_Thread_Mutex, unsigned long> frees_to_heap_ ;
   ACE_Atomic_Op<ACE_Thread_Mutex, unsigned long> frees_to_pool_;
 
 private:
+  /// Number of chunks in the pool.
+  size_t n_chunks_;
+
   /// Remember how we allocate the memory in the first place so
   /// we can clear things up later.
   unsigned char* begin_;
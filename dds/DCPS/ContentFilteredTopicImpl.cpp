@@ -96,6 +96,7 @@ ContentFilteredTopicImpl::set_expression_parameters(const DDS::StringSeq& p)
   }
 
   expression_parameters_ = p;
+  compiled_filter_.reset();
 
   Readers readers_still_alive;
 
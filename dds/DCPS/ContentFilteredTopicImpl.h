@@ -50,14 +50,17 @@ public:
   {
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
     const MetaStruct& meta = getMetaStruct<Sample>();
+    if (!compiled_filter_ || &compiled_filter_->meta() != &meta) {
+      compiled_filter_ = filter_eval_.compile(meta, expression_parameters_);
+    }
     /*
      * Omit the sample from results if the filter references non-key fields
      * and the sample only has key fields.
      */
-    if (sample_only_has_key_fields && filter_eval_.has_non_key_fields(meta)) {
+    if (sample_only_has_key_fields && compiled_filter_->has_non_key_fields()) {
       return false;
     }
-    return filter_eval_.eval(s, expression_parameters_);
+    return compiled_filter_->eval(s);
   }
 
   void add_reader(DataReaderImpl& reader);
@@ -72,11 +75,14 @@ private:
   OPENDDS_STRING filter_expression_;
   FilterEvaluator filter_eval_;
   DDS::StringSeq expression_parameters_;
+  /// filter_eval_ compiled with expression_parameters_, done by the first
+  /// filter() after they change
+  mutable RcHandle<CompiledFilter> compiled_filter_;
   DDS::Topic_var related_topic_;
   typedef OPENDDS_VECTOR(WeakRcHandle<DataReaderImpl>) Readers;
   Readers readers_;
 
-  /// Concurrent access to expression_parameters_ and readers_
+  /// Concurrent access to expression_parameters_, compiled_filter_ and readers_
   mutable ACE_Recursive_Thread_Mutex lock_;
 };
 
@@ -15,6 +15,7 @@
 #include "Qos_Helper.h"
 #include "FeatureDisabledQosCheck.h"
 #include "GuidConverter.h"
+#include "KeyHash.h"
 #include "TopicImpl.h"
 #include "Serializer.h"
 #include "SubscriberImpl.h"
@@ -38,6 +39,7 @@
 #include "ace/Auto_Ptr.h"
 #include "ace/OS_NS_sys_time.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <stdexcept>
 
@@ -50,6 +52,13 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+namespace {
+  /// Multiple of the default number of chunks (-DCPSChunks) that a
+  /// reader with bounded instances and depth but unlimited max_samples
+  /// preallocates at most.
+  const size_t MAX_BOUNDED_CHUNKS_FACTOR = 4;
+}
+
 DataReaderImpl::DataReaderImpl()
 : qos_(TheServiceParticipant->initial_DataReaderQos()),
   reverse_sample_lock_(sample_lock_),
@@ -78,6 +87,11 @@ DataReaderImpl::DataReaderImpl()
   statistics_enabled_(false),
   raw_latency_buffer_size_(0),
   raw_latency_buffer_type_(DataCollector<double>::KeepOldest),
+  pooled_dispatch_(false),
+  data_available_queued_(false),
+  coalesce_data_available_(false),
+  data_available_in_flight_(false),
+  data_available_pending_(false),
   transport_disabled_(false)
 {
   reactor_ = TheServiceParticipant->timer();
@@ -138,6 +152,13 @@ DataReaderImpl::cleanup()
   // deleted
   set_listener(0, NO_STATUS_MASK);
 
+  {
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+    if (data_available_task_) {
+      data_available_task_->cancel();
+    }
+  }
+
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
   OwnershipManagerPtr owner_manager = this->ownership_manager();
   if (owner_manager) {
@@ -807,6 +828,10 @@ DDS::QueryCondition_ptr DataReaderImpl::create_querycondition(
     }
     DDS::ReadCondition_var rc = DDS::ReadCondition::_duplicate(qc);
     read_conditions_.insert(rc);
+    QueryConditionImpl* const qci = dynamic_cast<QueryConditionImpl*>(qc.in());
+    if (qci && qci->hasFilter()) {
+      query_conditions_.push_back(qci);
+    }
     return qc._retn();
   } catch (const std::exception& e) {
     if (DCPS_debug_level) {
@@ -832,6 +857,13 @@ DDS::ReturnCode_t DataReaderImpl::delete_readcondition(
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_,
       DDS::RETCODE_OUT_OF_RESOURCES);
   DDS::ReadCondition_var rc = DDS::ReadCondition::_duplicate(a_condition);
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  QueryConditions::iterator qc = std::find(query_conditions_.begin(),
+    query_conditions_.end(), dynamic_cast<QueryConditionImpl*>(a_condition));
+  if (qc != query_conditions_.end()) {
+    query_conditions_.erase(qc);
+  }
+#endif
   return read_conditions_.erase(rc)
       ? DDS::RETCODE_OK : DDS::RETCODE_PRECONDITION_NOT_MET;
 }
@@ -840,10 +872,23 @@ DDS::ReturnCode_t DataReaderImpl::delete_contained_entities()
 {
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_,
       DDS::RETCODE_OUT_OF_RESOURCES);
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  query_conditions_.clear();
+#endif
   read_conditions_.clear();
   return DDS::RETCODE_OK;
 }
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+void
+DataReaderImpl::query_stored(DDS::InstanceHandle_t instance)
+{
+  for (QueryConditions::iterator iter = query_conditions_.begin(), end = query_conditions_.end(); iter != end; ++iter) {
+    (*iter)->sample_stored(instance);
+  }
+}
+#endif
+
 DDS::ReturnCode_t DataReaderImpl::set_qos(
     const DDS::DataReaderQos & qos)
 {
@@ -1185,6 +1230,14 @@ DataReaderImpl::enable()
 
   if (qos_.resource_limits.max_samples != DDS::LENGTH_UNLIMITED) {
     n_chunks_ = qos_.resource_limits.max_samples;
+
+  } else if (qos_.resource_limits.max_instances != DDS::LENGTH_UNLIMITED
+             && depth_ != ACE_INT32_MAX) {
+    // Every instance can hold at most depth_ samples.  Limits like that
+    // are rarely reached, so preallocate no more than a few times the
+    // configured default and let the pools overflow to the heap beyond it.
+    const size_t bound = static_cast<size_t>(qos_.resource_limits.max_instances) * depth_;
+    n_chunks_ = (std::min)(bound, n_chunks_ * MAX_BOUNDED_CHUNKS_FACTOR);
   }
 
   //else using value from Service_Participant
@@ -1355,6 +1408,12 @@ DataReaderImpl::writer_activity(const DataSampleHeader& header)
 
 void
 DataReaderImpl::data_received(const ReceivedDataSample& sample)
+{
+  data_received_i(sample, 0);
+}
+
+void
+DataReaderImpl::data_received_i(const ReceivedDataSample& sample, Demarshaled* demarshaled)
 {
   DBG_ENTRY_LVL("DataReaderImpl","data_received",6);
 
@@ -1401,7 +1460,9 @@ DataReaderImpl::data_received(const ReceivedDataSample& sample)
     SubscriptionInstance_rch instance;
     bool is_new_instance = false;
     bool filtered = false;
-    if (sample.header_.key_fields_only_) {
+    if (demarshaled) {
+      store_demarshaled(*demarshaled, sample, instance, is_new_instance, filtered);
+    } else if (sample.header_.key_fields_only_) {
       dds_demarshal(sample, instance, is_new_instance, filtered, KEY_ONLY_MARSHALING);
     } else {
       dds_demarshal(sample, instance, is_new_instance, filtered, FULL_MARSHALING);
@@ -1674,6 +1735,172 @@ void DataReaderImpl::notify_read_conditions()
   }
 }
 
+bool
+DataReaderImpl::dispatch_data_available()
+{
+  if (!pooled_dispatch_) {
+    return false;
+  }
+  if (data_available_queued_) {
+    // The queued job hasn't started yet, it will see this sample too
+    return true;
+  }
+  ListenerDispatcher* const dispatcher = TheServiceParticipant->listener_dispatcher();
+  if (!dispatcher) {
+    return false;
+  }
+  // The listener takes samples of any instance, so this reader's calls
+  // share one key and run one at a time.
+  data_available_queued_ =
+    dispatcher->enqueue(ListenerDispatcher::Key(this, DDS::HANDLE_NIL),
+                        make_rch<DataAvailableJob>(ref(*this)));
+  return data_available_queued_;
+}
+
+DataReaderImpl::DataAvailableJob::~DataAvailableJob()
+{
+  if (!executed_) {
+    RcHandle<DataReaderImpl> reader = reader_.lock();
+    if (reader) {
+      reader->data_available_abandoned();
+    }
+  }
+}
+
+void
+DataReaderImpl::DataAvailableJob::execute()
+{
+  RcHandle<DataReaderImpl> reader = reader_.lock();
+  if (!reader || reader->get_deleted()) {
+    return;
+  }
+  executed_ = true;
+  reader->pooled_data_available();
+}
+
+void
+DataReaderImpl::DataAvailableTask::execute(const MonotonicTimePoint&)
+{
+  RcHandle<DataReaderImpl> reader = reader_.lock();
+  if (reader) {
+    reader->data_available_timeout();
+  }
+}
+
+void
+DataReaderImpl::DataAvailableTask::schedule_failed()
+{
+  // Deliver now rather than never
+  execute(MonotonicTimePoint::now());
+}
+
+void
+DataReaderImpl::pooled_data_available()
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+  // Samples that arrive from here on need another job
+  data_available_queued_ = false;
+  if (coalesce_data_available_) {
+    deliver_coalesced_data_available();
+    return;
+  }
+  guard.release();
+
+  RcHandle<SubscriberImpl> subscriber = get_subscriber_servant();
+  if (!subscriber) {
+    return;
+  }
+
+  DDS::DataReaderListener_var listener =
+    listener_for(DDS::DATA_AVAILABLE_STATUS);
+  if (CORBA::is_nil(listener.in())) {
+    // Listener was removed after the job was enqueued
+    notify_status_condition();
+    return;
+  }
+
+  listener->on_data_available(this);
+  set_status_changed_flag(DDS::DATA_AVAILABLE_STATUS, false);
+  subscriber->set_status_changed_flag(DDS::DATA_ON_READERS_STATUS, false);
+}
+
+void
+DataReaderImpl::coalesced_data_available()
+{
+  if (data_available_in_flight_) {
+    data_available_pending_ = true;
+    return;
+  }
+  data_available_in_flight_ = true;
+
+  const TimeDuration window(qos_.latency_budget.duration);
+  if (!window.is_zero()) {
+    if (!data_available_task_) {
+      data_available_task_ = make_rch<DataAvailableTask>(
+        TheServiceParticipant->interceptor(), ref(*this));
+    }
+    data_available_task_->schedule(window);
+  } else if (!dispatch_data_available()) {
+    deliver_coalesced_data_available();
+  }
+}
+
+void
+DataReaderImpl::data_available_timeout()
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+  if (get_deleted()) {
+    data_available_in_flight_ = false;
+    return;
+  }
+  if (!dispatch_data_available()) {
+    deliver_coalesced_data_available();
+  }
+}
+
+void
+DataReaderImpl::data_available_abandoned()
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+  data_available_queued_ = false;
+  if (coalesce_data_available_) {
+    data_available_in_flight_ = false;
+  }
+}
+
+void
+DataReaderImpl::deliver_coalesced_data_available()
+{
+  RcHandle<SubscriberImpl> subscriber = get_subscriber_servant();
+  // Also when an abandoned job cleared it in the meantime
+  data_available_in_flight_ = true;
+
+  while (subscriber) {
+    data_available_pending_ = false;
+
+    DDS::DataReaderListener_var listener =
+      listener_for(DDS::DATA_AVAILABLE_STATUS);
+    if (CORBA::is_nil(listener.in())) {
+      ACE_GUARD(Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
+      notify_status_condition();
+      break;
+    }
+
+    {
+      ACE_GUARD(Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
+      listener->on_data_available(this);
+    }
+
+    if (!data_available_pending_) {
+      set_status_changed_flag(DDS::DATA_AVAILABLE_STATUS, false);
+      subscriber->set_status_changed_flag(DDS::DATA_ON_READERS_STATUS, false);
+      break;
+    }
+  }
+
+  data_available_in_flight_ = false;
+}
+
 RcHandle<SubscriberImpl>
 DataReaderImpl::get_subscriber_servant()
 {
@@ -2265,6 +2492,21 @@ void DataReaderImpl::dispose_unregister(const ReceivedDataSample&,
   }
 }
 
+void DataReaderImpl::store_demarshaled(Demarshaled&,
+                                       const ReceivedDataSample& sample,
+                                       SubscriptionInstance_rch& instance,
+                                       bool& is_new_instance,
+                                       bool& filtered)
+{
+  dds_demarshal(sample, instance, is_new_instance, filtered,
+                sample.header_.key_fields_only_ ? KEY_ONLY_MARSHALING : FULL_MARSHALING);
+}
+
+ACE_Recursive_Thread_Mutex& DataReaderImpl::receive_lock(const PublicationId& writer)
+{
+  return receive_locks_[hash_bytes(&writer, sizeof writer) % receive_lock_count];
+}
+
 void DataReaderImpl::process_latency(const ReceivedDataSample& sample)
 {
   StatsMapType::iterator location
@@ -2846,6 +3088,21 @@ DataReaderImpl::get_writer_states(WriterStatePairVec& writer_states)
   }
 }
 
+void
+DataReaderImpl::get_pool_occupancy(PoolOccupancy& elements, PoolOccupancy& samples)
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+  if (rd_allocator_) {
+    pool_occupancy(*rd_allocator_, elements);
+  }
+  sample_pool_occupancy(samples);
+}
+
+void
+DataReaderImpl::sample_pool_occupancy(PoolOccupancy&)
+{
+}
+
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
 void
 DataReaderImpl::update_ownership_strength (const PublicationId& pub_id,
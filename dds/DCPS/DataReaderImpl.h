@@ -40,6 +40,7 @@
 #include "PoolAllocator.h"
 #include "RemoveAssociationSweeper.h"
 #include "RcEventHandler.h"
+#include "SporadicTask.h"
 #include "TopicImpl.h"
 #include "DomainParticipantImpl.h"
 #include "TimeTypes.h"
@@ -71,7 +72,7 @@ class TopicDescriptionImpl;
 class RequestedDeadlineWatchdog;
 class Monitor;
 class DataReaderImpl;
-class FilterEvaluator;
+class QueryConditionImpl;
 
 typedef Cached_Allocator_With_Overflow<OpenDDS::DCPS::ReceivedDataElementMemoryBlock, ACE_Null_Mutex>
 ReceivedDataAllocator;
@@ -357,6 +358,22 @@ public:
 
   /// @}
 
+  /// Run on_data_available() on the Service_Participant's listener
+  /// dispatch threads instead of the thread that received the data.
+  /// A reader's calls run one at a time, as they do without it, and at
+  /// most one is queued; different readers' calls run concurrently.
+  /// Only takes effect if
+  /// -DCPSListenerDispatchThreads is set.  Initialized from the
+  /// Subscriber's setting.
+  bool& pooled_dispatch();
+
+  /// Call on_data_available() at most once at a time.  Samples that
+  /// arrive while it runs cause one more call once it returns instead of
+  /// one call each.  If the LATENCY_BUDGET QoS duration is non-zero the
+  /// first call waits for that long so that a burst of samples is
+  /// taken together.  Initialized from the Subscriber's setting.
+  bool& coalesce_data_available();
+
   /// update liveliness info for this writer.
   void writer_activity(const DataSampleHeader& header);
 
@@ -376,12 +393,9 @@ public:
                        DDS::ViewStateMask view_states,
                        DDS::InstanceStateMask instance_states);
 
-#ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
-  virtual bool contains_sample_filtered(DDS::SampleStateMask sample_states,
-                                        DDS::ViewStateMask view_states,
-                                        DDS::InstanceStateMask instance_states,
-                                        const FilterEvaluator& evaluator,
-                                        const DDS::StringSeq& params) = 0;
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// True if a sample matches the states and the query of 'qc'
+  virtual bool contains_sample_filtered(QueryConditionImpl& qc) = 0;
 #endif
 
   virtual void dds_demarshal(const ReceivedDataSample& sample,
@@ -390,6 +404,20 @@ public:
                              bool& filtered,
                              MarshalingType marshaling_type)= 0;
 
+  /// A sample that the type specific subclass deserialized before
+  /// taking the sample_lock_, see data_received_i().
+  struct Demarshaled {
+    virtual ~Demarshaled() {}
+  };
+
+  /// Store a sample deserialized without the sample_lock_, called with the
+  /// lock held.  Otherwise the same as dds_demarshal().
+  virtual void store_demarshaled(Demarshaled& demarshaled,
+                                 const ReceivedDataSample& sample,
+                                 SubscriptionInstance_rch& instance,
+                                 bool& is_new_instance,
+                                 bool& filtered);
+
   virtual void dispose_unregister(const ReceivedDataSample& sample,
                                   SubscriptionInstance_rch& instance);
 
@@ -440,6 +468,21 @@ public:
   typedef OPENDDS_VECTOR(WriterStatePair) WriterStatePairVec;
   void get_writer_states(WriterStatePairVec& writer_states);
 
+  /// Use of one of the reader's fixed-size allocators.
+  struct PoolOccupancy {
+    PoolOccupancy() : capacity(0), in_use(0), overflow(0) {}
+    /// Chunks preallocated when the reader was enabled
+    size_t capacity;
+    /// Preallocated chunks currently allocated
+    size_t in_use;
+    /// Chunks currently allocated from the heap because the pool ran out
+    size_t overflow;
+  };
+
+  /// Occupancy of the pools that ReceivedDataElements and samples are
+  /// allocated from.
+  void get_pool_occupancy(PoolOccupancy& elements, PoolOccupancy& samples);
+
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
   void update_ownership_strength (const PublicationId& pub_id,
                                   const CORBA::Long& ownership_strength);
@@ -579,6 +622,17 @@ protected:
   // type specific DataReader's part of enable.
   virtual DDS::ReturnCode_t enable_specific() = 0;
 
+  /// Occupancy of the type specific sample pool, called with sample_lock_ held.
+  virtual void sample_pool_occupancy(PoolOccupancy& samples);
+
+  template <typename Allocator>
+  static void pool_occupancy(Allocator& allocator, PoolOccupancy& occupancy)
+  {
+    occupancy.capacity = allocator.n_chunks();
+    occupancy.in_use = allocator.in_use();
+    occupancy.overflow = allocator.heap_outstanding();
+  }
+
   void sample_info(DDS::SampleInfo & sample_info,
                    const ReceivedDataElement *ptr);
 
@@ -632,6 +686,77 @@ protected:
   /// Data has arrived into the cache, unblock waiting ReadConditions
   void notify_read_conditions();
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// A sample of 'instance' was stored, called with sample_lock_ held.
+  void query_stored(DDS::InstanceHandle_t instance);
+#endif
+
+  /// Hand on_data_available() to the listener dispatch threads, unless a
+  /// call is already queued.  False if the reader doesn't use pooled
+  /// dispatch, the caller invokes the listener itself then.  Called with
+  /// sample_lock_ held.
+  bool dispatch_data_available();
+
+  /// Called on a listener dispatch thread.
+  void pooled_data_available();
+
+  /// Raise on_data_available() for a coalescing reader, called with
+  /// sample_lock_ held.
+  void coalesced_data_available();
+
+  /// Run on_data_available() until no more samples arrived during the
+  /// call.  Called with sample_lock_ held, it's released during the calls.
+  void deliver_coalesced_data_available();
+
+  /// End of the coalescing window
+  void data_available_timeout();
+
+  /// An on_data_available() won't be delivered by the job or timer that
+  /// was supposed to, let the next sample raise it again.
+  void data_available_abandoned();
+
+  class DataAvailableJob : public JobQueue::Job {
+  public:
+    explicit DataAvailableJob(DataReaderImpl& reader)
+      : reader_(reader)
+      , executed_(false)
+    {}
+
+    /// Discarded without being executed, see data_available_abandoned()
+    ~DataAvailableJob();
+
+  private:
+    WeakRcHandle<DataReaderImpl> reader_;
+    bool executed_;
+
+    void execute();
+  };
+
+  class DataAvailableTask : public SporadicTask {
+  public:
+    DataAvailableTask(RcHandle<ReactorInterceptor> interceptor, DataReaderImpl& reader)
+      : SporadicTask(interceptor)
+      , reader_(reader)
+    {}
+
+  private:
+    WeakRcHandle<DataReaderImpl> reader_;
+
+    void execute(const MonotonicTimePoint& now);
+    void schedule_failed();
+  };
+
+  /// Implements data_received(), 'demarshaled' is non-null if the subclass
+  /// already deserialized the sample (SAMPLE_DATA and INSTANCE_REGISTRATION
+  /// messages only).
+  void data_received_i(const ReceivedDataSample& sample, Demarshaled* demarshaled);
+
+  /// Held from deserializing a sample from 'writer' until it's stored,
+  /// which keeps samples from one writer in order when they are
+  /// deserialized outside the sample_lock_.  Writers share a fixed set of
+  /// locks, samples from different writers usually don't wait on each other.
+  ACE_Recursive_Thread_Mutex& receive_lock(const PublicationId& writer);
+
   unique_ptr<ReceivedDataAllocator> rd_allocator_;
   DDS::DataReaderQos qos_;
 
@@ -645,6 +770,9 @@ protected:
   typedef ACE_Reverse_Lock<ACE_Recursive_Thread_Mutex> Reverse_Lock_t;
   Reverse_Lock_t reverse_sample_lock_;
 
+  enum { receive_lock_count = 16 };
+  ACE_Recursive_Thread_Mutex receive_locks_[receive_lock_count];
+
   WeakRcHandle<DomainParticipantImpl> participant_servant_;
   TopicDescriptionPtr<TopicImpl> topic_servant_;
 
@@ -863,10 +991,29 @@ private:
   /// Type of raw latency data buffer.
   DataCollector<double>::OnFull raw_latency_buffer_type_;
 
+  /// Listener callbacks run on the listener dispatch threads
+  bool pooled_dispatch_;
+  /// A DataAvailableJob is queued and hasn't started yet
+  bool data_available_queued_;
+
+  bool coalesce_data_available_;
+  /// A coalesced on_data_available() is scheduled or running
+  bool data_available_in_flight_;
+  /// Samples arrived since the in flight on_data_available() started
+  bool data_available_pending_;
+  RcHandle<DataAvailableTask> data_available_task_;
+
   typedef VarLess<DDS::ReadCondition> RCCompLess;
   typedef OPENDDS_SET_CMP(DDS::ReadCondition_var,  RCCompLess) ReadConditionSet;
   ReadConditionSet read_conditions_;
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// The QueryConditions in read_conditions_ that have a filter, which
+  /// index the samples as they are stored.
+  typedef OPENDDS_VECTOR(QueryConditionImpl*) QueryConditions;
+  QueryConditions query_conditions_;
+#endif
+
   /// Monitor object for this entity
   unique_ptr<Monitor> monitor_;
 
@@ -28,6 +28,20 @@ OpenDDS::DCPS::DataReaderImpl::raw_latency_buffer_type()
   return this->raw_latency_buffer_type_;
 }
 
+ACE_INLINE
+bool&
+OpenDDS::DCPS::DataReaderImpl::pooled_dispatch()
+{
+  return this->pooled_dispatch_;
+}
+
+ACE_INLINE
+bool&
+OpenDDS::DCPS::DataReaderImpl::coalesce_data_available()
+{
+  return this->coalesce_data_available_;
+}
+
 ACE_INLINE
 void
 OpenDDS::DCPS::DataReaderImpl::disable_transport()
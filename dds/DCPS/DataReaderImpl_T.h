@@ -2,9 +2,12 @@
 #define dds_DCPS_DataReaderImpl_T_h
 #include "dds/DCPS/MultiTopicImpl.h"
 #include "dds/DCPS/RakeResults_T.h"
+#include "dds/DCPS/QueryConditionImpl.h"
 #include "dds/DCPS/SubscriberImpl.h"
 #include "dds/DCPS/BuiltInTopicUtils.h"
 #include "dds/DCPS/Util.h"
+#include "dds/DCPS/KeyHash.h"
+#include "dds/DCPS/SampleView.h"
 #include "dds/DCPS/TypeSupportImpl.h"
 #include "dds/DCPS/Watchdog.h"
 #include "dcps_export.h"
@@ -37,8 +40,14 @@ namespace OpenDDS {
     typedef DDSTraits<MessageType> TraitsType;
     typedef typename TraitsType::MessageSequenceType MessageSequenceType;
 
+#if defined ACE_HAS_CPP11 && defined OPENDDS_UNORDERED_INSTANCE_MAP
+    typedef KeyEqual<MessageType, typename TraitsType::LessThanType> KeyEqualType;
+    typedef OPENDDS_UNORDERED_MAP_CHE_T(MessageType, DDS::InstanceHandle_t,
+                                        typename TraitsType::HashType, KeyEqualType) InstanceMap;
+#else
     typedef OPENDDS_MAP_CMP_T(MessageType, DDS::InstanceHandle_t,
                               typename TraitsType::LessThanType) InstanceMap;
+#endif
 
     class SharedInstanceMap
       : public RcObject
@@ -57,11 +66,45 @@ namespace OpenDDS {
       void operator delete(void* memory, ACE_New_Allocator& pool);
       void operator delete(void* memory);
 
-      MessageTypeWithAllocator(){}
+      MessageTypeWithAllocator() : deferred_(false), corrupt_(false) {}
       MessageTypeWithAllocator(const MessageType& other)
         : MessageType(other)
+        , deferred_(false)
+        , corrupt_(false)
+      {
+      }
+
+      const SerializedPayload* serialized_payload() const
       {
+        return payload_.data_ ? &payload_ : 0;
       }
+
+      /// Deserialize the members that were skipped when the sample arrived.
+      /// False if that failed, now or on an earlier call, in which case
+      /// only the key members can be relied on.
+      bool complete()
+      {
+        if (deferred_) {
+          deferred_ = false;
+          if (!deserialize_payload(payload_, static_cast<MessageType&>(*this))) {
+            ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) %CDataReaderImpl::")
+                       ACE_TEXT("MessageTypeWithAllocator::complete: ")
+                       ACE_TEXT("deserialization failed.\n"),
+                       TraitsType::type_name()));
+            corrupt_ = true;
+          }
+        }
+        return !corrupt_;
+      }
+
+      /// Set when the reader has views enabled.
+      SerializedPayload payload_;
+
+      /// Only the key members have been deserialized from payload_.
+      bool deferred_;
+
+      /// complete() couldn't deserialize payload_.
+      bool corrupt_;
     };
 
     struct MessageTypeMemoryBlock {
@@ -69,12 +112,21 @@ namespace OpenDDS {
       ACE_New_Allocator* allocator_;
     };
 
-    typedef OpenDDS::DCPS::Cached_Allocator_With_Overflow<MessageTypeMemoryBlock, ACE_Null_Mutex>  DataAllocator;
+    /// Passed from data_received() to store_demarshaled()
+    struct DemarshaledSample : Demarshaled {
+      DemarshaledSample() : filtered_(false) {}
+      unique_ptr<MessageTypeWithAllocator> data_;
+      bool filtered_;
+    };
+
+    // Locked since samples are deserialized before taking the sample_lock_
+    typedef OpenDDS::DCPS::Cached_Allocator_With_Overflow<MessageTypeMemoryBlock, ACE_Thread_Mutex>  DataAllocator;
 
     typedef typename TraitsType::DataReaderType Interface;
 
     DataReaderImpl_T (void)
-    : filter_delayed_handler_(make_rch<FilterDelayedHandler>(ref(*this)))
+    : extract_key_(0)
+    , filter_delayed_handler_(make_rch<FilterDelayedHandler>(ref(*this)))
     {
     }
 
@@ -109,6 +161,13 @@ namespace OpenDDS {
       return DDS::RETCODE_OK;
     }
 
+    virtual void sample_pool_occupancy(PoolOccupancy& samples)
+    {
+      if (data_allocator()) {
+        pool_occupancy(*data_allocator(), samples);
+      }
+    }
+
     virtual DDS::ReturnCode_t read (
                                     MessageSequenceType & received_data,
                                     DDS::SampleInfoSeq & info_seq,
@@ -242,6 +301,7 @@ namespace OpenDDS {
 
         if (item->sample_state_ & DDS::NOT_READ_SAMPLE_STATE) {
           if (item->registered_data_) {
+            item->complete_data();
             received_data = *static_cast<MessageType*>(item->registered_data_);
           }
           ptr->instance_state_->sample_info(sample_info, item);
@@ -298,6 +358,7 @@ namespace OpenDDS {
 #endif
         if (item->sample_state_ & DDS::NOT_READ_SAMPLE_STATE) {
           if (item->registered_data_) {
+            item->complete_data();
             received_data = *static_cast<MessageType*>(item->registered_data_);
           }
           ptr->instance_state_->sample_info(sample_info, item);
@@ -356,6 +417,65 @@ namespace OpenDDS {
     return found_data ? DDS::RETCODE_OK : DDS::RETCODE_NO_DATA;
   }
 
+  /**
+   * Keep received samples in serialized form so that read_views() and
+   * take_views() can return them as View objects, which opendds_idl
+   * generates as <Type>_OpenDDS_View when run with -Gview.  Samples that
+   * arrive afterwards are deserialized only as far as their key members
+   * (found by View::extract_key()) and are completed the first time they
+   * are read or taken as MessageType, or are evaluated by a
+   * QueryCondition.  If a key member isn't at a fixed offset, or the
+   * reader belongs to a ContentFilteredTopic, samples are still
+   * deserialized on arrival, but the views keep working.
+   */
+  template <typename View>
+  void enable_views()
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, extract_key_lock_);
+    extract_key_ = &View::extract_key;
+  }
+
+  /// Like read() but doesn't copy or deserialize the samples.  Views of
+  /// samples that arrived before enable_views() are not valid().
+  template <typename View>
+  DDS::ReturnCode_t read_views(SampleViewSeq<View>& views,
+                               DDS::SampleInfoSeq& info_seq,
+                               ::CORBA::Long max_samples,
+                               DDS::SampleStateMask sample_states,
+                               DDS::ViewStateMask view_states,
+                               DDS::InstanceStateMask instance_states)
+  {
+    DDS::ReturnCode_t const precond =
+      check_inputs("read_views", views, info_seq);
+    if (DDS::RETCODE_OK != precond) {
+      return precond;
+    }
+
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, DDS::RETCODE_ERROR);
+    return read_i(views, info_seq, max_samples, sample_states,
+                  view_states, instance_states, 0);
+  }
+
+  /// Like take() but doesn't copy or deserialize the samples.
+  template <typename View>
+  DDS::ReturnCode_t take_views(SampleViewSeq<View>& views,
+                               DDS::SampleInfoSeq& info_seq,
+                               ::CORBA::Long max_samples,
+                               DDS::SampleStateMask sample_states,
+                               DDS::ViewStateMask view_states,
+                               DDS::InstanceStateMask instance_states)
+  {
+    DDS::ReturnCode_t const precond =
+      check_inputs("take_views", views, info_seq);
+    if (DDS::RETCODE_OK != precond) {
+      return precond;
+    }
+
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, DDS::RETCODE_ERROR);
+    return take_i(views, info_seq, max_samples, sample_states,
+                  view_states, instance_states, 0);
+  }
+
   virtual DDS::ReturnCode_t read_instance (
                                              MessageSequenceType & received_data,
                                              DDS::SampleInfoSeq & info_seq,
@@ -684,44 +804,53 @@ namespace OpenDDS {
     received_data.length(0);
   }
 
-#ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
-  bool contains_sample_filtered(DDS::SampleStateMask sample_states,
-                                DDS::ViewStateMask view_states,
-                                DDS::InstanceStateMask instance_states,
-                                const OpenDDS::DCPS::FilterEvaluator& evaluator,
-                                const DDS::StringSeq& params)
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  bool contains_sample_filtered(OpenDDS::DCPS::QueryConditionImpl& qc)
   {
     using namespace OpenDDS::DCPS;
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, false);
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_, false);
 
-    const bool filter_has_non_key_fields =
-      evaluator.has_non_key_fields(getMetaStruct<MessageType>());
+    const DDS::SampleStateMask sample_states = qc.get_sample_state_mask();
+    const DDS::ViewStateMask view_states = qc.get_view_state_mask();
+    const DDS::InstanceStateMask instance_states = qc.get_instance_state_mask();
 
-    for (SubscriptionInstanceMapType::iterator iter = instances_.begin(), end = instances_.end(); iter != end; ++iter) {
-      SubscriptionInstance& inst = *iter->second;
+    // Members whose matching samples are gone are dropped on the way
+    QueryConditionImpl::Members& members = query_members(qc);
+    for (QueryConditionImpl::Members::iterator iter = members.begin(); iter != members.end();) {
+      const SubscriptionInstanceMapType::iterator inst_iter = instances_.find(*iter);
+      bool member = false;
 
-      if (inst.instance_state_->match(view_states, instance_states)) {
+      if (inst_iter != instances_.end()) {
+        SubscriptionInstance& inst = *inst_iter->second;
+        const bool state_match = inst.instance_state_->match(view_states, instance_states);
         for (ReceivedDataElement* item = inst.rcvd_samples_.head_; item != 0; item = item->next_data_sample_) {
-          if ((item->sample_state_ & sample_states)
+          if (!qc.cached_filter<MessageType>(*item)) {
+            continue;
+          }
+          member = true;
+          if (state_match && (item->sample_state_ & sample_states)
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
               && !item->coherent_change_
 #endif
-              && item->registered_data_) {
-            if (!item->valid_data_ && filter_has_non_key_fields) {
-              continue;
-            }
-            if (evaluator.eval(*static_cast<MessageType*>(item->registered_data_), params)) {
-              return true;
-            }
+              ) {
+            return true;
           }
         }
       }
+
+      if (member) {
+        ++iter;
+      } else {
+        members.erase(iter++);
+      }
     }
 
     return false;
   }
+#endif
 
+#ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
   DDS::ReturnCode_t read_generic(
                                    OpenDDS::DCPS::DataReaderImpl::GenericBundle& gen,
                                    DDS::SampleStateMask sample_states, DDS::ViewStateMask view_states,
@@ -966,6 +1095,31 @@ namespace OpenDDS {
     DataReaderImpl::qos_change(qos);
   }
 
+  virtual void data_received(const OpenDDS::DCPS::ReceivedDataSample& sample)
+  {
+    // Taken for every message, before the sample_lock_, so that the locks
+    // are always acquired in the same order.
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, receive_lock(sample.header_.publication_id_));
+
+    const char message_id = sample.header_.message_id_;
+    if ((message_id != OpenDDS::DCPS::SAMPLE_DATA
+         && message_id != OpenDDS::DCPS::INSTANCE_REGISTRATION)
+        || !sample.sample_ || !data_allocator()) {
+      data_received_i(sample, 0);
+      return;
+    }
+
+    // Deserialize before taking the sample_lock_, transport threads
+    // delivering samples from different writers do this concurrently.
+    DemarshaledSample demarshaled;
+    demarshaled.data_ = demarshal(sample,
+                                  sample.header_.key_fields_only_
+                                  ? OpenDDS::DCPS::KEY_ONLY_MARSHALING
+                                  : OpenDDS::DCPS::FULL_MARSHALING,
+                                  demarshaled.filtered_);
+    data_received_i(sample, &demarshaled);
+  }
+
 protected:
 
   virtual void dds_demarshal(const OpenDDS::DCPS::ReceivedDataSample& sample,
@@ -973,12 +1127,66 @@ protected:
                              bool& just_registered,
                              bool& filtered,
                              OpenDDS::DCPS::MarshalingType marshaling_type)
+  {
+    unique_ptr<MessageTypeWithAllocator> data = demarshal(sample, marshaling_type, filtered);
+    if (data) {
+      store_instance_data(move(data), sample.header_, instance, just_registered, filtered);
+    }
+  }
+
+  virtual void store_demarshaled(Demarshaled& demarshaled,
+                                 const OpenDDS::DCPS::ReceivedDataSample& sample,
+                                 OpenDDS::DCPS::SubscriptionInstance_rch& instance,
+                                 bool& just_registered,
+                                 bool& filtered)
+  {
+    DemarshaledSample& ds = static_cast<DemarshaledSample&>(demarshaled);
+    filtered = ds.filtered_;
+    if (ds.data_) {
+      store_instance_data(move(ds.data_), sample.header_, instance, just_registered, filtered);
+    }
+  }
+
+  /// Deserialize the sample and apply the content filter, which doesn't
+  /// need the sample_lock_.  Null if the sample was dropped, 'filtered'
+  /// is set if that was because of the content filter.
+  unique_ptr<MessageTypeWithAllocator> demarshal(const OpenDDS::DCPS::ReceivedDataSample& sample,
+                                                 OpenDDS::DCPS::MarshalingType marshaling_type,
+                                                 bool& filtered)
   {
     unique_ptr<MessageTypeWithAllocator> data(new (*data_allocator()) MessageTypeWithAllocator);
     const bool cdr = sample.header_.cdr_encapsulation_;
 
+    const bool key_only_marshaling =
+      marshaling_type == OpenDDS::DCPS::KEY_ONLY_MARSHALING;
+    // Read once, enable_views() may be called while samples arrive
+    const ExtractKey extract_key = this->extract_key();
+    bool defer = false;
+    if (extract_key && !key_only_marshaling && sample.sample_) {
+      // Keep the serialized sample for views.  It's copied because the
+      // received blocks are part of a much larger receive buffer which
+      // belongs to the transport, and views may outlive both.
+      data->payload_.data_ = Message_Block_Shared_Ptr(
+        new ACE_Message_Block(sample.sample_->total_length()));
+      for (const ACE_Message_Block* mb = sample.sample_.get(); mb; mb = mb->cont()) {
+        data->payload_.data_->copy(mb->rd_ptr(), mb->length());
+      }
+      data->payload_.swap_bytes_ = sample.header_.byte_order_ != ACE_CDR_BYTE_ORDER;
+      data->payload_.cdr_encapsulation_ = cdr;
+      defer = true;
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+      if (!sample.header_.content_filter_ && content_filtered_topic_) {
+        // The content filter below needs the whole sample
+        defer = false;
+      }
+#endif
+    }
+
+    // Read from a duplicate, the sample may still be held for later
+    // delivery (see check_historic()) after this.
+    Message_Block_Ptr payload(sample.sample_ ? sample.sample_->duplicate() : 0);
     OpenDDS::DCPS::Serializer ser(
-                                  sample.sample_.get(),
+                                  payload.get(),
                                   sample.header_.byte_order_ != ACE_CDR_BYTE_ORDER,
                                   cdr ? OpenDDS::DCPS::Serializer::ALIGN_CDR : OpenDDS::DCPS::Serializer::ALIGN_NONE);
 
@@ -988,17 +1196,17 @@ protected:
         ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) %CDataReaderImpl::dds_demarshal ")
                   ACE_TEXT("deserialization header failed, dropping sample.\n"),
                   TraitsType::type_name()));
-        return;
+        return unique_ptr<MessageTypeWithAllocator>();
       }
 
       // Start counting byte-offset AFTER header
       ser.reset_alignment();
     }
 
-    const bool key_only_marshaling =
-      marshaling_type == OpenDDS::DCPS::KEY_ONLY_MARSHALING;
     if (key_only_marshaling) {
       ser >> OpenDDS::DCPS::KeyOnly< MessageType>(*data);
+    } else if (defer && extract_key(data->payload_, *data)) {
+      data->deferred_ = true;
     } else {
       ser >> *data;
     }
@@ -1007,7 +1215,7 @@ protected:
       ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) %CDataReaderImpl::dds_demarshal ")
                  ACE_TEXT("deserialization failed, dropping sample.\n"),
                  TraitsType::type_name()));
-      return;
+      return unique_ptr<MessageTypeWithAllocator>();
     }
 
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
@@ -1025,17 +1233,17 @@ protected:
           TraitsType::type_name(),
           to_string(static_cast<MessageId>(sample.header_.message_id_))));
         filtered = true;
-        return;
+        return unique_ptr<MessageTypeWithAllocator>();
       }
       const MessageType& type = static_cast<MessageType&>(*data);
       if (!content_filtered_topic_->filter(type, sample_only_has_key_fields)) {
         filtered = true;
-        return;
+        return unique_ptr<MessageTypeWithAllocator>();
       }
     }
 #endif
 
-    store_instance_data(move(data), sample.header_, instance, just_registered, filtered);
+    return data;
   }
 
   virtual void dispose_unregister(const OpenDDS::DCPS::ReceivedDataSample& sample,
@@ -1090,7 +1298,93 @@ protected:
 
 private:
 
-  DDS::ReturnCode_t read_i(MessageSequenceType& received_data,
+  /// Add the samples of 'inst' that match the masks to 'results'.
+  template <typename SampleSeq>
+  void rake_instance(RakeResults<SampleSeq>& results,
+                     const OpenDDS::DCPS::SubscriptionInstance_rch& inst,
+                     DDS::SampleStateMask sample_states,
+                     DDS::ViewStateMask view_states,
+                     DDS::InstanceStateMask instance_states)
+  {
+    using namespace OpenDDS::DCPS;
+    if (!inst->instance_state_->match(view_states, instance_states)) {
+      return;
+    }
+    size_t i(0);
+    for (ReceivedDataElement* item = inst->rcvd_samples_.head_; item; item = item->next_data_sample_) {
+      if ((item->sample_state_ & sample_states)
+#ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
+          && !item->coherent_change_
+#endif
+          ) {
+        results.insert_sample(item, inst, ++i);
+      }
+    }
+  }
+
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// The instances that can have samples matching 'qc', all samples are
+  /// looked at once if the query parameters changed since the last call.
+  /// Called with sample_lock_ held.
+  OpenDDS::DCPS::QueryConditionImpl::Members& query_members(OpenDDS::DCPS::QueryConditionImpl& qc)
+  {
+    using namespace OpenDDS::DCPS;
+    if (!qc.members_valid()) {
+      ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_, qc.members());
+      QueryConditionImpl::Members members;
+      for (SubscriptionInstanceMapType::iterator iter = instances_.begin(), end = instances_.end(); iter != end; ++iter) {
+        for (ReceivedDataElement* item = iter->second->rcvd_samples_.head_; item != 0; item = item->next_data_sample_) {
+          if (qc.cached_filter<MessageType>(*item)) {
+            members.insert(iter->first);
+            break;
+          }
+        }
+      }
+      qc.reset_members(members);
+    }
+    return qc.members();
+  }
+
+  /// Add the samples of the member instances of 'qc' to 'results', members
+  /// released since they were found are dropped.  Called with sample_lock_
+  /// held.
+  template <typename SampleSeq>
+  void rake_members(RakeResults<SampleSeq>& results,
+                    OpenDDS::DCPS::QueryConditionImpl& qc,
+                    DDS::SampleStateMask sample_states,
+                    DDS::ViewStateMask view_states,
+                    DDS::InstanceStateMask instance_states)
+  {
+    using namespace OpenDDS::DCPS;
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_);
+    QueryConditionImpl::Members& members = qc.members();
+    for (QueryConditionImpl::Members::iterator it = members.begin(); it != members.end();) {
+      const SubscriptionInstanceMapType::iterator inst = instances_.find(*it);
+      if (inst == instances_.end()) {
+        members.erase(it++);
+        continue;
+      }
+      rake_instance(results, inst->second, sample_states, view_states, instance_states);
+      ++it;
+    }
+  }
+
+  /// The QueryConditionImpl of 'cond' if it has a filter, which limits a
+  /// read or take to its member instances.
+  OpenDDS::DCPS::QueryConditionImpl* filtered_query(DDS::QueryCondition_ptr cond)
+  {
+    OpenDDS::DCPS::QueryConditionImpl* const qc =
+      dynamic_cast<OpenDDS::DCPS::QueryConditionImpl*>(cond);
+    if (!qc || !qc->hasFilter()) {
+      return 0;
+    }
+    query_members(*qc);
+    return qc;
+  }
+#endif
+
+  template <typename SampleSeq>
+  DDS::ReturnCode_t read_i(SampleSeq& received_data,
                            DDS::SampleInfoSeq& info_seq,
                            CORBA::Long max_samples,
                            DDS::SampleStateMask sample_states,
@@ -1103,7 +1397,7 @@ private:
 #endif
 {
 
-  typename MessageSequenceType::PrivateMemberAccess received_data_p(received_data);
+  typename SampleSeq::PrivateMemberAccess received_data_p(received_data);
 
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   if (subqos_.presentation.access_scope == DDS::GROUP_PRESENTATION_QOS && !coherent_) {
@@ -1120,34 +1414,33 @@ private:
   }
 #endif
 
-  RakeResults<MessageSequenceType> results(this, received_data, info_seq, max_samples, subqos_.presentation,
+  RakeResults<SampleSeq> results(this, received_data, info_seq, max_samples, subqos_.presentation,
 #ifndef OPENDDS_NO_QUERY_CONDITION
                                            a_condition,
 #endif
                                            DDS_OPERATION_READ);
 
-#ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
-  if (!group_coherent_ordered) {
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  // Only the instances that have samples matching the query
+  OpenDDS::DCPS::QueryConditionImpl* const query = filtered_query(a_condition);
 #endif
-    for (typename InstanceMap::iterator it = instance_map_.begin(),
-         the_end = instance_map_.end(); it != the_end; ++it) {
-
-      const DDS::InstanceHandle_t handle = it->second;
-      const SubscriptionInstance_rch inst = get_handle_instance(handle);
 
-      if (inst->instance_state_->match(view_states, instance_states)) {
-        size_t i(0);
-        for (ReceivedDataElement* item = inst->rcvd_samples_.head_; item; item = item->next_data_sample_) {
-          if ((item->sample_state_ & sample_states)
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
-              && !item->coherent_change_
+  if (!group_coherent_ordered) {
 #endif
-              ) {
-            results.insert_sample(item, inst, ++i);
-          }
-        }
+#ifndef OPENDDS_NO_QUERY_CONDITION
+    if (query) {
+      rake_members(results, *query, sample_states, view_states, instance_states);
+    } else {
+#endif
+      for (typename InstanceMap::iterator it = instance_map_.begin(),
+           the_end = instance_map_.end(); it != the_end; ++it) {
+        rake_instance(results, get_handle_instance(it->second),
+                      sample_states, view_states, instance_states);
       }
+#ifndef OPENDDS_NO_QUERY_CONDITION
     }
+#endif
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   } else {
     const RakeData item = group_coherent_ordered_data_.get_data();
@@ -1169,7 +1462,8 @@ private:
   return ret;
 }
 
-DDS::ReturnCode_t take_i(MessageSequenceType& received_data,
+template <typename SampleSeq>
+DDS::ReturnCode_t take_i(SampleSeq& received_data,
                          DDS::SampleInfoSeq& info_seq,
                          CORBA::Long max_samples,
                          DDS::SampleStateMask sample_states,
@@ -1181,7 +1475,7 @@ DDS::ReturnCode_t take_i(MessageSequenceType& received_data,
   int)
 #endif
 {
-  typename MessageSequenceType::PrivateMemberAccess received_data_p(received_data);
+  typename SampleSeq::PrivateMemberAccess received_data_p(received_data);
 
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   if (subqos_.presentation.access_scope == DDS::GROUP_PRESENTATION_QOS && !coherent_) {
@@ -1198,34 +1492,34 @@ DDS::ReturnCode_t take_i(MessageSequenceType& received_data,
   }
 #endif
 
-  RakeResults<MessageSequenceType> results(this, received_data, info_seq, max_samples, subqos_.presentation,
+  RakeResults<SampleSeq> results(this, received_data, info_seq, max_samples, subqos_.presentation,
 #ifndef OPENDDS_NO_QUERY_CONDITION
                                            a_condition,
 #endif
                                            DDS_OPERATION_TAKE);
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  // Only the instances that have samples matching the query
+  OpenDDS::DCPS::QueryConditionImpl* const query = filtered_query(a_condition);
+#endif
+
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   if (!group_coherent_ordered) {
 #endif
 
-    for (typename InstanceMap::iterator it = instance_map_.begin(), the_end = instance_map_.end(); it != the_end; ++it) {
-
-      const DDS::InstanceHandle_t handle = it->second;
-      const SubscriptionInstance_rch inst = get_handle_instance(handle);
-
-      if (inst->instance_state_->match(view_states, instance_states)) {
-        size_t i(0);
-        for (ReceivedDataElement* item = inst->rcvd_samples_.head_; item; item = item->next_data_sample_) {
-          if ((item->sample_state_ & sample_states)
-#ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
-              && !item->coherent_change_
+#ifndef OPENDDS_NO_QUERY_CONDITION
+    if (query) {
+      rake_members(results, *query, sample_states, view_states, instance_states);
+    } else {
 #endif
-              ) {
-            results.insert_sample(item, inst, ++i);
-          }
-        }
+      for (typename InstanceMap::iterator it = instance_map_.begin(),
+           the_end = instance_map_.end(); it != the_end; ++it) {
+        rake_instance(results, get_handle_instance(it->second),
+                      sample_states, view_states, instance_states);
       }
+#ifndef OPENDDS_NO_QUERY_CONDITION
     }
+#endif
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   } else {
     const RakeData item = group_coherent_ordered_data_.get_data();
@@ -1365,6 +1659,18 @@ DDS::ReturnCode_t take_instance_i(MessageSequenceType& received_data,
   return ret;
 }
 
+#if defined ACE_HAS_CPP11 && defined OPENDDS_UNORDERED_INSTANCE_MAP
+/// The instance after 'handle' for read/take_next_instance.  A rehash can
+/// reorder instance_map_ between calls, so they walk the instances in the
+/// order of their handles instead.
+DDS::InstanceHandle_t next_instance_handle(DDS::InstanceHandle_t handle) const
+{
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, instances_lock_, DDS::HANDLE_NIL);
+  const SubscriptionInstanceMapType::const_iterator it = instances_.upper_bound(handle);
+  return it == instances_.end() ? DDS::HANDLE_NIL : it->first;
+}
+#endif
+
 DDS::ReturnCode_t read_next_instance_i(MessageSequenceType& received_data,
                                        DDS::SampleInfoSeq& info_seq,
                                        CORBA::Long max_samples,
@@ -1378,10 +1684,12 @@ DDS::ReturnCode_t read_next_instance_i(MessageSequenceType& received_data,
   int)
 #endif
 {
-  DDS::InstanceHandle_t handle(DDS::HANDLE_NIL);
-
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, DDS::RETCODE_ERROR);
 
+#if defined ACE_HAS_CPP11 && defined OPENDDS_UNORDERED_INSTANCE_MAP
+  for (DDS::InstanceHandle_t handle = next_instance_handle(a_handle);
+       handle != DDS::HANDLE_NIL; handle = next_instance_handle(handle)) {
+#else
   typename InstanceMap::iterator it;
   const typename InstanceMap::iterator the_end = instance_map_.end ();
 
@@ -1398,7 +1706,8 @@ DDS::ReturnCode_t read_next_instance_i(MessageSequenceType& received_data,
   }
 
   for (; it != the_end; ++it) {
-    handle = it->second;
+    const DDS::InstanceHandle_t handle = it->second;
+#endif
     const DDS::ReturnCode_t status =
       read_instance_i(received_data, info_seq, max_samples, handle,
                       sample_states, view_states, instance_states,
@@ -1432,6 +1741,10 @@ DDS::ReturnCode_t take_next_instance_i(MessageSequenceType& received_data,
 {
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_, DDS::RETCODE_ERROR);
 
+#if defined ACE_HAS_CPP11 && defined OPENDDS_UNORDERED_INSTANCE_MAP
+  for (DDS::InstanceHandle_t handle = next_instance_handle(a_handle);
+       handle != DDS::HANDLE_NIL; handle = next_instance_handle(handle)) {
+#else
   typename InstanceMap::iterator it;
   const typename InstanceMap::iterator the_end = instance_map_.end ();
 
@@ -1447,9 +1760,9 @@ DDS::ReturnCode_t take_next_instance_i(MessageSequenceType& received_data,
     }
   }
 
-  DDS::InstanceHandle_t handle(DDS::HANDLE_NIL);
   for (; it != the_end; ++it) {
-    handle = it->second;
+    const DDS::InstanceHandle_t handle = it->second;
+#endif
     const DDS::ReturnCode_t status =
       take_instance_i(received_data, info_seq, max_samples, handle,
                       sample_states, view_states, instance_states,
@@ -1821,6 +2134,10 @@ void finish_store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_da
 
   instance_ptr->rcvd_strategy_->add(ptr);
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  query_stored(instance_ptr->instance_handle_);
+#endif
+
   if (! is_dispose_msg  && ! is_unregister_msg
       && instance_ptr->rcvd_samples_.size_ > get_depth())
     {
@@ -1883,6 +2200,14 @@ void finish_store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_da
 
         if (!CORBA::is_nil(listener.in()))
           {
+            if (coalesce_data_available()) {
+              coalesced_data_available();
+              return;
+            }
+            if (dispatch_data_available()) {
+              return;
+            }
+
             ACE_GUARD(typename DataReaderImpl::Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
 
             listener->on_data_available(this);
@@ -2010,6 +2335,26 @@ DDS::ReturnCode_t check_inputs (
   return DDS::RETCODE_OK;
 }
 
+/// The preconditions of check_inputs() that apply to read_views() and
+/// take_views(), whose sequence is always filled in like a zero-copy one.
+template <typename View>
+DDS::ReturnCode_t check_inputs(const char* method_name,
+                               SampleViewSeq<View>& views,
+                               DDS::SampleInfoSeq& info_seq)
+{
+  if (views.length() != info_seq.length()) {
+    ACE_DEBUG((LM_DEBUG,
+               ACE_TEXT("(%P|%t) %CDataReaderImpl::%C ")
+               ACE_TEXT("PRECONDITION_NOT_MET sample and info input ")
+               ACE_TEXT("sequences do not match.\n"),
+               TraitsType::type_name(),
+               method_name));
+    return DDS::RETCODE_PRECONDITION_NOT_MET;
+  }
+
+  return DDS::RETCODE_OK;
+}
+
 class FilterDelayedHandler : public Watchdog {
 public:
   FilterDelayedHandler(DataReaderImpl_T<MessageType>& data_reader_impl)
@@ -2240,6 +2585,20 @@ public:
 
 unique_ptr<DataAllocator>& data_allocator() { return filter_delayed_handler_->data_allocator_; }
 
+typedef bool (*ExtractKey)(const SerializedPayload& payload, MessageType& sample);
+
+/// Set by enable_views()
+ExtractKey extract_key_;
+
+/// Protects extract_key_, which demarshal() reads without the sample_lock_
+mutable ACE_Thread_Mutex extract_key_lock_;
+
+ExtractKey extract_key() const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, extract_key_lock_, 0);
+  return extract_key_;
+}
+
 RcHandle<FilterDelayedHandler> filter_delayed_handler_;
 
 InstanceMap  instance_map_;
@@ -43,6 +43,7 @@
 #include "ace/Reactor.h"
 #include "ace/Auto_Ptr.h"
 
+#include <cstring>
 #include <stdexcept>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -354,6 +355,7 @@ DataWriterImpl::ReaderInfo::ReaderInfo(const char* filterClassName,
 DataWriterImpl::ReaderInfo::~ReaderInfo()
 {
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  compiled_.reset();
   eval_ = RcHandle<FilterEvaluator>();
   RcHandle<DomainParticipantImpl> participant = participant_.lock();
   if (participant && !filter_.empty()) {
@@ -420,9 +422,7 @@ DataWriterImpl::association_complete_i(const RepoId& remote_id)
 
   bool reader_durable = false;
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-  OPENDDS_STRING filterClassName;
-  RcHandle<FilterEvaluator> eval;
-  DDS::StringSeq expression_params;
+  RcHandle<CompiledFilter> filter;
 #endif
   {
     ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, this->lock_);
@@ -442,9 +442,7 @@ DataWriterImpl::association_complete_i(const RepoId& remote_id)
     if (it != reader_info_.end()) {
       reader_durable = it->second.durable_;
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-      filterClassName = it->second.filter_class_name_;
-      eval = it->second.eval_;
-      expression_params = it->second.expression_params_;
+      filter = serialized_filter(it->second);
 #endif
     }
   }
@@ -515,7 +513,7 @@ DataWriterImpl::association_complete_i(const RepoId& remote_id)
     // samples.
     this->data_container_->reenqueue_all(remote_id, this->qos_.lifespan
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-                                         , filterClassName, eval.in(), expression_params
+                                         , filter.in()
 #endif
                                         );
 
@@ -719,9 +717,7 @@ void DataWriterImpl::replay_durable_data_for(const RepoId& remote_id)
 
   bool reader_durable = false;
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-  OPENDDS_STRING filterClassName;
-  RcHandle<FilterEvaluator> eval;
-  DDS::StringSeq expression_params;
+  RcHandle<CompiledFilter> filter;
 #endif
 
   {
@@ -731,9 +727,7 @@ void DataWriterImpl::replay_durable_data_for(const RepoId& remote_id)
     if (it != reader_info_.end()) {
       reader_durable = it->second.durable_;
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-      filterClassName = it->second.filter_class_name_;
-      eval = it->second.eval_;
-      expression_params = it->second.expression_params_;
+      filter = serialized_filter(it->second);
 #endif
     }
   }
@@ -744,7 +738,7 @@ void DataWriterImpl::replay_durable_data_for(const RepoId& remote_id)
     // samples.
     this->data_container_->reenqueue_all(remote_id, this->qos_.lifespan
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-                                         , filterClassName, eval.in(), expression_params
+                                         , filter.in()
 #endif
                                          );
 
@@ -944,6 +938,7 @@ DataWriterImpl::update_subscription_params(const RepoId& readerId,
 
   if (iter != reader_info_.end()) {
     iter->second.expression_params_ = params;
+    iter->second.compiled_.reset();
 
   } else if (DCPS_debug_level > 4 &&
              TheServiceParticipant->publisher_content_filter()) {
@@ -1821,6 +1816,26 @@ DataWriterImpl::write(Message_Block_Ptr data,
                     get_lock (),
                     DDS::RETCODE_ERROR);
 
+  const DDS::ReturnCode_t ret =
+    enqueue_sample(move(data), handle, source_timestamp, filter_out);
+
+  if (ret != DDS::RETCODE_OK) {
+    return ret;
+  }
+
+  send_enqueued(guard);
+
+  return DDS::RETCODE_OK;
+}
+
+DDS::ReturnCode_t
+DataWriterImpl::enqueue_sample(Message_Block_Ptr data,
+                               DDS::InstanceHandle_t handle,
+                               const DDS::Time_t& source_timestamp,
+                               GUIDSeq* filter_out)
+{
+  DBG_ENTRY_LVL("DataWriterImpl","enqueue_sample",6);
+
   // take ownership of sequence allocated in FooDWImpl::write_w_timestamp()
   GUIDSeq_var filter_out_var(filter_out);
 
@@ -1877,6 +1892,13 @@ DataWriterImpl::write(Message_Block_Ptr data,
   if (this->coherent_) {
     ++this->coherent_samples_;
   }
+
+  return DDS::RETCODE_OK;
+}
+
+void
+DataWriterImpl::send_enqueued(ACE_Guard<ACE_Recursive_Thread_Mutex>& guard)
+{
   SendStateDataSampleList list;
 
   ACE_UINT64 transaction_id = this->get_unsent_data(list);
@@ -1899,8 +1921,12 @@ DataWriterImpl::write(Message_Block_Ptr data,
 
     this->send(list, transaction_id);
   }
+}
 
-  return DDS::RETCODE_OK;
+bool
+DataWriterImpl::enqueue_would_block(DDS::InstanceHandle_t handle)
+{
+  return data_container_->would_block(handle);
 }
 
 void
@@ -2264,32 +2290,67 @@ DataWriterImpl::parent() const
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
 bool
 DataWriterImpl::filter_out(const DataSampleElement& elt,
-                           const OPENDDS_STRING& filterClassName,
-                           const FilterEvaluator& evaluator,
-                           const DDS::StringSeq& expression_params) const
+                           const CompiledFilter& filter) const
 {
-  TypeSupportImpl* const typesupport =
-    dynamic_cast<TypeSupportImpl*>(topic_servant_->get_type_support());
+  if (!elt.get_header().valid_data() && filter.has_non_key_fields()) {
+    return true;
+  }
+  return !filter.eval(elt.get_sample()->cont(),
+                      elt.get_header().byte_order_ != ACE_CDR_BYTE_ORDER,
+                      elt.get_header().cdr_encapsulation_);
+}
 
-  if (!typesupport) {
-    ACE_ERROR((LM_ERROR, "(%P|%t) ERROR DataWriterImpl::filter_out - Could not cast type support, not filtering\n"));
-    return false;
+namespace {
+  bool same_params(const DDS::StringSeq& a, const DDS::StringSeq& b)
+  {
+    if (a.length() != b.length()) {
+      return false;
+    }
+    for (CORBA::ULong i = 0; i < a.length(); ++i) {
+      if (std::strcmp(a[i], b[i]) != 0) {
+        return false;
+      }
+    }
+    return true;
   }
+}
 
-  if (filterClassName == "DDSSQL" ||
-      filterClassName == "OPENDDSSQL") {
-    const MetaStruct& meta = typesupport->getMetaStructForType();
-    if (!elt.get_header().valid_data() && evaluator.has_non_key_fields(meta)) {
-      return true;
+const CompiledFilter&
+DataWriterImpl::compiled_filter(ReaderInfo& info, const MetaStruct& meta)
+{
+  if (!info.compiled_) {
+    for (RepoIdToReaderInfoMap::const_iterator it = reader_info_.begin();
+         it != reader_info_.end(); ++it) {
+      const ReaderInfo& other = it->second;
+      if (other.compiled_ && other.eval_ == info.eval_
+          && same_params(other.expression_params_, info.expression_params_)) {
+        info.compiled_ = other.compiled_;
+        return *info.compiled_;
+      }
     }
-    return !evaluator.eval(elt.get_sample()->cont(),
-                           elt.get_header().byte_order_ != ACE_CDR_BYTE_ORDER,
-                           elt.get_header().cdr_encapsulation_, meta,
-                           expression_params);
+    info.compiled_ = info.eval_->compile(meta, info.expression_params_);
   }
-  else {
-    return false;
+  return *info.compiled_;
+}
+
+RcHandle<CompiledFilter>
+DataWriterImpl::serialized_filter(const ReaderInfo& info) const
+{
+  if (!info.eval_ || (info.filter_class_name_ != "DDSSQL" &&
+                      info.filter_class_name_ != "OPENDDSSQL")) {
+    return RcHandle<CompiledFilter>();
+  }
+
+  TypeSupportImpl* const typesupport =
+    dynamic_cast<TypeSupportImpl*>(topic_servant_->get_type_support());
+
+  if (!typesupport) {
+    ACE_ERROR((LM_ERROR, "(%P|%t) ERROR DataWriterImpl::serialized_filter - Could not cast type support, not filtering\n"));
+    return RcHandle<CompiledFilter>();
   }
+
+  return info.eval_->compile(typesupport->getMetaStructForType(),
+                             info.expression_params_, true);
 }
 #endif
 
@@ -254,6 +254,30 @@ public:
                           const DDS::Time_t& source_timestamp,
                           GUIDSeq* filter_out);
 
+  /**
+   * The part of write() that queues the sample in the WriteDataContainer,
+   * without sending it.  The caller holds get_lock() and calls
+   * send_enqueued() once it has queued all of its samples.
+   */
+  DDS::ReturnCode_t enqueue_sample(Message_Block_Ptr sample,
+                                   DDS::InstanceHandle_t handle,
+                                   const DDS::Time_t& source_timestamp,
+                                   GUIDSeq* filter_out);
+
+  /**
+   * Tell the transport to send the samples queued by enqueue_sample(), as
+   * one send list, unless the publisher is suspended.  Releases 'guard',
+   * which holds get_lock().
+   */
+  void send_enqueued(ACE_Guard<ACE_Recursive_Thread_Mutex>& guard);
+
+  /**
+   * True if enqueue_sample() for 'handle' would wait for the transport to
+   * release samples because of the resource limits.  Called with
+   * get_lock() held.
+   */
+  bool enqueue_would_block(DDS::InstanceHandle_t handle);
+
   /**
    * Delegate to the WriteDataContainer to dispose all data
    * samples for a given instance and tell the transport to
@@ -438,10 +462,9 @@ public:
   virtual RcHandle<EntityImpl> parent() const;
 
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  /// True if 'filter' (compiled for serialized samples) excludes 'elt'
   bool filter_out(const DataSampleElement& elt,
-                  const OPENDDS_STRING& filterClassName,
-                  const FilterEvaluator& evaluator,
-                  const DDS::StringSeq& expression_params) const;
+                  const CompiledFilter& filter) const;
 #endif
 
   /**
@@ -498,6 +521,8 @@ protected:
     OPENDDS_STRING filter_;
     DDS::StringSeq expression_params_;
     RcHandle<FilterEvaluator> eval_;
+    /// eval_ compiled with expression_params_, see compiled_filter()
+    RcHandle<CompiledFilter> compiled_;
 #endif
     SequenceNumber expected_sequence_;
     bool durable_;
@@ -509,6 +534,20 @@ protected:
   typedef OPENDDS_MAP_CMP(RepoId, ReaderInfo, GUID_tKeyLessThan) RepoIdToReaderInfoMap;
   RepoIdToReaderInfoMap reader_info_;
 
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  /**
+   * The filter of 'info' compiled for unserialized samples of the type
+   * 'meta' describes.  Readers with the same filter expression and
+   * parameters share one compiled filter, so that the writer can evaluate
+   * it once per sample for all of them.  Caller holds reader_info_lock_.
+   */
+  const CompiledFilter& compiled_filter(ReaderInfo& info, const MetaStruct& meta);
+
+  /// The filter of 'info' compiled for serialized samples, or nil if it
+  /// doesn't have one that the writer can evaluate.
+  RcHandle<CompiledFilter> serialized_filter(const ReaderInfo& info) const;
+#endif
+
   struct AckCustomization {
     GUIDSeq customized_;
     AckToken& token_;
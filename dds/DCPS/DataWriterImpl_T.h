@@ -8,6 +8,12 @@
 #include "dds/DCPS/TypeSupportImpl.h"
 #include "dcps_export.h"
 #include "dds/DCPS/SafetyProfileStreams.h"
+#include "dds/DCPS/KeyHash.h"
+
+#include "ace/Atomic_Op_T.h"
+
+#include <algorithm>
+#include <new>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -33,17 +39,26 @@ public:
   typedef DDSTraits<MessageType> TraitsType;
   typedef MarshalTraits<MessageType> MarshalTraitsType;
 
+#if defined ACE_HAS_CPP11 && defined OPENDDS_UNORDERED_INSTANCE_MAP
+  typedef KeyEqual<MessageType, typename TraitsType::LessThanType> KeyEqualType;
+  typedef OPENDDS_UNORDERED_MAP_CHE_T(MessageType, DDS::InstanceHandle_t,
+                                      typename TraitsType::HashType, KeyEqualType) InstanceMap;
+#else
   typedef OPENDDS_MAP_CMP_T(MessageType, DDS::InstanceHandle_t,
                             typename TraitsType::LessThanType) InstanceMap;
+#endif
   typedef ::OpenDDS::DCPS::Dynamic_Cached_Allocator_With_Overflow<ACE_Thread_Mutex> DataAllocator;
 
   enum {
-    cdr_header_size = 4
+    cdr_header_size = 4,
+    min_growth_size = 256,
+    loan_offset = 8  // start of a sample loaned in place, see loan_sample()
   };
 
   DataWriterImpl_T()
     : marshaled_size_(0)
     , key_marshaled_size_(0)
+    , marshaled_size_estimate_(0)
   {
     MessageType data;
     if (MarshalTraitsType::gen_is_bounded_size()) {
@@ -63,6 +78,9 @@ public:
 
   virtual ~DataWriterImpl_T()
   {
+    for (size_t i = 0; i < loan_pool_.size(); ++i) {
+      delete loan_pool_[i];
+    }
   }
 
   virtual DDS::InstanceHandle_t register_instance(const MessageType& instance)
@@ -151,29 +169,232 @@ public:
     }
 
     // list of reader RepoIds that should not get data
-    OpenDDS::DCPS::GUIDSeq_var filter_out;
-#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-    if (TheServiceParticipant->publisher_content_filter()) {
-      ACE_GUARD_RETURN(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_, DDS::RETCODE_ERROR);
-      for (RepoIdToReaderInfoMap::iterator iter = reader_info_.begin(),
-           end = reader_info_.end(); iter != end; ++iter) {
-        const ReaderInfo& ri = iter->second;
-        if (!ri.eval_.is_nil()) {
-          if (!filter_out.ptr()) {
-            filter_out = new OpenDDS::DCPS::GUIDSeq;
-          }
-          if (!ri.eval_->eval(instance_data, ri.expression_params_)) {
-            push_back(filter_out.inout(), iter->first);
-          }
+    OpenDDS::DCPS::GUIDSeq* const filter_out = filtered_readers(instance_data);
+
+    Message_Block_Ptr marshalled(
+      dds_marshal(instance_data, OpenDDS::DCPS::FULL_MARSHALING));
+    return OpenDDS::DCPS::DataWriterImpl::write(
+      move(marshalled), handle, source_timestamp, filter_out);
+  }
+
+  /**
+   * Write each element of 'samples' as write_w_timestamp() would, using
+   * the corresponding element of 'handles' and 'source_timestamps'.
+   * 'handles' may be empty, which is the same as HANDLE_NIL for every
+   * sample, and 'source_timestamps' may be empty to use the current time.
+   *
+   * The samples are marshaled before taking the writer's lock, queued
+   * under one acquisition of it, and handed to the transport as one send
+   * list, which lets it pack them into as few datagrams as it can.  When
+   * the resource limits would make a sample wait for the transport, the
+   * samples queued so far are sent first.  If a sample can't be written
+   * the ones before it are still sent and its error is returned.  This is
+   * an OpenDDS extension.
+   */
+  DDS::ReturnCode_t write_batch(
+    const typename TraitsType::MessageSequenceType& samples,
+    const DDS::InstanceHandleSeq& handles,
+    const OPENDDS_VECTOR(DDS::Time_t)& source_timestamps)
+  {
+    const CORBA::ULong count = samples.length();
+    if ((handles.length() && handles.length() != count) ||
+        (!source_timestamps.empty() && source_timestamps.size() != count)) {
+      return DDS::RETCODE_BAD_PARAMETER;
+    }
+    if (!count) {
+      return DDS::RETCODE_OK;
+    }
+
+    const DDS::Time_t now = SystemTimePoint::now().to_dds_time();
+    OPENDDS_VECTOR(DDS::InstanceHandle_t) instance_handles(count, DDS::HANDLE_NIL);
+    for (CORBA::ULong i = 0; i < count; ++i) {
+      if (handles.length()) {
+        instance_handles[i] = handles[i];
+      }
+      if (instance_handles[i] == DDS::HANDLE_NIL) {
+        const DDS::ReturnCode_t ret = this->get_or_create_instance_handle(
+          instance_handles[i], samples[i],
+          source_timestamps.empty() ? now : source_timestamps[i]);
+        if (ret != DDS::RETCODE_OK) {
+          ACE_ERROR_RETURN((
+              LM_ERROR, ACE_TEXT("(%P|%t) ERROR: %CDataWriterImpl::write_batch: ")
+              ACE_TEXT("register failed: %C.\n"),
+              TraitsType::type_name(),
+              retcode_to_string(ret)),
+            ret);
         }
       }
     }
-#endif
 
-    Message_Block_Ptr marshalled(
-      dds_marshal(instance_data, OpenDDS::DCPS::FULL_MARSHALING));
+    // Each sample in a chunk of the data allocator, as write() does
+    DDS::ReturnCode_t ret = DDS::RETCODE_OK;
+    OPENDDS_VECTOR(ACE_Message_Block*) marshalled(count, 0);
+    CORBA::ULong marshalled_count = 0;
+    for (; marshalled_count < count; ++marshalled_count) {
+      marshalled[marshalled_count] =
+        dds_marshal(samples[marshalled_count], OpenDDS::DCPS::FULL_MARSHALING);
+      if (!marshalled[marshalled_count]) {
+        ret = DDS::RETCODE_ERROR;
+        break;
+      }
+    }
+
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, get_lock(), DDS::RETCODE_ERROR);
+    CORBA::ULong enqueued = 0, unsent = 0;
+    for (; enqueued < marshalled_count; ++enqueued) {
+      // Don't wait for the transport to release samples that are still
+      // queued here
+      if (unsent && this->enqueue_would_block(instance_handles[enqueued])) {
+        this->send_enqueued(guard);
+        unsent = 0;
+        if (!guard.locked()) {
+          guard.acquire();
+        }
+      }
+
+      Message_Block_Ptr sample(marshalled[enqueued]);
+      marshalled[enqueued] = 0;
+      const DDS::ReturnCode_t enqueue_ret = this->enqueue_sample(move(sample),
+        instance_handles[enqueued],
+        source_timestamps.empty() ? now : source_timestamps[enqueued],
+        filtered_readers(samples[enqueued]));
+      if (enqueue_ret != DDS::RETCODE_OK) {
+        ret = enqueue_ret;
+        break;
+      }
+      ++unsent;
+    }
+
+    if (unsent) {
+      this->send_enqueued(guard);
+    }
+
+    for (CORBA::ULong i = enqueued; i < marshalled_count; ++i) {
+      ACE_Message_Block::release(marshalled[i]);
+    }
+    return ret;
+  }
+
+  /**
+   * Loan a sample for the application to fill in and then pass to
+   * write_loaned(), or give back with return_loan() if it isn't written.
+   * The writer must be enabled.  This is an OpenDDS extension for writing
+   * without allocating memory.
+   *
+   * If the type's native layout is its wire encoding (see
+   * MarshalTraits::gen_wire_compatible_size()) and the writer doesn't swap
+   * bytes, the sample is constructed in a chunk of the writer's data
+   * allocator and write_loaned() sends that chunk as it is, without
+   * serializing the sample.  Otherwise the sample comes from a pool of
+   * samples that the writer reuses, and write_loaned() serializes it into
+   * a chunk as write() would.  Either way the sample starts out
+   * value-initialized, as MessageType() would be, must not be used after it
+   * is written or returned, and all loans must be written or returned
+   * before the writer is deleted.
+   */
+  DDS::ReturnCode_t loan_sample(MessageType*& sample)
+  {
+    sample = 0;
+    if (!this->is_enabled()) {
+      return DDS::RETCODE_NOT_ENABLED;
+    }
+
+    if (loan_in_place()) {
+      ACE_Message_Block* const mb = sample_block(marshaled_size_, data_allocator_.get());
+      if (!mb) {
+        return DDS::RETCODE_OUT_OF_RESOURCES;
+      }
+      // The chunk starts with its message block for write_loaned() to find
+      *reinterpret_cast<ACE_Message_Block**>(mb->base()) = mb;
+      mb->rd_ptr(loan_offset);
+      mb->wr_ptr(loan_offset);
+      sample = new (mb->rd_ptr()) MessageType();
+      return DDS::RETCODE_OK;
+    }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, loan_lock_, DDS::RETCODE_ERROR);
+    if (loan_pool_.empty()) {
+      sample = new MessageType();
+    } else {
+      sample = loan_pool_.back();
+      loan_pool_.pop_back();
+    }
+    return DDS::RETCODE_OK;
+  }
+
+  /**
+   * Write a sample from loan_sample() as write() would, which ends the
+   * loan whether or not it succeeds.
+   */
+  DDS::ReturnCode_t write_loaned(MessageType* sample, DDS::InstanceHandle_t handle)
+  {
+    return write_loaned(sample, handle, SystemTimePoint::now().to_dds_time());
+  }
+
+  DDS::ReturnCode_t write_loaned(MessageType* sample,
+                                 DDS::InstanceHandle_t handle,
+                                 const DDS::Time_t& source_timestamp)
+  {
+    if (!sample) {
+      return DDS::RETCODE_BAD_PARAMETER;
+    }
+
+    if (handle == DDS::HANDLE_NIL) {
+      const DDS::ReturnCode_t ret =
+        this->get_or_create_instance_handle(handle, *sample, source_timestamp);
+      if (ret != DDS::RETCODE_OK) {
+        return_loan(sample);
+        ACE_ERROR_RETURN((
+            LM_ERROR, ACE_TEXT("(%P|%t) ERROR: %CDataWriterImpl::write_loaned: ")
+            ACE_TEXT("register failed: %C.\n"),
+            TraitsType::type_name(),
+            retcode_to_string(ret)),
+          ret);
+      }
+    }
+
+    // list of reader RepoIds that should not get data
+    OpenDDS::DCPS::GUIDSeq* const filter_out = filtered_readers(*sample);
+
+    Message_Block_Ptr marshalled;
+    if (loan_in_place()) {
+      marshalled.reset(loaned_block(sample));
+      marshalled->wr_ptr(sizeof(MessageType));
+      if (this->cdr_encapsulation()) {
+        ACE_Message_Block* const header = encapsulation_block();
+        if (header) {
+          header->cont(marshalled.release());
+          marshalled.reset(header);
+        } else {
+          marshalled.reset();
+        }
+      }
+    } else {
+      marshalled.reset(dds_marshal(*sample, OpenDDS::DCPS::FULL_MARSHALING));
+      return_loan(sample);
+    }
     return OpenDDS::DCPS::DataWriterImpl::write(
-      move(marshalled), handle, source_timestamp, filter_out._retn());
+      move(marshalled), handle, source_timestamp, filter_out);
+  }
+
+  /// End the loan of a sample from loan_sample() without writing it.
+  DDS::ReturnCode_t return_loan(MessageType* sample)
+  {
+    if (!sample) {
+      return DDS::RETCODE_BAD_PARAMETER;
+    }
+
+    if (loan_in_place()) {
+      loaned_block(sample)->release();
+      return DDS::RETCODE_OK;
+    }
+
+    // The next loan mustn't see this sample's contents
+    *sample = MessageType();
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, loan_lock_, DDS::RETCODE_ERROR);
+    loan_pool_.push_back(sample);
+    return DDS::RETCODE_OK;
   }
 
   virtual DDS::ReturnCode_t
@@ -256,6 +477,11 @@ public:
     mb_allocator_.reset(new ::OpenDDS::DCPS::MessageBlockAllocator(n_chunks_ * association_chunk_multiplier_));
     db_allocator_.reset(new ::OpenDDS::DCPS::DataBlockAllocator(n_chunks_));
 
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, loan_lock_, DDS::RETCODE_ERROR);
+      loan_pool_.reserve(n_chunks_);
+    }
+
     if (::OpenDDS::DCPS::DCPS_debug_level >= 2) {
       ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) %CDataWriterImpl::enable_specific-mb ")
                  ACE_TEXT("Cached_Allocator_With_Overflow ")
@@ -346,60 +572,205 @@ private:
       serializer << ko_instance_data;
     } else { // OpenDDS::DCPS::FULL_MARSHALING
       size_t effective_size = 0, padding = 0;
+      const size_t estimate = marshaled_size_estimate_.value();
       if (marshaled_size_) {
         effective_size = marshaled_size_;
+      } else if (estimate) {
+        // Unbounded: skip the gen_find_size pass, start with a block sized
+        // from earlier samples and let the serializer append more if needed.
+        effective_size = estimate;
       } else {
         TraitsType::gen_find_size(instance_data, effective_size, padding);
         if (cdr) {
           effective_size += cdr_header_size;
         }
       }
-      if (cdr) {
+      if (cdr && !estimate) {
         effective_size += padding;
       }
 
-      ACE_NEW_MALLOC_RETURN(tmp_mb,
-        static_cast<ACE_Message_Block*>(
-          mb_allocator_->malloc(sizeof(ACE_Message_Block))),
-        ACE_Message_Block(
-          effective_size,
-          ACE_Message_Block::MB_DATA,
-          0, // cont
-          0, // data
-          data_allocator_.get(), // allocator_strategy
-          get_db_lock(), // data block locking_strategy
-          ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
-          ACE_Time_Value::zero,
-          ACE_Time_Value::max_time,
-          db_allocator_.get(),
-          mb_allocator_.get()),
-        0);
+      tmp_mb = sample_block(effective_size, data_allocator_.get());
+      if (!tmp_mb) {
+        return 0;
+      }
       mb.reset(tmp_mb);
-      OpenDDS::DCPS::Serializer serializer(mb.get(), swap, cdr
-                                           ? OpenDDS::DCPS::Serializer::ALIGN_CDR
-                                           : OpenDDS::DCPS::Serializer::ALIGN_NONE);
-      if (cdr) {
-        serializer << ACE_OutputCDR::from_octet(0);
-        serializer << ACE_OutputCDR::from_octet(swap ? !ACE_CDR_BYTE_ORDER : ACE_CDR_BYTE_ORDER);
-        serializer << ACE_CDR::UShort(0);
+      const OpenDDS::DCPS::Serializer::ChainGrowth growth = {
+        (std::max)(estimate / 2, size_t(min_growth_size)),
+        0, // data from the heap, as for the first block
+        db_allocator_.get(),
+        mb_allocator_.get(),
+        get_db_lock()
+      };
+      if (!serialize_sample(mb.get(), instance_data,
+                            marshaled_size_ ? 0 : &growth)) {
+        return 0;
       }
 
-      // If this is RTI serialization, start counting byte offset AFTER
-      // the header
-      if (cdr) {
-        // Start counting byte-offset AFTER header
-        serializer.reset_alignment();
+      if (!marshaled_size_) {
+        update_size_estimate(mb->total_length());
       }
+    }
+
+    return mb.release();
+  }
+
+  /**
+   * Serialize 'instance_data', preceded by the encapsulation header if the
+   * writer uses one, after the write pointer of 'mb'.  If 'growth' is
+   * given, blocks are added to 'mb' as needed (see Serializer::grow_chain).
+   */
+  bool serialize_sample(ACE_Message_Block* mb, const MessageType& instance_data,
+                        const OpenDDS::DCPS::Serializer::ChainGrowth* growth = 0)
+  {
+    const bool cdr = this->cdr_encapsulation(), swap = this->swap_bytes();
+    OpenDDS::DCPS::Serializer serializer(mb, swap, cdr
+                                         ? OpenDDS::DCPS::Serializer::ALIGN_CDR
+                                         : OpenDDS::DCPS::Serializer::ALIGN_NONE);
+    if (growth) {
+      serializer.grow_chain(growth);
+    }
+    if (cdr) {
+      serializer << ACE_OutputCDR::from_octet(0);
+      serializer << ACE_OutputCDR::from_octet(swap ? !ACE_CDR_BYTE_ORDER : ACE_CDR_BYTE_ORDER);
+      serializer << ACE_CDR::UShort(0);
+    }
 
-      if (!(serializer << instance_data)) {
-        ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: %CDataWriterImpl::dds_marshal(): ")
-          ACE_TEXT("instance_data serialization error.\n"),
-          TraitsType::type_name()),
-          0);
+    // If this is RTI serialization, start counting byte offset AFTER
+    // the header
+    if (cdr) {
+      // Start counting byte-offset AFTER header
+      serializer.reset_alignment();
+    }
+
+    if (!(serializer << instance_data)) {
+      ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: %CDataWriterImpl::serialize_sample(): ")
+        ACE_TEXT("instance_data serialization error.\n"),
+        TraitsType::type_name()),
+        false);
+    }
+    return true;
+  }
+
+  /**
+   * A block of 'size' bytes for serialized samples, with its message and
+   * data blocks from the writer's allocators and its data from
+   * 'data_allocator' (the heap if null).
+   */
+  ACE_Message_Block* sample_block(size_t size, ACE_Allocator* data_allocator)
+  {
+    ACE_Message_Block* mb;
+    ACE_NEW_MALLOC_RETURN(mb,
+      static_cast<ACE_Message_Block*>(
+        mb_allocator_->malloc(sizeof(ACE_Message_Block))),
+      ACE_Message_Block(
+        size,
+        ACE_Message_Block::MB_DATA,
+        0, // cont
+        0, // data
+        data_allocator, // allocator_strategy
+        get_db_lock(), // data block locking_strategy
+        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
+        ACE_Time_Value::zero,
+        ACE_Time_Value::max_time,
+        db_allocator_.get(),
+        mb_allocator_.get()),
+      0);
+    return mb;
+  }
+
+  /// True if loan_sample() constructs samples in data allocator chunks
+  bool loan_in_place() const
+  {
+    return MarshalTraitsType::gen_wire_compatible_size() == sizeof(MessageType)
+      && !this->swap_bytes() && data_allocator_
+      && marshaled_size_ >= loan_offset + sizeof(MessageType);
+  }
+
+  /// The block holding a sample that loan_sample() constructed in place
+  static ACE_Message_Block* loaned_block(MessageType* sample)
+  {
+    return *reinterpret_cast<ACE_Message_Block**>(
+      reinterpret_cast<char*>(sample) - loan_offset);
+  }
+
+  /**
+   * The encapsulation header that precedes a sample loaned in place, which
+   * doesn't have room for it.  The data is shared by all of them.
+   */
+  ACE_Message_Block* encapsulation_block()
+  {
+    static const char header[cdr_header_size] = {0, ACE_CDR_BYTE_ORDER, 0, 0};
+    ACE_Message_Block* mb;
+    ACE_NEW_MALLOC_RETURN(mb,
+      static_cast<ACE_Message_Block*>(
+        mb_allocator_->malloc(sizeof(ACE_Message_Block))),
+      ACE_Message_Block(
+        cdr_header_size,
+        ACE_Message_Block::MB_DATA,
+        0, // cont
+        const_cast<char*>(header), // data, not deleted
+        0, // alloc_strategy
+        0, // data block locking_strategy
+        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
+        ACE_Time_Value::zero,
+        ACE_Time_Value::max_time,
+        db_allocator_.get(),
+        mb_allocator_.get()),
+      0);
+    mb->wr_ptr(cdr_header_size);
+    return mb;
+  }
+
+  /**
+   * Readers that shouldn't get 'instance_data' because their content
+   * filter excludes it, or null if the writer doesn't filter for any of
+   * them.  The caller owns the result.
+   */
+  OpenDDS::DCPS::GUIDSeq* filtered_readers(const MessageType& instance_data)
+  {
+    OpenDDS::DCPS::GUIDSeq_var filter_out;
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    if (TheServiceParticipant->publisher_content_filter()) {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_, 0);
+      // Readers with the same filter and parameters share a compiled
+      // filter, evaluate each one only once
+      typedef OPENDDS_MAP(const OpenDDS::DCPS::CompiledFilter*, bool) FilterResults;
+      FilterResults results;
+      for (RepoIdToReaderInfoMap::iterator iter = reader_info_.begin(),
+           end = reader_info_.end(); iter != end; ++iter) {
+        ReaderInfo& ri = iter->second;
+        if (!ri.eval_.is_nil()) {
+          if (!filter_out.ptr()) {
+            filter_out = new OpenDDS::DCPS::GUIDSeq;
+          }
+          const OpenDDS::DCPS::CompiledFilter& filter =
+            compiled_filter(ri, OpenDDS::DCPS::getMetaStruct<MessageType>());
+          const FilterResults::iterator found = results.find(&filter);
+          const bool pass = found != results.end() ? found->second
+            : (results[&filter] = filter.eval(instance_data));
+          if (!pass) {
+            push_back(filter_out.inout(), iter->first);
+          }
+        }
       }
     }
+#else
+    ACE_UNUSED_ARG(instance_data);
+#endif
+    return filter_out._retn();
+  }
 
-    return mb.release();
+  /// Track the marshaled size of unbounded samples: jump up to a larger
+  /// sample right away so the next one likely fits in a single block, and
+  /// decay slowly after smaller ones.
+  void update_size_estimate(size_t size)
+  {
+    const size_t estimate = marshaled_size_estimate_.value();
+    if (size >= estimate) {
+      marshaled_size_estimate_ = size;
+    } else {
+      marshaled_size_estimate_ = estimate - (estimate - size) / 8;
+    }
   }
 
 /**
@@ -471,9 +842,15 @@ private:
   InstanceMap instance_map_;
   size_t marshaled_size_;
   size_t key_marshaled_size_;
+  /// Running estimate of the marshaled size of unbounded samples, used
+  /// instead of gen_find_size once the first sample has been written.
+  ACE_Atomic_Op<ACE_Thread_Mutex, size_t> marshaled_size_estimate_;
   unique_ptr<DataAllocator> data_allocator_;
   unique_ptr<MessageBlockAllocator> mb_allocator_;
   unique_ptr<DataBlockAllocator> db_allocator_;
+  /// Samples for loan_sample() to reuse when it can't loan them in place
+  OPENDDS_VECTOR(MessageType*) loan_pool_;
+  ACE_Thread_Mutex loan_lock_;
 
   // A class, normally provided by an unit test, that needs access to
   // private methods/members.
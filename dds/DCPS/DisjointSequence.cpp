@@ -52,32 +52,31 @@ DisjointSequence::insert_i(const SequenceRange& range,
     sequences_.lower_bound(SequenceRange(1 /*ignored*/,
                                          (previous > 0) ? previous
                                          : SequenceNumber::ZERO()));
-  if (range_below != sequences_.end()) {
+  if (gaps) {
+    // report the parts of range not covered by [range_below, range_above)
+    SequenceNumber::Value next = range.first.getValue();
+    for (RangeSet::iterator gap_iter = range_below; gap_iter != range_above;
+         ++gap_iter) {
+      const SequenceNumber::Value present = gap_iter->first.getValue();
+      if (present > next && next <= range.second.getValue()) {
+        gaps->push_back(SequenceRange(next,
+                                      std::min(present - 1,
+                                               range.second.getValue())));
+      }
+      next = std::max(next, gap_iter->second.getValue() + 1);
+    }
+    if (next <= range.second.getValue()) {
+      gaps->push_back(SequenceRange(next, range.second));
+    }
+  }
+
+  if (range_below != range_above) {
     // if low end falls inside of the range_below range
     // then combine
     if (newRange.first > range_below->first) {
       newRange.first = range_below->first;
     }
 
-    if (gaps) {
-      RangeSet::iterator gap_iter = range_below;
-      if (range.first < gap_iter->second) {
-        gaps->push_back(SequenceRange(range.first,
-                                      gap_iter->second.previous()));
-      }
-      SequenceNumber last_gap = gap_iter++->second;
-      for (; gap_iter != range_above; ++gap_iter) {
-        const SequenceNumber in_range =
-          std::min(gap_iter->first.previous().getValue(),
-                   range.second.getValue());
-        gaps->push_back(SequenceRange(++last_gap, in_range));
-        last_gap = gap_iter->second;
-      }
-      if (last_gap < range.second) {
-        gaps->push_back(SequenceRange(++last_gap, range.second));
-      }
-    }
-
     sequences_.erase(range_below, range_above);
   }
 
@@ -102,7 +101,7 @@ DisjointSequence::insert(SequenceNumber value, CORBA::ULong num_bits,
 
     if (bit == 0) {
       x = static_cast<CORBA::ULong>(bits[i / 32]);
-      if (x == 0) {
+      if (x == 0 && !range_start_is_valid) {
         // skip an entire Long if it's all 0's (adds 32 due to ++i)
         i += 31;
         bit = 31;
@@ -107,6 +107,8 @@ public:
   void dump() const;
 
 private:
+  friend class BitmapDisjointSequence;
+
   static void validate(const SequenceRange& range);
 
   static bool SequenceRange_LessThan(const SequenceRange& lhs,
@@ -15,6 +15,7 @@
 #include "FilterExpressionGrammar.h"
 #include "AstNodeWrapper.h"
 #include "Definitions.h"
+#include "SampleView.h"
 #include "dds/DCPS/SafetyProfileStreams.h"
 
 #include <ace/ACE.h>
@@ -67,8 +68,10 @@ FilterEvaluator::FilterEvaluator(const char* filter, bool allowOrderBy)
 
 FilterEvaluator::FilterEvaluator(const AstNodeWrapper& yardNode)
   : extended_grammar_(false)
-  , filter_root_(walkAst(yardNode))
+  , filter_root_(0)
+  , number_parameters_(0)
 {
+  filter_root_ = walkAst(yardNode);
 }
 
 class FilterEvaluator::EvalNode {
@@ -96,6 +99,10 @@ public:
 
   virtual Value eval(DataForEval& data) = 0;
 
+  virtual CompiledFilter::Node* compile(const MetaStruct& meta,
+                                        const DDS::StringSeq& params,
+                                        bool serialized) const = 0;
+
 private:
   static void deleteChild(EvalNode* child)
   {
@@ -129,6 +136,7 @@ FilterEvaluator::SerializedForEval::lookup(const char* field) const
                  cdr_ ? Serializer::ALIGN_CDR : Serializer::ALIGN_NONE);
   if (cdr_) {
     ser.skip(4); // CDR encapsulation header
+    ser.reset_alignment();
   }
   const Value v = meta_.getValue(ser, field);
   cache_.insert(std::make_pair(OPENDDS_STRING(field), v));
@@ -148,7 +156,7 @@ bool FilterEvaluator::has_non_key_fields(const MetaStruct& meta) const
     }
   }
 
-  if (filter_root_->has_non_key_fields(meta)) {
+  if (filter_root_ && filter_root_->has_non_key_fields(meta)) {
     return true;
   }
 
@@ -174,6 +182,10 @@ namespace {
       return !meta.isDcpsKey(fieldName_.c_str());
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
     OPENDDS_STRING fieldName_;
   };
 
@@ -207,6 +219,10 @@ namespace {
       return value_;
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
     Value value_;
   };
 
@@ -221,6 +237,10 @@ namespace {
       return Value(value_, true);
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
     char value_;
   };
 
@@ -235,6 +255,10 @@ namespace {
       return Value(value_, true);
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
     double value_;
   };
 
@@ -251,6 +275,10 @@ namespace {
       return Value(value_.c_str(), true);
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
     OPENDDS_STRING value_;
   };
 
@@ -267,6 +295,10 @@ namespace {
       return Value(data.params_[static_cast<CORBA::ULong>(param_)], true);
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
     size_t param() { return param_; }
 
     size_t param_;
@@ -311,6 +343,10 @@ namespace {
       return false; // not reached
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
   private:
     void setOperator(AstNode* node)
     {
@@ -360,6 +396,10 @@ namespace {
       return invert_ ? !btwn : btwn;
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
   private:
     bool invert_;
     FilterEvaluator::Operand* field_;
@@ -400,6 +440,10 @@ namespace {
       return Value(0);
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
   private:
     Operator op_;
   };
@@ -444,6 +488,10 @@ namespace {
       return children_[1]->eval(data);
     }
 
+    CompiledFilter::Node* compile(const MetaStruct& meta,
+                                  const DDS::StringSeq& params,
+                                  bool serialized) const;
+
   private:
     LogicalOp op_;
   };
@@ -817,6 +865,10 @@ namespace {
 bool
 Value::operator==(const Value& v) const
 {
+  if (type_ == v.type_) {
+    Equals visitor(*this);
+    return visit(visitor, v);
+  }
   Value lhs = *this;
   Value rhs = v;
   conversion(lhs, rhs);
@@ -827,6 +879,10 @@ Value::operator==(const Value& v) const
 bool
 Value::operator<(const Value& v) const
 {
+  if (type_ == v.type_) {
+    Less visitor(*this);
+    return visit(visitor, v);
+  }
   Value lhs = *this;
   Value rhs = v;
   conversion(lhs, rhs);
@@ -837,6 +893,10 @@ Value::operator<(const Value& v) const
 Value
 Value::operator%(const Value& v) const
 {
+  if (type_ == v.type_) {
+    Modulus visitor(*this);
+    return visit(visitor, v);
+  }
   Value lhs = *this;
   Value rhs = v;
   conversion(lhs, rhs);
@@ -844,24 +904,32 @@ Value::operator%(const Value& v) const
   return visit(visitor, rhs);
 }
 
+namespace {
+  /// Translate the pattern of a LIKE into one for ACE::wild_match()
+  OPENDDS_STRING like_pattern(const char* like)
+  {
+    OPENDDS_STRING pattern(like);
+    // escape ? or * in the pattern string so they are not wildcards
+    for (size_t i = pattern.find_first_of("?*"); i < pattern.length();
+        i = pattern.find_first_of("?*", i + 1)) {
+      pattern.insert(i++, 1, '\\');
+    }
+    // translate _ and % wildcards into those used by ACE::wild_match() (?, *)
+    for (size_t i = pattern.find_first_of("_%"); i < pattern.length();
+        i = pattern.find_first_of("_%", i + 1)) {
+      pattern[i] = (pattern[i] == '_') ? '?' : '*';
+    }
+    return pattern;
+  }
+}
+
 bool
 Value::like(const Value& v) const
 {
   if (type_ != VAL_STRING || v.type_ != VAL_STRING) {
     throw std::runtime_error("'like' operator called on non-string arguments.");
   }
-  OPENDDS_STRING pattern(v.s_);
-  // escape ? or * in the pattern string so they are not wildcards
-  for (size_t i = pattern.find_first_of("?*"); i < pattern.length();
-      i = pattern.find_first_of("?*", i + 1)) {
-    pattern.insert(i++, 1, '\\');
-  }
-  // translate _ and % wildcards into those used by ACE::wild_match() (?, *)
-  for (size_t i = pattern.find_first_of("_%"); i < pattern.length();
-      i = pattern.find_first_of("_%", i + 1)) {
-    pattern[i] = (pattern[i] == '_') ? '?' : '*';
-  }
-  return ACE::wild_match(s_, pattern.c_str(), true, true);
+  return ACE::wild_match(s_, like_pattern(v.s_).c_str(), true, true);
 }
 
 namespace {
@@ -963,10 +1031,543 @@ Value::conversion(Value& lhs, Value& rhs)
   }
 }
 
+namespace {
+  class Constant;
+}
+
+class CompiledFilter::Node {
+public:
+  virtual ~Node() {}
+
+  /// Result of a node that is used as a condition
+  virtual bool test(const void* sample) const
+  {
+    return value(sample).b_;
+  }
+
+  /// Result of a node that is used as an operand
+  virtual Value value(const void* sample) const
+  {
+    return test(sample);
+  }
+
+  /// Literals and parameters return themselves
+  virtual const Constant* constant() const { return 0; }
+};
+
+namespace {
+  typedef CompiledFilter::Node CompiledNode;
+
+  /// A literal or parameter.  Value::conversion() always converts these to
+  /// the type of the (non-constant) value they are compared with, so that
+  /// is done here for every type, once.
+  class Constant : public CompiledNode {
+  public:
+    explicit Constant(const Value& value)
+      : value_(value)
+    {
+      for (int t = Value::VAL_BOOL; t <= Value::VAL_STRING; ++t) {
+        Value converted(value_);
+        const bool ok = converted.type_ == t
+          || converted.convert(static_cast<Value::Type>(t));
+        converted_.push_back(ok ? converted : value_);
+        convertible_.push_back(ok);
+      }
+    }
+
+    Value value(const void*) const
+    {
+      return value_;
+    }
+
+    const Constant* constant() const { return this; }
+
+    const Value& get() const { return value_; }
+
+    /// The constant converted for comparing with 'other', or 0 if 'other'
+    /// may be converted instead (it's also a literal or parameter).
+    const Value* converted_for(const Value& other) const
+    {
+      if (other.conversion_preferred_) {
+        return 0;
+      }
+      if (!convertible_[other.type_]) {
+        throw std::runtime_error("Types don't match and aren't convertible.");
+      }
+      return &converted_[other.type_];
+    }
+
+  private:
+    Value value_;
+    OPENDDS_VECTOR(Value) converted_;
+    OPENDDS_VECTOR(bool) convertible_;
+  };
+
+  /// A field read with the accessors from MetaStruct::getValueAccess()
+  class FieldAccess : public CompiledNode {
+  public:
+    FieldAccess(MetaStruct::ValueAccess access,
+                const OPENDDS_VECTOR(MetaStruct::MemberAccess)& path)
+      : access_(access)
+      , path_(path)
+    {}
+
+    Value value(const void* sample) const
+    {
+      for (OPENDDS_VECTOR(MetaStruct::MemberAccess)::const_iterator i = path_.begin();
+           i != path_.end(); ++i) {
+        sample = (*i)(sample);
+      }
+      return access_(sample);
+    }
+
+  private:
+    MetaStruct::ValueAccess access_;
+    OPENDDS_VECTOR(MetaStruct::MemberAccess) path_;
+  };
+
+  /// A field that the MetaStruct can only look up by name
+  class FieldByName : public CompiledNode {
+  public:
+    FieldByName(const MetaStruct& meta, const OPENDDS_STRING& field)
+      : meta_(meta)
+      , field_(field)
+    {}
+
+    Value value(const void* sample) const
+    {
+      return meta_.getValue(sample, field_.c_str());
+    }
+
+  private:
+    const MetaStruct& meta_;
+    OPENDDS_STRING field_;
+  };
+
+  /// A field of serialized samples that is at the same position in all of
+  /// them, see MetaStruct::getSerializedAccess()
+  class SerializedFieldAccess : public CompiledNode {
+  public:
+    SerializedFieldAccess(MetaStruct::SerializedValueAccess access,
+                          size_t aligned_offset, size_t packed_offset)
+      : access_(access)
+      , aligned_offset_(aligned_offset)
+      , packed_offset_(packed_offset)
+    {}
+
+    Value value(const void* sample) const
+    {
+      return access_(*static_cast<const SerializedPayload*>(sample),
+                     aligned_offset_, packed_offset_);
+    }
+
+  private:
+    MetaStruct::SerializedValueAccess access_;
+    size_t aligned_offset_;
+    size_t packed_offset_;
+  };
+
+  /// Any other field of serialized samples, found by skipping the ones
+  /// before it
+  class SerializedFieldByName : public CompiledNode {
+  public:
+    SerializedFieldByName(const MetaStruct& meta, const OPENDDS_STRING& field)
+      : meta_(meta)
+      , field_(field)
+    {}
+
+    Value value(const void* sample) const
+    {
+      const SerializedPayload& payload =
+        *static_cast<const SerializedPayload*>(sample);
+      Message_Block_Ptr mb(payload.data_->duplicate());
+      Serializer ser(mb.get(), payload.swap_bytes_,
+                     payload.cdr_encapsulation_ ? Serializer::ALIGN_CDR : Serializer::ALIGN_NONE);
+      if (payload.cdr_encapsulation_) {
+        ser.skip(SerializedPayload::encapsulation_header_size);
+        ser.reset_alignment();
+      }
+      return meta_.getValue(ser, field_.c_str());
+    }
+
+  private:
+    const MetaStruct& meta_;
+    OPENDDS_STRING field_;
+  };
+
+  bool compare(Comparison::Operator oper, const Value& left, const Value& right)
+  {
+    switch (oper) {
+    case Comparison::OPER_EQ:
+      return left == right;
+    case Comparison::OPER_LT:
+      return left < right;
+    case Comparison::OPER_GT:
+      return right < left;
+    case Comparison::OPER_LTEQ:
+      return !(right < left);
+    case Comparison::OPER_GTEQ:
+      return !(left < right);
+    case Comparison::OPER_NEQ:
+      return !(left == right);
+    case Comparison::OPER_LIKE:
+      return left.like(right);
+    default:
+      break;
+    }
+    return false; // not reached
+  }
+
+  /// Compare the value 'left' with 'right', which is only evaluated (or for
+  /// a constant, converted) if it has to be.
+  bool compare(Comparison::Operator oper, const Value& left,
+               const CompiledNode& right, const void* sample)
+  {
+    const Constant* const constant = right.constant();
+    if (!constant) {
+      return compare(oper, left, right.value(sample));
+    }
+    const Value* const converted = constant->converted_for(left);
+    return compare(oper, left, converted ? *converted : constant->get());
+  }
+
+  class CompiledComparison : public CompiledNode {
+  public:
+    CompiledComparison(Comparison::Operator oper, CompiledNode* left,
+                       CompiledNode* right)
+      : oper_(oper)
+      , left_(left)
+      , right_(right)
+    {
+      // Keep a constant on the right, where compare() can use its conversions
+      if (left_->constant() && !right_->constant() && oper_ != Comparison::OPER_LIKE) {
+        std::swap(left_, right_);
+        switch (oper_) {
+        case Comparison::OPER_LT:
+          oper_ = Comparison::OPER_GT;
+          break;
+        case Comparison::OPER_GT:
+          oper_ = Comparison::OPER_LT;
+          break;
+        case Comparison::OPER_LTEQ:
+          oper_ = Comparison::OPER_GTEQ;
+          break;
+        case Comparison::OPER_GTEQ:
+          oper_ = Comparison::OPER_LTEQ;
+          break;
+        default:
+          break;
+        }
+      }
+    }
+
+    ~CompiledComparison()
+    {
+      delete left_;
+      delete right_;
+    }
+
+    bool test(const void* sample) const
+    {
+      return compare(oper_, left_->value(sample), *right_, sample);
+    }
+
+  private:
+    Comparison::Operator oper_;
+    CompiledNode* left_;
+    CompiledNode* right_;
+  };
+
+  /// LIKE with a constant pattern, translated for ACE::wild_match() once
+  class CompiledLike : public CompiledNode {
+  public:
+    CompiledLike(CompiledNode* left, const char* pattern)
+      : left_(left)
+      , pattern_(like_pattern(pattern))
+    {}
+
+    ~CompiledLike()
+    {
+      delete left_;
+    }
+
+    bool test(const void* sample) const
+    {
+      const Value left = left_->value(sample);
+      if (left.type_ != Value::VAL_STRING) {
+        throw std::runtime_error("'like' operator called on non-string arguments.");
+      }
+      return ACE::wild_match(left.s_, pattern_.c_str(), true, true);
+    }
+
+  private:
+    CompiledNode* left_;
+    OPENDDS_STRING pattern_;
+  };
+
+  class CompiledBetween : public CompiledNode {
+  public:
+    CompiledBetween(bool invert, CompiledNode* field, CompiledNode* low,
+                    CompiledNode* high)
+      : invert_(invert)
+      , field_(field)
+      , low_(low)
+      , high_(high)
+    {}
+
+    ~CompiledBetween()
+    {
+      delete field_;
+      delete low_;
+      delete high_;
+    }
+
+    bool test(const void* sample) const
+    {
+      const Value field = field_->value(sample);
+      const bool btwn = !compare(Comparison::OPER_LT, field, *low_, sample)
+        && !compare(Comparison::OPER_GT, field, *high_, sample);
+      return invert_ ? !btwn : btwn;
+    }
+
+  private:
+    bool invert_;
+    CompiledNode* field_;
+    CompiledNode* low_;
+    CompiledNode* high_;
+  };
+
+  class CompiledMod : public CompiledNode {
+  public:
+    CompiledMod(CompiledNode* left, CompiledNode* right)
+      : left_(left)
+      , right_(right)
+    {}
+
+    ~CompiledMod()
+    {
+      delete left_;
+      delete right_;
+    }
+
+    Value value(const void* sample) const
+    {
+      const Value left = left_->value(sample);
+      const Constant* const constant = right_->constant();
+      if (!constant) {
+        return left % right_->value(sample);
+      }
+      const Value* const converted = constant->converted_for(left);
+      return left % (converted ? *converted : constant->get());
+    }
+
+  private:
+    CompiledNode* left_;
+    CompiledNode* right_;
+  };
+
+  class CompiledLogical : public CompiledNode {
+  public:
+    CompiledLogical(Logical::LogicalOp op, CompiledNode* left,
+                    CompiledNode* right = 0)
+      : op_(op)
+      , left_(left)
+      , right_(right)
+    {}
+
+    ~CompiledLogical()
+    {
+      delete left_;
+      delete right_;
+    }
+
+    bool test(const void* sample) const
+    {
+      switch (op_) {
+      case Logical::LG_NOT:
+        return !left_->test(sample);
+      case Logical::LG_AND:
+        return left_->test(sample) && right_->test(sample);
+      case Logical::LG_OR:
+        return left_->test(sample) || right_->test(sample);
+      }
+      return false; // not reached
+    }
+
+  private:
+    Logical::LogicalOp op_;
+    CompiledNode* left_;
+    CompiledNode* right_;
+  };
+
+  CompiledNode*
+  FieldLookup::compile(const MetaStruct& meta, const DDS::StringSeq&,
+                       bool serialized) const
+  {
+    if (serialized) {
+      size_t aligned = 0, packed = 0;
+      MetaStruct::SerializedValueAccess access = 0;
+      if (meta.getSerializedAccess(fieldName_.c_str(), aligned, packed, access)
+          && access) {
+        return new SerializedFieldAccess(access, aligned, packed);
+      }
+      return new SerializedFieldByName(meta, fieldName_);
+    }
+    OPENDDS_VECTOR(MetaStruct::MemberAccess) path;
+    const MetaStruct::ValueAccess access =
+      meta.getValueAccess(fieldName_.c_str(), path);
+    if (access) {
+      return new FieldAccess(access, path);
+    }
+    return new FieldByName(meta, fieldName_);
+  }
+
+  CompiledNode*
+  LiteralInt::compile(const MetaStruct&, const DDS::StringSeq&, bool) const
+  {
+    return new Constant(value_);
+  }
+
+  CompiledNode*
+  LiteralChar::compile(const MetaStruct&, const DDS::StringSeq&, bool) const
+  {
+    return new Constant(Value(value_, true));
+  }
+
+  CompiledNode*
+  LiteralFloat::compile(const MetaStruct&, const DDS::StringSeq&, bool) const
+  {
+    return new Constant(Value(value_, true));
+  }
+
+  CompiledNode*
+  LiteralString::compile(const MetaStruct&, const DDS::StringSeq&, bool) const
+  {
+    return new Constant(Value(value_.c_str(), true));
+  }
+
+  CompiledNode*
+  Parameter::compile(const MetaStruct&, const DDS::StringSeq& params,
+                     bool) const
+  {
+    return new Constant(Value(params[static_cast<CORBA::ULong>(param_)], true));
+  }
+
+  CompiledNode*
+  Comparison::compile(const MetaStruct& meta, const DDS::StringSeq& params,
+                      bool serialized) const
+  {
+    CompiledNode* const left = left_->compile(meta, params, serialized);
+    CompiledNode* const right = right_->compile(meta, params, serialized);
+    const Constant* const pattern = right->constant();
+    if (oper_type_ == OPER_LIKE && pattern && !left->constant()
+        && pattern->get().type_ == Value::VAL_STRING) {
+      CompiledLike* const like = new CompiledLike(left, pattern->get().s_);
+      delete right;
+      return like;
+    }
+    return new CompiledComparison(oper_type_, left, right);
+  }
+
+  CompiledNode*
+  Between::compile(const MetaStruct& meta, const DDS::StringSeq& params,
+                   bool serialized) const
+  {
+    return new CompiledBetween(invert_, field_->compile(meta, params, serialized),
+                               left_->compile(meta, params, serialized),
+                               right_->compile(meta, params, serialized));
+  }
+
+  CompiledNode*
+  Call::compile(const MetaStruct& meta, const DDS::StringSeq& params,
+                bool serialized) const
+  {
+    if (children_.size() != 2) {
+      std::stringstream ss;
+      ss << MOD << " expects 2 arguments, given " << children_.size();
+      throw std::runtime_error(ss.str ());
+    }
+    return new CompiledMod(children_[0]->compile(meta, params, serialized),
+                           children_[1]->compile(meta, params, serialized));
+  }
+
+  CompiledNode*
+  Logical::compile(const MetaStruct& meta, const DDS::StringSeq& params,
+                   bool serialized) const
+  {
+    CompiledNode* const left = children_[0]->compile(meta, params, serialized);
+    if (op_ == LG_NOT) {
+      return new CompiledLogical(op_, left);
+    }
+    return new CompiledLogical(op_, left, children_[1]->compile(meta, params, serialized));
+  }
+}
+
+RcHandle<CompiledFilter>
+FilterEvaluator::compile(const MetaStruct& meta,
+                         const DDS::StringSeq& params,
+                         bool serialized) const
+{
+  if (params.length() < number_parameters_) {
+    std::stringstream ss;
+    ss << "Filter expects " << number_parameters_ << " parameters, given "
+       << params.length();
+    throw std::runtime_error(ss.str());
+  }
+  return make_rch<CompiledFilter>(meta,
+    filter_root_ ? filter_root_->compile(meta, params, serialized) : 0,
+    has_non_key_fields(meta), serialized);
+}
+
+CompiledFilter::CompiledFilter(const MetaStruct& meta, Node* root,
+                               bool has_non_key_fields, bool serialized)
+  : meta_(meta)
+  , root_(root)
+  , has_non_key_fields_(has_non_key_fields)
+  , serialized_(serialized)
+{
+}
+
+CompiledFilter::~CompiledFilter()
+{
+  delete root_;
+}
+
+bool
+CompiledFilter::eval(ACE_Message_Block* serializedSample, bool swap_bytes,
+                     bool cdr_encap) const
+{
+  OPENDDS_ASSERT(serialized_);
+  SerializedPayload payload;
+  payload.data_ = Message_Block_Shared_Ptr(serializedSample->duplicate());
+  payload.swap_bytes_ = swap_bytes;
+  payload.cdr_encapsulation_ = cdr_encap;
+  return eval_i(&payload);
+}
+
+bool
+CompiledFilter::eval_i(const void* sample) const
+{
+  return !root_ || root_->test(sample);
+}
+
 MetaStruct::~MetaStruct()
 {
 }
 
+MetaStruct::ValueAccess
+MetaStruct::getValueAccess(const char*, OPENDDS_VECTOR(MemberAccess)&) const
+{
+  return 0;
+}
+
+bool
+MetaStruct::getSerializedAccess(const char*, size_t&, size_t&,
+                                SerializedValueAccess&) const
+{
+  return false;
+}
+
 }
 }
 
@@ -25,6 +25,8 @@ namespace OpenDDS {
 namespace DCPS {
 
 class MetaStruct;
+class CompiledFilter;
+struct SerializedPayload;
 
 template<typename T>
 const MetaStruct& getMetaStruct();
@@ -103,6 +105,15 @@ public:
 
   bool has_non_key_fields(const MetaStruct& meta) const;
 
+  /**
+   * Compile the filter for samples of the type described by 'meta', with
+   * the parameter values 'params' bound in.  See CompiledFilter.  If
+   * 'serialized' is set the filter is for serialized samples.
+   */
+  RcHandle<CompiledFilter> compile(const MetaStruct& meta,
+                                   const DDS::StringSeq& params,
+                                   bool serialized = false) const;
+
   /**
    * Returns true if the unserialized sample matches the filter.
    */
@@ -177,6 +188,59 @@ private:
 
 };
 
+/**
+ * A FilterEvaluator compiled for one type and one set of parameter values.
+ * Field names are resolved to the accessors generated in the type's
+ * MetaStruct, and literals and parameters are converted once to each type
+ * they may be compared with, so evaluating a sample doesn't look anything
+ * up by name or convert through strings.  Compiled filters don't change
+ * after they are created; recompile when the parameters change.
+ */
+class OpenDDS_Dcps_Export CompiledFilter : public RcObject {
+public:
+  class Node;
+
+  CompiledFilter(const MetaStruct& meta, Node* root, bool has_non_key_fields,
+                 bool serialized);
+
+  ~CompiledFilter();
+
+  const MetaStruct& meta() const { return meta_; }
+
+  /// Same as FilterEvaluator::has_non_key_fields(meta())
+  bool has_non_key_fields() const { return has_non_key_fields_; }
+
+  /**
+   * Returns true if the unserialized sample matches the filter.  T must be
+   * the type the filter was compiled for.
+   */
+  template<typename T>
+  bool eval(const T& sample) const
+  {
+    return eval_i(&sample);
+  }
+
+  /**
+   * Returns true if the serialized sample matches the filter, which must
+   * have been compiled for serialized samples.  Fields that are at the
+   * same position in every sample are read from there, others are found
+   * by skipping over the fields before them.
+   */
+  bool eval(ACE_Message_Block* serializedSample, bool swap_bytes,
+            bool cdr_encap) const;
+
+private:
+  CompiledFilter(const CompiledFilter&);
+  CompiledFilter& operator=(const CompiledFilter&);
+
+  bool eval_i(const void* sample) const;
+
+  const MetaStruct& meta_;
+  Node* root_;
+  bool has_non_key_fields_;
+  bool serialized_;
+};
+
 class OpenDDS_Dcps_Export MetaStruct {
 public:
   virtual ~MetaStruct();
@@ -184,6 +248,52 @@ public:
   virtual Value getValue(const void* stru, const char* fieldSpec) const = 0;
   virtual Value getValue(Serializer& ser, const char* fieldSpec) const = 0;
 
+  typedef const void* (*MemberAccess)(const void* stru);
+  typedef Value (*ValueAccess)(const void* stru);
+
+  /**
+   * Resolve 'fieldSpec' so that its value can be read from samples without
+   * looking it up by name: the accessors of the nested structs leading to
+   * the field are appended to 'path' and the accessor of the field itself
+   * is returned.  Returns 0 if the field is only available from getValue().
+   */
+  virtual ValueAccess getValueAccess(const char* fieldSpec,
+                                     OPENDDS_VECTOR(MemberAccess)& path) const;
+
+  typedef Value (*SerializedValueAccess)(const SerializedPayload& payload,
+                                         size_t aligned_offset,
+                                         size_t packed_offset);
+
+  /**
+   * Find 'fieldSpec' in serialized samples of this type that start at the
+   * given offsets (see SampleView for the two kinds of offset).  If it's a
+   * primitive or enum at the same position in every sample, the offsets
+   * are moved to it and 'access' is set to a function that reads it.  An
+   * empty 'fieldSpec' moves the offsets past the whole struct if its size
+   * is fixed.  Returns false otherwise.
+   */
+  virtual bool getSerializedAccess(const char* fieldSpec,
+                                   size_t& aligned_offset,
+                                   size_t& packed_offset,
+                                   SerializedValueAccess& access) const;
+
+  /// Used by getSerializedAccess() to align for a primitive of 'size' bytes
+  static void align_serialized(size_t& aligned_offset, size_t size)
+  {
+    const size_t align = size < 8 ? size : 8;
+    aligned_offset = (aligned_offset + align - 1) / align * align;
+  }
+
+  /// Used by getSerializedAccess() to move past 'count' primitives of 'size'
+  /// bytes
+  static void skip_serialized(size_t& aligned_offset, size_t& packed_offset,
+                              size_t size, size_t count)
+  {
+    align_serialized(aligned_offset, size);
+    aligned_offset += size * count;
+    packed_offset += size * count;
+  }
+
   virtual ComparatorBase::Ptr create_qc_comparator(const char* fieldSpec,
     ComparatorBase::Ptr next) const = 0;
 
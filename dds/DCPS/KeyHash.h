@@ -0,0 +1,123 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_KEY_HASH_H
+#define OPENDDS_DCPS_KEY_HASH_H
+
+#include "ace/CDR_Base.h"
+
+#include "dds/Versioned_Namespace.h"
+
+#include <cstddef>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * Helpers for the <Type>_OpenDDS_KeyHash function objects that opendds_idl
+ * generates next to <Type>_OpenDDS_KeyLessThan.  A key hash only looks at
+ * the key members, so samples that KeyLessThan considers equivalent (same
+ * instance) hash the same.
+ *
+ * With a C++11 compiler, defining OPENDDS_UNORDERED_INSTANCE_MAP makes
+ * DataWriterImpl_T and DataReaderImpl_T keep their instances in a hash map
+ * built on these instead of a std::map ordered by KeyLessThan.  The
+ * reader's read/take_next_instance then walk instances in the order of
+ * their handles rather than of their keys.
+ */
+
+/// Mix 'value' into the running hash 'seed'.
+inline void hash_combine(size_t& seed, size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+/// FNV-1a hash of 'size' bytes.
+inline size_t hash_bytes(const void* data, size_t size)
+{
+  const unsigned char* const bytes = static_cast<const unsigned char*>(data);
+  ACE_UINT64 hash = ACE_UINT64_LITERAL(0xcbf29ce484222325);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * ACE_UINT64_LITERAL(0x100000001b3);
+  }
+  return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+/// Integer, character, boolean and enum key members: equal values have
+/// equal object representations.
+template <typename T>
+void key_hash(size_t& seed, const T& value)
+{
+  hash_combine(seed, hash_bytes(&value, sizeof value));
+}
+
+/// Floating point key members: 0.0 and -0.0 compare equal.
+inline void key_hash(size_t& seed, ACE_CDR::Float value)
+{
+  if (value == 0) {
+    value = 0;
+  }
+  hash_combine(seed, hash_bytes(&value, sizeof value));
+}
+
+inline void key_hash(size_t& seed, ACE_CDR::Double value)
+{
+  if (value == 0) {
+    value = 0;
+  }
+  hash_combine(seed, hash_bytes(&value, sizeof value));
+}
+
+#ifndef NONNATIVE_LONGDOUBLE
+/// A native long double can have padding (x86 keeps 10 bytes of value in
+/// 12 or 16), so only its value is hashed, as the nearest double and what's
+/// left of it.  The ACE_CDR::LongDouble struct used otherwise has none.
+inline void key_hash(size_t& seed, ACE_CDR::LongDouble value)
+{
+  const ACE_CDR::Double high = static_cast<ACE_CDR::Double>(value);
+  key_hash(seed, high);
+  key_hash(seed, static_cast<ACE_CDR::Double>(value - high));
+}
+#endif
+
+/// String key members, passed as their (null-terminated) characters so
+/// that every language mapping's string type can use it.
+template <typename CharT>
+void key_hash_string(size_t& seed, const CharT* str)
+{
+  size_t length = 0;
+  if (str) {
+    while (str[length]) {
+      ++length;
+    }
+  }
+  hash_combine(seed, hash_bytes(str, length * sizeof(CharT)));
+}
+
+/// Equivalence derived from a strict weak ordering such as a generated
+/// <Type>_OpenDDS_KeyLessThan, for use with hashed containers.
+template <typename T, typename LessThan>
+struct KeyEqual {
+  bool operator()(const T& v1, const T& v2) const
+  {
+    const LessThan less = LessThan();
+    return !less(v1, v2) && !less(v2, v1);
+  }
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_KEY_HASH_H */
@@ -0,0 +1,218 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+#include "ListenerDispatcher.h"
+#include "KeyHash.h"
+
+#include "ace/Reverse_Lock_T.h"
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+ListenerDispatcher::ListenerDispatcher(size_t threads)
+  : threads_(threads ? threads : 1)
+  , work_available_(lock_)
+  , ready_(threads_)
+  , shutdown_(false)
+  , queue_depth_(0)
+  , max_queue_depth_(0)
+{
+}
+
+ListenerDispatcher::~ListenerDispatcher()
+{
+  shutdown();
+}
+
+int
+ListenerDispatcher::open(void*)
+{
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, -1);
+    shutdown_ = false;
+    workers_.clear();
+  }
+
+  if (activate(THR_NEW_LWP | THR_JOINABLE, static_cast<int>(threads_)) != 0) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: ListenerDispatcher::open: ")
+                      ACE_TEXT("failed to activate %B worker threads\n"),
+                      threads_),
+                     -1);
+  }
+  return 0;
+}
+
+void
+ListenerDispatcher::shutdown()
+{
+  bool on_worker = false, already_shut_down = false;
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+    already_shut_down = shutdown_;
+    shutdown_ = true;
+    work_available_.broadcast();
+
+    // A job could shut down the Service_Participant
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      if (ACE_OS::thr_equal(workers_[i], ACE_OS::thr_self())) {
+        on_worker = true;
+      }
+    }
+  }
+
+  // Also after a shutdown() from a job, which couldn't join the workers
+  if (!on_worker) {
+    wait();
+  }
+  if (already_shut_down) {
+    return;
+  }
+
+  // Discarded jobs are released after lock_ is, their destructors can
+  // take locks that are held while enqueue() is called.
+  Strands discarded;
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+    discarded.swap(strands_);
+    for (size_t i = 0; i < ready_.size(); ++i) {
+      ready_[i].clear();
+    }
+    queue_depth_ = 0;
+  }
+}
+
+bool
+ListenerDispatcher::enqueue(const Key& key, const JobQueue::JobPtr& job)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+  if (shutdown_) {
+    return false;
+  }
+
+  std::pair<Strands::iterator, bool> inserted =
+    strands_.insert(Strands::value_type(key, Strand()));
+  inserted.first->second.push_back(Pending(job, MonotonicTimePoint::now()));
+  if (++queue_depth_ > max_queue_depth_) {
+    max_queue_depth_ = queue_depth_;
+  }
+
+  if (inserted.second) {
+    // Not already waiting in a ready queue or being run
+    ready_[home(key)].push_back(key);
+    work_available_.signal();
+  }
+  return true;
+}
+
+bool
+ListenerDispatcher::is_shut_down() const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, true);
+  return shutdown_;
+}
+
+ListenerDispatcher::Status
+ListenerDispatcher::status() const
+{
+  Status status;
+  status.threads = threads_;
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, status);
+  status.queue_depth = queue_depth_;
+  status.max_queue_depth = max_queue_depth_;
+  status.latency = latency_;
+  return status;
+}
+
+size_t
+ListenerDispatcher::home(const Key& key) const
+{
+  size_t hash = 0;
+  hash_combine(hash, hash_bytes(&key.first, sizeof key.first));
+  hash_combine(hash, hash_bytes(&key.second, sizeof key.second));
+  return hash % threads_;
+}
+
+bool
+ListenerDispatcher::next_ready(size_t self, Key& key)
+{
+  if (!ready_[self].empty()) {
+    key = ready_[self].front();
+    ready_[self].pop_front();
+    return true;
+  }
+
+  for (size_t i = 1; i < threads_; ++i) {
+    ReadyQueue& victim = ready_[(self + i) % threads_];
+    if (!victim.empty()) {
+      key = victim.back();
+      victim.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+int
+ListenerDispatcher::svc()
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, -1);
+  const size_t self = workers_.size() % threads_;
+  workers_.push_back(ACE_OS::thr_self());
+  ACE_Reverse_Lock<ACE_Thread_Mutex> rev_lock(lock_);
+
+  while (true) {
+    Key key;
+    while (!shutdown_ && !next_ready(self, key)) {
+      work_available_.wait();
+    }
+    if (shutdown_) {
+      break;
+    }
+
+    Strands::iterator strand = strands_.find(key);
+    if (strand == strands_.end()) {
+      continue;
+    }
+    Pending pending = strand->second.front();
+    strand->second.pop_front();
+    --queue_depth_;
+
+    const TimeDuration latency = MonotonicTimePoint::now() - pending.enqueued_;
+    latency_.add(static_cast<double>(latency.value().sec()) * 1000000 + latency.value().usec());
+
+    {
+      ACE_GUARD_RETURN(ACE_Reverse_Lock<ACE_Thread_Mutex>, rev_guard, rev_lock, -1);
+      pending.job_->execute();
+      pending.job_.reset();
+    }
+    if (shutdown_) {
+      break;
+    }
+
+    // Only this worker has the strand until it goes back in a ready queue
+    strand = strands_.find(key);
+    if (strand != strands_.end()) {
+      if (strand->second.empty()) {
+        strands_.erase(strand);
+      } else {
+        ready_[self].push_back(key);
+        work_available_.signal();
+      }
+    }
+  }
+
+  return 0;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
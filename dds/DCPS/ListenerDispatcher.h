@@ -0,0 +1,118 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_LISTENER_DISPATCHER_H
+#define OPENDDS_DCPS_LISTENER_DISPATCHER_H
+
+#include "dcps_export.h"
+#include "JobQueue.h"
+#include "PoolAllocator.h"
+#include "Stats_T.h"
+#include "TimeTypes.h"
+
+#include "dds/DdsDcpsInfrastructureC.h"
+
+#include "ace/Condition_Thread_Mutex.h"
+#include "ace/Task.h"
+#include "ace/Thread_Mutex.h"
+
+#include <utility>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * Worker threads that run listener callbacks for the readers that opted
+ * in to pooled dispatch (see DataReaderImpl::pooled_dispatch()), so that
+ * a slow callback doesn't hold up the thread that received the data.
+ *
+ * Jobs are enqueued with a key, an entity and one of its instances.  Jobs
+ * with the same key run one at a time in the order they were enqueued,
+ * jobs with different keys run concurrently.  Each key has a home worker
+ * that takes it from the front of its ready queue; a worker with nothing
+ * to do steals from the back of the others' ready queues.
+ *
+ * The Service_Participant owns the dispatcher, the number of workers is
+ * set with -DCPSListenerDispatchThreads.
+ */
+class OpenDDS_Dcps_Export ListenerDispatcher : public ACE_Task_Base {
+public:
+  typedef std::pair<const void*, DDS::InstanceHandle_t> Key;
+
+  explicit ListenerDispatcher(size_t threads);
+  virtual ~ListenerDispatcher();
+
+  /// Start the worker threads, also after shutdown().
+  virtual int open(void* = 0);
+  virtual int svc();
+
+  /// Stop the worker threads once the jobs they are running return.
+  /// Jobs that haven't started are discarded.  Called from a job it
+  /// doesn't wait for the workers, a later call from another thread does.
+  void shutdown();
+  bool is_shut_down() const;
+
+  /// Run 'job' on a worker after the jobs enqueued before it with the
+  /// same key.  False if the dispatcher is shut down.
+  bool enqueue(const Key& key, const JobQueue::JobPtr& job);
+
+  /// Reported by the Service Participant monitor
+  struct Status {
+    Status() : threads(0), queue_depth(0), max_queue_depth(0) {}
+    size_t threads;
+    /// Jobs waiting to run
+    size_t queue_depth;
+    size_t max_queue_depth;
+    /// Microseconds from enqueue() until the job started
+    Stats<double> latency;
+  };
+  Status status() const;
+
+private:
+  struct Pending {
+    Pending(const JobQueue::JobPtr& job, const MonotonicTimePoint& enqueued)
+      : job_(job), enqueued_(enqueued) {}
+    JobQueue::JobPtr job_;
+    MonotonicTimePoint enqueued_;
+  };
+
+  /// Jobs of one key.  A strand is in one ready queue, or being run by a
+  /// worker, from when its first job is enqueued until it's empty.
+  typedef OPENDDS_DEQUE(Pending) Strand;
+  typedef OPENDDS_MAP(Key, Strand) Strands;
+  typedef OPENDDS_DEQUE(Key) ReadyQueue;
+
+  size_t home(const Key& key) const;
+
+  /// Next key for worker 'self' to run, called with lock_ held.
+  bool next_ready(size_t self, Key& key);
+
+  const size_t threads_;
+  mutable ACE_Thread_Mutex lock_;
+  ACE_Condition_Thread_Mutex work_available_;
+  Strands strands_;
+  OPENDDS_VECTOR(ReadyQueue) ready_;
+  OPENDDS_VECTOR(ACE_thread_t) workers_;
+  bool shutdown_;
+
+  size_t queue_depth_;
+  size_t max_queue_depth_;
+  Stats<double> latency_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_LISTENER_DISPATCHER_H */
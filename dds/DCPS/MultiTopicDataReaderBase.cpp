@@ -105,6 +105,8 @@ void MultiTopicDataReaderBase::init(const DDS::DataReaderQos& dr_qos,
   resulting_impl->enable_multi_topic(multitopic);
   resulting_impl->raw_latency_buffer_size() = parent->raw_latency_buffer_size();
   resulting_impl->raw_latency_buffer_type() = parent->raw_latency_buffer_type();
+  resulting_impl->pooled_dispatch() = parent->pooled_dispatch();
+  resulting_impl->coalesce_data_available() = parent->coalesce_data_available();
 
   DDS::DomainParticipant_var participant = parent->get_participant();
   DomainParticipantImpl* dpi = dynamic_cast<DomainParticipantImpl*>(participant.in());
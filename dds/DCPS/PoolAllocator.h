@@ -9,6 +9,9 @@
 #include <vector>
 #include <queue>
 #include <set>
+#ifdef ACE_HAS_CPP11
+#include <unordered_map>
+#endif
 
 #if defined OPENDDS_SAFETY_PROFILE && defined ACE_HAS_ALLOC_HOOKS
 #include "dcps_export.h"
@@ -119,6 +122,10 @@ OPENDDS_END_VERSIONED_NAMESPACE_DECL
           OpenDDS::DCPS::PoolAllocator<std::pair<typename OpenDDS::DCPS::add_const<K >::type, T > > >
 #define OPENDDS_MULTIMAP_CMP_T(K, T, C) std::multimap<K, T, C, \
           OpenDDS::DCPS::PoolAllocator<std::pair<typename OpenDDS::DCPS::add_const<K >::type, T > > >
+#ifdef ACE_HAS_CPP11
+#define OPENDDS_UNORDERED_MAP_CHE_T(K, V, H, E) std::unordered_map<K, V, H, E, \
+          OpenDDS::DCPS::PoolAllocator<std::pair<typename OpenDDS::DCPS::add_const<K >::type, V > > >
+#endif
 #define OPENDDS_SET(K) std::set<K, std::less<K >, \
           OpenDDS::DCPS::PoolAllocator<K > >
 #define OPENDDS_SET_CMP(K, C) std::set<K, C, \
@@ -144,6 +151,9 @@ OPENDDS_END_VERSIONED_NAMESPACE_DECL
 #define OPENDDS_MAP_CMP_T OPENDDS_MAP_CMP
 #define OPENDDS_MULTIMAP_T OPENDDS_MULTIMAP
 #define OPENDDS_MULTIMAP_CMP_T OPENDDS_MULTIMAP_CMP
+#ifdef ACE_HAS_CPP11
+#define OPENDDS_UNORDERED_MAP_CHE_T(K, V, H, E) std::unordered_map<K, V, H, E >
+#endif
 #define OPENDDS_SET(K) std::set<K >
 #define OPENDDS_SET_CMP(K, C) std::set<K, C >
 #define OPENDDS_MULTISET_CMP(K, C) std::multiset<K, C >
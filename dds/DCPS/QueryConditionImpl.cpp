@@ -11,11 +11,17 @@
 #include "QueryConditionImpl.h"
 #include "DataReaderImpl.h"
 
+#include "ace/Atomic_Op.h"
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
 namespace DCPS {
 
+namespace {
+  ACE_Atomic_Op<ACE_Thread_Mutex, unsigned long> last_generation;
+}
+
 QueryConditionImpl::QueryConditionImpl(
   DataReaderImpl* dr, DDS::SampleStateMask sample_states,
   DDS::ViewStateMask view_states, DDS::InstanceStateMask instance_states,
@@ -23,6 +29,9 @@ QueryConditionImpl::QueryConditionImpl(
   : ReadConditionImpl(dr, sample_states, view_states, instance_states)
   , query_expression_(query_expression)
   , evaluator_(query_expression, true)
+  , generation_(++last_generation)
+  , slot_(generation_ % ReceivedDataElement::QUERY_RESULT_SLOTS)
+  , members_valid_(false)
 {
   if (DCPS_debug_level > 5) {
     ACE_DEBUG((LM_DEBUG,
@@ -48,7 +57,8 @@ QueryConditionImpl::get_query_parameters(DDS::StringSeq& query_parameters)
 DDS::ReturnCode_t
 QueryConditionImpl::set_query_parameters(const DDS::StringSeq& query_parameters)
 {
-  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard2, parent_->sample_lock_, DDS::RETCODE_ERROR);
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, DDS::RETCODE_ERROR);
 
   // Check sequence of strings that give values to the ‘parameters’ (i.e., "%n" tokens)
   // in the query_expression matches the size of the parameter sequence.
@@ -65,6 +75,10 @@ QueryConditionImpl::set_query_parameters(const DDS::StringSeq& query_parameters)
   }
 
   query_parameters_ = query_parameters;
+  compiled_query_.reset();
+  generation_ = ++last_generation;
+  members_.clear();
+  members_valid_ = false;
   return DDS::RETCODE_OK;
 }
 
@@ -84,10 +98,7 @@ CORBA::Boolean
 QueryConditionImpl::get_trigger_value()
 {
   if (hasFilter()) {
-    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard2, parent_->sample_lock_, false);
-    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
-    return parent_->contains_sample_filtered(sample_states_, view_states_,
-      instance_states_, evaluator_, query_parameters_);
+    return parent_->contains_sample_filtered(*this);
   } else {
     return ReadConditionImpl::get_trigger_value();
   }
@@ -14,6 +14,7 @@
 #include "dds/DCPS/ReadConditionImpl.h"
 #include "dds/DCPS/FilterEvaluator.h"
 #include "dds/DCPS/PoolAllocator.h"
+#include "dds/DCPS/ReceivedDataElementList.h"
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
@@ -59,11 +60,14 @@ public:
   {
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
     const MetaStruct& meta = getMetaStruct<Sample>();
+    if (!compiled_query_ || &compiled_query_->meta() != &meta) {
+      compiled_query_ = evaluator_.compile(meta, query_parameters_);
+    }
     /*
      * Omit the sample from results if the query references non-key fields
      * and the sample only has key fields.
      */
-    if (sample_only_has_key_fields && evaluator_.has_non_key_fields(meta)) {
+    if (sample_only_has_key_fields && compiled_query_->has_non_key_fields()) {
       if (DCPS_debug_level > 8) {
         ACE_DEBUG((LM_DEBUG,
           ACE_TEXT("(%P|%t) QueryConditionImpl::filter: ")
@@ -73,15 +77,79 @@ public:
       }
       return false;
     }
-    return evaluator_.eval(s, query_parameters_);
+    return compiled_query_->eval(s);
+  }
+
+  /**
+   * filter() for a sample stored in the reader.  The result is kept with
+   * the sample until the query parameters change.  Called with the
+   * reader's sample lock held.
+   */
+  template<typename Sample>
+  bool cached_filter(ReceivedDataElement& item) const
+  {
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+    ReceivedDataElement::QueryResult& result = item.query_results_[slot_];
+    if (result.generation_ != generation_) {
+      result.generation_ = generation_;
+      result.match_ = evaluate<Sample>(item);
+    }
+    return result.match_;
+  }
+
+  /// Instances of the reader that can have a sample matching the query:
+  /// the ones that had a match when the reader last looked and the ones
+  /// that received samples since.  Maintained by the reader with its
+  /// sample lock held.
+  typedef OPENDDS_SET(DDS::InstanceHandle_t) Members;
+
+  /// False until the reader has looked at all of its samples since the
+  /// query parameters were last set.
+  bool members_valid() const { return members_valid_; }
+  Members& members() { return members_; }
+
+  void reset_members(Members& members)
+  {
+    members_.swap(members);
+    members_valid_ = true;
+  }
+
+  /// Called by the reader for each sample it stores, the sample is
+  /// evaluated when the condition is used.
+  void sample_stored(DDS::InstanceHandle_t instance)
+  {
+    if (members_valid_) {
+      members_.insert(instance);
+    }
   }
 
 private:
+  template<typename Sample>
+  bool evaluate(ReceivedDataElement& item) const
+  {
+    if (!item.registered_data_) {
+      return false;
+    }
+    item.complete_data();
+    return filter(*static_cast<const Sample*>(item.registered_data_), !item.valid_data_);
+  }
+
   CORBA::String_var query_expression_;
   DDS::StringSeq query_parameters_;
   FilterEvaluator evaluator_;
-  /// Concurrent access to query_parameters_
+  /// evaluator_ compiled with query_parameters_, done by the first filter()
+  /// after they change
+  mutable RcHandle<CompiledFilter> compiled_query_;
+  /// Identifies query_parameters_ in the results cached by samples, unique
+  /// across all QueryConditions.
+  unsigned long generation_;
+  /// Index in ReceivedDataElement::query_results_
+  const size_t slot_;
+  /// Concurrent access to query_parameters_, compiled_query_ and generation_
   mutable ACE_Recursive_Thread_Mutex lock_;
+
+  Members members_;
+  bool members_valid_;
 };
 
 } // namespace DCPS
@@ -87,11 +87,16 @@ bool RakeResults<SampleSeq>::insert_sample(ReceivedDataElement* sample,
 {
 #ifndef OPENDDS_NO_QUERY_CONDITION
 
+  if (cond_ && (do_filter_ || do_sort_) && !sample->complete_data()) {
+    // The query's filter and ORDER BY look at the sample's contents,
+    // which couldn't be deserialized
+    return false;
+  }
+
   if (do_filter_) {
     const QueryConditionImpl* qci = dynamic_cast<QueryConditionImpl*>(cond_);
     typedef typename SampleSeq::value_type VT;
-    const VT* typed_sample = static_cast<VT*>(sample->registered_data_);
-    if (!qci || !typed_sample || !qci->filter(*typed_sample, !sample->valid_data_)) {
+    if (!qci || !qci->cached_filter<VT>(*sample)) {
       return false;
     }
   }
@@ -139,6 +144,7 @@ bool RakeResults<SampleSeq>::copy_into(FwdIter iter, FwdIter end,
         received_data_p.assign_sample(idx, Sample());
 
       } else {
+        rde->complete_data();
         received_data_p.assign_sample(idx,
                                       *static_cast<Sample*>(rde->registered_data_));
       }
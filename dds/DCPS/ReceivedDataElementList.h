@@ -30,6 +30,8 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+struct SerializedPayload;
+
 class OpenDDS_Dcps_Export ReceivedDataElement {
 public:
   ReceivedDataElement(const DataSampleHeader& header, void *received_data, ACE_Recursive_Thread_Mutex* mx)
@@ -63,6 +65,11 @@ public:
     if (!header.valid_data()) {
       valid_data_ = false;
     }
+
+    for (size_t i = 0; i < QUERY_RESULT_SLOTS; ++i) {
+      query_results_[i].generation_ = 0;
+      query_results_[i].match_ = false;
+    }
   }
 
   virtual ~ReceivedDataElement(){}
@@ -84,6 +91,16 @@ public:
     return this->ref_count_.value();
   }
 
+  /// Finish deserializing registered_data_ if the reader deferred it,
+  /// see DataReaderImpl_T::enable_views().  Called with the reader's
+  /// sample lock held before registered_data_ is handed to the user.
+  /// If the serialized sample turns out to be malformed this clears
+  /// valid_data_ and returns false.
+  virtual bool complete_data() { return true; }
+
+  /// The sample in serialized form, if the reader kept it.
+  virtual const SerializedPayload* serialized_payload() const { return 0; }
+
   PublicationId pub_;
 
   /**
@@ -137,6 +154,18 @@ public:
   /// the next data sample in the ReceivedDataElementList
   ReceivedDataElement* next_data_sample_;
 
+  /// Result of a QueryCondition's filter for this sample, valid while the
+  /// condition's generation is unchanged.  Conditions share the slots, so
+  /// with more conditions than slots a result can be evaluated again.  See
+  /// QueryConditionImpl::cached_filter().
+  enum { QUERY_RESULT_SLOTS = 2 };
+  struct QueryResult {
+    /// 0 if empty
+    unsigned long generation_;
+    bool match_;
+  };
+  QueryResult query_results_[QUERY_RESULT_SLOTS];
+
   void* operator new(size_t size, ACE_New_Allocator& pool);
   void operator delete(void* memory);
   void operator delete(void* memory, ACE_New_Allocator& pool);
@@ -169,6 +198,22 @@ public:
               *this->mx_)
     delete static_cast<DataTypeWithAllocator*> (registered_data_);
   }
+
+  bool complete_data()
+  {
+    if (registered_data_
+        && !static_cast<DataTypeWithAllocator*>(registered_data_)->complete()) {
+      valid_data_ = false;
+      return false;
+    }
+    return true;
+  }
+
+  const SerializedPayload* serialized_payload() const
+  {
+    return registered_data_
+      ? static_cast<DataTypeWithAllocator*>(registered_data_)->serialized_payload() : 0;
+  }
 };
 
 class OpenDDS_Dcps_Export ReceivedDataFilter {
@@ -0,0 +1,212 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_SAMPLE_VIEW_H
+#define OPENDDS_DCPS_SAMPLE_VIEW_H
+
+#include "Message_Block_Ptr.h"
+#include "PoolAllocator.h"
+#include "ReceivedDataElementList.h"
+#include "Serializer.h"
+
+#include "ace/CDR_Base.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+class DataReaderImpl;
+
+/**
+ * A received sample in the serialized form it arrived in.  Readers that
+ * have views enabled (see DataReaderImpl_T::enable_views()) keep one of
+ * these with each sample, in a block of its own rather than the
+ * transport's receive buffer.  Copies share that block.
+ */
+struct SerializedPayload {
+  SerializedPayload()
+    : swap_bytes_(false)
+    , cdr_encapsulation_(false)
+  {}
+
+  /// Size of the encapsulation header that precedes the sample when
+  /// cdr_encapsulation_ is set.  Offsets of CDR-aligned members are
+  /// counted from the end of it.
+  static const size_t encapsulation_header_size = 4;
+
+  Message_Block_Shared_Ptr data_;
+  bool swap_bytes_;
+  bool cdr_encapsulation_;
+};
+
+/// Deserialize the whole sample held by 'payload'.
+template <typename Sample>
+bool deserialize_payload(const SerializedPayload& payload, Sample& sample)
+{
+  if (!payload.data_) {
+    return false;
+  }
+
+  Message_Block_Ptr data(payload.data_->duplicate());
+  Serializer ser(data.get(), payload.swap_bytes_,
+                 payload.cdr_encapsulation_ ? Serializer::ALIGN_CDR : Serializer::ALIGN_NONE);
+  if (payload.cdr_encapsulation_) {
+    ACE_CDR::ULong header;
+    if (!(ser >> header)) {
+      return false;
+    }
+    ser.reset_alignment();
+  }
+  return ser >> sample;
+}
+
+/**
+ * Base class of the <Type>_OpenDDS_View classes that opendds_idl generates
+ * with -Gview.  A view gives read-only access to the members of a
+ * serialized sample that are at a fixed offset (those declared before the
+ * first string, sequence or union), without deserializing it.  The
+ * offsets are computed by opendds_idl for both CDR-aligned and unaligned
+ * encodings.  Other members are available through to_sample().
+ */
+class SampleView {
+public:
+  SampleView() {}
+
+  explicit SampleView(const SerializedPayload* payload)
+  {
+    if (payload) {
+      payload_ = *payload;
+    }
+  }
+
+  /// False for samples without valid data (dispose and unregister) and
+  /// for samples received before views were enabled.
+  bool valid() const { return payload_.data_; }
+
+  const SerializedPayload& payload() const { return payload_; }
+
+  /// Copy the primitive at the given offset of 'payload' to 'value',
+  /// which must be an ACE_CDR integer, character or floating point type
+  /// (not LongDouble).
+  template <typename T>
+  static bool read(const SerializedPayload& payload,
+                   size_t aligned_offset, size_t packed_offset, T& value)
+  {
+    size_t offset = payload.cdr_encapsulation_
+      ? SerializedPayload::encapsulation_header_size + aligned_offset
+      : packed_offset;
+
+    char raw[sizeof(T)];
+    size_t copied = 0;
+    for (const ACE_Message_Block* mb = payload.data_.get();
+         mb && copied < sizeof(T); mb = mb->cont()) {
+      const size_t length = mb->length();
+      if (offset >= length) {
+        offset -= length;
+        continue;
+      }
+      const size_t n = (std::min)(length - offset, sizeof(T) - copied);
+      std::memcpy(raw + copied, mb->rd_ptr() + offset, n);
+      copied += n;
+      offset = 0;
+    }
+    if (copied < sizeof(T)) {
+      return false;
+    }
+
+    char* const target = reinterpret_cast<char*>(&value);
+    if (!payload.swap_bytes_ || sizeof(T) == 1) {
+      std::memcpy(target, raw, sizeof(T));
+    } else if (sizeof(T) == 2) {
+      ACE_CDR::swap_2(raw, target);
+    } else if (sizeof(T) == 4) {
+      ACE_CDR::swap_4(raw, target);
+    } else {
+      ACE_CDR::swap_8(raw, target);
+    }
+    return true;
+  }
+
+protected:
+  /// Used by generated accessors; yields T() if the member can't be read.
+  template <typename T>
+  T get(size_t aligned_offset, size_t packed_offset) const
+  {
+    T value = T();
+    read(payload_, aligned_offset, packed_offset, value);
+    return value;
+  }
+
+private:
+  SerializedPayload payload_;
+};
+
+/**
+ * The sequence type filled in by DataReaderImpl_T::read_views() and
+ * take_views().  Like a zero-copy read it doesn't copy samples out of the
+ * reader, but each view holds its own reference to the serialized data so
+ * there is nothing to return to the reader.
+ */
+template <typename View>
+class SampleViewSeq {
+public:
+  typedef typename View::MessageType value_type;
+
+  CORBA::ULong length() const
+  {
+    return static_cast<CORBA::ULong>(views_.size());
+  }
+
+  /// Always 0, which makes the reader hand over ReceivedDataElements
+  /// (as it would for a zero-copy sequence) instead of sample copies.
+  CORBA::ULong maximum() const { return 0; }
+
+  const View& operator[](CORBA::ULong i) const { return views_[i]; }
+
+  ///Only used by the FooDataReaderImpl
+  class PrivateMemberAccess {
+  public:
+    explicit PrivateMemberAccess(SampleViewSeq& seq)
+      : seq_(seq) {}
+
+    void internal_set_length(CORBA::ULong len)
+    {
+      seq_.views_.resize(len);
+    }
+
+    void set_loaner(DataReaderImpl*) {}
+
+    void assign_ptr(CORBA::ULong ii, ReceivedDataElement* item)
+    {
+      seq_.views_[ii] = View(item->serialized_payload());
+    }
+
+    void assign_sample(CORBA::ULong, const value_type&) {}
+
+  private:
+    SampleViewSeq& seq_;
+  };
+  friend class PrivateMemberAccess;
+
+private:
+  OPENDDS_VECTOR(View) views_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_SAMPLE_VIEW_H */
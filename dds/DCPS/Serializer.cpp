@@ -10,11 +10,18 @@
 #include <tao/String_Alloc.h>
 #include <ace/OS_NS_string.h>
 #include <ace/OS_Memory.h>
+#include <ace/Message_Block.h>
 
 #if !defined (__ACE_INLINE__)
 # include "Serializer.inl"
 #endif /* !__ACE_INLINE__ */
 
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__) \
+  && !defined OPENDDS_NO_SIMD_SWAP
+# define OPENDDS_SIMD_SWAP
+# include <immintrin.h>
+#endif
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -30,6 +37,7 @@ Serializer::Serializer(ACE_Message_Block* chain,
   , alignment_(align)
   , align_rshift_(chain ? ptrdiff_t(chain->rd_ptr()) % MAX_ALIGN : 0)
   , align_wshift_(chain ? ptrdiff_t(chain->wr_ptr()) % MAX_ALIGN : 0)
+  , growth_(0)
 {
 }
 
@@ -44,6 +52,52 @@ Serializer::reset_alignment()
   align_wshift_ = current_ ? ptrdiff_t(current_->wr_ptr()) % MAX_ALIGN : 0;
 }
 
+void
+Serializer::grow_chain(const ChainGrowth* growth)
+{
+  growth_ = growth;
+}
+
+void
+Serializer::append_block()
+{
+  ACE_Message_Block* mb = 0;
+  if (growth_->mb_allocator) {
+    ACE_NEW_MALLOC_NORETURN(mb,
+      static_cast<ACE_Message_Block*>(
+        growth_->mb_allocator->malloc(sizeof(ACE_Message_Block))),
+      ACE_Message_Block(growth_->block_size,
+                        ACE_Message_Block::MB_DATA,
+                        0, // cont
+                        0, // data
+                        growth_->data_allocator,
+                        growth_->locking_strategy,
+                        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
+                        ACE_Time_Value::zero,
+                        ACE_Time_Value::max_time,
+                        growth_->db_allocator,
+                        growth_->mb_allocator));
+  } else {
+    ACE_NEW_NORETURN(mb,
+      ACE_Message_Block(growth_->block_size,
+                        ACE_Message_Block::MB_DATA,
+                        0, // cont
+                        0, // data
+                        growth_->data_allocator,
+                        growth_->locking_strategy,
+                        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
+                        ACE_Time_Value::zero,
+                        ACE_Time_Value::max_time,
+                        growth_->db_allocator));
+  }
+  if (mb && (!mb->data_block() || !mb->base())) {
+    // The data allocation failed, leave the chain as it was.
+    mb->release();
+    mb = 0;
+  }
+  current_->cont(mb);
+}
+
 void
 Serializer::smemcpy(char* to, const char* from, size_t n)
 {
@@ -111,6 +165,99 @@ Serializer::swapcpy(char* to, const char* from, size_t n)
   }
 }
 
+namespace {
+  typedef void (*SwapKernel)(char* to, const char* from, size_t size, size_t count);
+
+  void swap_scalar(char* to, const char* from, size_t size, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i, to += size, from += size) {
+      for (size_t j = 0; j < size; ++j) {
+        to[j] = from[size - 1 - j];
+      }
+    }
+  }
+
+#ifdef OPENDDS_SIMD_SWAP
+  // The kernels swap 16 (SSE2) or 32 (AVX2) bytes at a time, which is a
+  // whole number of elements of any size up to 16, and leave the rest to
+  // swap_scalar().  Loads and stores are unaligned.
+
+  __attribute__((target("sse2")))
+  void swap_sse2(char* to, const char* from, size_t size, size_t count)
+  {
+    const size_t bytes = size * count, vec_bytes = bytes & ~size_t(15);
+    for (size_t i = 0; i < vec_bytes; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+      // SSE2 has no byte shuffle: reverse the 16-bit words in each element
+      // with word shuffles, then swap the bytes in each word.
+      switch (size) {
+      case 4:
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        break;
+      case 8:
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        break;
+      case 16:
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        break;
+      }
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), v);
+    }
+    swap_scalar(to + vec_bytes, from + vec_bytes, size, (bytes - vec_bytes) / size);
+  }
+
+  __attribute__((target("avx2")))
+  void swap_avx2(char* to, const char* from, size_t size, size_t count)
+  {
+    // Byte shuffle reversing each element, the same in both 128-bit lanes.
+    char mask[32];
+    for (size_t i = 0; i < 32; ++i) {
+      const size_t lane_pos = i % 16, elem_pos = lane_pos % size;
+      mask[i] = static_cast<char>(lane_pos - elem_pos + size - 1 - elem_pos);
+    }
+    const __m256i shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask));
+
+    const size_t bytes = size * count, vec_bytes = bytes & ~size_t(31);
+    for (size_t i = 0; i < vec_bytes; i += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i),
+                          _mm256_shuffle_epi8(v, shuffle));
+    }
+    swap_sse2(to + vec_bytes, from + vec_bytes, size, (bytes - vec_bytes) / size);
+  }
+#endif
+
+  SwapKernel select_swap_kernel()
+  {
+#ifdef OPENDDS_SIMD_SWAP
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return swap_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return swap_sse2;
+    }
+#endif
+    return swap_scalar;
+  }
+}
+
+void
+Serializer::swap_array_simd(char* to, const char* from, size_t size, size_t count)
+{
+  static const SwapKernel kernel = select_swap_kernel();
+  if (16 % size) {
+    swap_scalar(to, from, size, count);
+  } else {
+    kernel(to, from, size, count);
+  }
+}
+
 size_t
 Serializer::read_string(ACE_CDR::Char*& dest,
     ACE_CDR::Char* str_alloc(ACE_CDR::ULong),
@@ -24,6 +24,8 @@
 
 ACE_BEGIN_VERSIONED_NAMESPACE_DECL
 class ACE_Message_Block;
+class ACE_Allocator;
+class ACE_Lock;
 ACE_END_VERSIONED_NAMESPACE_DECL
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -85,9 +87,34 @@ public:
   /// Reset alignment as if a new instance were created
   void reset_alignment();
 
+  /// True if a type whose native layout matches its CDR encoding when
+  /// started on a 'max_align' boundary can be read (_r) or written (_w) at
+  /// the current position with a single read_octet_array() or
+  /// write_octet_array(): no byte swapping is needed and either alignment
+  /// is disabled or the position is already on that boundary.
+  /// Used by opendds_idl generated code for wire-compatible structs.
+  bool wire_compatible_r(size_t max_align) const;
+  bool wire_compatible_w(size_t max_align) const;
+
   /// Examine the state of the stream abstraction.
   bool good_bit() const;
 
+  /// Allocators for the blocks that a growable chain appends, see
+  /// grow_chain().  Null allocators mean the heap.
+  struct ChainGrowth {
+    size_t block_size;
+    ACE_Allocator* data_allocator;
+    ACE_Allocator* db_allocator;
+    ACE_Allocator* mb_allocator;
+    ACE_Lock* locking_strategy;
+  };
+
+  /// Make the chain growable: a write that runs past the end of the chain
+  /// appends a new block of growth->block_size bytes with cont() instead of
+  /// failing.  The new blocks belong to the chain's owner.  'growth' must
+  /// outlive the writes; pass 0 to make the chain fixed-size again.
+  void grow_chain(const ChainGrowth* growth);
+
   /// Number of bytes left to read in message block chain
   size_t length() const;
 
@@ -331,6 +358,20 @@ private:
   /// instance method to allow clearing the good_bit_ on error.
   void swapcpy(char* to, const char* from, size_t n);
 
+  /// Inline copy, or swapping copy if "swap", used when the value is
+  /// entirely within the current block.  With a constant "n" this compiles
+  /// down to a load and store (and byte swap).
+  static void fast_copy(char* to, const char* from, size_t n, bool swap);
+
+  /// Byte swap "count" elements of "size" bytes (up to MAX_SWAP) from
+  /// "from" to "to", which must not overlap.  Short arrays are swapped
+  /// inline, longer ones by swap_array_simd().
+  static void swap_array(char* to, const char* from, size_t size, size_t count);
+
+  /// Vectorized swap_array() using the widest kernel the CPU supports
+  /// (AVX2 or SSE2 on x86, scalar elsewhere), chosen at the first call.
+  static void swap_array_simd(char* to, const char* from, size_t size, size_t count);
+
   /// Implementation of the actual read from the chain.
   size_t doread(char* dest, size_t size, bool swap, size_t offset);
 
@@ -343,6 +384,9 @@ private:
   /// Update alignment state when a cont() chain is followed during a write.
   void align_cont_w();
 
+  /// Append a new block after current_, see grow_chain().
+  void append_block();
+
   /// Currently active message block in chain.
   ACE_Message_Block* current_;
 
@@ -363,7 +407,14 @@ private:
   /// wr_ptr() started at.
   unsigned char align_wshift_;
 
+  /// Block allocation for a growable chain, or 0 for a fixed-size chain.
+  const ChainGrowth* growth_;
+
   static const size_t MAX_ALIGN = 8;
+  /// Largest value that can be byte swapped, see swapcpy().
+  static const size_t MAX_SWAP = 16;
+  /// Shortest array that swap_array() hands to swap_array_simd().
+  static const size_t SIMD_SWAP_MIN = 8;
   static const char ALIGN_PAD[MAX_ALIGN];
   static bool use_rti_serialization_;
 
@@ -7,8 +7,11 @@
 
 #include <ace/Message_Block.h>
 #include <ace/CDR_Stream.h>
+#include <ace/OS_NS_string.h>
 #include "Serializer.h"
 
+#include <algorithm>
+
 #ifndef OPENDDS_SAFETY_PROFILE
 #include <string>
 #endif
@@ -94,9 +97,44 @@ Serializer::doread(char* dest, size_t size, bool swap, size_t offset)
   return offset + initial;
 }
 
+ACE_INLINE void
+Serializer::fast_copy(char* to, const char* from, size_t n, bool swap)
+{
+  if (swap) {
+    for (size_t i = 0; i < n; ++i) {
+      to[i] = from[n - 1 - i];
+    }
+  } else {
+    (void) ACE_OS::memcpy(to, from, n);
+  }
+}
+
+ACE_INLINE void
+Serializer::swap_array(char* to, const char* from, size_t size, size_t count)
+{
+  if (count < SIMD_SWAP_MIN) {
+    for (size_t i = 0; i < count; ++i, to += size, from += size) {
+      fast_copy(to, from, size, true);
+    }
+  } else {
+    swap_array_simd(to, from, size, count);
+  }
+}
+
 ACE_INLINE void
 Serializer::buffer_read(char* dest, size_t size, bool swap)
 {
+  //
+  // Fast path for the common case of a value that is in the current block
+  // and doesn't use it up, so the rest of the chain doesn't matter.
+  //
+  if (this->current_ && size < this->current_->length()
+      && (!swap || size <= MAX_SWAP)) {
+    fast_copy(dest, this->current_->rd_ptr(), size, swap);
+    this->current_->rd_ptr(size);
+    return;
+  }
+
   size_t offset = 0;
 
   while (size > offset) {
@@ -167,6 +205,15 @@ Serializer::dowrite(const char* src, size_t size, bool swap, size_t offset)
   //
   if (this->current_->space() == 0) {
 
+    if (this->growth_ && !this->current_->cont()) {
+      if (offset + initial == size) {
+        // Done; a growable chain is only extended by the next write so that
+        // it doesn't end in an empty block.
+        return size;
+      }
+      this->append_block();
+    }
+
     if (this->alignment_ == ALIGN_NONE) {
       this->current_ = this->current_->cont();
     } else {
@@ -183,6 +230,16 @@ Serializer::dowrite(const char* src, size_t size, bool swap, size_t offset)
 ACE_INLINE void
 Serializer::buffer_write(const char* src, size_t size, bool swap)
 {
+  //
+  // Fast path, see buffer_read().
+  //
+  if (this->current_ && size < this->current_->space()
+      && (!swap || size <= MAX_SWAP)) {
+    fast_copy(this->current_->wr_ptr(), src, size, swap);
+    this->current_->wr_ptr(size);
+    return;
+  }
+
   size_t offset = 0;
 
   while (size > offset) {
@@ -208,6 +265,26 @@ Serializer::alignment() const
   return this->alignment_;
 }
 
+ACE_INLINE bool
+Serializer::wire_compatible_r(size_t max_align) const
+{
+  if (this->swap_bytes_ || !this->current_) {
+    return false;
+  }
+  return this->alignment_ == ALIGN_NONE
+    || (ptrdiff_t(this->current_->rd_ptr()) - this->align_rshift_) % max_align == 0;
+}
+
+ACE_INLINE bool
+Serializer::wire_compatible_w(size_t max_align) const
+{
+  if (this->swap_bytes_ || !this->current_) {
+    return false;
+  }
+  return this->alignment_ == ALIGN_NONE
+    || (ptrdiff_t(this->current_->wr_ptr()) - this->align_wshift_) % max_align == 0;
+}
+
 ACE_INLINE bool
 Serializer::good_bit() const
 {
@@ -267,13 +344,24 @@ Serializer::read_array(char* x, size_t size,
 
   } else {
     //
-    // Swapping _must_ be done at 'size' boundaries, so we need to spin
-    // through the array element by element.  This silently corrupts the
-    // data if there is padding in the buffer.
+    // Swapping _must_ be done at 'size' boundaries.  All the elements that
+    // are in the current block (without using it up) are swapped at once,
+    // the ones that straddle blocks are read one at a time.  This silently
+    // corrupts the data if there is padding in the buffer.
     //
-    while (length-- > 0) {
-      this->buffer_read(x, size, true);
-      x += size;
+    while (length > 0) {
+      const size_t avail = this->current_ ? this->current_->length() : 0;
+      size_t n = (avail && size <= MAX_SWAP)
+        ? std::min(static_cast<size_t>(length), (avail - 1) / size) : 0;
+      if (n) {
+        swap_array(x, this->current_->rd_ptr(), size, n);
+        this->current_->rd_ptr(size * n);
+      } else {
+        this->buffer_read(x, size, true);
+        n = 1;
+      }
+      x += size * n;
+      length -= static_cast<ACE_CDR::ULong>(n);
     }
   }
 }
@@ -296,15 +384,24 @@ Serializer::write_array(const char* x, size_t size,
 
   } else {
     //
-    // Swapping _must_ be done at 'size' boundaries, so we need to spin
-    // through the array element by element.
+    // Swapping _must_ be done at 'size' boundaries, see read_array().
     // NOTE: This assumes that there is _no_ padding between the array
     //       elements.  If this is not the case, do not use this
     //       method.
     //
-    while (length-- > 0) {
-      this->buffer_write(x, size, true);
-      x += size;
+    while (length > 0) {
+      const size_t avail = this->current_ ? this->current_->space() : 0;
+      size_t n = (avail && size <= MAX_SWAP)
+        ? std::min(static_cast<size_t>(length), (avail - 1) / size) : 0;
+      if (n) {
+        swap_array(this->current_->wr_ptr(), x, size, n);
+        this->current_->wr_ptr(size * n);
+      } else {
+        this->buffer_write(x, size, true);
+        n = 1;
+      }
+      x += size * n;
+      length -= static_cast<ACE_CDR::ULong>(n);
     }
   }
 }
@@ -547,12 +644,17 @@ Serializer::align_w(size_t al)
       break;
     }
     const size_t cur_spc = this->current_->space();
-    if (cur_spc <= len) {
+    // Padding that just fills this block stays in it, so that a growable
+    // chain isn't extended until there's more to write.
+    if (cur_spc < len) {
       len -= cur_spc;
       if (this->alignment_ == ALIGN_INITIALIZE) {
         this->smemcpy(this->current_->wr_ptr(), ALIGN_PAD, cur_spc);
       }
       this->current_->wr_ptr(cur_spc);
+      if (this->growth_ && !this->current_->cont()) {
+        this->append_block();
+      }
       this->align_cont_w();
     } else {
       if (this->alignment_ == ALIGN_INITIALIZE) {
@@ -128,6 +128,7 @@ static bool got_use_rti_serialization = false;
 static bool got_info = false;
 static bool got_chunks = false;
 static bool got_chunk_association_multiplier = false;
+static bool got_listener_dispatch_threads = false;
 static bool got_liveliness_factor = false;
 static bool got_bit_transport_port = false;
 static bool got_bit_transport_ip = false;
@@ -204,7 +205,8 @@ Service_Participant::Service_Participant()
     monitor_enabled_(false),
     shut_down_(false),
     shutdown_listener_(0),
-    default_configuration_file_(ACE_TEXT(""))
+    default_configuration_file_(ACE_TEXT("")),
+    listener_dispatch_threads_(0)
 {
   initialize();
 }
@@ -266,6 +268,18 @@ Service_Participant::shutdown()
 
   shut_down_ = true;
   try {
+    // Kept until destruction, readers may still hold on to it.  Shut down
+    // without listener_dispatcher_lock_, which listener_dispatcher() takes
+    // from the callbacks being waited for.
+    ListenerDispatcher* dispatcher = 0;
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, listener_dispatcher_lock_);
+      dispatcher = listener_dispatcher_.get();
+    }
+    if (dispatcher) {
+      dispatcher->shutdown();
+    }
+
     TransportRegistry::instance()->release();
     {
       ACE_GUARD(TAO_SYNCH_MUTEX, guard, this->factory_lock_);
@@ -495,6 +509,11 @@ Service_Participant::parse_args(int &argc, ACE_TCHAR *argv[])
       arg_shifter.consume_arg();
       got_chunks = true;
 
+    } else if ((currentArg = arg_shifter.get_the_parameter(ACE_TEXT("-DCPSListenerDispatchThreads"))) != 0) {
+      listener_dispatch_threads_ = ACE_OS::atoi(currentArg);
+      arg_shifter.consume_arg();
+      got_listener_dispatch_threads = true;
+
     } else if ((currentArg = arg_shifter.get_the_parameter(ACE_TEXT("-DCPSChunkAssociationMultiplier"))) != 0) {
       association_chunk_multiplier_ = ACE_OS::atoi(currentArg);
       arg_shifter.consume_arg();
@@ -1309,6 +1328,19 @@ Service_Participant::n_chunks(size_t chunks)
   got_chunks = true;
 }
 
+size_t
+Service_Participant::listener_dispatch_threads() const
+{
+  return listener_dispatch_threads_;
+}
+
+void
+Service_Participant::listener_dispatch_threads(size_t threads)
+{
+  listener_dispatch_threads_ = threads;
+  got_listener_dispatch_threads = true;
+}
+
 size_t
 Service_Participant::association_chunk_multiplier() const
 {
@@ -1523,6 +1555,12 @@ Service_Participant::load_common_configuration(ACE_Configuration_Heap& cf,
       GET_CONFIG_VALUE(cf, sect, ACE_TEXT("DCPSChunks"), this->n_chunks_, size_t)
     }
 
+    if (got_listener_dispatch_threads) {
+      ACE_DEBUG((LM_NOTICE, message, ACE_TEXT("DCPSListenerDispatchThreads")));
+    } else {
+      GET_CONFIG_VALUE(cf, sect, ACE_TEXT("DCPSListenerDispatchThreads"), this->listener_dispatch_threads_, size_t)
+    }
+
     if (got_chunk_association_multiplier) {
       ACE_DEBUG((LM_NOTICE, message, ACE_TEXT("DCPSChunkAssociationMutltiplier")));
     } else {
@@ -2101,6 +2139,42 @@ NetworkConfigMonitor_rch Service_Participant::network_config_monitor()
   return network_config_monitor_;
 }
 
+ListenerDispatcher* Service_Participant::listener_dispatcher()
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, listener_dispatcher_lock_, 0);
+
+  if (shut_down_ || !listener_dispatch_threads_) {
+    return 0;
+  }
+
+  if (!listener_dispatcher_) {
+    listener_dispatcher_.reset(new ListenerDispatcher(listener_dispatch_threads_));
+  } else if (!listener_dispatcher_->is_shut_down()) {
+    return listener_dispatcher_.get();
+  }
+
+  // New, or stopped by an earlier shutdown()
+  if (listener_dispatcher_->open() != 0) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: Service_Participant::listener_dispatcher ")
+               ACE_TEXT("could not start the listener dispatch threads, dispatching inline\n")));
+    listener_dispatcher_->shutdown();
+    listener_dispatch_threads_ = 0;
+    return 0;
+  }
+
+  return listener_dispatcher_.get();
+}
+
+bool Service_Participant::listener_dispatch_status(ListenerDispatcher::Status& status) const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, listener_dispatcher_lock_, false);
+  if (!listener_dispatcher_) {
+    return false;
+  }
+  status = listener_dispatcher_->status();
+  return true;
+}
+
 #ifdef OPENDDS_NETWORK_CONFIG_MODIFIER
 NetworkConfigModifier* Service_Participant::network_config_modifier()
 {
@@ -19,6 +19,7 @@
 #include "dds/DCPS/DomainParticipantFactoryImpl.h"
 #include "dds/DCPS/unique_ptr.h"
 #include "dds/DCPS/ReactorTask.h"
+#include "dds/DCPS/ListenerDispatcher.h"
 #include "dds/DCPS/NetworkConfigMonitor.h"
 #include "dds/DCPS/NetworkConfigModifier.h"
 
@@ -184,6 +185,16 @@ public:
    */
   void     association_chunk_multiplier(size_t multiplier);
 
+  /// Number of worker threads that run listener callbacks for readers
+  /// with pooled dispatch (see DataReaderImpl::pooled_dispatch()).  The
+  /// default, 0, disables pooled dispatch.  Can be set by the
+  /// @c -DCPSListenerDispatchThreads option, or by the setter before the
+  /// pool is first used.
+  size_t   listener_dispatch_threads() const;
+
+  /// Set the value returned by @c listener_dispatch_threads() accessor.
+  void     listener_dispatch_threads(size_t threads);
+
   /// Set the Liveliness propagation delay factor.
   /// @param factor % of lease period before sending a liveliness
   ///               message.
@@ -411,6 +422,15 @@ public:
 #endif
   NetworkConfigMonitor_rch network_config_monitor();
 
+  /// The pool that runs pooled listener callbacks, started when first
+  /// used.  Null if listener_dispatch_threads() is 0 or after shutdown().
+  /// The pool lives as long as the Service_Participant.
+  ListenerDispatcher* listener_dispatcher();
+
+  /// Status of the listener dispatch pool for the monitor, false if it
+  /// hasn't been started.
+  bool listener_dispatch_status(ListenerDispatcher::Status& status) const;
+
 private:
 
   /// Initialize default qos.
@@ -644,6 +664,12 @@ private:
 
   NetworkConfigMonitor_rch network_config_monitor_;
   mutable ACE_Thread_Mutex network_config_monitor_lock_;
+
+  /// The configurable number of listener dispatch threads.
+  size_t listener_dispatch_threads_;
+
+  unique_ptr<ListenerDispatcher> listener_dispatcher_;
+  mutable ACE_Thread_Mutex listener_dispatcher_lock_;
 };
 
 #define TheServiceParticipant OpenDDS::DCPS::Service_Participant::instance()
@@ -45,6 +45,10 @@ public:
 
   virtual void execute(const MonotonicTimePoint& now) = 0;
 
+protected:
+  /// The reactor refused the timer, execute() won't be called.
+  virtual void schedule_failed() {}
+
 private:
   RcHandle<ReactorInterceptor> interceptor_;
   bool scheduled_;
@@ -92,6 +96,7 @@ private:
       if (timer == -1) {
         ACE_ERROR((LM_ERROR, "(%P|%t) SporadicTask::enable"
                    " failed to schedule timer %p\n", ACE_TEXT("")));
+        schedule_failed();
       } else {
         scheduled_ = true;
       }
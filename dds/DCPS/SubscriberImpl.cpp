@@ -53,6 +53,8 @@ SubscriberImpl::SubscriberImpl(DDS::InstanceHandle_t       handle,
   domain_id_(participant->get_domain_id()),
   raw_latency_buffer_size_(0),
   raw_latency_buffer_type_(DataCollector<double>::KeepOldest),
+  pooled_dispatch_(false),
+  coalesce_data_available_(false),
   access_depth_ (0)
 {
   //Note: OK to duplicate a nil.
@@ -216,6 +218,8 @@ SubscriberImpl::create_datareader(
   //        readers from data gathering.
   dr_servant->raw_latency_buffer_size() = this->raw_latency_buffer_size_;
   dr_servant->raw_latency_buffer_type() = this->raw_latency_buffer_type_;
+  dr_servant->pooled_dispatch() = this->pooled_dispatch_;
+  dr_servant->coalesce_data_available() = this->coalesce_data_available_;
 
 
   dr_servant->init(topic_servant,
@@ -932,6 +936,18 @@ SubscriberImpl::raw_latency_buffer_type()
   return this->raw_latency_buffer_type_;
 }
 
+bool&
+SubscriberImpl::pooled_dispatch()
+{
+  return this->pooled_dispatch_;
+}
+
+bool&
+SubscriberImpl::coalesce_data_available()
+{
+  return this->coalesce_data_available_;
+}
+
 void
 SubscriberImpl::get_subscription_ids(SubscriptionIdVec& subs)
 {
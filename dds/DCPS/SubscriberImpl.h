@@ -136,6 +136,14 @@ public:
 
   /// @}
 
+  /// Initial DataReaderImpl::pooled_dispatch() of readers created by
+  /// this Subscriber.
+  bool& pooled_dispatch();
+
+  /// Initial DataReaderImpl::coalesce_data_available() of readers created
+  /// by this Subscriber.
+  bool& coalesce_data_available();
+
   typedef OPENDDS_VECTOR(RepoId) SubscriptionIdVec;
   /// Populates a std::vector with the SubscriptionIds (GUIDs)
   /// of this Subscriber's Data Readers
@@ -201,6 +209,12 @@ private:
   /// Type of raw latency data buffers.
   DataCollector<double>::OnFull raw_latency_buffer_type_;
 
+  /// Readers run on_data_available() on the listener dispatch threads.
+  bool pooled_dispatch_;
+
+  /// Readers coalesce on_data_available() calls.
+  bool coalesce_data_available_;
+
   /// this lock protects the data structures in this class.
   ACE_Recursive_Thread_Mutex   si_lock_;
 
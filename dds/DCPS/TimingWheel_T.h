@@ -0,0 +1,248 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_TIMING_WHEEL_T_H
+#define OPENDDS_DCPS_TIMING_WHEEL_T_H
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+#include "PoolAllocator.h"
+#include "TimeTypes.h"
+
+#include "ace/Basic_Types.h"
+
+#include <algorithm>
+#include <functional>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class TimingWheel<Key, Compare>
+ *
+ * @brief Hierarchical timing wheel of deadlines, one per Key.
+ *
+ * Deadlines are rounded up to a multiple of the resolution ("tick").  Keys
+ * due within the next SLOTS ticks live in the innermost wheel, later ones
+ * in coarser outer wheels and are moved inward as their time approaches.
+ * expire() costs O(ticks elapsed + keys expired) no matter how many keys
+ * are scheduled, and schedule()/cancel() are O(log n).
+ *
+ * Not thread safe, callers provide locking.
+ */
+template<typename Key, typename Compare = std::less<Key> >
+class TimingWheel {
+public:
+  typedef OPENDDS_VECTOR(Key) KeyVec;
+
+  TimingWheel(const TimeDuration& resolution,
+              const MonotonicTimePoint& start = MonotonicTimePoint::now())
+    : resolution_usec_(to_usec(resolution.value()))
+    , origin_(start)
+    , current_tick_(0)
+  {
+    if (resolution_usec_ == 0) {
+      resolution_usec_ = 1;
+    }
+    std::fill(level_size_, level_size_ + LEVELS, size_t(0));
+  }
+
+  /// Schedule "key" to expire at "deadline".  If "key" is already
+  /// scheduled the earlier of the two deadlines is kept, use cancel() first
+  /// to postpone it.  Deadlines in the past expire on the next call to
+  /// expire().  Returns true if the deadline of "key" changed.
+  bool schedule(const Key& key, const MonotonicTimePoint& deadline)
+  {
+    Entry entry;
+    entry.tick_ = std::max(to_tick(deadline), current_tick_ + 1);
+    const typename EntryMap::iterator pos = entries_.find(key);
+    if (pos != entries_.end()) {
+      if (pos->second.tick_ <= entry.tick_) {
+        return false;
+      }
+      remove(pos);
+    }
+    place(key, entry);
+    return true;
+  }
+
+  /// Remove "key" from the wheel.  Returns false if it wasn't scheduled.
+  bool cancel(const Key& key)
+  {
+    const typename EntryMap::iterator pos = entries_.find(key);
+    if (pos == entries_.end()) {
+      return false;
+    }
+    remove(pos);
+    return true;
+  }
+
+  bool is_scheduled(const Key& key) const
+  {
+    return entries_.find(key) != entries_.end();
+  }
+
+  /// The deadline of "key" rounded up to the resolution, if scheduled.
+  bool deadline(const Key& key, MonotonicTimePoint& deadline) const
+  {
+    const typename EntryMap::const_iterator pos = entries_.find(key);
+    if (pos == entries_.end()) {
+      return false;
+    }
+    deadline = from_tick(pos->second.tick_);
+    return true;
+  }
+
+  TimeDuration resolution() const
+  {
+    return TimeDuration(static_cast<time_t>(resolution_usec_ / 1000000),
+                        static_cast<suseconds_t>(resolution_usec_ % 1000000));
+  }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  /// Advance the wheel to "now", removing every key whose deadline has
+  /// passed and appending it to "expired".
+  void expire(const MonotonicTimePoint& now, KeyVec& expired)
+  {
+    const ACE_UINT64 target = now < origin_ ? 0 : to_usec((now - origin_).value()) / resolution_usec_;
+    while (current_tick_ < target && !entries_.empty()) {
+      // Skip ahead to the next time the innermost non-empty wheel cascades.
+      size_t lowest = 0;
+      while (level_size_[lowest] == 0) {
+        ++lowest;
+      }
+      if (lowest > 0) {
+        const ACE_UINT64 next = ((current_tick_ >> (BITS * lowest)) + 1) << (BITS * lowest);
+        if (next > target) {
+          break;
+        }
+        current_tick_ = next - 1;
+      }
+
+      ++current_tick_;
+      const size_t index = static_cast<size_t>(current_tick_ & MASK);
+      if (index == 0) {
+        cascade(1);
+      }
+      Slot slot;
+      slot.swap(wheel_[0][index]);
+      level_size_[0] -= slot.size();
+      for (typename Slot::const_iterator pos = slot.begin(); pos != slot.end(); ++pos) {
+        const typename EntryMap::iterator entry = entries_.find(*pos);
+        if (entry->second.tick_ <= current_tick_) {
+          expired.push_back(*pos);
+          entries_.erase(entry);
+        } else {
+          place(*pos, entry->second);
+        }
+      }
+    }
+    current_tick_ = std::max(current_tick_, target);
+  }
+
+private:
+  enum {
+    BITS = 6,
+    SLOTS = 1 << BITS,
+    MASK = SLOTS - 1,
+    LEVELS = 4
+  };
+
+  struct Entry {
+    ACE_UINT64 tick_;
+    size_t level_, slot_;
+  };
+
+  typedef OPENDDS_SET_CMP(Key, Compare) Slot;
+  typedef OPENDDS_MAP_CMP(Key, Entry, Compare) EntryMap;
+
+  static ACE_UINT64 to_usec(const ACE_Time_Value& tv)
+  {
+    ACE_UINT64 usec = 0;
+    tv.to_usec(usec);
+    return usec;
+  }
+
+  ACE_UINT64 to_tick(const MonotonicTimePoint& time) const
+  {
+    if (time <= origin_) {
+      return 0;
+    }
+    const ACE_UINT64 usec = to_usec((time - origin_).value());
+    return (usec + resolution_usec_ - 1) / resolution_usec_;
+  }
+
+  MonotonicTimePoint from_tick(ACE_UINT64 tick) const
+  {
+    const ACE_UINT64 usec = tick * resolution_usec_;
+    return origin_ + TimeDuration(static_cast<time_t>(usec / 1000000),
+                                  static_cast<suseconds_t>(usec % 1000000));
+  }
+
+  /// Put "key" in the innermost wheel that can hold "entry.tick_".  Keys
+  /// beyond the outermost wheel wait in its furthest slot and are placed
+  /// again when that slot is cascaded.
+  void place(const Key& key, Entry entry)
+  {
+    const ACE_UINT64 delta = entry.tick_ - current_tick_;
+    size_t level = 0;
+    while (level + 1 < LEVELS && delta >= (ACE_UINT64(1) << (BITS * (level + 1)))) {
+      ++level;
+    }
+    ACE_UINT64 tick = entry.tick_;
+    if (delta >= (ACE_UINT64(1) << (BITS * LEVELS))) {
+      tick = current_tick_ + (ACE_UINT64(1) << (BITS * LEVELS)) - 1;
+    }
+    entry.level_ = level;
+    entry.slot_ = static_cast<size_t>((tick >> (BITS * level)) & MASK);
+    wheel_[level][entry.slot_].insert(key);
+    ++level_size_[level];
+    entries_[key] = entry;
+  }
+
+  void remove(const typename EntryMap::iterator& pos)
+  {
+    wheel_[pos->second.level_][pos->second.slot_].erase(pos->first);
+    --level_size_[pos->second.level_];
+    entries_.erase(pos);
+  }
+
+  /// Move the keys in the current slot of wheel "level" inward.
+  void cascade(size_t level)
+  {
+    const size_t index = static_cast<size_t>((current_tick_ >> (BITS * level)) & MASK);
+    if (index == 0 && level + 1 < LEVELS) {
+      cascade(level + 1);
+    }
+    Slot slot;
+    slot.swap(wheel_[level][index]);
+    level_size_[level] -= slot.size();
+    for (typename Slot::const_iterator pos = slot.begin(); pos != slot.end(); ++pos) {
+      place(*pos, entries_[*pos]);
+    }
+  }
+
+  ACE_UINT64 resolution_usec_;
+  MonotonicTimePoint origin_;
+  ACE_UINT64 current_tick_;
+  Slot wheel_[LEVELS][SLOTS];
+  size_t level_size_[LEVELS];
+  EntryMap entries_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_TIMING_WHEEL_T_H */
@@ -220,9 +220,7 @@ WriteDataContainer::reenqueue_all(const RepoId& reader_id,
                                   const DDS::LifespanQosPolicy& lifespan
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
                                   ,
-                                  const OPENDDS_STRING& filterClassName,
-                                  const FilterEvaluator* eval,
-                                  const DDS::StringSeq& expression_params
+                                  const CompiledFilter* filter
 #endif
                                   )
 {
@@ -245,7 +243,7 @@ WriteDataContainer::reenqueue_all(const RepoId& reader_id,
                    reader_id,
                    lifespan,
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-                   filterClassName, eval, expression_params,
+                   filter,
 #endif
                    total_size);
 
@@ -254,7 +252,7 @@ WriteDataContainer::reenqueue_all(const RepoId& reader_id,
                    reader_id,
                    lifespan,
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-                   filterClassName, eval, expression_params,
+                   filter,
 #endif
                    total_size);
 
@@ -1002,6 +1000,27 @@ WriteDataContainer::obtain_buffer_for_control(DataSampleElement*& element)
   return DDS::RETCODE_OK;
 }
 
+bool
+WriteDataContainer::would_block(DDS::InstanceHandle_t handle)
+{
+  if (this->writer_->qos_.reliability.kind != DDS::RELIABLE_RELIABILITY_QOS) {
+    return false;
+  }
+
+  PublicationInstance_rch instance = get_handle_instance(handle);
+  if (!instance) {
+    return false;
+  }
+
+  // Same conditions as the loop in obtain_buffer(), which removes the
+  // oldest sample instead of waiting if the instance is at its depth
+  const InstanceDataSampleList& instance_list = instance->samples_;
+  return ((instance_list.size() >= max_samples_per_instance_) ||
+          ((this->max_num_samples_ > 0) &&
+           ((CORBA::Long) this->num_all_samples () >= this->max_num_samples_)))
+    && instance_list.size() < history_depth_;
+}
+
 DDS::ReturnCode_t
 WriteDataContainer::obtain_buffer(DataSampleElement*& element,
                                   DDS::InstanceHandle_t handle)
@@ -1261,9 +1280,7 @@ WriteDataContainer::copy_and_prepend(SendStateDataSampleList& list,
                                      const RepoId& reader_id,
                                      const DDS::LifespanQosPolicy& lifespan,
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-                                     const OPENDDS_STRING& filterClassName,
-                                     const FilterEvaluator* eval,
-                                     const DDS::StringSeq& params,
+                                     const CompiledFilter* filter,
 #endif
                                      ssize_t& max_resend_samples)
 {
@@ -1274,7 +1291,7 @@ WriteDataContainer::copy_and_prepend(SendStateDataSampleList& list,
       continue;
 
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-    if (eval && writer_->filter_out(*cur, filterClassName, *eval, params))
+    if (filter && writer_->filter_out(*cur, *filter))
       continue;
 #endif
 
@@ -43,7 +43,7 @@ class DataWriterImpl;
 #ifndef OPENDDS_NO_PERSISTENCE_PROFILE
 class DataDurabilityCache;
 #endif
-class FilterEvaluator;
+class CompiledFilter;
 
 typedef OPENDDS_MAP(DDS::InstanceHandle_t, PublicationInstance_rch)
   PublicationInstanceMapType;
@@ -178,15 +178,14 @@ public:
   /**
    * Create a resend list with the copies of all current "sending"
    * and "sent" samples. The samples will be sent to the
-   *  subscriber specified.
+   *  subscriber specified, except those that 'filter' (compiled for
+   *  serialized samples) excludes.
    */
   DDS::ReturnCode_t reenqueue_all(const RepoId& reader_id,
                                   const DDS::LifespanQosPolicy& lifespan
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
                                   ,
-                                  const OPENDDS_STRING& filterClassName,
-                                  const FilterEvaluator* eval,
-                                  const DDS::StringSeq& params
+                                  const CompiledFilter* filter
 #endif
                                   );
 
@@ -241,6 +240,12 @@ public:
    */
   size_t num_all_samples();
 
+  /**
+   * True if obtain_buffer() for the instance would wait for samples to be
+   * released by the transport.
+   */
+  bool would_block(DDS::InstanceHandle_t handle);
+
   /**
    * Obtain a list of data that has not yet been sent.  The data
    * on the list returned is moved from the internal unsent_data_
@@ -367,9 +372,7 @@ private:
                         const RepoId& reader_id,
                         const DDS::LifespanQosPolicy& lifespan,
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-                        const OPENDDS_STRING& filterClassName,
-                        const FilterEvaluator* eval,
-                        const DDS::StringSeq& params,
+                        const CompiledFilter* filter,
 #endif
                         ssize_t& max_resend_samples);
 
@@ -279,6 +279,7 @@ ZeroCopyDataSeq<Sample_T, DEF_MAX>::assign_ptr(
   if (ptrs_[ii])
     ptrs_[ii]->dec_ref();
 
+  item->complete_data();
   item->inc_ref();
   ++item->zero_copy_cnt_;
   ptrs_[ii] = item;
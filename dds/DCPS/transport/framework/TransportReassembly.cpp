@@ -12,6 +12,9 @@
 #include "dds/DCPS/GuidConverter.h"
 #include "dds/DCPS/DisjointSequence.h"
 
+#include <algorithm>
+#include <cstring>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -26,6 +29,12 @@ TransportReassembly::FragKey::FragKey(const PublicationId& pubId,
 
 GUID_tKeyLessThan TransportReassembly::FragKey::compare_;
 
+TransportReassembly::TransportReassembly(size_t max_contiguous_size)
+  : max_contiguous_size_(max_contiguous_size)
+  , contiguous_bytes_(0)
+{
+}
+
 TransportReassembly::FragRange::FragRange(const SequenceRange& seqRange,
                                           const ReceivedDataSample& data)
   : transport_seq_(seqRange)
@@ -192,6 +201,10 @@ TransportReassembly::get_gaps(const SequenceNumber& seq, const RepoId& pub_id,
     return 0;
   }
 
+  if (iter->second.is_contiguous()) {
+    return get_gaps_contiguous(iter->second, bitmap, length, numBits);
+  }
+
   // RTPS's FragmentNumbers are 32-bit values, so we'll only be using the
   // low 32 bits of the 64-bit generalized sequence numbers in
   // FragRange::transport_seq_.
@@ -246,6 +259,205 @@ TransportReassembly::reassemble(const SequenceRange& seqRange,
   return reassemble_i(seqRange, seqRange.first == 1, data, total_frags);
 }
 
+CORBA::ULong
+TransportReassembly::get_gaps_contiguous(const FragInfo& info,
+                                         CORBA::Long bitmap[],
+                                         CORBA::ULong length,
+                                         CORBA::ULong& numBits)
+{
+  // Bit i of info.received_ (msb first) is fragment i + 1, find the first
+  // one missing, which is the base of the bitmap.
+  const ACE_UINT32 total = info.total_frags_;
+  ACE_UINT32 i = 0;
+  while (i < total && info.received_[i / 32] == 0xFFFFFFFF) {
+    i += 32;
+  }
+  while (i < total && (info.received_[i / 32] & (0x80000000u >> (i % 32)))) {
+    ++i;
+  }
+  if (i >= total) {
+    return 0;
+  }
+
+  const CORBA::ULong base = i + 1;
+  const ACE_UINT32 limit =
+    std::min(total, static_cast<ACE_UINT32>(i + length * 32));
+  while (i < limit) {
+    // i is missing, find the end of this run of missing fragments
+    ACE_UINT32 end = i + 1;
+    while (end < limit && !(info.received_[end / 32] & (0x80000000u >> (end % 32)))) {
+      ++end;
+    }
+    DisjointSequence::fill_bitmap_range(i + 1 - base, end - base,
+                                        bitmap, length, numBits);
+    // skip over the received fragments that follow
+    i = end + 1;
+    while (i < limit && (info.received_[i / 32] & (0x80000000u >> (i % 32)))) {
+      ++i;
+    }
+  }
+  return base;
+}
+
+bool
+TransportReassembly::reassemble(const SequenceRange& seqRange,
+                                ReceivedDataSample& data,
+                                ACE_UINT32 total_frags,
+                                ACE_UINT32 frag_size,
+                                ACE_UINT32 sample_size)
+{
+  const FragKey key(data.header_.publication_id_, data.header_.sequence_);
+  const FragInfoMap::iterator iter = fragments_.find(key);
+
+  // The mode is chosen when the first fragment of a sample arrives.
+  const bool contiguous = (iter == fragments_.end())
+    ? (total_frags && frag_size && sample_size
+       && static_cast<ACE_UINT64>(total_frags) * frag_size
+          <= max_contiguous_size_ - contiguous_bytes_)
+    : iter->second.is_contiguous();
+
+  if (!contiguous) {
+    return reassemble_i(seqRange, seqRange.first == 1, data, total_frags);
+  }
+  return reassemble_contiguous_i(iter, key, seqRange, data,
+                                 total_frags, frag_size, sample_size);
+}
+
+bool
+TransportReassembly::reassemble_contiguous_i(FragInfoMap::iterator iter,
+                                             const FragKey& key,
+                                             const SequenceRange& seqRange,
+                                             ReceivedDataSample& data,
+                                             ACE_UINT32 total_frags,
+                                             ACE_UINT32 frag_size,
+                                             ACE_UINT32 sample_size)
+{
+  if (Transport_debug_level > 5) {
+    GuidConverter conv(data.header_.publication_id_);
+    ACE_DEBUG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+      "frags %q-%q of %u contiguous dseq %q pub %C\n", seqRange.first.getValue(),
+      seqRange.second.getValue(), total_frags,
+      data.header_.sequence_.getValue(), OPENDDS_STRING(conv).c_str()));
+  }
+
+  if (iter == fragments_.end()) {
+    if (seqRange.first < 1 || seqRange.first > seqRange.second
+        || seqRange.second > SequenceNumber(total_frags)) {
+      VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+        "fragments %q-%q don't match the sample, dropping\n",
+        seqRange.first.getValue(), seqRange.second.getValue()));
+      return false;
+    }
+
+    const size_t size = static_cast<size_t>(total_frags) * frag_size;
+    ACE_Message_Block* buffer = 0;
+    ACE_NEW_NORETURN(buffer, ACE_Message_Block(size));
+    if (!buffer || !buffer->data_block() || buffer->size() < size) {
+      if (buffer) {
+        buffer->release();
+      }
+      if (Transport_debug_level) {
+        ACE_ERROR((LM_WARNING,
+                   ACE_TEXT("(%P|%t) WARNING: TransportReassembly::reassemble() - ")
+                   ACE_TEXT("failed to allocate %B bytes, chaining the fragments\n"),
+                   size));
+      }
+      return reassemble_i(seqRange, seqRange.first == 1, data, total_frags);
+    }
+
+    FragInfo info;
+    info.total_frags_ = total_frags;
+    info.frag_size_ = frag_size;
+    info.sample_size_ = sample_size;
+    info.received_.resize((total_frags + 31) / 32, 0);
+    info.contiguous_.header_ = data.header_;
+    info.contiguous_.sample_.reset(buffer);
+    iter = fragments_.insert(std::make_pair(key, info)).first;
+    contiguous_bytes_ += size;
+  } else if (iter->second.complete_) {
+    return false;
+  }
+
+  FragInfo& info = iter->second;
+  if (total_frags != info.total_frags_ || frag_size != info.frag_size_
+      || sample_size != info.sample_size_
+      || seqRange.first < 1 || seqRange.first > seqRange.second
+      || seqRange.second > SequenceNumber(total_frags)) {
+    VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+      "fragments %q-%q don't match the sample, dropping\n",
+      seqRange.first.getValue(), seqRange.second.getValue()));
+    return false;
+  }
+
+  const ACE_UINT32 first = seqRange.first.getLow(), last = seqRange.second.getLow();
+  const size_t offset = static_cast<size_t>(first - 1) * frag_size;
+  const size_t expected =
+    std::min(static_cast<size_t>(last) * frag_size, static_cast<size_t>(sample_size)) - offset;
+
+  // Make sure all the data is there before recording any of it as received.
+  size_t available = 0;
+  for (ACE_Message_Block* mb = data.sample_.get(); mb && available < expected; mb = mb->cont()) {
+    available += mb->length();
+  }
+  if (available < expected) {
+    if (Transport_debug_level) {
+      ACE_ERROR((LM_WARNING,
+                 ACE_TEXT("(%P|%t) WARNING: TransportReassembly::reassemble() - ")
+                 ACE_TEXT("fragments %q-%q have %B bytes, expected %B, dropping\n"),
+                 seqRange.first.getValue(), seqRange.second.getValue(),
+                 available, expected));
+    }
+    return false;
+  }
+
+  bool added = false;
+  for (ACE_UINT32 frag = first - 1; frag < last; ++frag) {
+    const ACE_UINT32 mask = 0x80000000u >> (frag % 32);
+    if (!(info.received_[frag / 32] & mask)) {
+      info.received_[frag / 32] |= mask;
+      ++info.received_count_;
+      added = true;
+    }
+  }
+  if (!added) {
+    VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+      "duplicate fragment range, dropping\n"));
+    return false;
+  }
+
+  char* dest = info.contiguous_.sample_->base() + offset;
+  size_t remaining = expected;
+  for (ACE_Message_Block* mb = data.sample_.get(); mb && remaining; mb = mb->cont()) {
+    const size_t len = std::min(mb->length(), remaining);
+    std::memcpy(dest, mb->rd_ptr(), len);
+    dest += len;
+    remaining -= len;
+  }
+  data.sample_.reset();
+
+  // The fragment that starts the sample has the inline QoS, use its header.
+  if (first == 1) {
+    info.contiguous_.header_ = data.header_;
+  }
+
+  if (info.received_count_ < info.total_frags_) {
+    VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+      "returning false (incomplete)\n"));
+    return false;
+  }
+
+  info.contiguous_.sample_->wr_ptr(info.sample_size_);
+  info.contiguous_.header_.message_length_ = info.sample_size_;
+  info.contiguous_.header_.more_fragments_ = false;
+  contiguous_bytes_ -= static_cast<size_t>(info.total_frags_) * info.frag_size_;
+  swap(data, info.contiguous_);
+  info.received_.clear();
+  info.complete_ = true;
+  VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+    "completed contiguous sample, returning true\n"));
+  return true;
+}
+
 bool
 TransportReassembly::reassemble(const SequenceNumber& transportSeq,
                                 bool firstFrag,
@@ -323,10 +535,21 @@ TransportReassembly::data_unavailable(const SequenceRange& dropped)
     "dropped %q-%q\n", dropped.first.getValue(), dropped.second.getValue()));
   typedef OPENDDS_LIST(FragRange)::iterator list_iterator;
 
-  for (FragInfoMap::iterator iter = fragments_.begin(); iter != fragments_.end();
-       ++iter) {
+  for (FragInfoMap::iterator next = fragments_.begin(); next != fragments_.end();) {
+    const FragInfoMap::iterator iter = next++;
     const FragKey& key = iter->first;
+    if (iter->second.is_contiguous()) {
+      // Fragments of contiguous samples aren't tracked by transport
+      // sequence, the rest of this one may never arrive.
+      release_contiguous(iter->second);
+      fragments_.erase(iter);
+      continue;
+    }
     OPENDDS_LIST(FragRange)& flist = iter->second.range_list_;
+    if (flist.empty()) {
+      // completed
+      continue;
+    }
 
     ReceivedDataSample dummy(0);
     dummy.header_.sequence_ = key.data_sample_seq_;
@@ -372,8 +595,21 @@ void
 TransportReassembly::data_unavailable(const SequenceNumber& dataSampleSeq,
                                       const RepoId& pub_id)
 {
-  const FragKey key(pub_id, dataSampleSeq);
-  fragments_.erase(key);
+  const FragInfoMap::iterator iter = fragments_.find(FragKey(pub_id, dataSampleSeq));
+  if (iter != fragments_.end()) {
+    release_contiguous(iter->second);
+    fragments_.erase(iter);
+  }
+}
+
+void
+TransportReassembly::release_contiguous(FragInfo& info)
+{
+  if (info.is_contiguous()) {
+    contiguous_bytes_ -= static_cast<size_t>(info.total_frags_) * info.frag_size_;
+    info.contiguous_.sample_.reset();
+    info.received_.clear();
+  }
 }
 
 }
@@ -21,6 +21,12 @@ namespace DCPS {
 class OpenDDS_Dcps_Export TransportReassembly {
 public:
 
+  /// Samples given to the reassemble() overload that takes the fragment
+  /// size are reassembled in one buffer while the buffers of all the
+  /// incomplete samples total at most max_contiguous_size bytes, 0 disables
+  /// this.
+  explicit TransportReassembly(size_t max_contiguous_size = 0);
+
   /// Called by TransportReceiveStrategy if the fragmentation header flag
   /// is set.  Returns true/false to indicate if data should be delivered to
   /// the datalink.  The 'data' argument may be modified by this method.
@@ -29,6 +35,18 @@ public:
 
   bool reassemble(const SequenceRange& seqRange, ReceivedDataSample& data, ACE_UINT32 total_frags = 0);
 
+  /// Same as above for a sample of sample_size bytes sent in fragments of
+  /// frag_size bytes (the last one may be shorter).  If the sample fits in
+  /// what is left of max_contiguous_size, a buffer of total_frags *
+  /// frag_size bytes is allocated when its first fragment arrives and each
+  /// fragment is copied to its offset, with a bitmap tracking which ones
+  /// have arrived.  The completed sample is then a single message block.
+  /// Otherwise, or if the buffer can't be allocated, the fragments are
+  /// chained.
+  bool reassemble(const SequenceRange& seqRange, ReceivedDataSample& data,
+                  ACE_UINT32 total_frags, ACE_UINT32 frag_size,
+                  ACE_UINT32 sample_size);
+
   /// Called by TransportReceiveStrategy to indicate that we can
   /// stop tracking partially-reassembled messages when we know the
   /// remaining fragments are not expected to arrive.
@@ -90,24 +108,54 @@ private:
 
   // Each element of the FragRangeList represents one sent message
   // (one DataSampleHeader before fragmentation).  The list must have at
-  // least one value in it.  If a FragRange in the list has a sample_ with
+  // least one value in it, unless the FragInfo is complete or contiguous.  If a FragRange in the list has a sample_ with
   // a null ACE_Message_Block*, it's one that was data_unavailable().
   typedef OPENDDS_LIST(FragRange) FragRangeList;
 
   struct FragInfo {
     FragInfo()
-      : complete_(false), have_first_(false), range_list_(), total_frags_(0) {}
+      : complete_(false), have_first_(false), range_list_(), total_frags_(0)
+      , contiguous_(0), received_count_(0), frag_size_(0), sample_size_(0) {}
     FragInfo(bool hf, const FragRangeList& rl, ACE_UINT32 tf)
-      : complete_(false), have_first_(hf), range_list_(rl), total_frags_(tf) {}
+      : complete_(false), have_first_(hf), range_list_(rl), total_frags_(tf)
+      , contiguous_(0), received_count_(0), frag_size_(0), sample_size_(0) {}
+
+    bool is_contiguous() const { return contiguous_.sample_.get() != 0; }
 
     bool complete_;
     bool have_first_;
     FragRangeList range_list_;
     ACE_UINT32 total_frags_;
+
+    // Only used in contiguous mode, where range_list_ is empty:
+    // contiguous_.sample_ is the buffer for the whole sample and bit
+    // (fragment number - 1) of received_ is set once that fragment is in it.
+    ReceivedDataSample contiguous_;
+    OPENDDS_VECTOR(ACE_UINT32) received_;
+    ACE_UINT32 received_count_;
+    ACE_UINT32 frag_size_;
+    ACE_UINT32 sample_size_;
   };
 
   typedef OPENDDS_MAP(FragKey, FragInfo) FragInfoMap;
   FragInfoMap fragments_;
+  size_t max_contiguous_size_;
+  /// Bytes allocated for the incomplete samples in contiguous mode
+  size_t contiguous_bytes_;
+
+  /// Free the buffer of an incomplete sample in contiguous mode.
+  void release_contiguous(FragInfo& info);
+
+  bool reassemble_contiguous_i(FragInfoMap::iterator iter, const FragKey& key,
+                               const SequenceRange& seqRange,
+                               ReceivedDataSample& data,
+                               ACE_UINT32 total_frags, ACE_UINT32 frag_size,
+                               ACE_UINT32 sample_size);
+
+  static CORBA::ULong get_gaps_contiguous(const FragInfo& info,
+                                          CORBA::Long bitmap[],
+                                          CORBA::ULong length,
+                                          CORBA::ULong& numBits);
 
   static bool insert(OPENDDS_LIST(FragRange)& flist,
                      const SequenceRange& seqRange,
@@ -9,6 +9,8 @@
 #include "ace/INET_Addr.h"
 #include "ace/Min_Max.h"
 
+#include <algorithm>
+
 #if !defined (__ACE_INLINE__)
 #include "TransportReceiveStrategy_T.inl"
 #endif /* __ACE_INLINE__ */
@@ -78,6 +80,30 @@ TransportReceiveStrategy<TH, DSH>::check_header(const DSH& /*header*/)
   return true;
 }
 
+template<typename TH, typename DSH>
+int
+TransportReceiveStrategy<TH, DSH>::allocate_receive_buffer(size_t index)
+{
+  ACE_NEW_MALLOC_RETURN(
+    receive_buffers_[index],
+    (ACE_Message_Block*) mb_allocator_.malloc(sizeof(ACE_Message_Block)),
+    ACE_Message_Block(
+      RECEIVE_DATA_BUFFER_SIZE,           // Buffer size
+      ACE_Message_Block::MB_DATA,         // Default
+      0,                                  // Start with no continuation
+      0,                                  // Let the constructor allocate
+      &data_allocator_,                   // Our buffer cache
+      &receive_lock_,                     // Our locking strategy
+      ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY, // Default
+      ACE_Time_Value::zero,               // Default
+      ACE_Time_Value::max_time,           // Default
+      &db_allocator_,                     // Our data block cache
+      &mb_allocator_                      // Our message block cache
+    ),
+    -1);
+  return 0;
+}
+
 template<typename TH, typename DSH>
 int
 TransportReceiveStrategy<TH, DSH>::handle_simple_dds_input(ACE_HANDLE fd)
@@ -85,24 +111,8 @@ TransportReceiveStrategy<TH, DSH>::handle_simple_dds_input(ACE_HANDLE fd)
   DBG_ENTRY_LVL("TransportReceiveStrategy", "handle_simple_dds_input", 6);
 
   for (int index = 0; index < RECEIVE_BUFFERS; ++index) {
-    if (receive_buffers_[index] == 0) {
-      ACE_NEW_MALLOC_RETURN(
-        receive_buffers_[index],
-        (ACE_Message_Block*) mb_allocator_.malloc(sizeof(ACE_Message_Block)),
-        ACE_Message_Block(
-          RECEIVE_DATA_BUFFER_SIZE,           // Buffer size
-          ACE_Message_Block::MB_DATA,         // Default
-          0,                                  // Start with no continuation
-          0,                                  // Let the constructor allocate
-          &data_allocator_,                   // Our buffer cache
-          &receive_lock_,                     // Our locking strategy
-          ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY, // Default
-          ACE_Time_Value::zero,               // Default
-          ACE_Time_Value::max_time,           // Default
-          &db_allocator_,                     // Our data block cache
-          &mb_allocator_                      // Our message block cache
-        ),
-        -1);
+    if (receive_buffers_[index] == 0 && allocate_receive_buffer(index) != 0) {
+      return -1;
     }
   }
 
@@ -139,8 +149,6 @@ TransportReceiveStrategy<TH, DSH>::handle_simple_dds_input(ACE_HANDLE fd)
     return -1;
   }
 
-  cur_rb->wr_ptr(bytes_remaining);
-
   if (bytes_remaining == 0) {
     if (gracefully_disconnected_) {
       return -1;
@@ -150,6 +158,134 @@ TransportReceiveStrategy<TH, DSH>::handle_simple_dds_input(ACE_HANDLE fd)
     }
   }
 
+  return process_simple_dds_input(buffer_index_, bytes_remaining, 0, remote_address);
+}
+
+template<typename TH, typename DSH>
+int
+TransportReceiveStrategy<TH, DSH>::handle_batched_dds_input(ACE_HANDLE fd,
+                                                            size_t max_datagrams)
+{
+  DBG_ENTRY_LVL("TransportReceiveStrategy", "handle_batched_dds_input", 6);
+
+  const int count = static_cast<int>(std::min(std::max(max_datagrams, size_t(1)),
+                                              size_t(RECEIVE_BUFFERS)));
+
+  iovec iov[RECEIVE_BUFFERS];
+  ssize_t lengths[RECEIVE_BUFFERS];
+  size_t segment_sizes[RECEIVE_BUFFERS];
+  ACE_INET_Addr remote_addresses[RECEIVE_BUFFERS];
+
+  for (int index = 0; index < count; ++index) {
+    if (receive_buffers_[index] == 0 && allocate_receive_buffer(index) != 0) {
+      return -1;
+    }
+    ACE_Message_Block* const rb = receive_buffers_[index];
+    rb->reset();
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4267)
+#endif
+    iov[index].iov_len = rb->space();
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+    iov[index].iov_base = rb->wr_ptr();
+    lengths[index] = 0;
+    segment_sizes[index] = 0;
+  }
+
+  bool stop = false;
+  const int received = receive_datagrams(iov, lengths, segment_sizes,
+                                         remote_addresses, count, fd, stop);
+
+  if (stop) {
+    return 0;
+  }
+
+  if (received < 0) {
+    relink();
+    return -1;
+  }
+
+  for (int index = 0; index < received; ++index) {
+    if (lengths[index] <= 0) {
+      continue;
+    }
+    datagram_received(remote_addresses[index]);
+    if (process_simple_dds_input(index, lengths[index], segment_sizes[index],
+                                 remote_addresses[index]) != 0) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+template<typename TH, typename DSH>
+int
+TransportReceiveStrategy<TH, DSH>::receive_datagrams(iovec iov[],
+                                                     ssize_t lengths[],
+                                                     size_t /*segment_sizes*/[],
+                                                     ACE_INET_Addr remote_addresses[],
+                                                     int n,
+                                                     ACE_HANDLE fd,
+                                                     bool& stop)
+{
+  if (n < 1) {
+    return 0;
+  }
+  lengths[0] = receive_bytes(iov, 1, remote_addresses[0], fd, stop);
+  return lengths[0] < 0 ? -1 : 1;
+}
+
+template<typename TH, typename DSH>
+int
+TransportReceiveStrategy<TH, DSH>::process_simple_dds_input(size_t index,
+                                                            ssize_t bytes,
+                                                            size_t segment_size,
+                                                            const ACE_INET_Addr& remote_address)
+{
+  ACE_Message_Block* cur_rb = receive_buffers_[index];
+
+  int status = 0;
+  if (segment_size == 0 || segment_size >= static_cast<size_t>(bytes)) {
+    cur_rb->wr_ptr(bytes);
+    status = process_datagram(cur_rb, bytes, remote_address);
+
+  } else {
+    // The receive coalesced several datagrams of segment_size bytes (only
+    // the last one may be shorter), process each one in place.
+    char* const base = cur_rb->wr_ptr();
+    for (size_t offset = 0; offset < static_cast<size_t>(bytes) && status == 0;
+         offset += segment_size) {
+      const size_t length = std::min(segment_size, static_cast<size_t>(bytes) - offset);
+      cur_rb->rd_ptr(base + offset);
+      cur_rb->wr_ptr(base + offset + length);
+      status = process_datagram(cur_rb, length, remote_address);
+    }
+  }
+
+  if (cur_rb->data_block()->reference_count() > 1) {
+    ACE_DES_FREE(
+      cur_rb,
+      mb_allocator_.free,
+      ACE_Message_Block);
+
+    if (allocate_receive_buffer(index) != 0) {
+      return -1;
+    }
+  }
+
+  return status;
+}
+
+template<typename TH, typename DSH>
+int
+TransportReceiveStrategy<TH, DSH>::process_datagram(ACE_Message_Block* cur_rb,
+                                                    ssize_t bytes_remaining,
+                                                    const ACE_INET_Addr& remote_address)
+{
   if (!pdu_remaining_) {
     receive_transport_header_.length_ = static_cast<ACE_UINT32>(bytes_remaining);
   }
@@ -209,32 +345,6 @@ TransportReceiveStrategy<TH, DSH>::handle_simple_dds_input(ACE_HANDLE fd)
     receive_transport_header_.last_fragment(false);
   }
 
-
-  if (cur_rb->data_block()->reference_count() > 1) {
-    ACE_DES_FREE(
-      cur_rb,
-      mb_allocator_.free,
-      ACE_Message_Block);
-
-    ACE_NEW_MALLOC_RETURN(
-      receive_buffers_[buffer_index_],
-      (ACE_Message_Block*) mb_allocator_.malloc(sizeof(ACE_Message_Block)),
-      ACE_Message_Block(
-        RECEIVE_DATA_BUFFER_SIZE,           // Buffer size
-        ACE_Message_Block::MB_DATA,         // Default
-        0,                                  // Start with no continuation
-        0,                                  // Let the constructor allocate
-        &data_allocator_,                   // Our buffer cache
-        &receive_lock_,                     // Our locking strategy
-        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY, // Default
-        ACE_Time_Value::zero,               // Default
-        ACE_Time_Value::max_time,           // Default
-        &db_allocator_,                     // Our data block cache
-        &mb_allocator_                      // Our message block cache
-      ),
-      -1);
-  }
-
   return 0;
 }
 
@@ -44,6 +44,12 @@ public:
   /// chains that need to be updated / maintained
   int handle_simple_dds_input(ACE_HANDLE fd);
 
+  /// Variant of handle_simple_dds_input that drains up to max_datagrams
+  /// datagrams with one call to receive_datagrams().  Each datagram lands
+  /// in its own receive buffer and is then processed, in the order
+  /// received, exactly as handle_simple_dds_input would process it.
+  int handle_batched_dds_input(ACE_HANDLE fd, size_t max_datagrams);
+
   int handle_dds_input(ACE_HANDLE fd);
 
   /// The subclass needs to provide the implementation
@@ -71,6 +77,23 @@ protected:
                                 ACE_HANDLE     fd,
                                 bool&          stop) = 0;
 
+  /// Receive up to n datagrams, one per iov entry, storing the size and
+  /// source of each in lengths[i] and remote_addresses[i].  If the socket
+  /// coalesced several equal-size datagrams into iov[i], segment_sizes[i]
+  /// is set to their size, otherwise it is left at 0.  Returns the number
+  /// of iov entries filled or -1 on error.  The default receives a single
+  /// datagram using receive_bytes().
+  virtual int receive_datagrams(iovec          iov[],
+                                ssize_t        lengths[],
+                                size_t         segment_sizes[],
+                                ACE_INET_Addr  remote_addresses[],
+                                int            n,
+                                ACE_HANDLE     fd,
+                                bool&          stop);
+
+  /// Called by handle_batched_dds_input before each datagram is processed.
+  virtual void datagram_received(const ACE_INET_Addr& /*remote_address*/) {}
+
   /// Check the transport header for suitability.
   virtual bool check_header(const TH& header);
 
@@ -106,6 +129,19 @@ private:
 
   void update_buffer_index(bool& done);
 
+  int allocate_receive_buffer(size_t index);
+
+  /// Parse and deliver the datagram(s) held by receive_buffers_[index].
+  /// A non-zero segment_size splits the buffer into datagrams of that size.
+  int process_simple_dds_input(size_t index,
+                               ssize_t bytes,
+                               size_t segment_size,
+                               const ACE_INET_Addr& remote_address);
+
+  int process_datagram(ACE_Message_Block* cur_rb,
+                       ssize_t bytes_remaining,
+                       const ACE_INET_Addr& remote_address);
+
   virtual bool reassemble(ReceivedDataSample& data);
 
   /// Bytes remaining in the current DataSample.
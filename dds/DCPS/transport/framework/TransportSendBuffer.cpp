@@ -17,6 +17,8 @@
 
 #include "ace/Log_Msg.h"
 
+#include <algorithm>
+
 #include "dds/DCPS/GuidConverter.h"
 
 #ifndef __ACE_INLINE__
@@ -57,7 +59,10 @@ SingleSendBuffer::SingleSendBuffer(size_t capacity,
     retained_mb_allocator_(n_chunks_ * 2),
     retained_db_allocator_(n_chunks_ * 2),
     replaced_mb_allocator_(n_chunks_ * 2),
-    replaced_db_allocator_(n_chunks_ * 2)
+    replaced_db_allocator_(n_chunks_ * 2),
+    head_(0),
+    span_(0),
+    count_(0)
 {
 }
 
@@ -70,34 +75,37 @@ void
 SingleSendBuffer::release_all()
 {
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  for (BufferMap::iterator it = buffers_.begin();
-       it != buffers_.end();) {
-    release_i(it++);
+  while (!unlimited_.empty()) {
+    release_i(unlimited_.begin()->second);
+  }
+  for (size_t i = 0; count_ && i < ring_.size(); ++i) {
+    if (ring_[i].occupied_) {
+      release_i(ring_[i]);
+    }
   }
 }
 
 void
 SingleSendBuffer::release_acked(SequenceNumber seq) {
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  BufferMap::iterator buffer_iter = buffers_.find(seq);
-  if (buffer_iter != buffers_.end()) {
-    release_i(buffer_iter);
+  Slot* const slot = find_i(seq);
+  if (slot) {
+    release_i(*slot);
   }
 }
 
 void
 SingleSendBuffer::remove_acked(SequenceNumber seq, BufferVec& removed) {
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  BufferMap::iterator buffer_iter = buffers_.find(seq);
-  if (buffer_iter != buffers_.end()) {
-    remove_i(buffer_iter, removed);
+  Slot* const slot = find_i(seq);
+  if (slot) {
+    remove_i(*slot, removed);
   }
 }
 
 void
-SingleSendBuffer::release_i(BufferMap::iterator buffer_iter)
+SingleSendBuffer::release_buffer(BufferType& buffer)
 {
-  BufferType& buffer(buffer_iter->second);
   if (Transport_debug_level > 5) {
     ACE_DEBUG((LM_DEBUG,
       ACE_TEXT("(%P|%t) SingleSendBuffer::release() - ")
@@ -106,63 +114,175 @@ SingleSendBuffer::release_i(BufferMap::iterator buffer_iter)
     ));
   }
 
-  if (buffer.first && buffer.second) {
-    // not a fragment
-    RemoveAllVisitor visitor;
-    buffer.first->accept_remove_visitor(visitor);
-    delete buffer.first;
+  RemoveAllVisitor visitor;
+  buffer.first->accept_remove_visitor(visitor);
+  delete buffer.first;
+  buffer.first = 0;
 
-    buffer.second->release();
-    buffer.second = 0;
+  buffer.second->release();
+  buffer.second = 0;
+}
 
+void
+SingleSendBuffer::release_i(Slot& slot)
+{
+  if (slot.buffer_.first && slot.buffer_.second) {
+    // not a fragment
+    release_buffer(slot.buffer_);
   } else {
-    // data actually stored in fragments_
-    const FragmentMap::iterator fm_it = fragments_.find(buffer_iter->first);
-    if (fm_it != fragments_.end()) {
-      for (BufferMap::iterator bm_it = fm_it->second.begin();
-           bm_it != fm_it->second.end(); ++bm_it) {
-        RemoveAllVisitor visitor;
-        bm_it->second.first->accept_remove_visitor(visitor);
-        delete bm_it->second.first;
-
-        bm_it->second.second->release();
-        bm_it->second.second = 0;
-      }
-      fragments_.erase(fm_it);
+    for (FragmentVec::iterator it = slot.fragments_.begin();
+         it != slot.fragments_.end(); ++it) {
+      release_buffer(it->second);
     }
   }
+  vacate_i(slot);
+}
 
-  buffers_.erase(buffer_iter);
+void
+SingleSendBuffer::remove_i(Slot& slot, BufferVec& removed)
+{
+  if (slot.buffer_.first && slot.buffer_.second) {
+    // not a fragment
+    removed.push_back(slot.buffer_);
+  } else {
+    for (FragmentVec::iterator it = slot.fragments_.begin();
+         it != slot.fragments_.end(); ++it) {
+      removed.push_back(it->second);
+    }
+  }
+  vacate_i(slot);
 }
 
 void
-SingleSendBuffer::remove_i(BufferMap::iterator buffer_iter, BufferVec& removed)
+SingleSendBuffer::vacate_i(Slot& slot)
 {
-  BufferType& buffer(buffer_iter->second);
-  if (Transport_debug_level > 5) {
-    ACE_DEBUG((LM_DEBUG,
-      ACE_TEXT("(%P|%t) SingleSendBuffer::release() - ")
-      ACE_TEXT("releasing buffer at: (0x%@,0x%@)\n"),
-      buffer.first, buffer.second
-    ));
+  slot.buffer_.first = 0;
+  slot.buffer_.second = 0;
+  slot.fragments_.clear();
+  slot.destination_ = GUID_UNKNOWN;
+  slot.occupied_ = false;
+  --count_;
+
+  if (capacity_ == UNLIMITED) {
+    const SequenceNumber sequence = slot.sequence_;
+    unlimited_.erase(sequence);
+    if (count_) {
+      first_ = unlimited_.begin()->first;
+      span_ = static_cast<size_t>(unlimited_.rbegin()->first.getValue() - first_.getValue()) + 1;
+      return;
+    }
   }
 
-  if (buffer.first && buffer.second) {
-    // not a fragment
-    removed.push_back(buffer);
-  } else {
-    // data actually stored in fragments_
-    const FragmentMap::iterator fm_it = fragments_.find(buffer_iter->first);
-    if (fm_it != fragments_.end()) {
-      for (BufferMap::iterator bm_it = fm_it->second.begin();
-           bm_it != fm_it->second.end(); ++bm_it) {
-        removed.push_back(bm_it->second);
+  if (count_ == 0) {
+    head_ = 0;
+    span_ = 0;
+    return;
+  }
+
+  // Keep both ends of the window on occupied slots so low() and high()
+  // stay O(1).  Each slot is skipped at most once after it is vacated.
+  const size_t size = ring_.size();
+  while (!ring_[head_].occupied_) {
+    head_ = (head_ + 1) % size;
+    ++first_;
+    --span_;
+  }
+  while (!ring_[(head_ + span_ - 1) % size].occupied_) {
+    --span_;
+  }
+}
+
+void
+SingleSendBuffer::reserve_i(size_t span)
+{
+  const size_t size = ring_.size();
+  if (span <= size) {
+    return;
+  }
+  size_t new_size = size ? size : 16;
+  while (new_size < span) {
+    new_size *= 2;
+  }
+  // slot_i() keeps the window within the capacity, so the ring doesn't
+  // need to be any larger than that.
+  if (capacity_ != UNLIMITED && new_size > capacity_) {
+    new_size = (std::max)(capacity_, span);
+  }
+  Ring ring(new_size);
+  for (size_t i = 0; i < span_; ++i) {
+    std::swap(ring[i], ring_[(head_ + i) % size]);
+  }
+  ring_.swap(ring);
+  head_ = 0;
+}
+
+SingleSendBuffer::Slot*
+SingleSendBuffer::slot_i(const SequenceNumber& seq, BufferVec& removed)
+{
+  Slot* const existing = find_i(seq);
+  if (existing) {
+    return existing;
+  }
+
+  // The window from the lowest to the highest sequence number retained is
+  // at most capacity_ wide: a jump ahead ages off what falls out of it and
+  // a sequence number too far behind high() isn't retained at all.
+  if (count_ && capacity_ != UNLIMITED) {
+    const SequenceNumber::Value capacity = SequenceNumber::Value(capacity_);
+    if (seq < first_) {
+      if (high().getValue() - seq.getValue() >= capacity) {
+        return 0;
       }
-      fragments_.erase(fm_it);
+    } else {
+      while (count_ && seq.getValue() - first_.getValue() >= capacity) {
+        remove_i(ring_[head_], removed);
+      }
+    }
+  }
+
+  check_capacity_i(removed);
+
+  if (capacity_ == UNLIMITED) {
+    if (count_ == 0) {
+      span_ = 1;
+      first_ = seq;
+    } else if (seq < first_) {
+      span_ += static_cast<size_t>(first_.getValue() - seq.getValue());
+      first_ = seq;
+    } else {
+      span_ = (std::max)(span_, static_cast<size_t>(seq.getValue() - first_.getValue()) + 1);
+    }
+    Slot& slot = unlimited_[seq];
+    slot.sequence_ = seq;
+    slot.occupied_ = true;
+    ++count_;
+    return &slot;
+  }
+
+  if (count_ == 0) {
+    reserve_i(1);
+    head_ = 0;
+    span_ = 1;
+    first_ = seq;
+  } else if (seq < first_) {
+    const size_t grow = static_cast<size_t>(first_.getValue() - seq.getValue());
+    reserve_i(span_ + grow);
+    head_ = (head_ + ring_.size() - grow) % ring_.size();
+    span_ += grow;
+    first_ = seq;
+  } else {
+    const size_t offset = static_cast<size_t>(seq.getValue() - first_.getValue());
+    if (offset >= span_) {
+      reserve_i(offset + 1);
+      span_ = offset + 1;
     }
   }
 
-  buffers_.erase(buffer_iter);
+  Slot& slot = ring_[(head_ + static_cast<size_t>(seq.getValue() - first_.getValue())) % ring_.size()];
+  slot.sequence_ = seq;
+  slot.occupied_ = true;
+  ++count_;
+  return &slot;
 }
 
 void
@@ -177,40 +297,55 @@ SingleSendBuffer::retain_all(const RepoId& pub_id)
     ));
   }
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  for (BufferMap::iterator it(buffers_.begin());
-       it != buffers_.end();) {
-    if (it->second.first && it->second.second) {
+  if (capacity_ == UNLIMITED) {
+    for (SlotMap::iterator it = unlimited_.begin(); it != unlimited_.end();) {
+      // retain_slot_i() can erase the slot
+      retain_slot_i(pub_id, (it++)->second);
+    }
+    return;
+  }
+  const SequenceNumber first = first_;
+  const size_t span = span_;
+  for (size_t i = 0; count_ && i < span; ++i) {
+    Slot* const slot = find_i(first.getValue() + SequenceNumber::Value(i));
+    if (slot) {
+      retain_slot_i(pub_id, *slot);
+    }
+  }
+}
+
+void
+SingleSendBuffer::retain_slot_i(const RepoId& pub_id, Slot& slot)
+{
+  if (slot.buffer_.first && slot.buffer_.second) {
+    if (retain_buffer(pub_id, slot.buffer_) == REMOVE_ERROR) {
+      GuidConverter converter(pub_id);
+      ACE_ERROR((LM_WARNING,
+                 ACE_TEXT("(%P|%t) WARNING: ")
+                 ACE_TEXT("SingleSendBuffer::retain_all: ")
+                 ACE_TEXT("failed to retain data from publication: %C!\n"),
+                 OPENDDS_STRING(converter).c_str()));
+      release_i(slot);
+    }
+
+  } else {
+    for (FragmentVec::iterator it = slot.fragments_.begin();
+         it != slot.fragments_.end();) {
       if (retain_buffer(pub_id, it->second) == REMOVE_ERROR) {
         GuidConverter converter(pub_id);
         ACE_ERROR((LM_WARNING,
                    ACE_TEXT("(%P|%t) WARNING: ")
-                   ACE_TEXT("SingleSendBuffer::retain_all: ")
-                   ACE_TEXT("failed to retain data from publication: %C!\n"),
+                   ACE_TEXT("SingleSendBuffer::retain_all: failed to ")
+                   ACE_TEXT("retain fragment data from publication: %C!\n"),
                    OPENDDS_STRING(converter).c_str()));
-        release_i(it++);
+        release_buffer(it->second);
+        it = slot.fragments_.erase(it);
       } else {
         ++it;
       }
-
-    } else {
-      const FragmentMap::iterator fm_it = fragments_.find(it->first);
-      if (fm_it != fragments_.end()) {
-        for (BufferMap::iterator bm_it = fm_it->second.begin();
-             bm_it != fm_it->second.end();) {
-          if (retain_buffer(pub_id, bm_it->second) == REMOVE_ERROR) {
-            GuidConverter converter(pub_id);
-            ACE_ERROR((LM_WARNING,
-                       ACE_TEXT("(%P|%t) WARNING: ")
-                       ACE_TEXT("SingleSendBuffer::retain_all: failed to ")
-                       ACE_TEXT("retain fragment data from publication: %C!\n"),
-                       OPENDDS_STRING(converter).c_str()));
-            release_i(bm_it++);
-          } else {
-            ++bm_it;
-          }
-        }
-      }
-      ++it;
+    }
+    if (slot.fragments_.empty()) {
+      vacate_i(slot);
     }
   }
 }
@@ -236,9 +371,29 @@ SingleSendBuffer::insert(SequenceNumber sequence,
 {
   BufferVec removed;
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  check_capacity_i(removed);
+  Slot* const retained = slot_i(sequence, removed);
+  if (!retained) {
+    if (Transport_debug_level > 5) {
+      ACE_DEBUG((LM_DEBUG,
+        ACE_TEXT("(%P|%t) SingleSendBuffer::insert() - ")
+        ACE_TEXT("not retaining PDU: %q, it is more than the capacity ")
+        ACE_TEXT("behind %q\n"),
+        sequence.getValue(), high().getValue()
+      ));
+    }
+    return;
+  }
+  Slot& slot = *retained;
+  if (slot.buffer_.first && slot.buffer_.second) {
+    removed.push_back(slot.buffer_);
+  }
+  for (FragmentVec::iterator it = slot.fragments_.begin();
+       it != slot.fragments_.end(); ++it) {
+    removed.push_back(it->second);
+  }
+  slot.fragments_.clear();
 
-  BufferType& buffer = buffers_[sequence];
+  BufferType& buffer = slot.buffer_;
   insert_buffer(buffer, queue, chain);
 
   if (Transport_debug_level > 5) {
@@ -256,7 +411,7 @@ SingleSendBuffer::insert(SequenceNumber sequence,
     const ACE_Message_Block* msg = elt->msg();
     if (msg && subId != GUID_UNKNOWN &&
         !DataSampleHeader::test_flag(HISTORIC_SAMPLE_FLAG, msg)) {
-      destinations_[sequence] = subId;
+      slot.destination_ = subId;
     }
   }
   g.release();
@@ -297,15 +452,41 @@ SingleSendBuffer::insert_fragment(SequenceNumber sequence,
 {
   BufferVec removed;
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  check_capacity_i(removed);
 
-  // Insert into buffers_ so that the overall capacity is maintained
-  // The entry in buffers_ with two null pointers indicates that the
-  // actual data is stored in fragments_[sequence].
-  buffers_[sequence] = std::make_pair(static_cast<QueueType*>(0),
-                                      static_cast<ACE_Message_Block*>(0));
+  // The slot counts once towards the capacity no matter how many
+  // fragments it holds.  A slot with fragments has a null buffer_.
+  Slot* const retained = slot_i(sequence, removed);
+  if (!retained) {
+    if (Transport_debug_level > 5) {
+      ACE_DEBUG((LM_DEBUG,
+        ACE_TEXT("(%P|%t) SingleSendBuffer::insert_fragment() - ")
+        ACE_TEXT("not retaining PDU: %q,%q, it is more than the capacity ")
+        ACE_TEXT("behind %q\n"),
+        sequence.getValue(), fragment.getValue(), high().getValue()
+      ));
+    }
+    return;
+  }
+  Slot& slot = *retained;
+  if (slot.buffer_.first && slot.buffer_.second) {
+    removed.push_back(slot.buffer_);
+    slot.buffer_.first = 0;
+    slot.buffer_.second = 0;
+  }
 
-  BufferType& buffer = fragments_[sequence][fragment];
+  // Fragments normally arrive in order, so this is an append.
+  FragmentVec::iterator pos = slot.fragments_.end();
+  while (pos != slot.fragments_.begin() && fragment < (pos - 1)->first) {
+    --pos;
+  }
+  if (pos != slot.fragments_.begin() && (pos - 1)->first == fragment) {
+    --pos;
+    removed.push_back(pos->second);
+  } else {
+    pos = slot.fragments_.insert(pos, Fragment(fragment, BufferType()));
+  }
+
+  BufferType& buffer = pos->second;
   insert_buffer(buffer, queue, chain);
 
   if (Transport_debug_level > 5) {
@@ -332,21 +513,19 @@ SingleSendBuffer::check_capacity_i(BufferVec& removed)
     return;
   }
   // Age off oldest sample if we are at capacity:
-  if (buffers_.size() == capacity_) {
-    BufferMap::iterator it(buffers_.begin());
-    if (it == buffers_.end()) return;
+  if (count_ == capacity_) {
+    Slot& oldest = ring_[head_];
 
     if (Transport_debug_level > 5) {
       ACE_DEBUG((LM_DEBUG,
         ACE_TEXT("(%P|%t) SingleSendBuffer::check_capacity() - ")
         ACE_TEXT("aging off PDU: %q as buffer(0x%@,0x%@)\n"),
-        it->first.getValue(),
-        it->second.first, it->second.second
+        first_.getValue(),
+        oldest.buffer_.first, oldest.buffer_.second
       ));
     }
 
-    destinations_.erase(it->first);
-    remove_i(it, removed);
+    remove_i(oldest, removed);
   }
 }
 
@@ -371,18 +550,34 @@ SingleSendBuffer::resend_i(const SequenceRange& range, DisjointSequence* gaps,
   const SequenceNumber lowForAllResent = range.first == SequenceNumber() ? low() : range.first;
   const bool has_dest = destination != GUID_UNKNOWN;
 
-  for (SequenceNumber sequence(range.first);
-       sequence <= range.second; ++sequence) {
-    ACE_GUARD_RETURN(ACE_Thread_Mutex, g, mutex_, false);
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, mutex_, false);
+
+  // Only the part of the range that overlaps the ring is walked, the rest
+  // is scored against the given DisjointSequence as a whole.
+  SequenceNumber sequence(range.first);
+  if (count_ == 0 || range.second < first_ || high() < sequence) {
+    if (gaps) {
+      gaps->insert(range);
+    }
+    sequence = range.second + 1;
+  } else if (sequence < first_) {
+    if (gaps) {
+      gaps->insert(SequenceRange(sequence, first_.previous()));
+    }
+    sequence = first_;
+  }
+
+  for (; sequence <= range.second; ++sequence) {
+    if (count_ == 0 || high() < sequence) {
+      if (gaps) {
+        gaps->insert(SequenceRange(sequence, range.second));
+      }
+      break;
+    }
     // Re-send requested sample if still buffered; missing samples
     // will be scored against the given DisjointSequence:
-    BufferMap::iterator it(buffers_.find(sequence));
-    DestinationMap::iterator dest_data;
-    if (has_dest) {
-      dest_data = destinations_.find(sequence);
-    }
-    if (it == buffers_.end() || (has_dest && (dest_data == destinations_.end() ||
-                                              dest_data->second != destination))) {
+    const Slot* const slot = find_i(sequence);
+    if (!slot || (has_dest && slot->destination_ != destination)) {
       if (gaps) {
         gaps->insert(sequence);
       }
@@ -392,18 +587,15 @@ SingleSendBuffer::resend_i(const SequenceRange& range, DisjointSequence* gaps,
                    ACE_TEXT("(%P|%t) SingleSendBuffer::resend() - ")
                    ACE_TEXT("resending PDU: %q, (0x%@,0x%@)\n"),
                    sequence.getValue(),
-                   it->second.first,
-                   it->second.second));
+                   slot->buffer_.first,
+                   slot->buffer_.second));
       }
-      if (it->second.first && it->second.second) {
-        resend_one(it->second);
+      if (slot->buffer_.first && slot->buffer_.second) {
+        resend_one(slot->buffer_);
       } else {
-        const FragmentMap::iterator fm_it = fragments_.find(it->first);
-        if (fm_it != fragments_.end()) {
-          for (BufferMap::iterator bm_it = fm_it->second.begin();
-                bm_it != fm_it->second.end(); ++bm_it) {
-            resend_one(bm_it->second);
-          }
+        for (FragmentVec::const_iterator it = slot->fragments_.begin();
+             it != slot->fragments_.end(); ++it) {
+          resend_one(it->second);
         }
       }
     }
@@ -416,37 +608,26 @@ void
 SingleSendBuffer::resend_fragments_i(const SequenceNumber& seq,
                                      const DisjointSequence& requested_frags)
 {
-  if (fragments_.empty() || requested_frags.empty()) {
+  if (requested_frags.empty()) {
     return;
   }
-  const FragmentMap::const_iterator fm_it = fragments_.find(seq);
-  if (fm_it == fragments_.end()) {
+  const Slot* const slot = find_i(seq);
+  if (!slot || slot->fragments_.empty()) {
     return;
   }
-  const BufferMap& buffers = fm_it->second;
+  const FragmentVec& fragments = slot->fragments_;
   const OPENDDS_VECTOR(SequenceRange)& psr = requested_frags.present_sequence_ranges();
 
-  BufferMap::const_iterator it = buffers.lower_bound(psr.front().first);
-  BufferMap::const_iterator end = buffers.lower_bound(psr.back().second);
-  if (end != buffers.end()) {
-    ++end;
-  }
-
-  SequenceNumber frag_min;
+  // Both are sorted, walk them together
+  FragmentVec::const_iterator it = fragments.begin();
   size_t i = 0;
-
-  // Iterate over both containers simultaneously
-  while (i < psr.size() && it != end) {
-    if (psr[i].second < frag_min) {
+  while (i < psr.size() && it != fragments.end()) {
+    if (psr[i].second < it->first) {
       ++i;
     } else {
-      // Once the range max is over our fragment minimum, we either
-      // expect overlap (resend fragment) or the range is too high (skip fragment)
-      // Either way, we will increment the fragment now to avoid duplicate resends
       if (it->first >= psr[i].first) {
         resend_one(it->second); // overlap - resend fragment buffer
       }
-      frag_min = it->first + 1; // increment fragment buffer
       ++it;
     }
   }
@@ -69,6 +69,15 @@ private:
 /// Implementation of TransportSendBuffer that manages data for a single
 /// domain of SequenceNumbers -- for a given SingleSendBuffer object, the
 /// sequence numbers passed to insert() must be generated from the same place.
+///
+/// Retained data is kept in a ring of slots indexed by the offset of the
+/// sequence number from the lowest one retained, so inserting, releasing
+/// and resending a sequence number is O(1).  Sequence numbers are expected
+/// to be mostly dense and increasing; unused sequence numbers just leave an
+/// empty slot.  The ring grows as needed up to the capacity, which limits
+/// both the number of sequence numbers retained and the distance between
+/// the lowest and the highest of them.  With an UNLIMITED capacity nothing
+/// bounds that distance, so the slots are kept in a map instead.
 class OpenDDS_Dcps_Export SingleSendBuffer
   : public TransportSendBuffer, public RcObject {
 public:
@@ -77,7 +86,6 @@ public:
 
   void release_all();
   typedef OPENDDS_VECTOR(BufferType) BufferVec;
-  typedef OPENDDS_MAP(SequenceNumber, BufferType) BufferMap;
   void release_acked(SequenceNumber seq);
   void remove_acked(SequenceNumber seq, BufferVec& removed);
   size_t n_chunks() const;
@@ -110,9 +118,40 @@ public:
                        ACE_Message_Block* chain);
 
 private:
+  typedef std::pair<SequenceNumber, BufferType> Fragment;
+  typedef OPENDDS_VECTOR(Fragment) FragmentVec;
+
+  /// A retained sequence number: either one buffer or, if it was sent in
+  /// fragments, the buffers of its fragments ordered by fragment number.
+  struct Slot {
+    Slot()
+      : buffer_(static_cast<QueueType*>(0), static_cast<ACE_Message_Block*>(0))
+      , destination_()
+      , occupied_(false)
+    {}
+
+    BufferType buffer_;
+    FragmentVec fragments_;
+    /// Only reader the sample was sent to, or GUID_UNKNOWN.
+    RepoId destination_;
+    SequenceNumber sequence_;
+    bool occupied_;
+  };
+  typedef OPENDDS_VECTOR(Slot) Ring;
+  typedef OPENDDS_MAP(SequenceNumber, Slot) SlotMap;
+
+  const Slot* find_i(const SequenceNumber& seq) const;
+  Slot* find_i(const SequenceNumber& seq);
+  /// Null if seq is too far behind high() to be retained
+  Slot* slot_i(const SequenceNumber& seq, BufferVec& removed);
+  void reserve_i(size_t span);
+  void vacate_i(Slot& slot);
+  void retain_slot_i(const RepoId& pub_id, Slot& slot);
+
   void check_capacity_i(BufferVec& removed);
-  void release_i(BufferMap::iterator buffer_iter);
-  void remove_i(BufferMap::iterator buffer_iter, BufferVec& removed);
+  void release_i(Slot& slot);
+  void remove_i(Slot& slot, BufferVec& removed);
+  static void release_buffer(BufferType& buffer);
 
   RemoveResult retain_buffer(const RepoId& pub_id, BufferType& buffer);
   void insert_buffer(BufferType& buffer,
@@ -126,13 +165,17 @@ private:
   MessageBlockAllocator replaced_mb_allocator_;
   DataBlockAllocator replaced_db_allocator_;
 
-  BufferMap buffers_;
-
-  typedef OPENDDS_MAP(SequenceNumber, BufferMap) FragmentMap;
-  FragmentMap fragments_;
-
-  typedef OPENDDS_MAP(SequenceNumber, RepoId) DestinationMap;
-  DestinationMap destinations_;
+  /// ring_[head_] holds first_, the lowest sequence number retained, and
+  /// the following span_ - 1 slots (modulo the ring size) hold the rest up
+  /// to high().  count_ is the number of occupied slots.
+  Ring ring_;
+  /// Used instead of ring_ if the capacity is UNLIMITED, holds only the
+  /// occupied slots.  first_, span_ and count_ have the same meaning.
+  SlotMap unlimited_;
+  size_t head_;
+  size_t span_;
+  size_t count_;
+  SequenceNumber first_;
 
   ACE_Thread_Mutex mutex_;
 };
@@ -34,27 +34,51 @@ SingleSendBuffer::n_chunks() const
 ACE_INLINE SequenceNumber
 SingleSendBuffer::low() const
 {
-  if (this->buffers_.empty()) throw std::exception();
-  return this->buffers_.begin()->first;
+  if (this->count_ == 0) throw std::exception();
+  return this->first_;
 }
 
 ACE_INLINE SequenceNumber
 SingleSendBuffer::high() const
 {
-  if (this->buffers_.empty()) throw std::exception();
-  return this->buffers_.rbegin()->first;
+  if (this->count_ == 0) throw std::exception();
+  return this->first_.getValue() + SequenceNumber::Value(this->span_ - 1);
 }
 
 ACE_INLINE bool
 SingleSendBuffer::empty() const
 {
-  return this->buffers_.empty();
+  return this->count_ == 0;
 }
 
 ACE_INLINE bool
 SingleSendBuffer::contains(const SequenceNumber& seq) const
 {
-  return this->buffers_.count(seq);
+  return this->find_i(seq) != 0;
+}
+
+ACE_INLINE const SingleSendBuffer::Slot*
+SingleSendBuffer::find_i(const SequenceNumber& seq) const
+{
+  if (this->count_ == 0 || seq < this->first_) {
+    return 0;
+  }
+  const size_t offset = static_cast<size_t>(seq.getValue() - this->first_.getValue());
+  if (offset >= this->span_) {
+    return 0;
+  }
+  if (this->capacity_ == UNLIMITED) {
+    const SlotMap::const_iterator it = this->unlimited_.find(seq);
+    return it == this->unlimited_.end() ? 0 : &it->second;
+  }
+  const Slot& slot = this->ring_[(this->head_ + offset) % this->ring_.size()];
+  return slot.occupied_ ? &slot : 0;
+}
+
+ACE_INLINE SingleSendBuffer::Slot*
+SingleSendBuffer::find_i(const SequenceNumber& seq)
+{
+  return const_cast<Slot*>(static_cast<const SingleSendBuffer*>(this)->find_i(seq));
 }
 
 } // namespace DCPS
@@ -235,6 +235,7 @@ TransportSendStrategy::perform_work()
     // matter.  Just attempt to send as many of the "unsent" bytes in the
     // packet as possible.
     outcome = this->send_packet();
+    this->flush_coalesced_i();
 
     // If we sent the whole packet (eg, partial_send is false), and the queue_
     // is now empty, then we've cleared the backpressure situation.
@@ -1043,6 +1044,7 @@ TransportSendStrategy::send(TransportQueueElement* element, bool relink)
                     "Queue elem and leave.\n"), 5);
           this->queue_.put(element);
           this->synch_->work_available();
+          this->flush_coalesced_i();
 
           return;
         }
@@ -1171,6 +1173,8 @@ TransportSendStrategy::send(TransportQueueElement* element, bool relink)
           }
         }
       }
+
+      this->flush_coalesced_i();
     }
   }
 
@@ -1250,6 +1254,7 @@ TransportSendStrategy::send_stop(RepoId /*repoId*/)
             "it (directly) now.\n"));
       // If a relink needs to be done for this packet to be sent, do it.
       this->direct_send(true);
+      this->flush_coalesced_i();
       VDBG((LM_DEBUG, "(%P|%t) DBG:   "
             "Back from the attempt to send leftover packet directly.\n"));
 
@@ -165,6 +165,11 @@ protected:
 
   virtual ssize_t send_bytes_i(const iovec iov[], int n) = 0;
 
+  /// Called with the send lock held after send(), send_stop() or
+  /// perform_work() has passed its packets to send_bytes_i().  Subclasses
+  /// that hold back datagrams in order to coalesce them send them here.
+  virtual void flush_coalesced_i() {}
+
   /// Specific implementation processing of prepared packet header.
   virtual void prepare_header_i();
 
@@ -417,7 +417,7 @@ ReliableSession::send_naks()
   }
 
   // Take a copy to facilitate temporary suppression:
-  DisjointSequence received(this->nak_sequence_);
+  BitmapDisjointSequence received(this->nak_sequence_);
   if (DCPS_debug_level > 0) {
     received.dump();
   }
@@ -571,7 +571,7 @@ ReliableSession::nak_received(const Message_Block_Ptr& control)
 }
 
 void
-ReliableSession::send_naks(DisjointSequence& received)
+ReliableSession::send_naks(BitmapDisjointSequence& received)
 {
   const std::vector<SequenceRange> ranges(received.missing_sequence_ranges());
 
@@ -15,7 +15,7 @@
 
 #include "ace/Synch_Traits.h"
 
-#include "dds/DCPS/DisjointSequence.h"
+#include "dds/DCPS/BitmapDisjointSequence.h"
 #include "dds/DCPS/PoolAllocator.h"
 #include "dds/DCPS/RcEventHandler.h"
 
@@ -69,7 +69,7 @@ public:
   void send_naks();
 
   void nak_received(const Message_Block_Ptr& control);
-  void send_naks(DisjointSequence& found);
+  void send_naks(BitmapDisjointSequence& found);
 
   void nakack_received(const Message_Block_Ptr& control);
   virtual void send_nakack(SequenceNumber low);
@@ -83,7 +83,7 @@ public:
 private:
   RcHandle<NakWatchdog> nak_watchdog_;
 
-  DisjointSequence nak_sequence_;
+  BitmapDisjointSequence nak_sequence_;
 
   typedef OPENDDS_MAP(MonotonicTimePoint, SequenceNumber) NakRequestMap;
   NakRequestMap nak_requests_;
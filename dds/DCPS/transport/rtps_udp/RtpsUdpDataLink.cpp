@@ -34,7 +34,10 @@
 #include "ace/Default_Constants.h"
 #include "ace/Log_Msg.h"
 #include "ace/Message_Block.h"
+#include "ace/OS_NS_sys_socket.h"
+#include "ace/OS_NS_Thread.h"
 #include "ace/Reactor.h"
+#include "ace/Thread.h"
 
 #include <string.h>
 
@@ -91,6 +94,10 @@ namespace DCPS {
 
 const size_t ONE_SAMPLE_PER_PACKET = 1;
 
+/// Resolution of the heartbeat and acknack timing wheels, as a fraction
+/// of the period they are driven by.
+const double WHEEL_TICKS_PER_PERIOD = 16;
+
 RtpsUdpDataLink::RtpsUdpDataLink(RtpsUdpTransport& transport,
                                  const GuidPrefix_t& local_prefix,
                                  const RtpsUdpInst& config,
@@ -109,11 +116,14 @@ RtpsUdpDataLink::RtpsUdpDataLink(RtpsUdpTransport& transport,
   , heartbeat_reply_(reactor_task->interceptor(), config.heartbeat_period_, *this, &RtpsUdpDataLink::send_heartbeat_replies)
   , heartbeatchecker_(reactor_task->interceptor(), *this, &RtpsUdpDataLink::check_heartbeats)
   , relay_beacon_(reactor_task->interceptor(), *this, &RtpsUdpDataLink::send_relay_beacon)
+  , heartbeat_wheel_(config.heartbeat_period_ * (1.0 / WHEEL_TICKS_PER_PERIOD))
+  , acknack_wheel_(config.heartbeat_response_delay_ * (1.0 / WHEEL_TICKS_PER_PERIOD))
   , held_data_delivery_handler_(this)
   , max_bundle_size_(config.max_bundle_size_)
   , quick_heartbeat_delay_(config.heartbeat_period_ * config.quick_reply_ratio_)
   , normal_heartbeat_response_delay_(config.heartbeat_response_delay_)
   , quick_heartbeat_response_delay_(config.heartbeat_response_delay_ * config.quick_reply_ratio_)
+  , adaptive_heartbeat_(config.adaptive_heartbeat_)
 #ifdef OPENDDS_SECURITY
   , security_config_(Security::SecurityRegistry::instance()->default_config())
   , local_crypto_handle_(DDS::HANDLE_NIL)
@@ -133,7 +143,7 @@ RtpsUdpDataLink::config() const
 bool
 RtpsUdpDataLink::add_delayed_notification(TransportQueueElement* element)
 {
-  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, writers_lock_, false);
+  ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, g, writers_index_lock_, false);
   RtpsWriter_rch writer;
   RtpsWriterMap::iterator iter = writers_.find(element->publication_id());
   if (iter != writers_.end()) {
@@ -154,7 +164,7 @@ RtpsUdpDataLink::remove_sample(const DataSampleElement* sample)
 {
   RepoId pub_id = sample->get_pub_id();
 
-  ACE_Guard<ACE_Thread_Mutex> g(writers_lock_);
+  ACE_Read_Guard<ACE_RW_Thread_Mutex> g(writers_index_lock_);
   RtpsWriter_rch writer;
   RtpsWriterMap::iterator iter = writers_.find(pub_id);
   if (iter != writers_.end()) {
@@ -171,7 +181,7 @@ RtpsUdpDataLink::remove_sample(const DataSampleElement* sample)
 
 void RtpsUdpDataLink::remove_all_msgs(const RepoId& pub_id)
 {
-  ACE_Guard<ACE_Thread_Mutex> g(writers_lock_);
+  ACE_Read_Guard<ACE_RW_Thread_Mutex> g(writers_index_lock_);
   RtpsWriter_rch writer;
   RtpsWriterMap::iterator iter = writers_.find(pub_id);
   if (iter != writers_.end()) {
@@ -285,6 +295,7 @@ RtpsUdpDataLink::open(const ACE_SOCK_Dgram& unicast_socket
 #ifdef ACE_HAS_IPV6
                       , const ACE_SOCK_Dgram& ipv6_unicast_socket
 #endif
+                      , const ACE_SOCK_Dgram& receive_shard_socket
                       )
 {
   unicast_socket_ = unicast_socket;
@@ -393,6 +404,15 @@ RtpsUdpDataLink::open(const ACE_SOCK_Dgram& unicast_socket
                      false);
   }
 
+  if (receive_shard_socket.get_handle() != ACE_INVALID_HANDLE
+      && !open_receive_shards(receive_shard_socket)) {
+    stop_i();
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: ")
+                      ACE_TEXT("RtpsUdpDataLink::open: failed to open receive shards\n")),
+                     false);
+  }
+
   if (cfg.rtps_relay_address() != ACE_INET_Addr() ||
       cfg.use_rtps_relay_) {
     relay_beacon_.enable(false, cfg.rtps_relay_beacon_period_);
@@ -411,6 +431,135 @@ RtpsUdpDataLink::open(const ACE_SOCK_Dgram& unicast_socket
   return true;
 }
 
+bool
+RtpsUdpDataLink::sharded_receive(const RtpsUdpInst& config)
+{
+#ifdef OPENDDS_RTPS_UDP_HAS_REUSEPORT
+  // ICE demultiplexes STUN on the transport's own unicast socket.
+  return config.receive_threads_ > 1 && !config.use_ice_;
+#else
+  ACE_UNUSED_ARG(config);
+  return false;
+#endif
+}
+
+bool
+RtpsUdpDataLink::open_unicast_socket(ACE_SOCK_Dgram& socket,
+                                     const ACE_INET_Addr& address,
+                                     int protocol_family,
+                                     bool reuse_port)
+{
+#ifdef OPENDDS_RTPS_UDP_HAS_REUSEPORT
+  if (reuse_port) {
+    // ACE_SOCK_Dgram::open binds right away, but SO_REUSEPORT only
+    // applies to sockets that have it set before they are bound.
+    const ACE_HANDLE handle = ACE_OS::socket(protocol_family, SOCK_DGRAM, 0);
+    if (handle == ACE_INVALID_HANDLE) {
+      return false;
+    }
+    socket.set_handle(handle);
+
+    int enable = 1;
+    if (socket.set_option(SOL_SOCKET, SO_REUSEPORT, &enable, sizeof enable) == -1
+        || ACE_OS::bind(handle, static_cast<sockaddr*>(address.get_addr()),
+                        address.get_size()) == -1) {
+      socket.close();
+      return false;
+    }
+    return true;
+  }
+#else
+  ACE_UNUSED_ARG(reuse_port);
+#endif
+  return socket.open(address, protocol_family) == 0;
+}
+
+bool
+RtpsUdpDataLink::open_receive_shards(const ACE_SOCK_Dgram& first_socket)
+{
+  RtpsUdpInst& cfg = config();
+
+  ACE_INET_Addr address;
+  if (first_socket.get_local_addr(address) != 0) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: RtpsUdpDataLink::open_receive_shards: ")
+                      ACE_TEXT("get_local_addr %m\n")),
+                     false);
+  }
+
+  // The transport bound the first socket to reserve the port, the primary
+  // receive strategy on reactor_task_ reads the link's other sockets.
+  receive_shards_.resize(cfg.receive_threads_);
+  receive_shards_.front().socket_ = first_socket;
+  for (ReceiveShards::iterator shard = receive_shards_.begin();
+       shard != receive_shards_.end(); ++shard) {
+    if (shard != receive_shards_.begin()
+        && !open_unicast_socket(shard->socket_, address, PF_INET, true)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: RtpsUdpDataLink::open_receive_shards: ")
+                        ACE_TEXT("failed to open socket %m\n")),
+                       false);
+    }
+
+#ifdef ACE_RECVPKTINFO
+    int sockopt = 1;
+    if (shard->socket_.set_option(IPPROTO_IP, ACE_RECVPKTINFO, &sockopt, sizeof sockopt) == -1) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: RtpsUdpDataLink::open_receive_shards: ")
+                        ACE_TEXT("set_option %m\n")),
+                       false);
+    }
+#endif
+
+    if (cfg.rcv_buffer_size_ > 0) {
+      int rcv_size = cfg.rcv_buffer_size_;
+      if (shard->socket_.set_option(SOL_SOCKET, SO_RCVBUF, &rcv_size, sizeof rcv_size) < 0
+          && errno != ENOTSUP) {
+        ACE_ERROR_RETURN((LM_ERROR,
+                          ACE_TEXT("(%P|%t) ERROR: RtpsUdpDataLink::open_receive_shards: ")
+                          ACE_TEXT("failed to set the receive buffer size to %d errno %m\n"),
+                          rcv_size),
+                         false);
+      }
+    }
+
+    shard->reactor_task_ = make_rch<ReactorTask>(false);
+    if (shard->reactor_task_->open(0) != 0) {
+      return false; // error already logged by ReactorTask::open()
+    }
+
+    shard->strategy_ = make_rch<RtpsUdpReceiveStrategy>(this, local_prefix_,
+                                                        shard->socket_.get_handle(),
+                                                        shard->reactor_task_->get_reactor());
+    if (shard->strategy_->start() != 0) {
+      return false;
+    }
+  }
+
+  if (Transport_debug_level > 0) {
+    ACE_DEBUG((LM_DEBUG,
+               ACE_TEXT("(%P|%t) RtpsUdpDataLink::open_receive_shards: ")
+               ACE_TEXT("receiving on %B sockets\n"),
+               receive_shards_.size()));
+  }
+  return true;
+}
+
+void
+RtpsUdpDataLink::stop_receive_shards()
+{
+  for (ReceiveShards::iterator shard = receive_shards_.begin();
+       shard != receive_shards_.end(); ++shard) {
+    if (shard->strategy_) {
+      shard->strategy_->stop();
+    }
+    if (shard->reactor_task_) {
+      shard->reactor_task_->stop();
+    }
+    shard->socket_.close();
+  }
+}
+
 void
 RtpsUdpDataLink::add_address(const DCPS::NetworkInterface& nic,
                              const ACE_INET_Addr&)
@@ -580,14 +729,14 @@ RtpsUdpDataLink::make_reservation(const RepoId& rpi,
                                   const TransportReceiveListener_wrch& trl,
                                   bool reliable)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(readers_lock_);
   if (reliable) {
+    ACE_Guard<ACE_Thread_Mutex> guard(readers_lock_);
     RtpsReaderMap::iterator rr = readers_.find(lsi);
     if (rr == readers_.end()) {
+      ACE_Write_Guard<ACE_RW_Thread_Mutex> index_guard(readers_index_lock_);
       pending_reliable_readers_.insert(lsi);
     }
   }
-  guard.release();
   return DataLink::make_reservation(rpi, lsi, trl, reliable);
 }
 
@@ -611,7 +760,6 @@ RtpsUdpDataLink::associated(const RepoId& local_id, const RepoId& remote_id,
     return;
   }
 
-  bool enable_heartbeat = false;
   bool enable_replies = false;
 
   if (conv.isWriter()) {
@@ -629,10 +777,10 @@ RtpsUdpDataLink::associated(const RepoId& local_id, const RepoId& remote_id,
         }
         RtpsWriter_rch writer = make_rch<RtpsWriter>(link, local_id, local_durable,
                                                      hb_start, multi_buff_.capacity());
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, wg, writers_index_lock_);
         rw = writers_.insert(RtpsWriterMap::value_type(local_id, writer)).first;
       }
       RtpsWriter_rch writer = rw->second;
-      enable_heartbeat = true;
       g.release();
       writer->add_reader(remote_id, ReaderInfo(remote_durable));
     } else {
@@ -642,20 +790,27 @@ RtpsUdpDataLink::associated(const RepoId& local_id, const RepoId& remote_id,
     {
       GuardType guard(strategy_lock_);
       if (receive_strategy()) {
-        receive_strategy()->clear_completed_fragments(remote_id);
+        clear_completed_fragments(remote_id);
       }
     }
     if (remote_reliable) {
       ACE_GUARD(ACE_Thread_Mutex, g, readers_lock_);
       RtpsReaderMap::iterator rr = readers_.find(local_id);
+      RtpsReader_rch reader;
       if (rr == readers_.end()) {
-        pending_reliable_readers_.erase(local_id);
         RtpsUdpDataLink_rch link(this, OpenDDS::DCPS::inc_count());
-        RtpsReader_rch reader = make_rch<RtpsReader>(link, local_id, local_durable);
-        rr = readers_.insert(RtpsReaderMap::value_type(local_id, reader)).first;
+        reader = make_rch<RtpsReader>(link, local_id, local_durable);
+      } else {
+        reader = rr->second;
+      }
+      {
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, wg, readers_index_lock_);
+        if (rr == readers_.end()) {
+          pending_reliable_readers_.erase(local_id);
+          readers_.insert(RtpsReaderMap::value_type(local_id, reader));
+        }
+        readers_of_writer_.insert(RtpsReaderMultiMap::value_type(remote_id, reader));
       }
-      RtpsReader_rch reader = rr->second;
-      readers_of_writer_.insert(RtpsReaderMultiMap::value_type(remote_id, rr->second));
       enable_replies = true;
       g.release();
       reader->add_writer(remote_id, WriterInfo());
@@ -664,11 +819,8 @@ RtpsUdpDataLink::associated(const RepoId& local_id, const RepoId& remote_id,
     }
   }
 
-  if (enable_heartbeat) {
-    heartbeat_.enable(quick_heartbeat_delay_);
-  }
   if (enable_replies) {
-    heartbeat_reply_.enable(normal_heartbeat_response_delay_);
+    schedule_acknack(local_id, normal_heartbeat_response_delay_);
   }
 }
 
@@ -680,7 +832,7 @@ RtpsUdpDataLink::check_handshake_complete(const RepoId& local_id,
   if (conv.isWriter()) {
     RtpsWriter_rch writer;
     {
-      ACE_Guard<ACE_Thread_Mutex> guard(writers_lock_);
+      ACE_Read_Guard<ACE_RW_Thread_Mutex> guard(writers_index_lock_);
       RtpsWriterMap::iterator rw = writers_.find(local_id);
       if (rw == writers_.end()) {
         return true; // not reliable, no handshaking
@@ -691,7 +843,7 @@ RtpsUdpDataLink::check_handshake_complete(const RepoId& local_id,
   } else if (conv.isReader()) {
     RtpsReader_rch reader;
     {
-      ACE_Guard<ACE_Thread_Mutex> guard(readers_lock_);
+      ACE_Read_Guard<ACE_RW_Thread_Mutex> guard(readers_index_lock_);
       RtpsReaderMap::iterator rr = readers_.find(local_id);
       if (rr == readers_.end()) {
         return true; // not reliable, no handshaking
@@ -781,12 +933,22 @@ void RtpsUdpDataLink::client_stop(const RepoId& localId)
   const GuidConverter conv(localId);
 
   if (conv.isReader()) {
-    ACE_GUARD(ACE_Thread_Mutex, gr, readers_lock_);
-    readers_.erase(localId);
+    {
+      ACE_GUARD(ACE_Thread_Mutex, gr, readers_lock_);
+      ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, wg, readers_index_lock_);
+      readers_.erase(localId);
+    }
+    ACE_GUARD(ACE_Thread_Mutex, g, wheels_lock_);
+    acknack_wheel_.cancel(localId);
 
   } else {
-    ACE_GUARD(ACE_Thread_Mutex, gw, writers_lock_);
-    writers_.erase(localId);
+    {
+      ACE_GUARD(ACE_Thread_Mutex, gw, writers_lock_);
+      ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, wg, writers_index_lock_);
+      writers_.erase(localId);
+    }
+    ACE_GUARD(ACE_Thread_Mutex, g, wheels_lock_);
+    heartbeat_wheel_.cancel(localId);
   }
 }
 
@@ -824,14 +986,20 @@ RtpsUdpDataLink::pre_stop_i()
   {
     ACE_GUARD(ACE_Thread_Mutex, g, writers_lock_);
 
-    RtpsWriterMap::iterator iter = writers_.begin();
-    while (iter != writers_.end()) {
-      RtpsWriter_rch writer = iter->second;
-      writer->pre_stop_helper(to_drop);
-      RtpsWriterMap::iterator last = iter;
-      ++iter;
-      heartbeat_counts_.erase(last->first);
-      writers_.erase(last);
+    RtpsWriterMap writers;
+    {
+      ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, wg, writers_index_lock_);
+      writers.swap(writers_);
+    }
+
+    for (RtpsWriterMap::iterator iter = writers.begin(); iter != writers.end(); ++iter) {
+      iter->second->pre_stop_helper(to_drop);
+      heartbeat_counts_.erase(iter->first);
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, gw, wheels_lock_);
+    for (RtpsWriterMap::iterator iter = writers.begin(); iter != writers.end(); ++iter) {
+      heartbeat_wheel_.cancel(iter->first);
     }
   }
   typedef OPENDDS_VECTOR(TransportQueueElement*)::iterator tqe_iter;
@@ -841,13 +1009,14 @@ RtpsUdpDataLink::pre_stop_i()
     ++drop_it;
   }
   {
-    ACE_GUARD(ACE_Thread_Mutex, g, readers_lock_);
+    RtpsReaderMap readers;
+    {
+      ACE_READ_GUARD(ACE_RW_Thread_Mutex, g, readers_index_lock_);
+      readers = readers_;
+    }
 
-    RtpsReaderMap::iterator iter = readers_.begin();
-    while (iter != readers_.end()) {
-      RtpsReader_rch reader = iter->second;
-      reader->pre_stop_helper();
-      ++iter;
+    for (RtpsReaderMap::iterator iter = readers.begin(); iter != readers.end(); ++iter) {
+      iter->second->pre_stop_helper();
     }
   }
 }
@@ -860,7 +1029,7 @@ RtpsUdpDataLink::release_reservations_i(const RepoId& remote_id,
   using std::pair;
   const GuidConverter conv(local_id);
   if (conv.isWriter()) {
-    ACE_GUARD(ACE_Thread_Mutex, g, writers_lock_);
+    ACE_Read_Guard<ACE_RW_Thread_Mutex> g(writers_index_lock_);
     RtpsWriterMap::iterator rw = writers_.find(local_id);
 
     if (rw != writers_.end()) {
@@ -878,6 +1047,7 @@ RtpsUdpDataLink::release_reservations_i(const RepoId& remote_id,
     RtpsReaderMap::iterator rr = readers_.find(local_id);
 
     if (rr != readers_.end()) {
+      ACE_Write_Guard<ACE_RW_Thread_Mutex> wg(readers_index_lock_);
       for (pair<RtpsReaderMultiMap::iterator, RtpsReaderMultiMap::iterator> iters =
              readers_of_writer_.equal_range(remote_id);
            iters.first != iters.second;) {
@@ -887,6 +1057,7 @@ RtpsUdpDataLink::release_reservations_i(const RepoId& remote_id,
           ++iters.first;
         }
       }
+      wg.release();
 
       RtpsReader_rch reader = rr->second;
       g.release();
@@ -926,6 +1097,7 @@ RtpsUdpDataLink::stop_i()
   heartbeat_.disable_and_wait();
   heartbeatchecker_.disable_and_wait();
   relay_beacon_.disable_and_wait();
+  stop_receive_shards();
   unicast_socket_.close();
   multicast_socket_.close();
 #ifdef ACE_HAS_IPV6
@@ -938,7 +1110,7 @@ RcHandle<SingleSendBuffer>
 RtpsUdpDataLink::get_writer_send_buffer(const RepoId& pub_id)
 {
   RcHandle<SingleSendBuffer> result;
-  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, writers_lock_, result);
+  ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, g, writers_index_lock_, result);
 
   const RtpsWriterMap::iterator wi = writers_.find(pub_id);
   if (wi != writers_.end()) {
@@ -1034,6 +1206,8 @@ RtpsUdpDataLink::RtpsWriter::customize_queue_element_helper(
     return 0;
   }
 
+  heartbeat_needed_i(*link, false);
+
   bool gap_ok = true;
   DestToEntityMap gap_receivers;
   if (!remote_readers_.empty()) {
@@ -1247,20 +1421,24 @@ RtpsUdpDataLink::customize_queue_element(TransportQueueElement* element)
   const RepoId pub_id = element->publication_id();
   GUIDSeq_var peers = peer_ids(pub_id);
 
-  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, writers_lock_, 0);
+  const bool require_iq = requires_inline_qos(peers);
 
-  bool require_iq = requires_inline_qos(peers);
+  RtpsWriter_rch writer;
+  {
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, g, writers_index_lock_, 0);
+    const RtpsWriterMap::iterator rw = writers_.find(pub_id);
+    if (rw != writers_.end()) {
+      writer = rw->second;
+    }
+  }
 
-  const RtpsWriterMap::iterator rw = writers_.find(pub_id);
   MetaSubmessageVec meta_submessages;
-  RtpsWriter_rch writer;
   TransportQueueElement* result;
   bool deliver_after_send = false;
-  if (rw != writers_.end()) {
-    writer = rw->second;
-    guard.release();
+  if (writer) {
     result = writer->customize_queue_element_helper(element, require_iq, meta_submessages, deliver_after_send);
   } else {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, writers_lock_, 0);
     result = customize_queue_element_non_reliable_i(element, require_iq, meta_submessages, deliver_after_send, guard);
     guard.release();
   }
@@ -1318,7 +1496,7 @@ RtpsUdpDataLink::RtpsWriter::end_historic_samples_i(const DataSampleHeader& head
     // which already holds a RCH to the datalink... this is just to avoid adding another parameter to pass it
     RtpsUdpDataLink_rch link = link_.lock();
     if (link) {
-      link->heartbeat_.enable(link->quick_heartbeat_delay_);
+      heartbeat_needed_i(*link, true);
     }
   }
 }
@@ -1332,6 +1510,7 @@ bool RtpsUdpDataLink::requires_inline_qos(const GUIDSeq_var& peers)
     if (!peers.ptr()) {
       return false;
     }
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, g, locators_lock_, false);
     for (CORBA::ULong i = 0; i < peers->length(); ++i) {
       const RemoteInfoMap::const_iterator iter = locators_.find(peers[i]);
       if (iter != locators_.end() && iter->second.requires_inline_qos_) {
@@ -1444,7 +1623,7 @@ RtpsUdpDataLink::received(const RTPS::DataSubmessage& data,
 
   OPENDDS_VECTOR(RtpsReader_rch) to_call;
   {
-    ACE_GUARD(ACE_Thread_Mutex, g, readers_lock_);
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, g, readers_index_lock_);
     if (local.entityId == ENTITYID_UNKNOWN) {
       typedef std::pair<RtpsReaderMultiMap::iterator, RtpsReaderMultiMap::iterator> RRMM_IterRange;
       for (RRMM_IterRange iters = readers_of_writer_.equal_range(src); iters.first != iters.second; ++iters.first) {
@@ -1906,7 +2085,7 @@ RtpsUdpDataLink::RtpsReader::process_heartbeat_i(const RTPS::HeartBeatSubmessage
     if (!durable_) {
       if (wi_first < hb_first) {
         info.recvd_.insert(SequenceRange(wi_first, hb_first.previous()));
-        link->receive_strategy()->remove_fragments(SequenceRange(wi_first, hb_first.previous()), wi->first);
+        link->remove_fragments(SequenceRange(wi_first, hb_first.previous()), wi->first);
         wi_first = hb_first;
         link->deliver_held_data(id_, info, durable_);
       }
@@ -1922,11 +2101,11 @@ RtpsUdpDataLink::RtpsReader::process_heartbeat_i(const RTPS::HeartBeatSubmessage
   bool result = false;
   if (!is_final || (!liveliness && (info.should_nack() ||
       should_nack_durable(info) ||
-      link->receive_strategy()->has_fragments(info.hb_range_, wi->first)))) {
+      link->has_fragments(info.hb_range_, wi->first)))) {
     info.ack_pending_ = true;
 
     if (immediate_reply) {
-      link->heartbeat_reply_.enable(link->quick_heartbeat_response_delay_);
+      link->schedule_acknack(id_, link->quick_heartbeat_response_delay_);
     } else {
       result = true; // timer will invoke send_heartbeat_replies()
     }
@@ -1962,6 +2141,10 @@ RtpsUdpDataLink::RtpsWriter::add_reader(const RepoId& id, const ReaderInfo& info
   ReaderInfoMap::const_iterator iter = remote_readers_.find(id);
   if (iter == remote_readers_.end()) {
     remote_readers_.insert(ReaderInfoMap::value_type(id, info));
+    RtpsUdpDataLink_rch link = link_.lock();
+    if (link) {
+      heartbeat_needed_i(*link, true);
+    }
     return true;
   }
   return false;
@@ -2057,14 +2240,14 @@ RtpsUdpDataLink::RtpsReader::should_nack_durable(const WriterInfo& info)
   return durable_ && (info.recvd_.empty() || info.recvd_.low() > info.hb_range_.first);
 }
 
-void
+bool
 RtpsUdpDataLink::RtpsReader::gather_ack_nacks(MetaSubmessageVec& meta_submessages, bool finalFlag)
 {
-  ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
-  gather_ack_nacks_i(meta_submessages, finalFlag);
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, mutex_, false);
+  return gather_ack_nacks_i(meta_submessages, finalFlag);
 }
 
-void
+bool
 RtpsUdpDataLink::RtpsReader::gather_ack_nacks_i(MetaSubmessageVec& meta_submessages, bool finalFlag)
 {
   using namespace OpenDDS::RTPS;
@@ -2072,21 +2255,23 @@ RtpsUdpDataLink::RtpsReader::gather_ack_nacks_i(MetaSubmessageVec& meta_submessa
   RtpsUdpDataLink_rch link = link_.lock();
 
   if (!link) {
-    return;
+    return false;
   }
 
   GuardType guard(link->strategy_lock_);
   if (link->receive_strategy() == 0) {
-    return;
+    return false;
   }
 
+  bool any_nack = false;
   for (WriterInfoMap::iterator wi = remote_writers_.begin(); wi != remote_writers_.end(); ++wi) {
 
     // if we have some negative acknowledgments, we'll ask for a reply
-    DisjointSequence& recvd = wi->second.recvd_;
+    BitmapDisjointSequence& recvd = wi->second.recvd_;
     const bool nack = wi->second.should_nack() ||
       should_nack_durable(wi->second);
     bool is_final = finalFlag || !nack;
+    any_nack |= nack;
 
     if (wi->second.ack_pending_ || nack || finalFlag) {
       wi->second.ack_pending_ = false;
@@ -2135,7 +2320,7 @@ RtpsUdpDataLink::RtpsReader::gather_ack_nacks_i(MetaSubmessageVec& meta_submessa
       // not be "nacked" in the ACKNACK reply.  They will be accounted for
       // in the NACK_FRAG(s) instead.
       bool frags_modified =
-        link->receive_strategy()->remove_frags_from_bitmap(bitmap.get_buffer(),
+        link->remove_frags_from_bitmap(bitmap.get_buffer(),
                                                  num_bits, ack, wi->first);
       if (frags_modified && !is_final) { // change to is_final if bitmap is empty
         is_final = true;
@@ -2184,6 +2369,7 @@ RtpsUdpDataLink::RtpsReader::gather_ack_nacks_i(MetaSubmessageVec& meta_submessa
       }
     }
   }
+  return any_nack;
 }
 
 #ifdef OPENDDS_SECURITY
@@ -2435,7 +2621,14 @@ RtpsUdpDataLink::send_heartbeat_replies(const DCPS::MonotonicTimePoint& /*now*/)
   using namespace OpenDDS::RTPS;
 
   MetaSubmessageVec meta_submessages;
-  RtpsReaderMap readers;
+  OPENDDS_VECTOR(RtpsReader_rch) readers;
+
+  const MonotonicTimePoint now = MonotonicTimePoint::now();
+  EndpointWheel::KeyVec due;
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, wheels_lock_);
+    acknack_wheel_.expire(now + acknack_wheel_.resolution(), due);
+  }
 
   {
     ACE_GUARD(ACE_Thread_Mutex, g, readers_lock_);
@@ -2469,11 +2662,19 @@ RtpsUdpDataLink::send_heartbeat_replies(const DCPS::MonotonicTimePoint& /*now*/)
     }
     interesting_ack_nacks_.clear();
 
-    readers = readers_;
+    for (EndpointWheel::KeyVec::const_iterator pos = due.begin(); pos != due.end(); ++pos) {
+      const RtpsReaderMap::iterator rr = readers_.find(*pos);
+      if (rr != readers_.end()) {
+        readers.push_back(rr->second);
+      }
+    }
   }
 
-  for (RtpsReaderMap::iterator rr = readers.begin(); rr != readers.end(); ++rr) {
-    rr->second->gather_ack_nacks(meta_submessages);
+  // Readers still missing data keep sending ACKNACKs every period.
+  for (OPENDDS_VECTOR(RtpsReader_rch)::iterator rr = readers.begin(); rr != readers.end(); ++rr) {
+    if ((*rr)->gather_ack_nacks(meta_submessages)) {
+      schedule_acknack((*rr)->id(), config().heartbeat_period_);
+    }
   }
 
   send_bundled_submessages(meta_submessages);
@@ -2495,12 +2696,12 @@ RtpsUdpDataLink::RtpsReader::generate_nack_frags_i(NackFragSubmessageVec& nf,
   // 1. sequence #s in the reception gaps that we have partially received
   OPENDDS_VECTOR(SequenceRange) missing = wi.recvd_.missing_sequence_ranges();
   for (size_t i = 0; i < missing.size(); ++i) {
-    link->receive_strategy()->has_fragments(missing[i], pub_id, &frag_info);
+    link->has_fragments(missing[i], pub_id, &frag_info);
   }
   // 1b. larger than the last received seq# but less than the heartbeat.lastSN
   if (!wi.recvd_.empty()) {
     const SequenceRange range(wi.recvd_.high(), wi.hb_range_.second);
-    link->receive_strategy()->has_fragments(range, pub_id, &frag_info);
+    link->has_fragments(range, pub_id, &frag_info);
   }
   for (size_t i = 0; i < frag_info.size(); ++i) {
     // If we've received a HeartbeatFrag, we know the last (available) frag #
@@ -2524,7 +2725,7 @@ RtpsUdpDataLink::RtpsReader::generate_nack_frags_i(NackFragSubmessageVec& nf,
     }
 
     const SequenceRange range(iter->first, iter->first);
-    if (!link->receive_strategy()->has_fragments(range, pub_id, &frag_info)) {
+    if (!link->has_fragments(range, pub_id, &frag_info)) {
       // it was not in the recv strategy, so the entire range is "missing"
       frag_info.push_back(Frag_t(iter->first, RTPS::FragmentNumberSet()));
       RTPS::FragmentNumberSet& fnSet = frag_info.back().second;
@@ -2779,6 +2980,10 @@ RtpsUdpDataLink::RtpsWriter::process_acknack(const RTPS::AckNackSubmessage& ackn
     first_ack = true;
   }
 
+  if (link->adaptive_heartbeat_) {
+    ri->second.acknack_received(MonotonicTimePoint::now());
+  }
+
   OPENDDS_MAP(SequenceNumber, TransportQueueElement*) pendingCallbacks;
   const bool is_final = acknack.smHeader.flags & RTPS::FLAG_F;
 
@@ -2914,6 +3119,9 @@ RtpsUdpDataLink::RtpsWriter::process_acknack(const RTPS::AckNackSubmessage& ackn
     DisjointSequence reqs;
     process_requested_changes_i(reqs, ri->second);
     ri->second.requires_heartbeat_ = reqs.empty();
+    if (ri->second.requires_heartbeat_) {
+      heartbeat_needed_i(*link, false);
+    }
   }
 
   TqeSet to_deliver;
@@ -3015,6 +3223,11 @@ RtpsUdpDataLink::RtpsWriter::send_and_gather_nack_replies(MetaSubmessageVec& met
     0 == std::memcmp(&pvs_writer, &id_.entityId, sizeof pvs_writer);
 #endif
 
+  const MonotonicTimePoint now = MonotonicTimePoint::now();
+  // What each reader asked for and is being resent (adaptive_heartbeat)
+  typedef std::pair<ReaderInfo*, DisjointSequence> Requester;
+  OPENDDS_VECTOR(Requester) requesters;
+
   bool gaps_ok = true;
   typedef ReaderInfoMap::iterator ri_iter;
   const ri_iter end = remote_readers_.end();
@@ -3031,12 +3244,37 @@ RtpsUdpDataLink::RtpsWriter::send_and_gather_nack_replies(MetaSubmessageVec& met
     }
 #endif
 
-    process_requested_changes_i(requests, ri->second);
+    DisjointSequence resending;
+    if (link->adaptive_heartbeat_) {
+      DisjointSequence reader_requests;
+      process_requested_changes_i(reader_requests, ri->second);
+      // A reader that was sent a reply within its round trip time probably
+      // sent its ACKNACK before that reply arrived: don't send the same data
+      // again.  Inserting into what was resent yields the rest.
+      DisjointSequence answered;
+      if (ri->second.recently_resent(now)) {
+        answered = ri->second.resent_;
+      }
+      const OPENDDS_VECTOR(SequenceRange) ranges = reader_requests.present_sequence_ranges();
+      for (size_t i = 0; i < ranges.size(); ++i) {
+        OPENDDS_VECTOR(SequenceRange) unanswered;
+        answered.insert(ranges[i], unanswered);
+        for (size_t j = 0; j < unanswered.size(); ++j) {
+          requests.insert(unanswered[j]);
+          resending.insert(unanswered[j]);
+        }
+      }
+    } else {
+      process_requested_changes_i(requests, ri->second);
+    }
 
     if (!ri->second.requested_changes_.empty()) {
       AddrSet addrs = link->get_addresses(id_, ri->first);
       if (!addrs.empty()) {
         recipients.insert(addrs.begin(), addrs.end());
+        if (!resending.empty()) {
+          requesters.push_back(Requester(&ri->second, resending));
+        }
         if (ri->second.expecting_durable_data()) {
           gaps_ok = false;
         }
@@ -3071,6 +3309,10 @@ RtpsUdpDataLink::RtpsWriter::send_and_gather_nack_replies(MetaSubmessageVec& met
         sb.resend_i(ranges[i], &gaps);
       }
     }
+    for (size_t i = 0; i < requesters.size(); ++i) {
+      requesters[i].first->resent_ = requesters[i].second;
+      requesters[i].first->resent_time_ = now;
+    }
   }
 
   send_nackfrag_replies_i(gaps, recipients);
@@ -3090,7 +3332,7 @@ RtpsUdpDataLink::send_nack_replies()
 {
   RtpsWriterMap writers;
   {
-    ACE_GUARD(ACE_Thread_Mutex, g, writers_lock_);
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, g, writers_index_lock_);
     writers = writers_;
   }
 
@@ -3212,6 +3454,9 @@ RtpsUdpDataLink::RtpsWriter::send_directed_nack_replies_i(const RepoId& readerId
   process_requested_changes_i(requests, reader);
   reader.requires_heartbeat_ = requests.empty();
   reader.requested_changes_.clear();
+  if (reader.requires_heartbeat_) {
+    heartbeat_needed_i(*link, false);
+  }
 
   DisjointSequence gaps;
 
@@ -3368,7 +3613,25 @@ RtpsUdpDataLink::send_heartbeats(const DCPS::MonotonicTimePoint& /*now*/)
       heartbeat_.disable_and_wait();
     }
 
-    writers = writers_;
+    // Only the writers whose heartbeat deadline has expired (within one
+    // tick of the wheel) and those with readers to advertise to are visited.
+    EndpointWheel::KeyVec due;
+    {
+      ACE_GUARD(ACE_Thread_Mutex, gw, wheels_lock_);
+      heartbeat_wheel_.expire(now + heartbeat_wheel_.resolution(), due);
+    }
+    for (EndpointWheel::KeyVec::const_iterator pos = due.begin(); pos != due.end(); ++pos) {
+      const RtpsWriterMap::iterator rw = writers_.find(*pos);
+      if (rw != writers_.end()) {
+        writers.insert(*rw);
+      }
+    }
+    for (WtaMap::const_iterator pos = writers_to_advertise.begin(); pos != writers_to_advertise.end(); ++pos) {
+      const RtpsWriterMap::iterator rw = writers_.find(pos->first);
+      if (rw != writers_.end()) {
+        writers.insert(*rw);
+      }
+    }
   }
 
   using namespace OpenDDS::RTPS;
@@ -3500,11 +3763,36 @@ RtpsUdpDataLink::RtpsWriter::gather_heartbeats(OPENDDS_VECTOR(TransportQueueElem
     }
   }
 
+  bool has_unacked = false;
   {
     ACE_GUARD_RETURN(ACE_Thread_Mutex, g2, elems_not_acked_mutex_, false);
 
     if (!elems_not_acked_.empty()) {
       is_final = false;
+      has_unacked = true;
+    }
+  }
+
+  // Keep heartbeating while there is anything to announce, otherwise leave
+  // the wheel until new data, a new reader, or an ACKNACK needs one.
+  heartbeat_scheduled_ = has_data || has_durable_data || has_unacked || !pre_assoc_hb_guids.empty();
+  if (heartbeat_scheduled_) {
+    link->schedule_heartbeat(id_, link->adaptive_heartbeat_ ?
+                             adaptive_heartbeat_delay_i(*link, has_unacked) : cfg.heartbeat_period_);
+  }
+
+  if (link->adaptive_heartbeat_) {
+    // Readers are expected to answer the non-final heartbeats.
+    if (!is_final) {
+      for (RepoIdSet::const_iterator it = meta_submessage.to_guids_.begin(); it != meta_submessage.to_guids_.end(); ++it) {
+        const ri_iter ri = remote_readers_.find(*it);
+        if (ri != end) {
+          ri->second.heartbeat_sent(now);
+        }
+      }
+    }
+    for (RepoIdSet::const_iterator it = pre_assoc_hb_guids.begin(); it != pre_assoc_hb_guids.end(); ++it) {
+      remote_readers_.find(*it)->second.heartbeat_sent(now);
     }
   }
 
@@ -3568,6 +3856,86 @@ RtpsUdpDataLink::RtpsWriter::gather_heartbeats(OPENDDS_VECTOR(TransportQueueElem
   return true;
 }
 
+void
+RtpsUdpDataLink::RtpsWriter::heartbeat_needed_i(RtpsUdpDataLink& link, bool quick)
+{
+  if (quick) {
+    heartbeat_scheduled_ = true;
+    link.schedule_heartbeat(id_, link.quick_heartbeat_delay_);
+  } else if (!heartbeat_scheduled_ || idle_heartbeats_) {
+    // An idle writer may have backed off beyond heartbeat_period_.
+    heartbeat_scheduled_ = true;
+    idle_heartbeats_ = 0;
+    link.schedule_heartbeat(id_, link.config().heartbeat_period_);
+  }
+}
+
+TimeDuration
+RtpsUdpDataLink::RtpsWriter::adaptive_heartbeat_delay_i(const RtpsUdpDataLink& link, bool has_unacked)
+{
+  const RtpsUdpInst& cfg = link.config();
+
+  bool outstanding = has_unacked, rtt_unknown = false;
+  SequenceNumber::Value most_unacked = 0;
+  TimeDuration timeout;
+  for (ReaderInfoMap::const_iterator ri = remote_readers_.begin(); ri != remote_readers_.end(); ++ri) {
+    const SequenceNumber hb_high = heartbeat_high(ri->second);
+    if (ri->second.handshake_done_ &&
+        (hb_high == SequenceNumber::ZERO() || ri->second.cur_cumulative_ack_ > hb_high)) {
+      continue; // up to date
+    }
+    outstanding = true;
+    if (ri->second.handshake_done_) {
+      most_unacked = std::max(most_unacked,
+                              hb_high.getValue() - ri->second.cur_cumulative_ack_.getValue() + 1);
+    }
+    if (ri->second.srtt_.is_zero()) {
+      rtt_unknown = true;
+    } else {
+      timeout = std::max(timeout, ri->second.response_timeout());
+    }
+  }
+
+  if (!outstanding) {
+    // All readers are up to date, back off to at most 4 heartbeat periods.
+    if (idle_heartbeats_ < 2) {
+      ++idle_heartbeats_;
+    }
+    return cfg.heartbeat_period_ * double(1u << idle_heartbeats_);
+  }
+  idle_heartbeats_ = 0;
+
+  if (rtt_unknown || timeout.is_zero()) {
+    timeout = cfg.heartbeat_period_;
+  }
+  // The fuller the send buffer gets, the sooner readers should find out
+  // what they are missing, before it is released for lack of space.
+  const double fill = cfg.nak_depth_ ?
+    std::min(1.0, double(most_unacked) / double(cfg.nak_depth_)) : 1.0;
+  const TimeDuration delay = timeout * (1.0 - fill / 2);
+  return std::min(cfg.heartbeat_period_, std::max(link.quick_heartbeat_delay_, delay));
+}
+
+void
+RtpsUdpDataLink::schedule_heartbeat(const RepoId& writer, const TimeDuration& delay)
+{
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, wheels_lock_);
+    heartbeat_wheel_.schedule(writer, MonotonicTimePoint::now() + delay);
+  }
+  heartbeat_.enable(delay);
+}
+
+void
+RtpsUdpDataLink::schedule_acknack(const RepoId& reader, const TimeDuration& delay)
+{
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, wheels_lock_);
+    acknack_wheel_.schedule(reader, MonotonicTimePoint::now() + delay);
+  }
+  heartbeat_reply_.enable(delay);
+}
+
 void
 RtpsUdpDataLink::check_heartbeats(const DCPS::MonotonicTimePoint& now)
 {
@@ -3795,6 +4163,38 @@ RtpsUdpDataLink::ReaderInfo::expire_durable_data()
   }
 }
 
+void
+RtpsUdpDataLink::ReaderInfo::heartbeat_sent(const MonotonicTimePoint& now)
+{
+  if (heartbeats_unanswered_++ == 0) {
+    heartbeat_sent_ = now;
+  }
+}
+
+void
+RtpsUdpDataLink::ReaderInfo::acknack_received(const MonotonicTimePoint& now)
+{
+  if (heartbeats_unanswered_ == 1) {
+    // RFC 6298 smoothing
+    const TimeDuration sample = now - heartbeat_sent_;
+    if (srtt_.is_zero()) {
+      srtt_ = sample;
+      rttvar_ = sample * 0.5;
+    } else {
+      const TimeDuration error = sample < srtt_ ? srtt_ - sample : sample - srtt_;
+      rttvar_ = rttvar_ * 0.75 + error * 0.25;
+      srtt_ = srtt_ * 0.875 + sample * 0.125;
+    }
+  }
+  heartbeats_unanswered_ = 0;
+}
+
+bool
+RtpsUdpDataLink::ReaderInfo::recently_resent(const MonotonicTimePoint& now) const
+{
+  return !srtt_.is_zero() && !resent_.empty() && now < resent_time_ + response_timeout();
+}
+
 bool
 RtpsUdpDataLink::ReaderInfo::expecting_durable_data() const
 {
@@ -3810,6 +4210,8 @@ RtpsUdpDataLink::RtpsWriter::RtpsWriter(RcHandle<RtpsUdpDataLink> link, const Re
  , id_(id)
  , durable_(durable)
  , heartbeat_count_(heartbeat_count)
+ , heartbeat_scheduled_(false)
+ , idle_heartbeats_(0)
 {
   send_buff_->bind(link->send_strategy());
 }
@@ -3888,7 +4290,7 @@ RtpsUdpDataLink::send_final_acks(const RepoId& readerid)
 {
   RtpsReader_rch reader;
   {
-    ACE_GUARD(ACE_Thread_Mutex, g, readers_lock_);
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, g, readers_index_lock_);
     RtpsReaderMap::iterator rr = readers_.find(readerid);
     if (rr != readers_.end()) {
       reader = rr->second;
@@ -3965,9 +4367,106 @@ RtpsUdpDataLink::send_strategy()
 RtpsUdpReceiveStrategy*
 RtpsUdpDataLink::receive_strategy()
 {
+  if (!receive_shards_.empty()) {
+    const ACE_thread_t self = ACE_Thread::self();
+    for (ReceiveShards::const_iterator shard = receive_shards_.begin();
+         shard != receive_shards_.end(); ++shard) {
+      if (shard->reactor_task_ && receive_strategy_
+          && ACE_OS::thr_equal(shard->reactor_task_->get_reactor_owner(), self)) {
+        return shard->strategy_.in();
+      }
+    }
+  }
   return static_cast<RtpsUdpReceiveStrategy*>(receive_strategy_.in());
 }
 
+RtpsUdpReceiveStrategy*
+RtpsUdpDataLink::receive_owner(const GuidPrefix_t& prefix,
+                               RtpsUdpReceiveStrategy* receiver)
+{
+  if (receive_shards_.empty()) {
+    return receiver;
+  }
+  const RepoId participant = RTPS::make_id(prefix, ENTITYID_PARTICIPANT);
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, receive_owners_lock_, receiver);
+  return receive_owners_.insert(ReceiveOwnerMap::value_type(participant, receiver)).first->second;
+}
+
+void
+RtpsUdpDataLink::release_remote_i(const RepoId& remote_id)
+{
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, locators_lock_);
+    locators_.erase(remote_id);
+    if (receive_shards_.empty()) {
+      return;
+    }
+    // Entities of one participant share its prefix and sort together.
+    const RemoteInfoMap::const_iterator next =
+      locators_.lower_bound(RTPS::make_id(remote_id.guidPrefix, ENTITYID_UNKNOWN));
+    if (next != locators_.end()
+        && std::memcmp(next->first.guidPrefix, remote_id.guidPrefix, sizeof(GuidPrefix_t)) == 0) {
+      return;
+    }
+  }
+
+  ACE_GUARD(ACE_Thread_Mutex, g, receive_owners_lock_);
+  receive_owners_.erase(RTPS::make_id(remote_id.guidPrefix, ENTITYID_PARTICIPANT));
+}
+
+bool
+RtpsUdpDataLink::has_fragments(const SequenceRange& range, const RepoId& pub_id,
+                               RtpsUdpReceiveStrategy::FragmentInfo* frag_info)
+{
+  bool found = static_cast<RtpsUdpReceiveStrategy*>(receive_strategy_.in())->has_fragments(range, pub_id, frag_info);
+  for (ReceiveShards::const_iterator shard = receive_shards_.begin();
+       shard != receive_shards_.end(); ++shard) {
+    if (shard->strategy_ && shard->strategy_->has_fragments(range, pub_id, frag_info)) {
+      found = true;
+    }
+  }
+  return found;
+}
+
+void
+RtpsUdpDataLink::remove_fragments(const SequenceRange& range, const RepoId& pub_id)
+{
+  static_cast<RtpsUdpReceiveStrategy*>(receive_strategy_.in())->remove_fragments(range, pub_id);
+  for (ReceiveShards::const_iterator shard = receive_shards_.begin();
+       shard != receive_shards_.end(); ++shard) {
+    if (shard->strategy_) {
+      shard->strategy_->remove_fragments(range, pub_id);
+    }
+  }
+}
+
+bool
+RtpsUdpDataLink::remove_frags_from_bitmap(CORBA::Long bitmap[], CORBA::ULong num_bits,
+                                          const SequenceNumber& base,
+                                          const RepoId& pub_id)
+{
+  bool modified = static_cast<RtpsUdpReceiveStrategy*>(receive_strategy_.in())->remove_frags_from_bitmap(bitmap, num_bits, base, pub_id);
+  for (ReceiveShards::const_iterator shard = receive_shards_.begin();
+       shard != receive_shards_.end(); ++shard) {
+    if (shard->strategy_ && shard->strategy_->remove_frags_from_bitmap(bitmap, num_bits, base, pub_id)) {
+      modified = true;
+    }
+  }
+  return modified;
+}
+
+void
+RtpsUdpDataLink::clear_completed_fragments(const RepoId& pub_id)
+{
+  static_cast<RtpsUdpReceiveStrategy*>(receive_strategy_.in())->clear_completed_fragments(pub_id);
+  for (ReceiveShards::const_iterator shard = receive_shards_.begin();
+       shard != receive_shards_.end(); ++shard) {
+    if (shard->strategy_) {
+      shard->strategy_->clear_completed_fragments(pub_id);
+    }
+  }
+}
+
 RtpsUdpDataLink::AddrSet
 RtpsUdpDataLink::get_addresses(const RepoId& local, const RepoId& remote) const {
   ACE_GUARD_RETURN(ACE_Thread_Mutex, g, locators_lock_, AddrSet());
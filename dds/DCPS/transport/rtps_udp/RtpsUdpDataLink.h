@@ -17,6 +17,7 @@
 #include "RtpsCustomizedElement.h"
 
 #include "ace/Basic_Types.h"
+#include "ace/RW_Thread_Mutex.h"
 #include "ace/SOCK_Dgram.h"
 #include "ace/SOCK_Dgram_Mcast.h"
 
@@ -29,6 +30,7 @@
 #include "dds/DCPS/NetworkConfigMonitor.h"
 
 #include "dds/DCPS/DataSampleElement.h"
+#include "dds/DCPS/BitmapDisjointSequence.h"
 #include "dds/DCPS/DisjointSequence.h"
 #include "dds/DCPS/GuidConverter.h"
 #include "dds/DCPS/PoolAllocator.h"
@@ -37,6 +39,7 @@
 #include "dds/DCPS/RcEventHandler.h"
 #include "dds/DCPS/JobQueue.h"
 #include "dds/DCPS/SequenceNumber.h"
+#include "dds/DCPS/TimingWheel_T.h"
 
 #ifdef OPENDDS_SECURITY
 #include "dds/DdsSecurityCoreC.h"
@@ -44,6 +47,10 @@
 #include "dds/DCPS/security/framework/SecurityConfig_rch.h"
 #endif
 
+#if defined SO_REUSEPORT && !defined ACE_WIN32
+#  define OPENDDS_RTPS_UDP_HAS_REUSEPORT
+#endif
+
 class DDS_TEST;
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -95,12 +102,33 @@ public:
   ACE_SOCK_Dgram_Mcast& ipv6_multicast_socket();
 #endif
 
+  /// With sharded receive "receive_shard_socket" is the first of the
+  /// receive shard sockets, otherwise it isn't open.
   bool open(const ACE_SOCK_Dgram& unicast_socket
 #ifdef ACE_HAS_IPV6
             , const ACE_SOCK_Dgram& ipv6_unicast_socket
 #endif
+            , const ACE_SOCK_Dgram& receive_shard_socket
             );
 
+  /// True if "config" asks for more than one IPv4 unicast receive socket
+  /// and this platform and configuration can provide them.
+  static bool sharded_receive(const RtpsUdpInst& config);
+
+  /// Open and bind "socket" to "address".  With "reuse_port" the socket
+  /// gets SO_REUSEPORT before it is bound so that the other receive
+  /// shards can bind the same port.
+  static bool open_unicast_socket(ACE_SOCK_Dgram& socket,
+                                  const ACE_INET_Addr& address,
+                                  int protocol_family,
+                                  bool reuse_port);
+
+  /// The receive strategy that processes datagrams from the participant
+  /// "prefix": "receiver" itself unless the link has receive shards and
+  /// another strategy received from that participant first.
+  RtpsUdpReceiveStrategy* receive_owner(const GuidPrefix_t& prefix,
+                                        RtpsUdpReceiveStrategy* receiver);
+
   void received(const RTPS::DataSubmessage& data,
                 const GuidPrefix_t& src_prefix);
 
@@ -226,8 +254,47 @@ private:
   RcHandle<DCPS::JobQueue> job_queue_;
 
   RtpsUdpSendStrategy* send_strategy();
+
+  /// The receive strategy of the receive shard serviced by the calling
+  /// thread, or the primary receive strategy for any other thread.
   RtpsUdpReceiveStrategy* receive_strategy();
 
+  // Fragments from a given writer are held by whichever receive strategy
+  // its datagrams are delivered to, so these check all of them.
+  bool has_fragments(const SequenceRange& range, const RepoId& pub_id,
+                     RtpsUdpReceiveStrategy::FragmentInfo* frag_info = 0);
+  void remove_fragments(const SequenceRange& range, const RepoId& pub_id);
+  bool remove_frags_from_bitmap(CORBA::Long bitmap[], CORBA::ULong num_bits,
+                                const SequenceNumber& base,
+                                const RepoId& pub_id);
+  void clear_completed_fragments(const RepoId& pub_id);
+
+  /// IPv4 unicast sockets bound to the port of the transport's unicast
+  /// locator with SO_REUSEPORT, unicast_socket_ only sends then.  The
+  /// kernel hashes each remote address and port to one of them, datagrams
+  /// from a participant that arrive on any other socket of the link are
+  /// forwarded to the strategy that owns it (see receive_owner()), so all
+  /// of a remote writer's traffic is processed, in order, by one thread.
+  struct ReceiveShard {
+    ACE_SOCK_Dgram socket_;
+    ReactorTask_rch reactor_task_;
+    RtpsUdpReceiveStrategy_rch strategy_;
+  };
+  typedef OPENDDS_VECTOR(ReceiveShard) ReceiveShards;
+  /// Set up in open() and left in place until the link is destroyed so
+  /// that receive_strategy() may read it without locking.
+  ReceiveShards receive_shards_;
+
+  bool open_receive_shards(const ACE_SOCK_Dgram& first_socket);
+  void stop_receive_shards();
+
+  /// The strategy that received from each remote participant first, keyed
+  /// by its participant GUID.  An entry is dropped in release_remote_i()
+  /// once none of the participant's entities remain in locators_.
+  typedef OPENDDS_MAP_CMP(RepoId, RtpsUdpReceiveStrategy*, GUID_tKeyLessThan) ReceiveOwnerMap;
+  ACE_Thread_Mutex receive_owners_lock_;
+  ReceiveOwnerMap receive_owners_;
+
   GuidPrefix_t local_prefix_;
 
   struct RemoteInfo {
@@ -290,6 +357,16 @@ private:
     bool handshake_done_, durable_;
     OPENDDS_MAP(SequenceNumber, TransportQueueElement*) durable_data_;
     MonotonicTimePoint durable_timestamp_;
+    /// Round trip from a HEARTBEAT requiring a response to the ACKNACK
+    /// answering it (adaptive_heartbeat only).  Samples are only taken when
+    /// a single heartbeat was outstanding.
+    MonotonicTimePoint heartbeat_sent_;
+    int heartbeats_unanswered_;
+    TimeDuration srtt_, rttvar_;
+    /// What this reader last requested and was resent in reply to a NACK,
+    /// and when.
+    DisjointSequence resent_;
+    MonotonicTimePoint resent_time_;
 
     explicit ReaderInfo(bool durable)
       : acknack_recvd_count_(0)
@@ -298,11 +375,17 @@ private:
       , cur_cumulative_ack_(SequenceNumber::ZERO()) // Starting at zero instead of unknown makes the logic cleaner.
       , handshake_done_(false)
       , durable_(durable)
+      , heartbeats_unanswered_(0)
     {}
     ~ReaderInfo();
     void swap_durable_data(OPENDDS_MAP(SequenceNumber, TransportQueueElement*)& dd);
     void expire_durable_data();
     bool expecting_durable_data() const;
+    void heartbeat_sent(const MonotonicTimePoint& now);
+    void acknack_received(const MonotonicTimePoint& now);
+    /// Time within which an ACKNACK should answer a heartbeat, zero if unknown.
+    TimeDuration response_timeout() const { return srtt_ + 4 * rttvar_; }
+    bool recently_resent(const MonotonicTimePoint& now) const;
   };
 
   typedef OPENDDS_MAP_CMP(RepoId, ReaderInfo, GUID_tKeyLessThan) ReaderInfoMap;
@@ -344,6 +427,11 @@ private:
     RepoId id_;
     bool durable_;
     CORBA::Long heartbeat_count_;
+    /// This writer is in the link's heartbeat_wheel_ (or is about to be
+    /// put back into it by gather_heartbeats()).
+    bool heartbeat_scheduled_;
+    /// Consecutive heartbeats with all readers up to date (adaptive_heartbeat).
+    unsigned int idle_heartbeats_;
     mutable ACE_Thread_Mutex mutex_;
     mutable ACE_Thread_Mutex elems_not_acked_mutex_;
 
@@ -353,6 +441,8 @@ private:
     void end_historic_samples_i(const DataSampleHeader& header,
                                 ACE_Message_Block* body);
     void send_heartbeats_manual_i(MetaSubmessageVec& meta_submessages);
+    void heartbeat_needed_i(RtpsUdpDataLink& link, bool quick);
+    TimeDuration adaptive_heartbeat_delay_i(const RtpsUdpDataLink& link, bool has_unacked);
 
     void gather_gaps_i(const RepoId& reader,
                        const DisjointSequence& gaps,
@@ -409,7 +499,7 @@ private:
   // RTPS reliability support for local readers:
 
   struct WriterInfo {
-    DisjointSequence recvd_;
+    BitmapDisjointSequence recvd_;
     OPENDDS_MAP(SequenceNumber, ReceivedDataSample) held_;
     SequenceRange hb_range_;
     OPENDDS_MAP(SequenceNumber, RTPS::FragmentNumber_t) frags_;
@@ -447,10 +537,12 @@ private:
     bool process_gap_i(const RTPS::GapSubmessage& gap, const RepoId& src, MetaSubmessageVec& meta_submessages);
     bool process_hb_frag_i(const RTPS::HeartBeatFragSubmessage& hb_frag, const RepoId& src, MetaSubmessageVec& meta_submessages);
 
-    void gather_ack_nacks(MetaSubmessageVec& meta_submessages, bool finalFlag = false);
+    bool gather_ack_nacks(MetaSubmessageVec& meta_submessages, bool finalFlag = false);
+
+    const RepoId& id() const { return id_; }
 
   private:
-    void gather_ack_nacks_i(MetaSubmessageVec& meta_submessages, bool finalFlag = false);
+    bool gather_ack_nacks_i(MetaSubmessageVec& meta_submessages, bool finalFlag = false);
     void generate_nack_frags_i(NackFragSubmessageVec& nack_frags,
                                WriterInfo& wi, const RepoId& pub_id);
 
@@ -489,16 +581,29 @@ private:
   void deliver_held_data(const RepoId& readerId, WriterInfo& info, bool durable);
 
   /// What was once a single lock for the whole datalink is now split between three (four including ch_lock_):
-  /// - readers_lock_ protects readers_, readers_of_writer_, pending_reliable_readers_, interesting_writers_, and
+  /// - readers_lock_ protects interesting_writers_, interesting_ack_nacks_, and
   ///   writer_to_seq_best_effort_readers_ along with anything else that fits the 'reader side activity' of the datalink
-  /// - writers_lock_ protects writers_, heartbeat_counts_ best_effort_heartbeat_count_, and interesting_readers_
+  /// - writers_lock_ protects heartbeat_counts_ best_effort_heartbeat_count_, and interesting_readers_
   ///   along with anything else that fits the 'writers side activity' of the datalink
   /// - locators_lock_ protects locators_ (and therefore calls to get_addresses_i())
   ///   for both remote writers and remote readers
+  /// The state of each local writer and reader is protected by the
+  /// RtpsWriter or RtpsReader itself.
   mutable ACE_Thread_Mutex readers_lock_;
   mutable ACE_Thread_Mutex writers_lock_;
   mutable ACE_Thread_Mutex locators_lock_;
 
+  /// The GUID indexes used to find the RtpsWriter or RtpsReader for each
+  /// submessage and sample are read-mostly, so they have reader/writer locks:
+  /// - writers_index_lock_ protects writers_
+  /// - readers_index_lock_ protects readers_, readers_of_writer_, and pending_reliable_readers_
+  /// Changing an index requires holding writers_lock_ (or readers_lock_) and
+  /// then the index lock for writing.  Reading it requires either one, so
+  /// lookups on the send and receive paths only take a read guard.  No other
+  /// lock is acquired while an index lock is held for writing.
+  mutable ACE_RW_Thread_Mutex readers_index_lock_;
+  mutable ACE_RW_Thread_Mutex writers_index_lock_;
+
   /// Extend the FragmentNumberSet to cover the fragments that are
   /// missing from our last known fragment to the extent
   /// @param fnSet FragmentNumberSet for the message sequence number
@@ -524,7 +629,7 @@ private:
 
     OPENDDS_VECTOR(RtpsWriter_rch) to_call;
     {
-      ACE_GUARD(ACE_Thread_Mutex, g, writers_lock_);
+      ACE_READ_GUARD(ACE_RW_Thread_Mutex, g, writers_index_lock_);
       const RtpsWriterMap::iterator rw = writers_.find(local);
       if (rw == writers_.end()) {
         return;
@@ -551,10 +656,9 @@ private:
     std::memcpy(src.guidPrefix, src_prefix, sizeof(GuidPrefix_t));
     src.entityId = submessage.writerId;
 
-    bool schedule_timer = false;
     OPENDDS_VECTOR(RtpsReader_rch) to_call;
     {
-      ACE_GUARD(ACE_Thread_Mutex, g, readers_lock_);
+      ACE_READ_GUARD(ACE_RW_Thread_Mutex, g, readers_index_lock_);
       if (local.entityId == ENTITYID_UNKNOWN) {
         typedef std::pair<RtpsReaderMultiMap::iterator, RtpsReaderMultiMap::iterator> RRMM_IterRange;
         for (RRMM_IterRange iters = readers_of_writer_.equal_range(src); iters.first != iters.second; ++iters.first) {
@@ -571,12 +675,11 @@ private:
     MetaSubmessageVec meta_submessages;
     for (OPENDDS_VECTOR(RtpsReader_rch)::const_iterator it = to_call.begin(); it < to_call.end(); ++it) {
       RtpsReader& reader = **it;
-      schedule_timer |= (reader.*func)(submessage, src, meta_submessages);
+      if ((reader.*func)(submessage, src, meta_submessages)) {
+        schedule_acknack(reader.id(), normal_heartbeat_response_delay_);
+      }
     }
     send_bundled_submessages(meta_submessages);
-    if (schedule_timer) {
-      heartbeat_reply_.enable(normal_heartbeat_response_delay_);
-    }
   }
 
   void send_nack_replies();
@@ -584,6 +687,8 @@ private:
   void send_heartbeat_replies(const DCPS::MonotonicTimePoint& now);
   void send_directed_heartbeats(OPENDDS_VECTOR(RTPS::HeartBeatSubmessage)& hbs);
   void check_heartbeats(const DCPS::MonotonicTimePoint& now);
+  void schedule_heartbeat(const RepoId& writer, const TimeDuration& delay);
+  void schedule_acknack(const RepoId& reader, const TimeDuration& delay);
   void send_relay_beacon(const DCPS::MonotonicTimePoint& now);
 
   CORBA::Long best_effort_heartbeat_count_;
@@ -622,6 +727,15 @@ private:
   typedef PmfPeriodicTask<RtpsUdpDataLink> Periodic;
   Periodic heartbeatchecker_, relay_beacon_;
 
+  /// Deadlines of the local writers that need to send a periodic HEARTBEAT
+  /// and of the local readers that need to send an ACKNACK.  heartbeat_ and
+  /// heartbeat_reply_ only visit the endpoints that have expired, instead
+  /// of all of writers_ and readers_.  Both are protected by wheels_lock_,
+  /// which is never held while acquiring another lock.
+  typedef TimingWheel<RepoId, GUID_tKeyLessThan> EndpointWheel;
+  EndpointWheel heartbeat_wheel_, acknack_wheel_;
+  mutable ACE_Thread_Mutex wheels_lock_;
+
   /// Data structure representing an "interesting" remote entity for static discovery.
   struct InterestingRemote {
     /// id of local entity that is interested in this remote.
@@ -711,6 +825,7 @@ private:
   TimeDuration quick_heartbeat_delay_;
   TimeDuration normal_heartbeat_response_delay_;
   TimeDuration quick_heartbeat_response_delay_;
+  const bool adaptive_heartbeat_;
 
 #ifdef OPENDDS_SECURITY
   mutable ACE_Thread_Mutex ch_lock_;
@@ -36,6 +36,11 @@ RtpsUdpInst::RtpsUdpInst(const OPENDDS_STRING& name)
   , max_message_size_(RtpsUdpSendStrategy::UDP_MAX_MESSAGE_SIZE)
   , nak_depth_(0)
   , max_bundle_size_(TransportSendStrategy::UDP_MAX_MESSAGE_SIZE - RTPS::RTPSHDR_SZ) // default maximum bundled message size is max udp message size (see TransportStrategy) minus RTPS header
+  , receive_batch_size_(1)
+  , use_gso_(false)
+  , use_gro_(false)
+  , receive_threads_(1)
+  , adaptive_heartbeat_(false)
   , quick_reply_ratio_(0.1)
   , nak_response_delay_(0, 200*1000 /*microseconds*/) // default from RTPS
   , heartbeat_period_(1) // no default in RTPS spec
@@ -103,6 +108,15 @@ RtpsUdpInst::load(ACE_Configuration_Heap& cf,
 
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("max_bundle_size"), max_bundle_size_, size_t);
 
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("receive_batch_size"), receive_batch_size_, size_t);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("use_gso"), use_gso_, bool);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("use_gro"), use_gro_, bool);
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("receive_threads"), receive_threads_, size_t);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("adaptive_heartbeat"), adaptive_heartbeat_, bool);
+
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("quick_reply_ratio"), quick_reply_ratio_, double);
 
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("ttl"), ttl_, unsigned char);
@@ -178,6 +192,11 @@ RtpsUdpInst::dump_to_str() const
   ret += formatNameForDump("multicast_interface") + multicast_interface_ + '\n';
   ret += formatNameForDump("nak_depth") + to_dds_string(unsigned(nak_depth_)) + '\n';
   ret += formatNameForDump("max_bundle_size") + to_dds_string(unsigned(max_bundle_size_)) + '\n';
+  ret += formatNameForDump("receive_batch_size") + to_dds_string(unsigned(receive_batch_size_)) + '\n';
+  ret += formatNameForDump("use_gso") + (use_gso_ ? "true" : "false") + '\n';
+  ret += formatNameForDump("use_gro") + (use_gro_ ? "true" : "false") + '\n';
+  ret += formatNameForDump("receive_threads") + to_dds_string(unsigned(receive_threads_)) + '\n';
+  ret += formatNameForDump("adaptive_heartbeat") + (adaptive_heartbeat_ ? "true" : "false") + '\n';
   ret += formatNameForDump("nak_response_delay") + to_dds_string(nak_response_delay_.value().msec()) + '\n';
   ret += formatNameForDump("heartbeat_period") + to_dds_string(heartbeat_period_.value().msec()) + '\n';
   ret += formatNameForDump("heartbeat_response_delay") + to_dds_string(heartbeat_response_delay_.value().msec()) + '\n';
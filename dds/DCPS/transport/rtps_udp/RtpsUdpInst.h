@@ -39,6 +39,28 @@ public:
   size_t max_message_size_;
   size_t nak_depth_;
   size_t max_bundle_size_;
+  /// Maximum number of datagrams drained per reactor wakeup.  Values
+  /// greater than 1 enable batched receive (recvmmsg) where supported.
+  size_t receive_batch_size_;
+  /// Send runs of equal-size fragment datagrams with one UDP segmentation
+  /// offload (UDP_SEGMENT) send where supported.
+  bool use_gso_;
+  /// Let the kernel coalesce received datagrams (UDP_GRO) where supported.
+  bool use_gro_;
+  /// Number of IPv4 unicast receive sockets, each bound to the port of the
+  /// unicast locator with SO_REUSEPORT and serviced by its own thread.  The
+  /// transport then sends from a socket of its own on an ephemeral port, so
+  /// peers see a source port other than the advertised locator's; firewall
+  /// or NAT rules keyed on the source port must allow for it.  Values
+  /// greater than 1 take effect where SO_REUSEPORT is supported and ICE is
+  /// not used.
+  size_t receive_threads_;
+  /// Derive each reliable writer's heartbeat period from the measured
+  /// ACKNACK round trip of its readers and its unacknowledged data, between
+  /// heartbeat_period_ * quick_reply_ratio_ and heartbeat_period_, and back
+  /// off when all readers are up to date.  Also suppresses NACK replies for
+  /// data that was resent to the same reader within its round trip time.
+  bool adaptive_heartbeat_;
   double quick_reply_ratio_;
   TimeDuration nak_response_delay_, heartbeat_period_,
     heartbeat_response_delay_, handshake_timeout_, durable_data_timeout_;
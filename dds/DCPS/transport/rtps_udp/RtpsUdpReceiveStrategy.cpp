@@ -26,29 +26,371 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
-RtpsUdpReceiveStrategy::RtpsUdpReceiveStrategy(RtpsUdpDataLink* link, const GuidPrefix_t& local_prefix)
+namespace {
+  /// Fragmented samples are reassembled into a single buffer allocated up
+  /// front while the buffers of the incomplete ones total at most this
+  /// many bytes.  Past that (the sizes come from the remote writers) the
+  /// fragments are chained as they arrive.
+  const size_t MAX_CONTIGUOUS_REASSEMBLY = 16 * 1024 * 1024;
+}
+
+RtpsUdpReceiveStrategy::RtpsUdpReceiveStrategy(RtpsUdpDataLink* link, const GuidPrefix_t& local_prefix,
+                                               ACE_HANDLE shard_handle,
+                                               ACE_Reactor* shard_reactor)
   : link_(link)
   , last_received_()
   , recvd_sample_(0)
   , total_frags_(0)
+  , frag_size_(0)
+  , sample_size_(0)
+  , reassembly_(MAX_CONTIGUOUS_REASSEMBLY)
   , receiver_(local_prefix)
+  , gro_enabled_(false)
+  , shard_reactor_(shard_reactor)
+  , current_forwarded_(0)
 #ifdef OPENDDS_SECURITY
   , secure_sample_(0)
   , encoded_rtps_(false)
   , encoded_submsg_(false)
 #endif
 {
+  shard_socket_.set_handle(shard_handle);
 #ifdef OPENDDS_SECURITY
   secure_prefix_.smHeader.submessageId = SUBMESSAGE_NONE;
 #endif
 }
 
+RtpsUdpReceiveStrategy::~RtpsUdpReceiveStrategy()
+{
+  for (ForwardedDatagrams::iterator it = forwarded_.begin(); it != forwarded_.end(); ++it) {
+    it->data_->release();
+  }
+}
+
 int
 RtpsUdpReceiveStrategy::handle_input(ACE_HANDLE fd)
 {
+  if (fd == ACE_INVALID_HANDLE) {
+    // Notified by forward()
+    return handle_forwarded_input();
+  }
+
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+  if (gro_enabled_ && !batch_receive_allowed()) {
+    // Security or ICE came up after start_i(), the simple path can't split
+    // coalesced datagrams.
+    disable_gro();
+    return 0;
+  }
+#endif
+
+  const size_t batch_size = link_->config().receive_batch_size_;
+  if ((batch_size > 1 || gro_enabled_) && batch_receive_allowed()) {
+    return handle_batched_dds_input(fd, batch_size);
+  }
   return handle_simple_dds_input(fd);
 }
 
+void
+RtpsUdpReceiveStrategy::forward(const char* data, size_t length, size_t segment_size,
+                                const ACE_INET_Addr& remote_address)
+{
+  const size_t step = (segment_size && segment_size < length) ? segment_size : length;
+  bool notify = false;
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, forwarded_lock_);
+    notify = forwarded_.empty();
+    for (size_t offset = 0; offset < length; offset += step) {
+      const size_t size = std::min(step, length - offset);
+      ForwardedDatagram datagram;
+      datagram.data_ = new ACE_Message_Block(size);
+      datagram.data_->copy(data + offset, size);
+      datagram.remote_address_ = remote_address;
+      forwarded_.push_back(datagram);
+    }
+  }
+
+  // handle_forwarded_input() takes everything queued so far, so there only
+  // needs to be a notification when the queue was empty.
+  ACE_Reactor* const reactor = shard_reactor_ ? shard_reactor_ : link_->get_reactor();
+  if (notify && reactor) {
+    reactor->notify(this, ACE_Event_Handler::READ_MASK);
+  }
+}
+
+bool
+RtpsUdpReceiveStrategy::forward_to_owner(const char* data, size_t length,
+                                         size_t segment_size,
+                                         const ACE_INET_Addr& remote_address)
+{
+  static const size_t GuidPrefixOffset = 8; // "RTPS", Version(2), Vendor(2)
+  if (length < RTPS::RTPSHDR_SZ || std::memcmp(data, "RTPS", 4) != 0) {
+    return false;
+  }
+  GuidPrefix_t prefix;
+  std::memcpy(prefix, data + GuidPrefixOffset, sizeof prefix);
+  RtpsUdpReceiveStrategy* const owner = link_->receive_owner(prefix, this);
+  if (owner == this) {
+    return false;
+  }
+  owner->forward(data, length, segment_size, remote_address);
+  return true;
+}
+
+int
+RtpsUdpReceiveStrategy::handle_forwarded_input()
+{
+  ForwardedDatagrams forwarded;
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, g, forwarded_lock_, 0);
+    forwarded.swap(forwarded_);
+  }
+
+  for (ForwardedDatagrams::const_iterator it = forwarded.begin(); it != forwarded.end(); ++it) {
+    current_forwarded_ = &*it;
+    handle_simple_dds_input(ACE_INVALID_HANDLE);
+    it->data_->release();
+  }
+  current_forwarded_ = 0;
+
+  // An error only concerns one datagram, keep the notifications coming
+  return 0;
+}
+
+ssize_t
+RtpsUdpReceiveStrategy::receive_forwarded(iovec iov[], int n,
+                                          ACE_INET_Addr& remote_address)
+{
+  if (!current_forwarded_) {
+    return -1;
+  }
+  remote_address = current_forwarded_->remote_address_;
+  const char* const data = current_forwarded_->data_->rd_ptr();
+  const size_t length = current_forwarded_->data_->length();
+  size_t copied = 0;
+  for (int i = 0; i < n && copied < length; ++i) {
+    const size_t chunk = std::min(static_cast<size_t>(iov[i].iov_len), length - copied);
+    std::memcpy(iov[i].iov_base, data + copied, chunk);
+    copied += chunk;
+  }
+  return static_cast<ssize_t>(copied);
+}
+
+bool
+RtpsUdpReceiveStrategy::batch_receive_allowed() const
+{
+#ifdef OPENDDS_RTPS_UDP_HAS_RECVMMSG
+# ifdef OPENDDS_SECURITY
+  return link_->get_ice_endpoint() == 0
+    && link_->local_crypto_handle() == DDS::HANDLE_NIL;
+# else
+  return true;
+# endif
+#else
+  return false;
+#endif
+}
+
+int
+RtpsUdpReceiveStrategy::receive_datagrams(iovec iov[],
+                                          ssize_t lengths[],
+                                          size_t segment_sizes[],
+                                          ACE_INET_Addr remote_addresses[],
+                                          int n,
+                                          ACE_HANDLE fd,
+                                          bool& stop)
+{
+#ifdef OPENDDS_RTPS_UDP_HAS_RECVMMSG
+  ACE_UNUSED_ARG(stop);
+  if (n < 1) {
+    return 0;
+  }
+
+  const size_t count = static_cast<size_t>(n);
+  if (batch_headers_.size() < count) {
+    batch_headers_.resize(count);
+    batch_addresses_.resize(count);
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+    batch_controls_.resize(count);
+#endif
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    std::memset(&batch_headers_[i], 0, sizeof(mmsghdr));
+    msghdr& hdr = batch_headers_[i].msg_hdr;
+    hdr.msg_name = &batch_addresses_[i];
+    hdr.msg_namelen = sizeof(sockaddr_storage);
+    hdr.msg_iov = &iov[i];
+    hdr.msg_iovlen = 1;
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+    if (gro_enabled_) {
+      hdr.msg_control = batch_controls_[i].buffer_;
+      hdr.msg_controllen = sizeof batch_controls_[i].buffer_;
+    }
+#endif
+  }
+
+  // MSG_WAITFORONE: the reactor reported at least one readable datagram,
+  // take it plus whatever else is already queued without blocking.
+  const int ret = recvmmsg(fd, &batch_headers_[0], n, MSG_WAITFORONE, 0);
+
+  if (ret < 0) {
+    return ret;
+  }
+
+  for (int i = 0; i < ret; ++i) {
+    lengths[i] = static_cast<ssize_t>(batch_headers_[i].msg_len);
+    remote_addresses[i].set(reinterpret_cast<sockaddr_in*>(&batch_addresses_[i]),
+                            static_cast<int>(batch_headers_[i].msg_hdr.msg_namelen));
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+    msghdr& hdr = batch_headers_[i].msg_hdr;
+    for (cmsghdr* cm = gro_enabled_ ? CMSG_FIRSTHDR(&hdr) : 0; cm; cm = CMSG_NXTHDR(&hdr, cm)) {
+      if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+        int segment_size = 0;
+        std::memcpy(&segment_size, CMSG_DATA(cm), sizeof segment_size);
+        segment_sizes[i] = static_cast<size_t>(segment_size);
+      }
+    }
+#endif
+    // A zero length is skipped by handle_batched_dds_input()
+    if (lengths[i] > 0
+        && forward_to_owner(static_cast<const char*>(iov[i].iov_base),
+                            static_cast<size_t>(lengths[i]), segment_sizes[i],
+                            remote_addresses[i])) {
+      lengths[i] = 0;
+    }
+  }
+
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, batch_stats_lock_, ret);
+  batch_stats_.add(ret);
+  return ret;
+#else
+  return TransportReceiveStrategy<RtpsTransportHeader, RtpsSampleHeader>::receive_datagrams(
+    iov, lengths, segment_sizes, remote_addresses, n, fd, stop);
+#endif
+}
+
+void
+RtpsUdpReceiveStrategy::datagram_received(const ACE_INET_Addr& remote_address)
+{
+  remote_address_ = remote_address;
+}
+
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+void
+RtpsUdpReceiveStrategy::enable_gro()
+{
+  if (!batch_receive_allowed()) {
+    return;
+  }
+
+  const int enable = 1;
+  if (shard_reactor_) {
+    if (shard_socket_.set_option(SOL_UDP, UDP_GRO, const_cast<int*>(&enable),
+                                 sizeof enable) != 0) {
+      ACE_ERROR((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: RtpsUdpReceiveStrategy::enable_gro: ")
+                 ACE_TEXT("failed to enable UDP_GRO on a receive shard: %m\n")));
+      return;
+    }
+    gro_enabled_ = true;
+    return;
+  }
+
+  if (link_->unicast_socket().set_option(SOL_UDP, UDP_GRO, const_cast<int*>(&enable),
+                                         sizeof enable) != 0) {
+    ACE_ERROR((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: RtpsUdpReceiveStrategy::enable_gro: ")
+               ACE_TEXT("failed to enable UDP_GRO: %m\n")));
+    return;
+  }
+#ifdef ACE_HAS_IPV6
+  if (link_->ipv6_unicast_socket().get_handle() != ACE_INVALID_HANDLE
+      && link_->ipv6_unicast_socket().set_option(SOL_UDP, UDP_GRO, const_cast<int*>(&enable),
+                                                 sizeof enable) != 0) {
+    ACE_ERROR((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: RtpsUdpReceiveStrategy::enable_gro: ")
+               ACE_TEXT("failed to enable UDP_GRO on the IPv6 socket: %m\n")));
+  }
+#endif
+  gro_enabled_ = true;
+}
+
+void
+RtpsUdpReceiveStrategy::disable_gro()
+{
+  gro_enabled_ = false;
+  if (shard_reactor_) {
+    disable_gro(shard_socket_);
+    return;
+  }
+  disable_gro(link_->unicast_socket());
+#ifdef ACE_HAS_IPV6
+  if (link_->ipv6_unicast_socket().get_handle() != ACE_INVALID_HANDLE) {
+    disable_gro(link_->ipv6_unicast_socket());
+  }
+#endif
+}
+
+void
+RtpsUdpReceiveStrategy::disable_gro(const ACE_SOCK_Dgram& socket)
+{
+  const int disable = 0;
+  if (socket.set_option(SOL_UDP, UDP_GRO, const_cast<int*>(&disable),
+                        sizeof disable) != 0) {
+    ACE_ERROR((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: RtpsUdpReceiveStrategy::disable_gro: ")
+               ACE_TEXT("failed to disable UDP_GRO: %m\n")));
+  }
+
+  // Datagrams queued before now may still be coalesced.  Take them without
+  // blocking and queue their segments for handle_forwarded_input(), which
+  // runs each one through the simple path.
+  char buffer[0x10000];
+  for (;;) {
+    iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = sizeof buffer;
+    sockaddr_storage address;
+    GroControl control;
+    msghdr hdr;
+    std::memset(&hdr, 0, sizeof hdr);
+    hdr.msg_name = &address;
+    hdr.msg_namelen = sizeof address;
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buffer_;
+    hdr.msg_controllen = sizeof control.buffer_;
+
+    const ssize_t length = recvmsg(socket.get_handle(), &hdr, MSG_DONTWAIT);
+    if (length < 0) {
+      break;
+    }
+    if (length == 0) {
+      continue;
+    }
+
+    size_t segment_size = 0;
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm; cm = CMSG_NXTHDR(&hdr, cm)) {
+      if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+        int size = 0;
+        std::memcpy(&size, CMSG_DATA(cm), sizeof size);
+        segment_size = static_cast<size_t>(size);
+      }
+    }
+
+    const ACE_INET_Addr remote_address(reinterpret_cast<sockaddr_in*>(&address),
+                                       static_cast<int>(hdr.msg_namelen));
+    if (!forward_to_owner(buffer, static_cast<size_t>(length), segment_size, remote_address)) {
+      forward(buffer, static_cast<size_t>(length), segment_size, remote_address);
+    }
+  }
+}
+#endif
+
+Stats<ssize_t>
+RtpsUdpReceiveStrategy::receive_batch_stats() const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, batch_stats_lock_, Stats<ssize_t>());
+  return batch_stats_;
+}
+
 ssize_t
 RtpsUdpReceiveStrategy::receive_bytes_helper(iovec iov[],
                                              int n,
@@ -133,6 +475,9 @@ namespace {
 const ACE_SOCK_Dgram&
 RtpsUdpReceiveStrategy::choose_recv_socket(ACE_HANDLE fd) const
 {
+  if (shard_reactor_) {
+    return shard_socket_;
+  }
 #ifdef ACE_HAS_IPV6
   if (fd == link_->ipv6_multicast_socket().get_handle()) {
     return link_->ipv6_multicast_socket();
@@ -154,23 +499,35 @@ RtpsUdpReceiveStrategy::receive_bytes(iovec iov[],
                                       ACE_HANDLE fd,
                                       bool& stop)
 {
-  const ACE_SOCK_Dgram& socket = choose_recv_socket(fd);
+  ssize_t ret = 0;
+  if (fd == ACE_INVALID_HANDLE) {
+    ret = receive_forwarded(iov, n, remote_address);
+  } else {
+    const ACE_SOCK_Dgram& socket = choose_recv_socket(fd);
 #ifdef ACE_LACKS_SENDMSG
-  ACE_UNUSED_ARG(stop);
-  char buffer[0x10000];
-  ssize_t scatter = socket.recv(buffer, sizeof buffer, remote_address);
-  char* iter = buffer;
-  for (int i = 0; scatter > 0 && i < n; ++i) {
-    const size_t chunk = std::min(static_cast<size_t>(iov[i].iov_len), // int on LynxOS
-                                  static_cast<size_t>(scatter));
-    std::memcpy(iov[i].iov_base, iter, chunk);
-    scatter -= chunk;
-    iter += chunk;
-  }
-  const ssize_t ret = (scatter < 0) ? scatter : (iter - buffer);
+    char buffer[0x10000];
+    ssize_t scatter = socket.recv(buffer, sizeof buffer, remote_address);
+    char* iter = buffer;
+    for (int i = 0; scatter > 0 && i < n; ++i) {
+      const size_t chunk = std::min(static_cast<size_t>(iov[i].iov_len), // int on LynxOS
+                                    static_cast<size_t>(scatter));
+      std::memcpy(iov[i].iov_base, iter, chunk);
+      scatter -= chunk;
+      iter += chunk;
+    }
+    ret = (scatter < 0) ? scatter : (iter - buffer);
 #else
-  const ssize_t ret = receive_bytes_helper(iov, n, socket, remote_address, link_->get_ice_endpoint(), stop);
+    ret = receive_bytes_helper(iov, n, socket, remote_address, link_->get_ice_endpoint(), stop);
 #endif
+
+    // Datagrams are forwarded as received, the owner decodes them
+    if (ret > 0 && !stop && n > 0 && static_cast<size_t>(ret) <= iov[0].iov_len
+        && forward_to_owner(static_cast<const char*>(iov[0].iov_base),
+                            static_cast<size_t>(ret), 0, remote_address)) {
+      stop = true;
+      return ret;
+    }
+  }
   remote_address_ = remote_address;
 
 #ifdef OPENDDS_SECURITY
@@ -737,7 +1094,7 @@ bool RtpsUdpReceiveStrategy::decode_payload(ReceivedDataSample& sample,
 int
 RtpsUdpReceiveStrategy::start_i()
 {
-  ACE_Reactor* reactor = link_->get_reactor();
+  ACE_Reactor* reactor = shard_reactor_ ? shard_reactor_ : link_->get_reactor();
   if (reactor == 0) {
     ACE_ERROR_RETURN((LM_ERROR,
                       ACE_TEXT("(%P|%t) ERROR: ")
@@ -746,6 +1103,26 @@ RtpsUdpReceiveStrategy::start_i()
                      -1);
   }
 
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+  if (link_->config().use_gro_) {
+    enable_gro();
+  }
+#endif
+
+  if (shard_reactor_) {
+    if (reactor->register_handler(shard_socket_.get_handle(), this,
+                                  ACE_Event_Handler::READ_MASK) != 0) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: ")
+                        ACE_TEXT("RtpsUdpReceiveStrategy::start_i: ")
+                        ACE_TEXT("failed to register handler for receive shard ")
+                        ACE_TEXT("socket %d\n"),
+                        shard_socket_.get_handle()),
+                       -1);
+    }
+    return 0;
+  }
+
 #ifdef ACE_WIN32
   // By default Winsock will cause reads to fail with "connection reset"
   // when UDP sends result in ICMP "port unreachable" messages.
@@ -786,7 +1163,20 @@ RtpsUdpReceiveStrategy::start_i()
 void
 RtpsUdpReceiveStrategy::stop_i()
 {
-  ACE_Reactor* reactor = link_->get_reactor();
+  if (Transport_debug_level > 0) {
+    const Stats<ssize_t> stats = receive_batch_stats();
+    if (stats.n()) {
+      ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) RtpsUdpReceiveStrategy::stop_i: ")
+                 ACE_TEXT("%u batched receive calls, datagrams per call ")
+                 ACE_TEXT("min %d max %d mean %f\n"),
+                 static_cast<unsigned int>(stats.n()),
+                 static_cast<int>(stats.minimum()),
+                 static_cast<int>(stats.maximum()),
+                 static_cast<double>(stats.mean())));
+    }
+  }
+
+  ACE_Reactor* reactor = shard_reactor_ ? shard_reactor_ : link_->get_reactor();
   if (reactor == 0) {
     ACE_ERROR((LM_ERROR,
                ACE_TEXT("(%P|%t) ERROR: ")
@@ -795,6 +1185,14 @@ RtpsUdpReceiveStrategy::stop_i()
     return;
   }
 
+  reactor->purge_pending_notifications(this, ACE_Event_Handler::READ_MASK);
+
+  if (shard_reactor_) {
+    reactor->remove_handler(shard_socket_.get_handle(),
+                            ACE_Event_Handler::READ_MASK);
+    return;
+  }
+
   reactor->remove_handler(link_->unicast_socket().get_handle(),
                           ACE_Event_Handler::READ_MASK);
 
@@ -843,6 +1241,8 @@ RtpsUdpReceiveStrategy::check_header(const RtpsSampleHeader& header)
     frags_.first = rtps.fragmentStartingNum.value;
     frags_.second = frags_.first + (rtps.fragmentsInSubmessage - 1);
     total_frags_ = (rtps.sampleSize / rtps.fragmentSize) + (rtps.sampleSize % rtps.fragmentSize ? 1 : 0);
+    frag_size_ = rtps.fragmentSize;
+    sample_size_ = rtps.sampleSize;
   }
 
   return header.valid();
@@ -878,7 +1278,13 @@ RtpsUdpReceiveStrategy::reassemble(ReceivedDataSample& data)
 {
   using namespace RTPS;
   receiver_.fill_header(data.header_); // set publication_id_.guidPrefix
-  if (link_->is_target(data.header_.publication_id_) && reassembly_.reassemble(frags_, data, total_frags_)) {
+  bool complete = false;
+  if (link_->is_target(data.header_.publication_id_)) {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, g, reassembly_lock_, false);
+    complete = reassembly_.reassemble(frags_, data, total_frags_, frag_size_, sample_size_);
+  }
+
+  if (complete) {
 
     // Reassembly was successful, replace DataFrag with Data.  This doesn't have
     // to be a fully-formed DataSubmessage, just enough for this class to use
@@ -908,6 +1314,7 @@ RtpsUdpReceiveStrategy::remove_frags_from_bitmap(CORBA::Long bitmap[],
                                                  const SequenceNumber& base,
                                                  const RepoId& pub_id)
 {
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, reassembly_lock_, false);
   bool modified = false;
   for (CORBA::ULong i = 0, x = 0, bit = 0; i < num_bits; ++i, ++bit) {
     if (bit == 32) bit = 0;
@@ -939,6 +1346,7 @@ void
 RtpsUdpReceiveStrategy::remove_fragments(const SequenceRange& range,
                                          const RepoId& pub_id)
 {
+  ACE_GUARD(ACE_Thread_Mutex, g, reassembly_lock_);
   for (SequenceNumber sn = range.first; sn <= range.second; ++sn) {
     reassembly_.data_unavailable(sn, pub_id);
   }
@@ -947,6 +1355,7 @@ RtpsUdpReceiveStrategy::remove_fragments(const SequenceRange& range,
 void
 RtpsUdpReceiveStrategy::clear_completed_fragments(const RepoId& pub_id)
 {
+  ACE_GUARD(ACE_Thread_Mutex, g, reassembly_lock_);
   reassembly_.clear_completed(pub_id);
 }
 
@@ -955,6 +1364,7 @@ RtpsUdpReceiveStrategy::has_fragments(const SequenceRange& range,
                                       const RepoId& pub_id,
                                       FragmentInfo* frag_info)
 {
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, reassembly_lock_, false);
   for (SequenceNumber sn = range.first; sn <= range.second; ++sn) {
     if (reassembly_.has_frags(sn, pub_id)) {
       if (frag_info) {
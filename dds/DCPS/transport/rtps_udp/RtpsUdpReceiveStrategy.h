@@ -16,12 +16,23 @@
 
 #include "dds/DCPS/RTPS/RtpsCoreC.h"
 #include "dds/DCPS/RcEventHandler.h"
+#include "dds/DCPS/Stats_T.h"
 
 #include "ace/INET_Addr.h"
 #include "ace/SOCK_Dgram.h"
+#include "ace/Thread_Mutex.h"
 
 #include <cstring>
 
+#if defined ACE_LINUX && !defined ACE_LACKS_SENDMSG
+#  define OPENDDS_RTPS_UDP_HAS_RECVMMSG
+#  include <sys/socket.h>
+#  include <netinet/udp.h>
+#  ifdef UDP_GRO
+#    define OPENDDS_RTPS_UDP_HAS_GRO
+#  endif
+#endif
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -40,10 +51,23 @@ class OpenDDS_Rtps_Udp_Export RtpsUdpReceiveStrategy
     public RcEventHandler
 {
 public:
-  explicit RtpsUdpReceiveStrategy(RtpsUdpDataLink* link, const GuidPrefix_t& local_prefix);
+  /// With a valid "shard_handle" this strategy serves one of the link's
+  /// SO_REUSEPORT receive shards: it reads only from that socket and is
+  /// registered with "shard_reactor" instead of the link's reactor.
+  explicit RtpsUdpReceiveStrategy(RtpsUdpDataLink* link, const GuidPrefix_t& local_prefix,
+                                  ACE_HANDLE shard_handle = ACE_INVALID_HANDLE,
+                                  ACE_Reactor* shard_reactor = 0);
+  ~RtpsUdpReceiveStrategy();
 
   virtual int handle_input(ACE_HANDLE fd);
 
+  /// Queue the datagram(s) in "data", received by another strategy from a
+  /// participant this one owns (see RtpsUdpDataLink::receive_owner()), to
+  /// be processed on this strategy's thread.  A non-zero "segment_size"
+  /// splits coalesced datagrams.
+  void forward(const char* data, size_t length, size_t segment_size,
+               const ACE_INET_Addr& remote_address);
+
   /// For each "1" bit in the bitmap, change it to a "0" if there are
   /// fragments from publication "pub_id" for the sequence number represented
   /// by that position in the bitmap.
@@ -75,17 +99,57 @@ public:
                                       ICE::Endpoint* endpoint,
                                       bool& stop);
 
+  /// Number of datagrams returned by each batched receive call.
+  Stats<ssize_t> receive_batch_stats() const;
+
 private:
   bool getDirectedWriteReaders(RepoIdSet& directedWriteReaders, const RTPS::DataSubmessage& ds) const;
 
   const ACE_SOCK_Dgram& choose_recv_socket(ACE_HANDLE fd) const;
 
+  /// Forward the datagram(s) in "data" if another strategy owns their
+  /// source, returns false if they are this strategy's to process.
+  bool forward_to_owner(const char* data, size_t length, size_t segment_size,
+                        const ACE_INET_Addr& remote_address);
+
+  /// Process what forward() queued, on a reactor notification.
+  int handle_forwarded_input();
+
+  /// receive_bytes() for the forwarded datagram being processed.
+  ssize_t receive_forwarded(iovec iov[], int n, ACE_INET_Addr& remote_address);
+
+  /// Batched receive can't be used when each datagram may need to be
+  /// inspected for STUN or decoded by the security plugin before parsing.
+  bool batch_receive_allowed() const;
+
   virtual ssize_t receive_bytes(iovec iov[],
                                 int n,
                                 ACE_INET_Addr& remote_address,
                                 ACE_HANDLE fd,
                                 bool& stop);
 
+  virtual int receive_datagrams(iovec iov[],
+                                ssize_t lengths[],
+                                size_t segment_sizes[],
+                                ACE_INET_Addr remote_addresses[],
+                                int n,
+                                ACE_HANDLE fd,
+                                bool& stop);
+
+  virtual void datagram_received(const ACE_INET_Addr& remote_address);
+
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+  /// Ask the kernel to coalesce received datagrams (UDP_GRO) on the
+  /// unicast sockets.  Coalesced datagrams are split again in
+  /// TransportReceiveStrategy::process_simple_dds_input.
+  void enable_gro();
+
+  /// Stop UDP_GRO once batch_receive_allowed() no longer holds, splitting
+  /// the datagrams that were coalesced before then.
+  void disable_gro();
+  void disable_gro(const ACE_SOCK_Dgram& socket);
+#endif
+
   virtual void deliver_sample(ReceivedDataSample& sample,
                               const ACE_INET_Addr& remote_address);
 
@@ -121,6 +185,11 @@ private:
 
   SequenceRange frags_;
   ACE_UINT32 total_frags_;
+  ACE_UINT32 frag_size_;
+  ACE_UINT32 sample_size_;
+  /// The link queries fragments from threads other than the one
+  /// receiving into this strategy.
+  mutable ACE_Thread_Mutex reassembly_lock_;
   TransportReassembly reassembly_;
 
   struct MessageReceiver {
@@ -152,6 +221,31 @@ private:
   MessageReceiver receiver_;
   ACE_INET_Addr remote_address_;
 
+#ifdef OPENDDS_RTPS_UDP_HAS_RECVMMSG
+  OPENDDS_VECTOR(mmsghdr) batch_headers_;
+  OPENDDS_VECTOR(sockaddr_storage) batch_addresses_;
+#endif
+#ifdef OPENDDS_RTPS_UDP_HAS_GRO
+  struct GroControl {
+    char buffer_[CMSG_SPACE(sizeof(int))];
+  };
+  OPENDDS_VECTOR(GroControl) batch_controls_;
+#endif
+  bool gro_enabled_;
+  ACE_SOCK_Dgram shard_socket_;
+  ACE_Reactor* const shard_reactor_;
+
+  struct ForwardedDatagram {
+    ACE_Message_Block* data_;
+    ACE_INET_Addr remote_address_;
+  };
+  typedef OPENDDS_VECTOR(ForwardedDatagram) ForwardedDatagrams;
+  ACE_Thread_Mutex forwarded_lock_;
+  ForwardedDatagrams forwarded_;
+  const ForwardedDatagram* current_forwarded_;
+  mutable ACE_Thread_Mutex batch_stats_lock_;
+  Stats<ssize_t> batch_stats_;
+
 #ifdef OPENDDS_SECURITY
   RTPS::SecuritySubmessage secure_prefix_;
   OPENDDS_VECTOR(RTPS::Submessage) secure_submessages_;
@@ -21,11 +21,14 @@
 
 #include "dds/DdsDcpsGuidTypeSupportImpl.h"
 
+#include "ace/OS_NS_sys_socket.h"
+
 #ifdef OPENDDS_SECURITY
 #include "dds/DCPS/RTPS/SecurityHelpers.h"
 #include <vector>
 #endif
 
+#include <algorithm>
 #include <cstring>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -47,6 +50,13 @@ RtpsUdpSendStrategy::RtpsUdpSendStrategy(RtpsUdpDataLink* link,
                     rtps_header_data_, 0, 0, ACE_Message_Block::DONT_DELETE, 0),
     rtps_header_mb_(&rtps_header_db_, ACE_Message_Block::DONT_DELETE),
     network_is_unreachable_(false)
+#ifdef OPENDDS_RTPS_UDP_HAS_GSO
+    , use_gso_(link->config().use_gso_)
+    , gso_buffer_(use_gso_ ? UDP_MAX_MESSAGE_SIZE : 0)
+    , gso_segment_size_(0)
+    , gso_segments_(0)
+    , gso_send_errors_(0)
+#endif
 {
   std::memcpy(rtps_header_.prefix, RTPS::PROTOCOL_RTPS, sizeof RTPS::PROTOCOL_RTPS);
   rtps_header_.version = OpenDDS::RTPS::PROTOCOLVERSION;
@@ -68,6 +78,15 @@ namespace {
 ssize_t
 RtpsUdpSendStrategy::send_bytes_i(const iovec iov[], int n)
 {
+#ifdef OPENDDS_RTPS_UDP_HAS_GSO
+  if (use_gso_) {
+    ssize_t coalesced = 0;
+    if (coalesce_fragment(iov, n, coalesced)) {
+      return coalesced;
+    }
+  }
+#endif
+
   ssize_t result = send_bytes_i_helper(iov, n);
 
   if (result == -1 && shouldWarn(errno)) {
@@ -95,28 +114,209 @@ RtpsUdpSendStrategy::send_bytes_i_helper(const iovec iov[], int n)
     return send_multi_i(iov, n, *override_dest_);
   }
 
+  OPENDDS_SET(ACE_INET_Addr) addrs;
+  if (!current_destinations(addrs)) {
+    errno = ENOTCONN;
+    return -1;
+  }
+
+  return send_multi_i(iov, n, addrs);
+}
+
+bool
+RtpsUdpSendStrategy::current_destinations(OPENDDS_SET(ACE_INET_Addr)& addrs)
+{
   // determine destination address(es) from TransportQueueElement in progress
   TransportQueueElement* elem = current_packet_first_element();
   if (!elem) {
-    errno = ENOTCONN;
-    return -1;
+    return false;
   }
 
-  OPENDDS_SET(ACE_INET_Addr) addrs;
   if (elem->subscription_id() != GUID_UNKNOWN) {
     addrs = link_->get_addresses(elem->publication_id(), elem->subscription_id());
   } else {
     addrs = link_->get_addresses(elem->publication_id());
   }
 
-  if (addrs.empty()) {
-    errno = ENOTCONN;
-    return -1;
+  return !addrs.empty();
+}
+
+void
+RtpsUdpSendStrategy::flush_coalesced_i()
+{
+#ifdef OPENDDS_RTPS_UDP_HAS_GSO
+  // The fragments of the run were reported as sent, so all that's left to
+  // do on failure is to log it.  Reliable writers resend them when nacked.
+  if (flush_gso_run() < 0) {
+    ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: RtpsUdpSendStrategy::flush_coalesced_i() - "
+               "coalesced fragments didn't reach any destination: %m, "
+               "%B such runs so far\n", gso_send_errors_));
   }
+#endif
+}
 
-  return send_multi_i(iov, n, addrs);
+#ifdef OPENDDS_RTPS_UDP_HAS_GSO
+bool
+RtpsUdpSendStrategy::coalesce_fragment(const iovec iov[], int n, ssize_t& result)
+{
+  TransportQueueElement* const elem = current_packet_first_element();
+  OPENDDS_SET(ACE_INET_Addr) addrs;
+  if (override_single_dest_ || override_dest_ || link_->config().rtps_relay_only_
+      || !elem || !elem->is_fragment() || !current_destinations(addrs)) {
+    // Sent on its own, unless ending the run failed it
+    return !flush_gso_run_for_send(result);
+  }
+
+  size_t size = 0;
+  for (int i = 0; i < n; ++i) {
+    size += iov[i].iov_len;
+  }
+
+  if (gso_segments_ && (addrs != gso_addrs_ || size > gso_segment_size_
+                        || size > gso_buffer_.space()
+                        || gso_segments_ == MAX_GSO_SEGMENTS)
+      && !flush_gso_run_for_send(result)) {
+    return true;
+  }
+
+  if (size > gso_buffer_.space()) {
+    return false;
+  }
+
+  if (gso_segments_ == 0) {
+    gso_segment_size_ = size;
+    gso_addrs_.swap(addrs);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    gso_buffer_.copy(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  ++gso_segments_;
+
+  // Only the last segment of a GSO send may be shorter than the rest.
+  if (size < gso_segment_size_ && !flush_gso_run_for_send(result)) {
+    return true;
+  }
+
+  result = static_cast<ssize_t>(size);
+  return true;
+}
+
+bool
+RtpsUdpSendStrategy::flush_gso_run_for_send(ssize_t& result)
+{
+  if (flush_gso_run() < 0 && !shouldWarn(errno)) {
+    // Fail the current send like send_bytes_i() would have failed it
+    result = -1;
+    return false;
+  }
+  return true;
 }
 
+ssize_t
+RtpsUdpSendStrategy::flush_gso_run()
+{
+  if (gso_segments_ == 0) {
+    return 0;
+  }
+
+  iovec iov;
+  iov.iov_base = gso_buffer_.rd_ptr();
+  iov.iov_len = gso_buffer_.length();
+
+  // Like send_multi_i(), the run is sent if it reached any destination.
+  ssize_t result = -1;
+  int err = 0;
+  typedef OPENDDS_SET(ACE_INET_Addr)::const_iterator iter_t;
+  for (iter_t iter = gso_addrs_.begin(); iter != gso_addrs_.end(); ++iter) {
+    const ssize_t result_per_dest = gso_segments_ == 1
+      ? send_single_i(&iov, 1, *iter) : send_gso_i(iov, *iter);
+    if (result_per_dest >= 0) {
+      result = result_per_dest;
+    } else {
+      err = errno;
+    }
+  }
+
+  gso_buffer_.reset();
+  gso_segments_ = 0;
+  gso_segment_size_ = 0;
+  gso_addrs_.clear();
+
+  if (result < 0) {
+    ++gso_send_errors_;
+    errno = err;
+  }
+  return result;
+}
+
+ssize_t
+RtpsUdpSendStrategy::send_gso_i(const iovec& iov, const ACE_INET_Addr& addr)
+{
+  const ACE_SOCK_Dgram& socket = choose_send_socket(addr);
+
+  char control[CMSG_SPACE(sizeof(ACE_UINT16))] = {};
+  msghdr hdr;
+  std::memset(&hdr, 0, sizeof hdr);
+  hdr.msg_name = addr.get_addr();
+  hdr.msg_namelen = addr.get_size();
+  hdr.msg_iov = const_cast<iovec*>(&iov);
+  hdr.msg_iovlen = 1;
+  hdr.msg_control = control;
+  hdr.msg_controllen = sizeof control;
+
+  cmsghdr* const cm = CMSG_FIRSTHDR(&hdr);
+  cm->cmsg_level = SOL_UDP;
+  cm->cmsg_type = UDP_SEGMENT;
+  cm->cmsg_len = CMSG_LEN(sizeof(ACE_UINT16));
+  const ACE_UINT16 segment_size = static_cast<ACE_UINT16>(gso_segment_size_);
+  std::memcpy(CMSG_DATA(cm), &segment_size, sizeof segment_size);
+
+  const ssize_t result = ACE_OS::sendmsg(socket.get_handle(), &hdr, 0);
+  if (result >= 0) {
+    network_is_unreachable_ = false;
+    return result;
+  }
+
+  // The kernel or the egress device can't segment this datagram, stop
+  // using GSO and send the segments one at a time.
+  if (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT) {
+    if (use_gso_) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: RtpsUdpSendStrategy::send_gso_i() - "
+                 "UDP segmentation offload failed: %m, disabling use_gso\n"));
+      use_gso_ = false;
+    }
+    ssize_t sent = -1;
+    const char* const base = static_cast<const char*>(iov.iov_base);
+    for (size_t offset = 0; offset < iov.iov_len; offset += gso_segment_size_) {
+      iovec segment;
+      segment.iov_base = const_cast<char*>(base + offset);
+      segment.iov_len = std::min(gso_segment_size_, iov.iov_len - offset);
+      const ssize_t ret = send_single_i(&segment, 1, addr);
+      if (ret >= 0) {
+        sent = ret;
+      }
+    }
+    return sent;
+  }
+
+  const int err = errno;
+  if (err != ENETUNREACH || !network_is_unreachable_) {
+    ACE_TCHAR addr_buff[256] = {};
+    addr.addr_to_string(addr_buff, 256);
+    errno = err;
+    const ACE_Log_Priority prio = shouldWarn(errno) ? LM_WARNING : LM_ERROR;
+    ACE_ERROR((prio, "(%P|%t) RtpsUdpSendStrategy::send_gso_i() - "
+               "destination %s failed send: %m\n", addr_buff));
+  }
+  if (err == ENETUNREACH) {
+    network_is_unreachable_ = true;
+  }
+  errno = err;
+  return result;
+}
+#endif
+
 RtpsUdpSendStrategy::OverrideToken
 RtpsUdpSendStrategy::override_destinations(const ACE_INET_Addr& destination)
 {
@@ -214,6 +414,12 @@ ssize_t
 RtpsUdpSendStrategy::send_multi_i(const iovec iov[], int n,
                                   const OPENDDS_SET(ACE_INET_Addr)& addrs)
 {
+#ifdef OPENDDS_RTPS_UDP_HAS_SENDMMSG
+  if (addrs.size() > 1 && !link_->config().rtps_relay_only_) {
+    return send_multi_batched_i(iov, n, addrs);
+  }
+#endif
+
   ssize_t result = -1;
   typedef OPENDDS_SET(ACE_INET_Addr)::const_iterator iter_t;
   for (iter_t iter = addrs.begin(); iter != addrs.end(); ++iter) {
@@ -225,6 +431,76 @@ RtpsUdpSendStrategy::send_multi_i(const iovec iov[], int n,
   return result;
 }
 
+#ifdef OPENDDS_RTPS_UDP_HAS_SENDMMSG
+ssize_t
+RtpsUdpSendStrategy::send_multi_batched_i(const iovec iov[], int n,
+                                          const OPENDDS_SET(ACE_INET_Addr)& addrs)
+{
+  AddrPtrVec ipv4;
+#ifdef ACE_HAS_IPV6
+  AddrPtrVec ipv6;
+#endif
+  typedef OPENDDS_SET(ACE_INET_Addr)::const_iterator iter_t;
+  for (iter_t iter = addrs.begin(); iter != addrs.end(); ++iter) {
+#ifdef ACE_HAS_IPV6
+    if (iter->get_type() == AF_INET6) {
+      ipv6.push_back(&*iter);
+      continue;
+    }
+#endif
+    ipv4.push_back(&*iter);
+  }
+
+  ssize_t result = -1;
+  send_mmsg_i(link_->unicast_socket(), iov, n, ipv4, result);
+#ifdef ACE_HAS_IPV6
+  send_mmsg_i(link_->ipv6_unicast_socket(), iov, n, ipv6, result);
+#endif
+  return result;
+}
+
+void
+RtpsUdpSendStrategy::send_mmsg_i(const ACE_SOCK_Dgram& socket,
+                                 const iovec iov[], int n,
+                                 const AddrPtrVec& addrs, ssize_t& result)
+{
+  static const size_t MAX_MMSG = 64;
+  mmsghdr headers[MAX_MMSG];
+
+  size_t sent = 0;
+  while (sent < addrs.size()) {
+    const size_t count = std::min(addrs.size() - sent, MAX_MMSG);
+    for (size_t i = 0; i < count; ++i) {
+      std::memset(&headers[i], 0, sizeof(mmsghdr));
+      msghdr& hdr = headers[i].msg_hdr;
+      hdr.msg_name = addrs[sent + i]->get_addr();
+      hdr.msg_namelen = addrs[sent + i]->get_size();
+      // The kernel only reads the iovec array, which is shared by every
+      // destination.
+      hdr.msg_iov = const_cast<iovec*>(iov);
+      hdr.msg_iovlen = n;
+    }
+
+    const int ret = sendmmsg(socket.get_handle(), headers,
+                             static_cast<unsigned int>(count), 0);
+    if (ret > 0) {
+      result = headers[ret - 1].msg_len;
+      network_is_unreachable_ = false;
+      sent += ret;
+    } else {
+      // sendmmsg stops at the first destination that fails.  Retry that one
+      // through send_single_i so the error is logged and tracked as usual,
+      // then carry on with the rest of the fan-out.
+      const ssize_t result_per_dest = send_single_i(iov, n, *addrs[sent]);
+      if (result_per_dest >= 0) {
+        result = result_per_dest;
+      }
+      ++sent;
+    }
+  }
+}
+#endif
+
 const ACE_SOCK_Dgram&
 RtpsUdpSendStrategy::choose_send_socket(const ACE_INET_Addr& addr) const
 {
@@ -711,6 +987,7 @@ RtpsUdpSendStrategy::replace_chunks(const ACE_Message_Block* plain,
 void
 RtpsUdpSendStrategy::stop_i()
 {
+  flush_coalesced_i();
 }
 
 } // namespace DCPS
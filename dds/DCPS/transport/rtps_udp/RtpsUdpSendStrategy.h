@@ -21,6 +21,15 @@
 #include "ace/INET_Addr.h"
 #include "ace/SOCK_Dgram.h"
 
+#if defined ACE_LINUX && !defined ACE_LACKS_SENDMSG
+#  define OPENDDS_RTPS_UDP_HAS_SENDMMSG
+#  include <sys/socket.h>
+#  include <netinet/udp.h>
+#  ifdef UDP_SEGMENT
+#    define OPENDDS_RTPS_UDP_HAS_GSO
+#  endif
+#endif
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -70,14 +79,48 @@ protected:
 
   virtual void add_delayed_notification(TransportQueueElement* element);
 
+  virtual void flush_coalesced_i();
+
 private:
   bool marshal_transport_header(ACE_Message_Block* mb);
+  bool current_destinations(OPENDDS_SET(ACE_INET_Addr)& addrs);
   ssize_t send_multi_i(const iovec iov[], int n,
                        const OPENDDS_SET(ACE_INET_Addr)& addrs);
   const ACE_SOCK_Dgram& choose_send_socket(const ACE_INET_Addr& addr) const;
   ssize_t send_single_i(const iovec iov[], int n,
                         const ACE_INET_Addr& addr);
 
+#ifdef OPENDDS_RTPS_UDP_HAS_SENDMMSG
+  typedef OPENDDS_VECTOR(const ACE_INET_Addr*) AddrPtrVec;
+
+  /// Send the same datagram to every address using as few sendmmsg calls
+  /// as possible.  Returns the same value send_multi_i's loop would.
+  ssize_t send_multi_batched_i(const iovec iov[], int n,
+                               const OPENDDS_SET(ACE_INET_Addr)& addrs);
+  void send_mmsg_i(const ACE_SOCK_Dgram& socket, const iovec iov[], int n,
+                   const AddrPtrVec& addrs, ssize_t& result);
+#endif
+
+#ifdef OPENDDS_RTPS_UDP_HAS_GSO
+  /// Maximum number of segments the kernel accepts in one GSO send.
+  static const size_t MAX_GSO_SEGMENTS = 64;
+
+  /// If the current packet is a fragment, append it to the pending run of
+  /// equal-size fragment datagrams and return true.  The run is sent with
+  /// one UDP_SEGMENT send per destination once it ends.
+  bool coalesce_fragment(const iovec iov[], int n, ssize_t& result);
+
+  /// Send the pending run.  Returns -1, with errno set, if it didn't reach
+  /// any destination.
+  ssize_t flush_gso_run();
+
+  /// flush_gso_run() ahead of or as part of sending the current packet.
+  /// Returns false, with "result" set to -1, if the failure has to be
+  /// reported as the current packet's.
+  bool flush_gso_run_for_send(ssize_t& result);
+  ssize_t send_gso_i(const iovec& iov, const ACE_INET_Addr& addr);
+#endif
+
 #ifdef OPENDDS_SECURITY
   ACE_Message_Block* pre_send_packet(const ACE_Message_Block* plain);
 
@@ -122,6 +165,16 @@ private:
   ACE_Data_Block rtps_header_db_;
   ACE_Message_Block rtps_header_mb_;
   bool network_is_unreachable_;
+
+#ifdef OPENDDS_RTPS_UDP_HAS_GSO
+  bool use_gso_;
+  ACE_Message_Block gso_buffer_;
+  size_t gso_segment_size_;
+  size_t gso_segments_;
+  OPENDDS_SET(ACE_INET_Addr) gso_addrs_;
+  /// Runs that didn't reach any destination.
+  size_t gso_send_errors_;
+#endif
 };
 
 } // namespace DCPS
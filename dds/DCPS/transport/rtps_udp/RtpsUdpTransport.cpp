@@ -95,6 +95,7 @@ RtpsUdpTransport::make_datalink(const GuidPrefix_t& local_prefix)
 #ifdef ACE_HAS_IPV6
                   , ipv6_unicast_socket_
 #endif
+                  , receive_shard_socket_
                   )) {
 #ifdef ACE_HAS_IPV6
     const ACE_HANDLE v6handle = ipv6_unicast_socket_.get_handle();
@@ -115,6 +116,7 @@ RtpsUdpTransport::make_datalink(const GuidPrefix_t& local_prefix)
 #ifdef ACE_HAS_IPV6
   ipv6_unicast_socket_.set_handle(ACE_INVALID_HANDLE);
 #endif
+  receive_shard_socket_.set_handle(ACE_INVALID_HANDLE);
 
   return link;
 }
@@ -380,6 +382,22 @@ RtpsUdpTransport::configure_i(RtpsUdpInst& config)
 
   ACE_INET_Addr address = config.local_address();
 
+  if (RtpsUdpDataLink::sharded_receive(config)) {
+    // The receive shards take the configured address, the unicast socket
+    // sends from an ephemeral port of its own, outside of their
+    // SO_REUSEPORT group (see RtpsUdpInst::receive_threads_).
+    if (!RtpsUdpDataLink::open_unicast_socket(receive_shard_socket_, address, PF_INET, true)
+        || receive_shard_socket_.get_local_addr(address) != 0) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: ")
+                        ACE_TEXT("RtpsUdpTransport::configure_i: receive shard open:")
+                        ACE_TEXT("%m\n")),
+                       false);
+    }
+    config.local_address(address);
+    address.set_port_number(0);
+  }
+
   if (unicast_socket_.open(address, PF_INET) != 0) {
     ACE_ERROR_RETURN((LM_ERROR,
                       ACE_TEXT("(%P|%t) ERROR: ")
@@ -396,7 +414,9 @@ RtpsUdpTransport::configure_i(RtpsUdpInst& config)
                      false);
   }
 
-  config.local_address(address);
+  if (receive_shard_socket_.get_handle() == ACE_INVALID_HANDLE) {
+    config.local_address(address);
+  }
 
 #ifdef ACE_RECVPKTINFO
   int sockopt = 1;
@@ -124,6 +124,9 @@ private:
 #ifdef ACE_HAS_IPV6
   ACE_SOCK_Dgram ipv6_unicast_socket_;
 #endif
+  /// With sharded receive, the first receive shard socket.  It is bound
+  /// here so that connection_info_i() knows its port.
+  ACE_SOCK_Dgram receive_shard_socket_;
   TransportClient_wrch default_listener_;
 
 #if defined(OPENDDS_SECURITY)
@@ -48,6 +48,7 @@ BE_GlobalData::BE_GlobalData()
   , generate_itl_(false)
   , generate_v8_(false)
   , generate_rapidjson_(false)
+  , generate_view_(false)
   , face_ts_(false)
   , seq_("Seq")
   , language_mapping_(LANGMAP_NONE)
@@ -227,6 +228,16 @@ bool BE_GlobalData::rapidjson() const
   return this->generate_rapidjson_;
 }
 
+void BE_GlobalData::view(bool b)
+{
+  this->generate_view_ = b;
+}
+
+bool BE_GlobalData::view() const
+{
+  return this->generate_view_;
+}
+
 void BE_GlobalData::face_ts(bool b)
 {
   this->face_ts_ = b;
@@ -351,6 +362,8 @@ BE_GlobalData::parse_args(long& i, char** av)
       be_global->v8(true);
     } else if (0 == ACE_OS::strcasecmp(av[i], "-Grapidjson")) {
       be_global->rapidjson(true);
+    } else if (0 == ACE_OS::strcasecmp(av[i], "-Gview")) {
+      be_global->view(true);
     } else {
       invalid_option(av[i]);
     }
@@ -114,6 +114,7 @@ be_util::usage()
     ACE_TEXT("\t\t\t\t-Wb,v8 is an alternative form for this option\n")
     ACE_TEXT(" -Grapidjson\t\tgenerate TypeSupport for converting data samples ")
     ACE_TEXT("to RapidJSON JavaScript objects\n")
+    ACE_TEXT(" -Gview\t\t\tgenerate read-only views of serialized data samples\n")
     ACE_TEXT(" --[no-]default-nested\tTopic types must be declared. True by default.\n")
     ACE_TEXT(" --no-dcps-data-type-warnings\t\tdon't warn about #pragma DCPS_DATA_TYPE\n")
     ACE_TEXT(" -Wb,export_macro=<macro name>\t\tsets export macro ")
@@ -240,3 +240,80 @@ NestedForLoops::~NestedForLoops()
     be_global->impl_ << indent_ << "}\n";
   }
 }
+
+AST_Type* find_type(AST_Structure* struct_node, const string& key)
+{
+  string key_base = key;   // the field we are looking for here
+  string key_rem;          // the sub-field we will look for recursively
+  bool is_array = false;
+  size_t pos = key.find_first_of(".[");
+  if (pos != string::npos) {
+    key_base = key.substr(0, pos);
+    if (key[pos] == '[') {
+      is_array = true;
+      size_t l_brack = key.find("]");
+      if (l_brack == string::npos) {
+        throw string("Missing right bracket");
+      } else if (l_brack != key.length()) {
+        key_rem = key.substr(l_brack+1);
+      }
+    } else {
+      key_rem = key.substr(pos+1);
+    }
+  }
+
+  const Fields fields(struct_node);
+  const Fields::Iterator fields_end = fields.end();
+  for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+    AST_Field* field = *i;
+    if (key_base == field->local_name()->get_string()) {
+      AST_Type* field_type = AstTypeClassification::resolveActualType(field->field_type());
+      if (!is_array && key_rem.empty()) {
+        // The requested key field matches this one.  We do not allow
+        // arrays (must be indexed specifically) or structs (must
+        // identify specific sub-fields).
+        AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
+        if (sub_struct != 0) {
+          throw string("Structs not allowed as keys");
+        }
+        AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
+        if (array_node != 0) {
+          throw string("Arrays not allowed as keys");
+        }
+        return field_type;
+      } else if (is_array) {
+        // must be a typedef of an array
+        AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
+        if (array_node == 0) {
+          throw string("Indexing for non-array type");
+        }
+        if (array_node->n_dims() > 1) {
+          throw string("Only single dimension arrays allowed in keys");
+        }
+        if (key_rem == "") {
+          return array_node->base_type();
+        } else {
+          // This must be a struct...
+          if ((key_rem[0] != '.') || (key_rem.length() == 1)) {
+            throw string("Unexpected characters after array index");
+          } else {
+            // Set up key_rem and field_type and let things fall into
+            // the struct code below
+            key_rem = key_rem.substr(1);
+            field_type = array_node->base_type();
+          }
+        }
+      }
+
+      // nested structures
+      AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
+      if (sub_struct == 0) {
+        throw string("Expected structure field for ") + key_base;
+      }
+
+      // find type of nested struct field
+      return find_type(sub_struct, key_rem);
+    }
+  }
+  throw string("Field not found.");
+}
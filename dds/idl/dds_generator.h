@@ -801,4 +801,10 @@ private:
   AST_Structure* node_;
 };
 
+/// Looks through the fields of a struct for the key specified and returns
+/// the AST_Type associated with that key.  Because the key name can contain
+/// indexed arrays and nested structures, things can get interesting.
+/// Throws a std::string describing the problem if the key is invalid.
+AST_Type* find_type(AST_Structure* struct_node, const std::string& key);
+
 #endif
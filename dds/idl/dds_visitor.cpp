@@ -14,6 +14,7 @@
 #include "itl_generator.h"
 #include "v8_generator.h"
 #include "rapidjson_generator.h"
+#include "view_generator.h"
 #include "langmap_generator.h"
 #include "topic_keys.h"
 
@@ -61,6 +62,7 @@ namespace {
   itl_generator itl_gen_;
   v8_generator v8_gen_;
   rapidjson_generator rj_gen_;
+  view_generator view_gen_;
   langmap_generator lm_gen_;
 
   template <typename T>
@@ -106,6 +108,9 @@ dds_visitor::dds_visitor(AST_Decl* scope, bool java_ts_only)
   if (be_global->rapidjson()) {
     gen_target_.add_generator(&rj_gen_);
   }
+  if (be_global->view()) {
+    gen_target_.add_generator(&view_gen_);
+  }
   if (be_global->language_mapping() != BE_GlobalData::LANGMAP_NONE) {
     gen_target_.add_generator(&lm_gen_);
     lm_gen_.init();
@@ -12,7 +12,10 @@
 #include "utl_identifier.h"
 
 #include <string>
+#include <vector>
+
 using std::string;
+using namespace AstTypeClassification;
 
 struct KeyLessThanWrapper {
   size_t n_;
@@ -79,6 +82,86 @@ struct KeyLessThanWrapper {
   }
 };
 
+struct KeyHashWrapper {
+  size_t n_;
+  const string cxx_name_;
+
+  explicit KeyHashWrapper(UTL_ScopedName* name)
+    : n_(0)
+    , cxx_name_(scoped(name))
+  {
+    be_global->add_include("dds/DCPS/KeyHash.h");
+    be_global->header_ << be_global->versioning_begin() << "\n";
+
+    for (UTL_ScopedName* sn = name; sn && sn->tail();
+        sn = static_cast<UTL_ScopedName*>(sn->tail())) {
+      const string str = sn->head()->get_string();
+      if (!str.empty()) {
+        be_global->header_ << "namespace " << str << " {\n";
+        ++n_;
+      }
+    }
+
+    be_global->header_ <<
+      "/// This structure supports use of hashed containers with one or more keys.\n"
+      "struct " << be_global->export_macro() << ' ' <<
+      name->last_component()->get_string() << "_OpenDDS_KeyHash {\n";
+  }
+
+  void
+  has_no_keys_signature()
+  {
+    be_global->header_ <<
+      "  size_t operator()(const " << cxx_name_ << "&) const\n"
+      "  {\n"
+      "    size_t seed = 0;\n";
+  }
+
+  void
+  has_keys_signature()
+  {
+    be_global->header_ <<
+      "  size_t operator()(const " << cxx_name_ << "& v) const\n"
+      "  {\n"
+      "    size_t seed = 0;\n";
+  }
+
+  void
+  key_hash(const string& member, AST_Type* type)
+  {
+    const Classification cls = type ? classify(type) : CL_UNKNOWN;
+    if (cls & CL_STRING) {
+      const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+      be_global->header_ <<
+        "    OpenDDS::DCPS::key_hash_string(seed, v." << member
+        << (use_cxx11 ? ".c_str()" : ".in()") << ");\n";
+    } else {
+      be_global->header_ <<
+        "    OpenDDS::DCPS::key_hash(seed, v." << member << ");\n";
+    }
+  }
+
+  ~KeyHashWrapper()
+  {
+    be_global->header_ <<
+      "    return seed;\n"
+      "  }\n};\n";
+
+    for (size_t i = 0; i < n_; ++i) {
+      be_global->header_ << "}\n";
+    }
+
+    be_global->header_ << be_global->versioning_end() << "\n";
+  }
+};
+
+namespace {
+  struct KeyMember {
+    string name;
+    AST_Type* type;
+  };
+}
+
 bool keys_generator::gen_struct(AST_Structure* node, UTL_ScopedName* name,
   const std::vector<AST_Field*>&, AST_Type::SIZE_TYPE, const char*)
 {
@@ -94,6 +177,40 @@ bool keys_generator::gen_struct(AST_Structure* node, UTL_ScopedName* name,
     return true;
   }
 
+  std::vector<KeyMember> members;
+  if (key_count) {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    if (is_topic_type) {
+      TopicKeys::Iterator finished = keys.end();
+      for (TopicKeys::Iterator i = keys.begin(); i != finished; ++i) {
+        KeyMember member = {i.path(), i.get_ast_type()};
+        if (i.root_type() == TopicKeys::UnionType) {
+          member.name += "._d()";
+          AST_Union* union_type = dynamic_cast<AST_Union*>(member.type);
+          member.type = union_type ? union_type->disc_type() : 0;
+        } else if (use_cxx11) {
+          member.name = insert_cxx11_accessor_parens(member.name, false);
+        }
+        members.push_back(member);
+      }
+    } else if (info) {
+      IDL_GlobalData::DCPS_Data_Type_Info_Iter iter(info->key_list_);
+      for (ACE_TString* kp = 0; iter.next(kp) != 0; iter.advance()) {
+        const string key_name = ACE_TEXT_ALWAYS_CHAR(kp->c_str());
+        KeyMember member = {key_name, 0};
+        try {
+          member.type = find_type(node, key_name);
+        } catch (const string&) {
+          // reported by marshal_generator
+        }
+        if (use_cxx11) {
+          member.name = insert_cxx11_accessor_parens(member.name, false);
+        }
+        members.push_back(member);
+      }
+    }
+  }
+
   {
     KeyLessThanWrapper wrapper(name);
 
@@ -107,26 +224,21 @@ bool keys_generator::gen_struct(AST_Structure* node, UTL_ScopedName* name,
           "in global NS\n";
       }
 
-      if (is_topic_type) {
-        TopicKeys::Iterator finished = keys.end();
-        for (TopicKeys::Iterator i = keys.begin(); i != finished; ++i) {
-          string fname = i.path();
-          if (i.root_type() == TopicKeys::UnionType) {
-            fname += "._d()";
-          } else if (use_cxx11) {
-            fname = insert_cxx11_accessor_parens(fname, false);
-          }
-          wrapper.key_compare(fname);
-        }
-      } else if (info) {
-        IDL_GlobalData::DCPS_Data_Type_Info_Iter iter(info->key_list_);
-        for (ACE_TString* kp = 0; iter.next(kp) != 0; iter.advance()) {
-          string fname = ACE_TEXT_ALWAYS_CHAR(kp->c_str());
-          if (use_cxx11) {
-            fname = insert_cxx11_accessor_parens(fname, false);
-          }
-          wrapper.key_compare(fname);
-        }
+      for (size_t i = 0; i < members.size(); ++i) {
+        wrapper.key_compare(members[i].name);
+      }
+    } else {
+      wrapper.has_no_keys_signature();
+    }
+  }
+
+  {
+    KeyHashWrapper wrapper(name);
+
+    if (key_count) {
+      wrapper.has_keys_signature();
+      for (size_t i = 0; i < members.size(); ++i) {
+        wrapper.key_hash(members[i].name, members[i].type);
       }
     } else {
       wrapper.has_no_keys_signature();
@@ -149,5 +261,14 @@ bool keys_generator::gen_union(
       wrapper.has_no_keys_signature();
     }
   }
+  if (be_global->is_topic_type(node)) {
+    KeyHashWrapper wrapper(name);
+    if (be_global->has_key(node)) {
+      wrapper.has_keys_signature();
+      wrapper.key_hash("_d()", node->disc_type());
+    } else {
+      wrapper.has_no_keys_signature();
+    }
+  }
   return true;
 }
@@ -843,87 +843,6 @@ namespace {
       + cxx_fld + "_slice*>(" + prefix + "." + fname + "));";
   }
 
-  // This function looks through the fields of a struct for the key
-  // specified and returns the AST_Type associated with that key.
-  // Because the key name can contain indexed arrays and nested
-  // structures, things can get interesting.
-  AST_Type* find_type(AST_Structure* struct_node, const string& key)
-  {
-    string key_base = key;   // the field we are looking for here
-    string key_rem;          // the sub-field we will look for recursively
-    bool is_array = false;
-    size_t pos = key.find_first_of(".[");
-    if (pos != string::npos) {
-      key_base = key.substr(0, pos);
-      if (key[pos] == '[') {
-        is_array = true;
-        size_t l_brack = key.find("]");
-        if (l_brack == string::npos) {
-          throw string("Missing right bracket");
-        } else if (l_brack != key.length()) {
-          key_rem = key.substr(l_brack+1);
-        }
-      } else {
-        key_rem = key.substr(pos+1);
-      }
-    }
-
-    const Fields fields(struct_node);
-    const Fields::Iterator fields_end = fields.end();
-    for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
-      AST_Field* field = *i;
-      if (key_base == field->local_name()->get_string()) {
-        AST_Type* field_type = resolveActualType(field->field_type());
-        if (!is_array && key_rem.empty()) {
-          // The requested key field matches this one.  We do not allow
-          // arrays (must be indexed specifically) or structs (must
-          // identify specific sub-fields).
-          AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
-          if (sub_struct != 0) {
-            throw string("Structs not allowed as keys");
-          }
-          AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
-          if (array_node != 0) {
-            throw string("Arrays not allowed as keys");
-          }
-          return field_type;
-        } else if (is_array) {
-          // must be a typedef of an array
-          AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
-          if (array_node == 0) {
-            throw string("Indexing for non-array type");
-          }
-          if (array_node->n_dims() > 1) {
-            throw string("Only single dimension arrays allowed in keys");
-          }
-          if (key_rem == "") {
-            return array_node->base_type();
-          } else {
-            // This must be a struct...
-            if ((key_rem[0] != '.') || (key_rem.length() == 1)) {
-              throw string("Unexpected characters after array index");
-            } else {
-              // Set up key_rem and field_type and let things fall into
-              // the struct code below
-              key_rem = key_rem.substr(1);
-              field_type = array_node->base_type();
-            }
-          }
-        }
-
-        // nested structures
-        AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
-        if (sub_struct == 0) {
-          throw string("Expected structure field for ") + key_base;
-        }
-
-        // find type of nested struct field
-        return find_type(sub_struct, key_rem);
-      }
-    }
-    throw string("Field not found.");
-  }
-
   bool is_bounded_type(AST_Type* type)
   {
     bool bounded = true;
@@ -1560,6 +1479,100 @@ namespace {
     string iQosOffset_, preamble_;
   };
 
+  // A "wire-compatible" type has the same native (C++) layout as its CDR
+  // encoding when it starts on a max_align boundary: only fixed-size
+  // primitives, arrays of them, and nested wire-compatible structs, with no
+  // padding between members and no tail padding.  Types whose native
+  // representation is implementation-defined (boolean, wchar, long double,
+  // enum) are excluded, as are structs with custom marshaling.
+  bool wire_compatible_layout(AST_Type* type, size_t& size, size_t& max_align)
+  {
+    type = resolveActualType(type);
+    switch (type->node_type()) {
+    case AST_Decl::NT_pre_defined: {
+      size_t elem = 0;
+      switch (AST_PredefinedType::narrow_from_decl(type)->pt()) {
+      case AST_PredefinedType::PT_char:
+      case AST_PredefinedType::PT_octet:
+        elem = 1;
+        break;
+      case AST_PredefinedType::PT_short:
+      case AST_PredefinedType::PT_ushort:
+        elem = 2;
+        break;
+      case AST_PredefinedType::PT_long:
+      case AST_PredefinedType::PT_ulong:
+      case AST_PredefinedType::PT_float:
+        elem = 4;
+        break;
+      case AST_PredefinedType::PT_longlong:
+      case AST_PredefinedType::PT_ulonglong:
+      case AST_PredefinedType::PT_double:
+        elem = 8;
+        break;
+      default:
+        return false;
+      }
+      if (size % elem) {
+        return false;
+      }
+      size += elem;
+      if (elem > max_align) {
+        max_align = elem;
+      }
+      return true;
+    }
+    case AST_Decl::NT_array: {
+      AST_Array* array_node = dynamic_cast<AST_Array*>(type);
+      size_t elem_size = 0, elem_align = 1;
+      if (!wire_compatible_layout(array_node->base_type(), elem_size, elem_align)
+          || size % elem_align) {
+        return false;
+      }
+      size_t array_size = 1;
+      AST_Expression** dims = array_node->dims();
+      for (unsigned long i = 0; i < array_node->n_dims(); i++) {
+        array_size *= dims[i]->ev()->u.ulval;
+      }
+      size += array_size * elem_size;
+      if (elem_align > max_align) {
+        max_align = elem_align;
+      }
+      return true;
+    }
+    case AST_Decl::NT_struct: {
+      const string cxx = scoped(type->name());
+      for (size_t i = 0; i < LENGTH(special_structs); ++i) {
+        if (special_structs[i].check(cxx)) {
+          return false;
+        }
+      }
+      const RtpsFieldCustomizer rtpsCustom(cxx);
+      if (!rtpsCustom.cst_.empty() || !rtpsCustom.preamble_.empty()) {
+        return false;
+      }
+      size_t struct_size = 0, struct_align = 1;
+      const Fields fields(dynamic_cast<AST_Structure*>(type));
+      const Fields::Iterator fields_end = fields.end();
+      for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+        if (!wire_compatible_layout((*i)->field_type(), struct_size, struct_align)) {
+          return false;
+        }
+      }
+      if (struct_size == 0 || struct_size % struct_align || size % struct_align) {
+        return false;
+      }
+      size += struct_size;
+      if (struct_align > max_align) {
+        max_align = struct_align;
+      }
+      return true;
+    }
+    default:
+      return false;
+    }
+  }
+
   typedef void (*KeyIterationFn)(
     const string& key_name, AST_Type* ast_type,
     size_t* size, size_t* padding,
@@ -1647,6 +1660,19 @@ bool marshal_generator::gen_struct(AST_Structure* node,
   }
 
   RtpsFieldCustomizer rtpsCustom(cxx);
+
+  // Wire-compatible structs are copied in one piece when the stream allows
+  // it, falling back to member-by-member marshaling otherwise.  The sizeof
+  // check guards against a compiler laying the struct out differently.
+  size_t wc_size = 0, wc_align = 1;
+  const bool wire_compatible =
+    be_global->language_mapping() != BE_GlobalData::LANGMAP_CXX11
+    && wire_compatible_layout(node, wc_size, wc_align);
+  std::ostringstream wc_check;
+  if (wire_compatible) {
+    wc_check << "sizeof(stru) == " << wc_size << " && strm.wire_compatible_";
+  }
+
   {
     Function find_size("gen_find_size", "void");
     find_size.addArg("stru", "const " + cxx + "&");
@@ -1690,6 +1716,13 @@ bool marshal_generator::gen_struct(AST_Structure* node,
         expr += ")";
       }
     }
+    if (wire_compatible) {
+      be_global->impl_ <<
+        "  if (" << wc_check.str() << "w(" << wc_align << ")) {\n"
+        "    return strm.write_octet_array(reinterpret_cast<const ACE_CDR::Octet*>(&stru), "
+        << wc_size << ");\n"
+        "  }\n";
+    }
     be_global->impl_ << intro << "  return " << expr << ";\n";
   }
   {
@@ -1711,6 +1744,13 @@ bool marshal_generator::gen_struct(AST_Structure* node,
         expr += ")";
       }
     }
+    if (wire_compatible) {
+      be_global->impl_ <<
+        "  if (" << wc_check.str() << "r(" << wc_align << ")) {\n"
+        "    return strm.read_octet_array(reinterpret_cast<ACE_CDR::Octet*>(&stru), "
+        << wc_size << ");\n"
+        "  }\n";
+    }
     be_global->impl_ << intro << "  return " << expr << ";\n";
   }
 
@@ -1968,6 +2008,8 @@ bool marshal_generator::gen_struct(AST_Structure* node,
       "struct MarshalTraits<" << cxx << "> {\n"
       "  static bool gen_is_bounded_size() { return " << (is_bounded_struct ? "true" : "false") << "; }\n"
       "  static bool gen_is_bounded_key_size() { return " << (bounded_key ? "true" : "false") << "; }\n"
+      "  /// Size of the type if its native layout is its CDR encoding, else 0\n"
+      "  static size_t gen_wire_compatible_size() { return " << (wire_compatible ? wc_size : 0) << "; }\n"
       "};\n";
   }
 
@@ -2313,6 +2355,7 @@ bool marshal_generator::gen_union(AST_Union* node, UTL_ScopedName* name,
     "  static bool gen_is_bounded_size() { return " << (is_bounded ? "true" : "false") << "; }\n"
     // Key is the discriminator, so it's always bounded
     "  static bool gen_is_bounded_key_size() { return true; }\n"
+    "  static size_t gen_wire_compatible_size() { return 0; }\n"
     "};\n";
 
   return true;
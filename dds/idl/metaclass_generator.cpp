@@ -82,6 +82,31 @@ namespace {
     }
   }
 
+  /// Expression for the Value of the scalar 'field' of 'typed'
+  std::string
+  scalar_value(AST_Field* field)
+  {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    const Classification cls = classify(field->field_type());
+    const std::string fieldName = field->local_name()->get_string();
+    std::string prefix, suffix;
+    if (cls & CL_ENUM) {
+      AST_Type* enum_type = resolveActualType(field->field_type());
+      prefix = "gen_" +
+        dds_generator::scoped_helper(enum_type->name(), "_")
+        + "_names[";
+      if (use_cxx11) {
+        prefix += "static_cast<int>(";
+      }
+      suffix = use_cxx11 ? "())]" : "]";
+    } else if (use_cxx11) {
+      suffix += "()";
+    }
+    const std::string string_to_ptr = use_cxx11 ? "" : ".in()";
+    return prefix + "typed." + fieldName
+      + (cls & CL_STRING ? string_to_ptr : "") + suffix;
+  }
+
   void
   gen_field_getValue(AST_Field* field)
   {
@@ -89,24 +114,9 @@ namespace {
     const Classification cls = classify(field->field_type());
     const std::string fieldName = field->local_name()->get_string();
     if (cls & CL_SCALAR) {
-      std::string prefix, suffix;
-      if (cls & CL_ENUM) {
-        AST_Type* enum_type = resolveActualType(field->field_type());
-        prefix = "gen_" +
-          dds_generator::scoped_helper(enum_type->name(), "_")
-          + "_names[";
-        if (use_cxx11) {
-          prefix += "static_cast<int>(";
-        }
-        suffix = use_cxx11 ? "())]" : "]";
-      } else if (use_cxx11) {
-        suffix += "()";
-      }
-      const std::string string_to_ptr = use_cxx11 ? "" : ".in()";
       be_global->impl_ <<
         "    if (std::strcmp(field, \"" << fieldName << "\") == 0) {\n"
-        "      return " + prefix + "typed." + fieldName
-        + (cls & CL_STRING ? string_to_ptr : "") + suffix + ";\n"
+        "      return " + scalar_value(field) + ";\n"
         "    }\n";
       be_global->add_include("<cstring>", BE_GlobalData::STREAM_CPP);
     } else if (cls & CL_STRUCTURE) {
@@ -116,6 +126,54 @@ namespace {
     }
   }
 
+  /// Static functions that getValueAccess() returns for each field
+  void
+  gen_field_accessor(AST_Field* field)
+  {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    const Classification cls = classify(field->field_type());
+    const std::string fieldName = field->local_name()->get_string();
+    if (cls & CL_SCALAR) {
+      be_global->impl_ <<
+        "  static Value value_" << fieldName << "(const void* stru)\n"
+        "  {\n"
+        "    const T& typed = *static_cast<const T*>(stru);\n"
+        "    return " << scalar_value(field) << ";\n"
+        "  }\n\n";
+    } else if (cls & CL_STRUCTURE) {
+      be_global->impl_ <<
+        "  static const void* member_" << fieldName << "(const void* stru)\n"
+        "  {\n"
+        "    return &static_cast<const T*>(stru)->" << (use_cxx11 ? "_" : "")
+        << fieldName << ";\n"
+        "  }\n\n";
+    }
+  }
+
+  void
+  gen_field_getValueAccess(AST_Field* field)
+  {
+    const Classification cls = classify(field->field_type());
+    const std::string fieldName = field->local_name()->get_string();
+    if (cls & CL_SCALAR) {
+      be_global->impl_ <<
+        "    if (std::strcmp(field, \"" << fieldName << "\") == 0) {\n"
+        "      return &value_" << fieldName << ";\n"
+        "    }\n";
+      be_global->add_include("<cstring>", BE_GlobalData::STREAM_CPP);
+    } else if (cls & CL_STRUCTURE) {
+      const size_t n = fieldName.size() + 1 /* 1 for the dot */;
+      be_global->impl_ <<
+        "    if (std::strncmp(field, \"" << fieldName << ".\", " << n
+        << ") == 0) {\n"
+        "      path.push_back(&member_" << fieldName << ");\n"
+        "      return getMetaStruct<" << scoped(field->field_type()->name())
+        << ">().getValueAccess(field + " << n << ", path);\n"
+        "    }\n";
+      be_global->add_include("<cstring>", BE_GlobalData::STREAM_CPP);
+    }
+  }
+
   std::string string_type(Classification cls)
   {
     return be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11 ?
@@ -185,6 +243,112 @@ namespace {
     return scoped(type->name());
   }
 
+  /// Size of the primitive or enum 'type' in serialized samples, or 0 if
+  /// it isn't one with a fixed size
+  size_t
+  fixed_size(AST_Type* type)
+  {
+    const Classification cls = classify(type);
+    if (!(cls & (CL_PRIMITIVE | CL_ENUM)) || (cls & CL_WIDE)) {
+      return 0;
+    }
+    int size = 0;
+    if (to_cxx_type(type, size) == "ACE_CDR::LongDouble") {
+      return 0;
+    }
+    return size;
+  }
+
+  /// Static functions that getSerializedAccess() returns for each field
+  void
+  gen_field_serializedAccessor(AST_Field* field)
+  {
+    AST_Type* const type = field->field_type();
+    if (!fixed_size(type)) {
+      return;
+    }
+    const std::string fieldName = field->local_name()->get_string();
+    int size = 0;
+    std::string cxx_type = to_cxx_type(type, size);
+    const bool boolean = cxx_type == "ACE_CDR::Boolean";
+    if (boolean) {
+      cxx_type = "ACE_CDR::Octet";
+    }
+    be_global->impl_ <<
+      "  static Value serialized_" << fieldName << "(const SerializedPayload& payload,\n"
+      "    size_t aligned_offset, size_t packed_offset)\n"
+      "  {\n"
+      "    " << cxx_type << " val;\n"
+      "    if (!SampleView::read(payload, aligned_offset, packed_offset, val)) {\n"
+      "      throw std::runtime_error(\"Field '" << fieldName << "' could "
+      "not be deserialized\");\n"
+      "    }\n"
+      "    return " << (boolean ? "val != 0" : "val") << ";\n"
+      "  }\n\n";
+  }
+
+  void
+  gen_getSerializedAccess(const std::vector<AST_Field*>& fields)
+  {
+    be_global->impl_ <<
+      "  bool getSerializedAccess(const char* field, size_t& aligned, "
+      "size_t& packed,\n"
+      "    SerializedValueAccess& access) const\n"
+      "  {\n"
+      "    ACE_UNUSED_ARG(access);\n";
+    // Fields after the first one of variable size aren't at a fixed offset
+    bool fixed = true;
+    for (size_t i = 0; fixed && i < fields.size(); ++i) {
+      const std::string fieldName = fields[i]->local_name()->get_string();
+      AST_Type* const type = resolveActualType(fields[i]->field_type());
+      const Classification cls = classify(type);
+      const size_t size = fixed_size(type);
+      if (size) {
+        be_global->impl_ <<
+          "    align_serialized(aligned, " << size << ");\n"
+          "    if (std::strcmp(field, \"" << fieldName << "\") == 0) {\n"
+          "      access = &serialized_" << fieldName << ";\n"
+          "      return true;\n"
+          "    }\n"
+          "    skip_serialized(aligned, packed, " << size << ", 1);\n";
+      } else if (cls & CL_STRUCTURE) {
+        const size_t n = fieldName.size() + 1 /* 1 for the dot */;
+        const std::string fieldType = scoped(fields[i]->field_type()->name());
+        be_global->impl_ <<
+          "    if (std::strncmp(field, \"" << fieldName << ".\", " << n
+          << ") == 0) {\n"
+          "      return getMetaStruct<" << fieldType << ">().getSerializedAccess("
+          "field + " << n << ", aligned, packed, access);\n"
+          "    }\n"
+          "    if (!getMetaStruct<" << fieldType << ">().getSerializedAccess("
+          "\"\", aligned, packed, access)) {\n"
+          "      return false;\n"
+          "    }\n";
+      } else if (cls & CL_ARRAY) {
+        AST_Array* const arr = AST_Array::narrow_from_decl(type);
+        const size_t elem_size = fixed_size(arr->base_type());
+        size_t n_elems = 1;
+        for (size_t dim = 0; dim < arr->n_dims(); ++dim) {
+          n_elems *= arr->dims()[dim]->ev()->u.ulval;
+        }
+        if (elem_size) {
+          be_global->impl_ <<
+            "    skip_serialized(aligned, packed, " << elem_size << ", "
+            << n_elems << ");\n";
+        } else {
+          fixed = false;
+        }
+      } else {
+        fixed = false;
+      }
+    }
+    be_global->impl_ <<
+      "    return " << (fixed ? "!field[0]" : "false") << ";\n"
+      "  }\n\n";
+    be_global->add_include("<cstring>", BE_GlobalData::STREAM_CPP);
+    be_global->add_include("dds/DCPS/SampleView.h", BE_GlobalData::STREAM_CPP);
+  }
+
   void
   gen_field_getValueFromSerialized(AST_Field* field)
   {
@@ -502,7 +666,21 @@ namespace {
       "found or its type is not supported (in struct " + clazz + ")\");\n";
     be_global->impl_ <<
       exception <<
-      "  }\n\n"
+      "  }\n\n";
+    if (struct_node && fields.size()) {
+      std::for_each(fields.begin(), fields.end(), gen_field_accessor);
+      be_global->impl_ <<
+        "  ValueAccess getValueAccess(const char* field, "
+        "OPENDDS_VECTOR(MemberAccess)& path) const\n"
+        "  {\n";
+      std::for_each(fields.begin(), fields.end(), gen_field_getValueAccess);
+      be_global->impl_ <<
+        "    return 0;\n"
+        "  }\n\n";
+      std::for_each(fields.begin(), fields.end(), gen_field_serializedAccessor);
+      gen_getSerializedAccess(fields);
+    }
+    be_global->impl_ <<
       "  Value getValue(Serializer& ser, const char* field) const\n"
       "  {\n";
     if (struct_node && fields.size()) {
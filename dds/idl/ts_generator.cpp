@@ -160,6 +160,7 @@ bool ts_generator::generate_ts(AST_Decl* node, UTL_ScopedName* name)
     "  typedef " << cxxName << "DataWriter DataWriterType;\n"
     "  typedef " << cxxName << "DataReader DataReaderType;\n"
     "  typedef " << cxxName << "_OpenDDS_KeyLessThan LessThanType;\n"
+    "  typedef " << cxxName << "_OpenDDS_KeyHash HashType;\n"
     "\n"
     "  static const char* type_name () { return \"" << cxxName << "\"; }\n"
     "  static bool gen_has_key () { return " << (key_count ? "true" : "false") << "; }\n"
@@ -0,0 +1,329 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "view_generator.h"
+#include "be_extern.h"
+#include "topic_keys.h"
+
+#include "utl_identifier.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using namespace AstTypeClassification;
+
+namespace {
+
+  enum Conversion { CONV_NONE, CONV_BOOLEAN, CONV_ENUM };
+
+  /// A member that the view has an accessor for.
+  struct ViewMember {
+    string wire_type; // ACE_CDR type of the serialized value
+    string type;      // type returned by the accessor
+    Conversion conversion;
+    size_t aligned_offset; // after the encapsulation header, CDR alignment
+    size_t packed_offset;  // no encapsulation, no alignment
+  };
+
+  /// Size and ACE_CDR type of a primitive as the Serializer writes it.
+  /// False for types whose size on the wire varies (wchar) or that have
+  /// no portable native representation (long double).
+  bool primitive_layout(AST_Type* type, size_t& size, string& wire_type)
+  {
+    switch (AST_PredefinedType::narrow_from_decl(type)->pt()) {
+    case AST_PredefinedType::PT_char:
+      size = 1;
+      wire_type = "ACE_CDR::Char";
+      return true;
+    case AST_PredefinedType::PT_octet:
+    case AST_PredefinedType::PT_boolean:
+      size = 1;
+      wire_type = "ACE_CDR::Octet";
+      return true;
+    case AST_PredefinedType::PT_short:
+      size = 2;
+      wire_type = "ACE_CDR::Short";
+      return true;
+    case AST_PredefinedType::PT_ushort:
+      size = 2;
+      wire_type = "ACE_CDR::UShort";
+      return true;
+    case AST_PredefinedType::PT_long:
+      size = 4;
+      wire_type = "ACE_CDR::Long";
+      return true;
+    case AST_PredefinedType::PT_ulong:
+      size = 4;
+      wire_type = "ACE_CDR::ULong";
+      return true;
+    case AST_PredefinedType::PT_float:
+      size = 4;
+      wire_type = "ACE_CDR::Float";
+      return true;
+    case AST_PredefinedType::PT_longlong:
+      size = 8;
+      wire_type = "ACE_CDR::LongLong";
+      return true;
+    case AST_PredefinedType::PT_ulonglong:
+      size = 8;
+      wire_type = "ACE_CDR::ULongLong";
+      return true;
+    case AST_PredefinedType::PT_double:
+      size = 8;
+      wire_type = "ACE_CDR::Double";
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  void advance(size_t size, size_t count, size_t& aligned, size_t& packed)
+  {
+    aligned = (aligned + size - 1) / size * size + size * count;
+    packed += size * count;
+  }
+
+  /// Move the offsets past a member of the given type.  False if the
+  /// type's serialized size isn't fixed.
+  bool skip_fixed(AST_Type* type, size_t& aligned, size_t& packed)
+  {
+    type = resolveActualType(type);
+    switch (type->node_type()) {
+    case AST_Decl::NT_pre_defined: {
+      size_t size;
+      string wire_type;
+      if (!primitive_layout(type, size, wire_type)) {
+        return false;
+      }
+      advance(size, 1, aligned, packed);
+      return true;
+    }
+    case AST_Decl::NT_enum:
+      advance(4, 1, aligned, packed);
+      return true;
+    case AST_Decl::NT_array: {
+      AST_Array* const array_node = dynamic_cast<AST_Array*>(type);
+      size_t count = 1;
+      AST_Expression** const dims = array_node->dims();
+      for (unsigned long i = 0; i < array_node->n_dims(); ++i) {
+        count *= dims[i]->ev()->u.ulval;
+      }
+      AST_Type* const elem = resolveActualType(array_node->base_type());
+      size_t size;
+      string wire_type;
+      if (elem->node_type() == AST_Decl::NT_enum) {
+        advance(4, count, aligned, packed);
+        return true;
+      }
+      if (elem->node_type() == AST_Decl::NT_pre_defined) {
+        if (!primitive_layout(elem, size, wire_type)) {
+          return false;
+        }
+        advance(size, count, aligned, packed);
+        return true;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        if (!skip_fixed(elem, aligned, packed)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case AST_Decl::NT_struct: {
+      const Fields fields(dynamic_cast<AST_Structure*>(type));
+      const Fields::Iterator fields_end = fields.end();
+      for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+        if (!skip_fixed((*i)->field_type(), aligned, packed)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+    }
+  }
+
+  /// Names that the SampleView base class or the generated code uses.
+  bool reserved(const string& name)
+  {
+    static const char* const names[] = {
+      "MessageType", "valid", "payload", "read", "get", "to_sample", "extract_key"
+    };
+    for (size_t i = 0; i < sizeof names / sizeof names[0]; ++i) {
+      if (name == names[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Expression for the value of the member in a view
+  string view_get(const ViewMember& member)
+  {
+    std::ostringstream expr;
+    expr << "OpenDDS::DCPS::SampleView::get<" << member.wire_type << ">("
+         << member.aligned_offset << ", " << member.packed_offset << ')';
+    return expr.str();
+  }
+
+  string convert(const ViewMember& member, const string& value)
+  {
+    switch (member.conversion) {
+    case CONV_BOOLEAN:
+      return "(" + value + " != 0)";
+    case CONV_ENUM:
+      return "static_cast<" + member.type + ">(" + value + ")";
+    default:
+      return value;
+    }
+  }
+}
+
+bool view_generator::gen_struct(AST_Structure* node, UTL_ScopedName* name,
+  const std::vector<AST_Field*>& fields, AST_Type::SIZE_TYPE, const char*)
+{
+  IDL_GlobalData::DCPS_Data_Type_Info* info = idl_global->is_dcps_type(name);
+  const bool is_topic_type = be_global->is_topic_type(node);
+  if (!is_topic_type && !info) {
+    return true;
+  }
+
+  be_global->add_include("dds/DCPS/SampleView.h", BE_GlobalData::STREAM_H);
+
+  const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+  const string cxx = scoped(name);
+  const string view = string(name->last_component()->get_string()) + "_OpenDDS_View";
+
+  // Members declared before the first one of variable size are at the
+  // same offset in every sample.
+  typedef std::map<string, ViewMember> ViewMembers;
+  ViewMembers members;
+  std::vector<string> order;
+  size_t aligned = 0, packed = 0;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const string field_name = fields[i]->local_name()->get_string();
+    AST_Type* const type = resolveActualType(fields[i]->field_type());
+    ViewMember member = {"", "", CONV_NONE, 0, 0};
+    size_t size = 0;
+    if (type->node_type() == AST_Decl::NT_pre_defined
+        && primitive_layout(type, size, member.wire_type)) {
+      member.type = member.wire_type;
+      if (AST_PredefinedType::narrow_from_decl(type)->pt() == AST_PredefinedType::PT_boolean) {
+        member.type = "ACE_CDR::Boolean";
+        member.conversion = CONV_BOOLEAN;
+      }
+    } else if (type->node_type() == AST_Decl::NT_enum) {
+      size = 4;
+      member.wire_type = "ACE_CDR::ULong";
+      member.type = scoped(type->name());
+      member.conversion = CONV_ENUM;
+    } else if (skip_fixed(type, aligned, packed)) {
+      continue;
+    } else {
+      break;
+    }
+    advance(size, 0, aligned, packed);
+    member.aligned_offset = aligned;
+    member.packed_offset = packed;
+    advance(size, 1, aligned, packed);
+    if (!reserved(field_name)) {
+      members[field_name] = member;
+      order.push_back(field_name);
+    }
+  }
+
+  // Key members, which extract_key() can fill in if they all have accessors
+  std::vector<string> keys;
+  bool keys_fixed = true;
+  if (is_topic_type) {
+    TopicKeys topic_keys(node);
+    const TopicKeys::Iterator finished = topic_keys.end();
+    for (TopicKeys::Iterator i = topic_keys.begin(); i != finished; ++i) {
+      if (i.root_type() == TopicKeys::UnionType) {
+        keys_fixed = false;
+      }
+      keys.push_back(i.path());
+    }
+  } else {
+    IDL_GlobalData::DCPS_Data_Type_Info_Iter iter(info->key_list_);
+    for (ACE_TString* kp = 0; iter.next(kp) != 0; iter.advance()) {
+      keys.push_back(ACE_TEXT_ALWAYS_CHAR(kp->c_str()));
+    }
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (!members.count(keys[i])) {
+      keys_fixed = false;
+    }
+  }
+
+  be_global->header_ << be_global->versioning_begin() << "\n";
+  {
+    ScopedNamespaceGuard guard(name, be_global->header_);
+
+    be_global->header_ <<
+      "/// Read-only access to a serialized " << cxx << " without deserializing it.\n"
+      "/// Only members at a fixed offset have accessors, use to_sample() for the others.\n"
+      "class " << view << " : public OpenDDS::DCPS::SampleView {\n"
+      "public:\n"
+      "  typedef " << cxx << " MessageType;\n\n"
+      "  explicit " << view << "(const OpenDDS::DCPS::SerializedPayload* payload = 0)\n"
+      "    : OpenDDS::DCPS::SampleView(payload)\n"
+      "  {}\n\n";
+
+    for (size_t i = 0; i < order.size(); ++i) {
+      const ViewMember& member = members[order[i]];
+      be_global->header_ <<
+        "  " << member.type << ' ' << order[i] << "() const\n"
+        "  {\n"
+        "    return " << convert(member, view_get(member)) << ";\n"
+        "  }\n\n";
+    }
+
+    be_global->header_ <<
+      "  bool to_sample(MessageType& sample) const\n"
+      "  {\n"
+      "    return OpenDDS::DCPS::deserialize_payload(OpenDDS::DCPS::SampleView::payload(), sample);\n"
+      "  }\n\n"
+      "  /// Used by DataReaderImpl_T to find the instance of a sample that it\n"
+      "  /// doesn't deserialize yet.\n"
+      "  static bool extract_key(const OpenDDS::DCPS::SerializedPayload&"
+      << (keys_fixed && !keys.empty() ? " payload" : "") << ", MessageType&"
+      << (keys_fixed && !keys.empty() ? " sample" : "") << ")\n"
+      "  {\n";
+    if (!keys_fixed) {
+      be_global->header_ <<
+        "    // Not all key members are at a fixed offset\n"
+        "    return false;\n";
+    } else {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        const ViewMember& member = members[keys[i]];
+        std::ostringstream var;
+        var << "key" << i;
+        const string value = convert(member, var.str());
+        be_global->header_ <<
+          "    " << member.wire_type << ' ' << var.str() << ";\n"
+          "    if (!OpenDDS::DCPS::SampleView::read(payload, "
+          << member.aligned_offset << ", " << member.packed_offset << ", " << var.str() << ")) {\n"
+          "      return false;\n"
+          "    }\n"
+          "    sample." << keys[i] << (use_cxx11 ? "(" + value + ")" : " = " + value) << ";\n";
+      }
+      be_global->header_ <<
+        "    return true;\n";
+    }
+    be_global->header_ <<
+      "  }\n"
+      "};\n\n";
+  }
+  be_global->header_ << be_global->versioning_end() << "\n";
+
+  return true;
+}
@@ -6,6 +6,7 @@
  */
 
 #include "DRMonitorImpl.h"
+#include "MonitorUtil.h"
 #include "monitorC.h"
 #include "monitorTypeSupportImpl.h"
 #include "dds/DCPS/DataReaderImpl.h"
@@ -16,6 +17,17 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+namespace {
+
+void add_pool(NVPSeq& values, const OPENDDS_STRING& prefix,
+              const DataReaderImpl::PoolOccupancy& pool)
+{
+  add_value(values, (prefix + "_pool_capacity").c_str(), pool.capacity);
+  add_value(values, (prefix + "_pool_in_use").c_str(), pool.in_use);
+  add_value(values, (prefix + "_pool_overflow").c_str(), pool.overflow);
+}
+
+}
 
 DRMonitorImpl::DRMonitorImpl(DataReaderImpl* dr,
               OpenDDS::DCPS::DataReaderReportDataWriter_ptr dr_writer)
@@ -57,6 +69,10 @@ DRMonitorImpl::report() {
       report.associations[length].state = iter->second;
       length++;
     }
+    DataReaderImpl::PoolOccupancy elements, samples;
+    this->dr_->get_pool_occupancy(elements, samples);
+    add_pool(report.values, "element", elements);
+    add_pool(report.values, "sample", samples);
     this->dr_writer_->write(report, DDS::HANDLE_NIL);
   }
 }
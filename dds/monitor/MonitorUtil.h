@@ -0,0 +1,53 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_MONITOR_UTIL_H
+#define OPENDDS_DCPS_MONITOR_UTIL_H
+
+#include "monitorC.h"
+#include "dds/DCPS/Stats_T.h"
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/// Append an integer value to the values of a report.
+inline void add_value(NVPSeq& values, const char* name, size_t value)
+{
+  const CORBA::ULong i = values.length();
+  values.length(i + 1);
+  values[i].name = name;
+  values[i].value.integer_value(static_cast<CORBA::Long>(value));
+}
+
+/// Append the statistics of 'stats' to the values of a report.
+inline void add_value(NVPSeq& values, const char* name, const Stats<double>& stats)
+{
+  Statistics value;
+  value.n = static_cast<CORBA::ULong>(stats.n());
+  value.maximum = stats.maximum();
+  value.minimum = stats.minimum();
+  value.mean = static_cast<double>(stats.mean());
+  value.variance = static_cast<double>(stats.var());
+
+  const CORBA::ULong i = values.length();
+  values.length(i + 1);
+  values[i].name = name;
+  values[i].value.stat_value(value);
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_MONITOR_UTIL_H */
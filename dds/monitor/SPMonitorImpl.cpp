@@ -7,6 +7,7 @@
 
 #include "SPMonitorImpl.h"
 #include "MonitorFactoryImpl.h"
+#include "MonitorUtil.h"
 #include "monitorC.h"
 #include "monitorTypeSupportImpl.h"
 #include "dds/DCPS/Service_Participant.h"
@@ -77,6 +78,14 @@ SPMonitorImpl::report()
     //     ++mapIter) {
     //  report.transports[length++] = mapIter->first;
     //}
+
+    ListenerDispatcher::Status dispatch;
+    if (TheServiceParticipant->listener_dispatch_status(dispatch)) {
+      add_value(report.values, "listener_dispatch_threads", dispatch.threads);
+      add_value(report.values, "listener_dispatch_queue_depth", dispatch.queue_depth);
+      add_value(report.values, "listener_dispatch_max_queue_depth", dispatch.max_queue_depth);
+      add_value(report.values, "listener_dispatch_latency", dispatch.latency);
+    }
     this->sp_writer_->write(report, DDS::HANDLE_NIL);
   }
 }
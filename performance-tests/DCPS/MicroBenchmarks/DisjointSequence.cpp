@@ -0,0 +1,127 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "dds/DCPS/BitmapDisjointSequence.h"
+#include "dds/DCPS/DisjointSequence.h"
+#include "dds/DCPS/TimeTypes.h"
+
+#include "ace/Arg_Shifter.h"
+#include "ace/OS_main.h"
+#include "ace/OS_NS_stdlib.h"
+
+#include <vector>
+
+using OpenDDS::DCPS::BitmapDisjointSequence;
+using OpenDDS::DCPS::DisjointSequence;
+using OpenDDS::DCPS::MonotonicTimePoint;
+using OpenDDS::DCPS::SequenceNumber;
+using OpenDDS::DCPS::SequenceRange;
+using OpenDDS::DCPS::TimeDuration;
+
+namespace {
+
+void report(const char* name, const TimeDuration& elapsed, size_t samples)
+{
+  const double usec = static_cast<double>(elapsed.value().usec());
+  ACE_DEBUG((LM_INFO, "%C: %B samples in %.0f us (%.3f us per sample)\n",
+             name, samples, usec, usec / samples));
+}
+
+/// Order in which a reliable reader sees "samples" sequence numbers when
+/// every "loss"th one is dropped and repaired "delay" samples later.
+std::vector<SequenceNumber::Value> arrival_order(size_t samples, size_t loss, size_t delay)
+{
+  std::vector<SequenceNumber::Value> order;
+  std::vector<SequenceNumber::Value> repairs;
+  for (size_t i = 1; i <= samples; ++i) {
+    if (loss && i % loss == 0) {
+      repairs.push_back(static_cast<SequenceNumber::Value>(i));
+    } else {
+      order.push_back(static_cast<SequenceNumber::Value>(i));
+    }
+    if (!repairs.empty() && repairs.front() + static_cast<SequenceNumber::Value>(delay) <= static_cast<SequenceNumber::Value>(i)) {
+      order.push_back(repairs.front());
+      repairs.erase(repairs.begin());
+    }
+  }
+  order.insert(order.end(), repairs.begin(), repairs.end());
+  return order;
+}
+
+/// What RtpsUdpDataLink does per DATA received: insert, check whether the
+/// sample can be delivered, and build an ACKNACK every "ack" samples.
+template <typename Sequence>
+TimeDuration run(const std::vector<SequenceNumber::Value>& order, size_t ack)
+{
+  Sequence sequence;
+  CORBA::Long bitmap[8];
+  CORBA::ULong num_bits = 0;
+  // Results are accumulated so the calls can't be optimized away.
+  size_t results = 0;
+
+  const MonotonicTimePoint start = MonotonicTimePoint::now();
+  for (size_t i = 0; i < order.size(); ++i) {
+    sequence.insert(SequenceNumber(order[i]));
+    if (!sequence.disjoint()) {
+      ++results;
+    }
+    if (ack && i % ack == 0) {
+      sequence.to_bitmap(bitmap, 8, num_bits, true);
+      results += num_bits + sequence.missing_sequence_ranges().size();
+    }
+  }
+  const TimeDuration elapsed = MonotonicTimePoint::now() - start;
+
+  if (sequence.cumulative_ack() != SequenceNumber(static_cast<SequenceNumber::Value>(order.size()))) {
+    ACE_ERROR((LM_ERROR, "ERROR: cumulative_ack %q, expected %B (%B)\n",
+               sequence.cumulative_ack().getValue(), order.size(), results));
+  }
+  return elapsed;
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  size_t samples = 1000000;
+  size_t loss = 100;
+  size_t delay = 50;
+  size_t ack = 16;
+
+  ACE_Arg_Shifter args(argc, argv);
+  while (args.is_anything_left()) {
+    const ACE_TCHAR* arg = 0;
+    if ((arg = args.get_the_parameter(ACE_TEXT("-n")))) {
+      samples = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-l")))) {
+      loss = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-d")))) {
+      delay = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-a")))) {
+      ack = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else {
+      args.ignore_arg();
+    }
+  }
+
+  if (samples == 0) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: -n must be positive\n"), 1);
+  }
+
+  const std::vector<SequenceNumber::Value> in_order = arrival_order(samples, 0, 0);
+  const std::vector<SequenceNumber::Value> lossy = arrival_order(samples, loss, delay);
+
+  report("DisjointSequence in order", run<DisjointSequence>(in_order, ack), samples);
+  report("BitmapDisjointSequence in order", run<BitmapDisjointSequence>(in_order, ack), samples);
+  report("DisjointSequence with loss", run<DisjointSequence>(lossy, ack), samples);
+  report("BitmapDisjointSequence with loss", run<BitmapDisjointSequence>(lossy, ack), samples);
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "dds/DCPS/TimeTypes.h"
+#include "dds/DCPS/transport/rtps_udp/RtpsUdpSendStrategy.h"
+
+#include "ace/Arg_Shifter.h"
+#include "ace/INET_Addr.h"
+#include "ace/OS_main.h"
+#include "ace/OS_NS_stdlib.h"
+#include "ace/SOCK_Dgram.h"
+
+#include <cstring>
+#include <vector>
+
+using OpenDDS::DCPS::MonotonicTimePoint;
+using OpenDDS::DCPS::TimeDuration;
+
+namespace {
+
+void report(const char* name, const TimeDuration& elapsed,
+            int iterations, size_t destinations)
+{
+  const double usec = static_cast<double>(elapsed.value().usec());
+  ACE_DEBUG((LM_INFO, "%C: %d fan-outs to %B destinations in %.0f us "
+             "(%.3f us per fan-out, %.3f us per datagram)\n",
+             name, iterations, destinations, usec, usec / iterations,
+             usec / (iterations * destinations)));
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  size_t destinations = 32;
+  int iterations = 10000;
+  size_t size = 1024;
+
+  ACE_Arg_Shifter args(argc, argv);
+  while (args.is_anything_left()) {
+    const ACE_TCHAR* arg = 0;
+    if ((arg = args.get_the_parameter(ACE_TEXT("-d")))) {
+      destinations = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-i")))) {
+      iterations = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-s")))) {
+      size = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else {
+      args.ignore_arg();
+    }
+  }
+
+  if (destinations == 0 || iterations <= 0) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: -d and -i must be positive\n"), 1);
+  }
+
+  // Receivers are never read; the kernel drops what doesn't fit in their
+  // buffers, which is fine since only the sender's cost is measured.
+  std::vector<ACE_SOCK_Dgram> receivers(destinations);
+  std::vector<ACE_INET_Addr> addrs(destinations);
+  for (size_t i = 0; i < destinations; ++i) {
+    if (receivers[i].open(ACE_INET_Addr(u_short(0), "127.0.0.1")) != 0) {
+      ACE_ERROR_RETURN((LM_ERROR, "ERROR: failed to open receiver %B: %m\n", i), 1);
+    }
+    receivers[i].get_local_addr(addrs[i]);
+  }
+
+  ACE_SOCK_Dgram sender;
+  if (sender.open(ACE_INET_Addr(u_short(0), "127.0.0.1")) != 0) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: failed to open sender: %m\n"), 1);
+  }
+
+  std::vector<char> payload(size, 'x');
+  iovec iov[2];
+  iov[0].iov_base = &payload[0];
+  iov[0].iov_len = size / 2;
+  iov[1].iov_base = &payload[size / 2];
+  iov[1].iov_len = size - size / 2;
+
+  MonotonicTimePoint start = MonotonicTimePoint::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (size_t d = 0; d < destinations; ++d) {
+      sender.send(iov, 2, addrs[d]);
+    }
+  }
+  report("sendmsg loop", MonotonicTimePoint::now() - start, iterations, destinations);
+
+#ifdef OPENDDS_RTPS_UDP_HAS_SENDMMSG
+  std::vector<mmsghdr> headers(destinations);
+  start = MonotonicTimePoint::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (size_t d = 0; d < destinations; ++d) {
+      std::memset(&headers[d], 0, sizeof(mmsghdr));
+      headers[d].msg_hdr.msg_name = addrs[d].get_addr();
+      headers[d].msg_hdr.msg_namelen = addrs[d].get_size();
+      headers[d].msg_hdr.msg_iov = iov;
+      headers[d].msg_hdr.msg_iovlen = 2;
+    }
+    size_t sent = 0;
+    while (sent < destinations) {
+      const int ret = sendmmsg(sender.get_handle(), &headers[sent],
+                               static_cast<unsigned int>(destinations - sent), 0);
+      sent += ret > 0 ? ret : 1;
+    }
+  }
+  report("sendmmsg", MonotonicTimePoint::now() - start, iterations, destinations);
+#else
+  ACE_DEBUG((LM_INFO, "sendmmsg: not available on this platform\n"));
+#endif
+
+  for (size_t i = 0; i < destinations; ++i) {
+    receivers[i].close();
+  }
+  sender.close();
+  return 0;
+}
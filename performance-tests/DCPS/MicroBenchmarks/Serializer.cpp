@@ -0,0 +1,134 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "SerializerBenchTypeSupportImpl.h"
+
+#include "dds/DCPS/Message_Block_Ptr.h"
+#include "dds/DCPS/Serializer.h"
+#include "dds/DCPS/TimeTypes.h"
+
+#include "ace/Arg_Shifter.h"
+#include "ace/OS_main.h"
+#include "ace/OS_NS_stdlib.h"
+
+using OpenDDS::DCPS::Message_Block_Ptr;
+using OpenDDS::DCPS::MonotonicTimePoint;
+using OpenDDS::DCPS::Serializer;
+using OpenDDS::DCPS::TimeDuration;
+
+namespace {
+
+/// Blocks of "block_size" bytes holding at least "size" bytes, or a single
+/// block if "block_size" is 0.
+ACE_Message_Block* make_chain(size_t size, size_t block_size)
+{
+  if (block_size == 0) {
+    return new ACE_Message_Block(size);
+  }
+  ACE_Message_Block* head = new ACE_Message_Block(block_size);
+  ACE_Message_Block* tail = head;
+  for (size_t total = block_size; total < size; total += block_size) {
+    tail->cont(new ACE_Message_Block(block_size));
+    tail = tail->cont();
+  }
+  return head;
+}
+
+void reset_chain(ACE_Message_Block* chain)
+{
+  for (ACE_Message_Block* mb = chain; mb; mb = mb->cont()) {
+    mb->reset();
+  }
+}
+
+/// Serialize and deserialize "sample" the way DataWriterImpl and
+/// DataReaderImpl do, "iterations" times.
+template <typename T>
+void run(const char* name, const T& sample, size_t iterations,
+         size_t block_size, bool swap)
+{
+  size_t size = 0, padding = 0;
+  OpenDDS::DCPS::gen_find_size(sample, size, padding);
+  Message_Block_Ptr chain(make_chain(size + padding, block_size));
+  // Results are accumulated so the calls can't be optimized away.
+  size_t results = 0;
+
+  const MonotonicTimePoint start = MonotonicTimePoint::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    reset_chain(chain.get());
+    Serializer out(chain.get(), swap, Serializer::ALIGN_CDR);
+    results += out << sample;
+
+    Serializer in(chain.get(), swap, Serializer::ALIGN_CDR);
+    T copy;
+    results += in >> copy;
+  }
+  const TimeDuration elapsed = MonotonicTimePoint::now() - start;
+
+  const double usec = static_cast<double>(elapsed.value().usec());
+  ACE_DEBUG((LM_INFO, "%C, %C, %C: %B bytes, %.3f us per round trip\n",
+             name, block_size ? "chained" : "single block",
+             swap ? "swapped" : "native", size + padding, usec / iterations));
+  if (results != 2 * iterations) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C failed to (de)serialize\n", name));
+  }
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  size_t iterations = 1000000;
+  size_t block_size = 64;
+  size_t readings = 64;
+
+  ACE_Arg_Shifter args(argc, argv);
+  while (args.is_anything_left()) {
+    const ACE_TCHAR* arg = 0;
+    if ((arg = args.get_the_parameter(ACE_TEXT("-i")))) {
+      iterations = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-b")))) {
+      block_size = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else if ((arg = args.get_the_parameter(ACE_TEXT("-r")))) {
+      readings = ACE_OS::atoi(arg);
+      args.consume_arg();
+    } else {
+      args.ignore_arg();
+    }
+  }
+
+  if (iterations == 0 || block_size == 0) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: -i and -b must be positive\n"), 1);
+  }
+
+  SerializerBench::Small small;
+  small.id = 42;
+  small.value = 3.25;
+
+  SerializerBench::Mixed mixed;
+  mixed.id = 42;
+  mixed.timestamp = ACE_UINT64_LITERAL(1234567890123);
+  mixed.name = "sensor-0042";
+  for (int i = 0; i < 3; ++i) {
+    mixed.position[i] = 0.5 * i;
+  }
+  mixed.readings.length(static_cast<CORBA::ULong>(readings));
+  for (CORBA::ULong i = 0; i < mixed.readings.length(); ++i) {
+    mixed.readings[i] = static_cast<CORBA::Long>(i * 7);
+  }
+  mixed.valid = true;
+
+  for (int swap = 0; swap < 2; ++swap) {
+    run("Small", small, iterations, 0, swap != 0);
+    run("Small", small, iterations, block_size, swap != 0);
+    run("Mixed", mixed, iterations, 0, swap != 0);
+    run("Mixed", mixed, iterations, block_size, swap != 0);
+  }
+  return 0;
+}
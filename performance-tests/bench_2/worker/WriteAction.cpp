@@ -151,17 +151,21 @@ void WriteAction::stop() {
   }
 }
 
+void WriteAction::next_sample() {
+  ++(data_.msg_count);
+  if ((new_key_count_ != 0 && (data_.msg_count % new_key_count_) == 0)
+      || (new_key_probability_ != 0 && mt_() <= new_key_probability_)) {
+    data_.id.high = mt_();
+    data_.id.low = mt_();
+  }
+  data_.created_time = data_.sent_time = Builder::get_time();
+}
+
 void WriteAction::do_write() {
   std::unique_lock<std::mutex> lock(mutex_);
   if (started_ && !stopped_) {
     if (max_count_ == 0 || data_.msg_count < max_count_) {
-      ++(data_.msg_count);
-      if ((new_key_count_ != 0 && (data_.msg_count % new_key_count_) == 0)
-          || (new_key_probability_ != 0 && mt_() <= new_key_probability_)) {
-        data_.id.high = mt_();
-        data_.id.low = mt_();
-      }
-      data_.created_time = data_.sent_time = Builder::get_time();
+      next_sample();
       DDS::ReturnCode_t result = data_dw_->write(data_, 0);
       if (result != DDS::RETCODE_OK) {
         --(data_.msg_count);
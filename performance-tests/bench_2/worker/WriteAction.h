@@ -20,6 +20,9 @@ public:
   void do_write();
 
 protected:
+  /// Update data_ for the next sample: count, key and timestamps
+  void next_sample();
+
   std::mutex mutex_;
   ACE_Proactor& proactor_;
   bool started_, stopped_;
@@ -0,0 +1,63 @@
+#include "WriteBatchAction.h"
+
+#include "MemFunHandler.h"
+
+namespace Bench {
+
+WriteBatchAction::WriteBatchAction(ACE_Proactor& proactor)
+ : WriteAction(proactor), data_dw_impl_(0), batch_size_(10)
+{
+}
+
+bool WriteBatchAction::init(const ActionConfig& config, ActionReport& report, Builder::ReaderMap& readers, Builder::WriterMap& writers) {
+
+  WriteAction::init(config, report, readers, writers);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  data_dw_impl_ = dynamic_cast<DataTypeSupportImpl::DataWriterImplType*>(data_dw_.in());
+  if (!data_dw_impl_) {
+    std::stringstream ss;
+    ss << "WriteBatchAction '" << config.name << "' has a Bench::Data datawriter without write_batch()" << std::flush;
+    throw std::runtime_error(ss.str());
+  }
+
+  auto batch_size_prop = get_property(config.params, "batch_size", Builder::PVK_ULL);
+  if (batch_size_prop) {
+    batch_size_ = static_cast<size_t>(batch_size_prop->value.ull_prop());
+  }
+  if (batch_size_ == 0) {
+    std::stringstream ss;
+    ss << "WriteBatchAction '" << config.name << "' has a batch_size of 0" << std::flush;
+    throw std::runtime_error(ss.str());
+  }
+
+  handler_.reset(new MemFunHandler<WriteBatchAction>(&WriteBatchAction::do_write_batch, *this));
+
+  return true;
+}
+
+void WriteBatchAction::do_write_batch() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (started_ && !stopped_) {
+    CORBA::ULong count = 0;
+    batch_.length(static_cast<CORBA::ULong>(batch_size_));
+    while (count < batch_size_ && (max_count_ == 0 || data_.msg_count < max_count_)) {
+      next_sample();
+      batch_[count++] = data_;
+    }
+    if (count == 0) {
+      return;
+    }
+    batch_.length(count);
+    const DDS::InstanceHandleSeq handles;
+    const OPENDDS_VECTOR(DDS::Time_t) timestamps;
+    DDS::ReturnCode_t result = data_dw_impl_->write_batch(batch_, handles, timestamps);
+    if (result != DDS::RETCODE_OK) {
+      data_.msg_count -= count;
+      std::cout << "Error during WriteBatchAction::do_write_batch()'s call to datawriter::write_batch()" << std::endl;
+    }
+  }
+}
+
+}
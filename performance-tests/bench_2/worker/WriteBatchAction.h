@@ -0,0 +1,23 @@
+#pragma once
+
+#include "WriteAction.h"
+
+namespace Bench {
+
+/// Like WriteAction, but each timer expiration writes "batch_size" samples
+/// with one call to the DataWriter's write_batch() extension.
+class WriteBatchAction : public WriteAction {
+public:
+  WriteBatchAction(ACE_Proactor& proactor);
+
+  bool init(const ActionConfig& config, ActionReport& report, Builder::ReaderMap& readers, Builder::WriterMap& writers) override;
+
+  void do_write_batch();
+
+protected:
+  DataTypeSupportImpl::DataWriterImplType* data_dw_impl_;
+  size_t batch_size_;
+  DataSeq batch_;
+};
+
+}
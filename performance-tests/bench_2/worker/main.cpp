@@ -43,6 +43,7 @@
 #include "WorkerPublisherListener.h"
 #include "WorkerParticipantListener.h"
 #include "WriteAction.h"
+#include "WriteBatchAction.h"
 
 #include <cmath>
 #include <iostream>
@@ -188,6 +189,10 @@ int ACE_TMAIN(int argc, ACE_TCHAR* argv[]) {
     write_action_registration("write", [&](){
       return std::shared_ptr<Bench::Action>(new Bench::WriteAction(proactor));
     });
+  Bench::ActionManager::Registration
+    write_batch_action_registration("write_batch", [&](){
+      return std::shared_ptr<Bench::Action>(new Bench::WriteBatchAction(proactor));
+    });
   Bench::ActionManager::Registration
     forward_action_registration("forward", [&](){
       return std::shared_ptr<Bench::Action>(new Bench::ForwardAction(proactor));
@@ -2,6 +2,7 @@
 #include "ace/ACE.h"
 #include "ace/Log_Msg.h"
 #include <map>
+#include <cstring>
 #include "tao/CDR.h"
 #include "dds/DCPS/Message_Block_Ptr.h"
 
@@ -241,6 +242,143 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
     }
   }
 
+  {
+    Xyz::WireCompatibleStruct wcs;
+    for (int i = 0; i < 4; ++i) {
+      wcs.samples[i] = 1.5 * i;
+    }
+    wcs.stamp = -1234567890123LL;
+    wcs.id = 42;
+    wcs.seq = 7;
+    size_t size_wcs = find_size(wcs, padding);
+    if (size_wcs != 48 || padding != 0) {
+      ACE_ERROR((LM_ERROR,
+        ACE_TEXT("WireCompatibleStruct find_size failed with = %B ; expecting 48\n"),
+        size_wcs));
+      failed = true;
+    }
+
+    const size_t wc_size =
+      OpenDDS::DCPS::MarshalTraits<Xyz::WireCompatibleStruct>::gen_wire_compatible_size();
+    if (wc_size != 48) {
+      ACE_ERROR((LM_ERROR,
+        ACE_TEXT("WireCompatibleStruct gen_wire_compatible_size failed with = %B ; expecting 48\n"),
+        wc_size));
+      failed = true;
+    }
+    if (OpenDDS::DCPS::MarshalTraits<Xyz::Foo>::gen_wire_compatible_size() != 0) {
+      ACE_ERROR((LM_ERROR,
+        ACE_TEXT("Foo gen_wire_compatible_size should be 0\n")));
+      failed = true;
+    }
+
+    // bulk copy (no swap), member-by-member (swap), and member-by-member
+    // because the stream is not 8-byte aligned
+    for (int pass = 0; pass < 3; ++pass) {
+      ACE_Message_Block mb(size_wcs + 8);
+      OpenDDS::DCPS::Serializer ss(&mb, pass == 1,
+                                   OpenDDS::DCPS::Serializer::ALIGN_CDR);
+      const ACE_CDR::Octet lead = 1;
+      if (pass == 2 && !(ss << ACE_OutputCDR::from_octet(lead))) {
+        failed = true;
+      }
+      if (!(ss << wcs)) {
+        ACE_ERROR((LM_ERROR, "Serializing WireCompatibleStruct failed\n"));
+        failed = true;
+      }
+      if (mb.length() != (pass == 2 ? 8 : 0) + size_wcs) {
+        ACE_ERROR((LM_ERROR,
+          "WireCompatibleStruct pass %d wrote %B bytes\n", pass, mb.length()));
+        failed = true;
+      }
+
+      OpenDDS::DCPS::Serializer ss2(&mb, pass == 1,
+                                    OpenDDS::DCPS::Serializer::ALIGN_CDR);
+      ACE_CDR::Octet lead2 = 0;
+      if (pass == 2 && !(ss2 >> ACE_InputCDR::to_octet(lead2))) {
+        failed = true;
+      }
+      Xyz::WireCompatibleStruct wcs2;
+      if (!(ss2 >> wcs2)) {
+        ACE_ERROR((LM_ERROR, "Deserializing WireCompatibleStruct failed\n"));
+        failed = true;
+      } else if (wcs2.samples[0] != wcs.samples[0]
+                 || wcs2.samples[3] != wcs.samples[3]
+                 || wcs2.stamp != wcs.stamp || wcs2.id != wcs.id
+                 || wcs2.seq != wcs.seq) {
+        ACE_ERROR((LM_ERROR,
+          "WireCompatibleStruct pass %d round trip failed\n", pass));
+        failed = true;
+      }
+    }
+  }
+
+  {
+    // Views (-Gview) over CDR, byte-swapped, unaligned, and chained encodings
+    Xyz::Foo vf;
+    vf.key = 1234;
+    vf.octer = 0x5a;
+    vf.xcolor = Xyz::bluex;
+    vf.theString = "view";
+    vf.x = 2.5f;
+    vf.y = -1.0f;
+    for (int pass = 0; pass < 4; ++pass) {
+      const bool swap = pass == 1, cdr = pass != 2;
+      OpenDDS::DCPS::SerializedPayload payload;
+      payload.data_ = OpenDDS::DCPS::Message_Block_Shared_Ptr(new ACE_Message_Block(512));
+      payload.swap_bytes_ = swap;
+      payload.cdr_encapsulation_ = cdr;
+      OpenDDS::DCPS::Serializer ss(payload.data_.get(), swap,
+                                   cdr ? OpenDDS::DCPS::Serializer::ALIGN_CDR
+                                       : OpenDDS::DCPS::Serializer::ALIGN_NONE);
+      if (cdr) {
+        const ACE_CDR::ULong header = 0;
+        ss << header;
+        ss.reset_alignment();
+      }
+      if (!(ss << vf)) {
+        ACE_ERROR((LM_ERROR, "Serializing Foo for view pass %d failed\n", pass));
+        failed = true;
+        continue;
+      }
+      if (pass == 3) {
+        // split in the middle of the first member
+        ACE_Message_Block* const head = new ACE_Message_Block(6);
+        head->copy(payload.data_->rd_ptr(), 6);
+        payload.data_->rd_ptr(6);
+        head->cont(payload.data_->duplicate());
+        payload.data_ = OpenDDS::DCPS::Message_Block_Shared_Ptr(head);
+      }
+
+      const Xyz::Foo_OpenDDS_View view(&payload);
+      if (!view.valid() || view.key() != vf.key || view.octer() != vf.octer
+          || view.xcolor() != vf.xcolor) {
+        ACE_ERROR((LM_ERROR, "Foo_OpenDDS_View pass %d accessors failed\n", pass));
+        failed = true;
+      }
+
+      Xyz::Foo key_only;
+      if (!Xyz::Foo_OpenDDS_View::extract_key(payload, key_only)
+          || key_only.key != vf.key || key_only.xcolor != vf.xcolor) {
+        ACE_ERROR((LM_ERROR, "Foo_OpenDDS_View pass %d extract_key failed\n", pass));
+        failed = true;
+      }
+
+      Xyz::Foo whole;
+      if (!view.to_sample(whole) || whole.key != vf.key
+          || std::strcmp(whole.theString.in(), "view") || whole.x != vf.x
+          || whole.y != vf.y) {
+        ACE_ERROR((LM_ERROR, "Foo_OpenDDS_View pass %d to_sample failed\n", pass));
+        failed = true;
+      }
+    }
+
+    if (Xyz::Foo_OpenDDS_View().valid()) {
+      ACE_ERROR((LM_ERROR, "Foo_OpenDDS_View without a payload is valid\n"));
+      failed = true;
+    }
+  }
+
   if (!OpenDDS::DCPS::DDSTraits<Xyz::AStruct>::gen_has_key()) {
     ACE_ERROR((LM_ERROR,
       ACE_TEXT("_dcps_has_key(Xyz::AStruct) returned false when expecting true.\n")
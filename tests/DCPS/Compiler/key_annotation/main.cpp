@@ -5,6 +5,8 @@
 #include <ace/ACE.h>
 #include <ace/Log_Msg.h>
 
+#include <cstring>
+
 #include "key_annotationTypeSupportImpl.h"
 
 using namespace key_annotation;
@@ -113,6 +115,21 @@ private:
   bool failed_;
 };
 
+/// Samples of the same instance must hash the same, and (for these values)
+/// samples of different instances differently.
+template <typename T>
+bool assert_key_hash(const T& a, const T& same_instance, const T& other_instance)
+{
+  typename OpenDDS::DCPS::DDSTraits<T>::HashType hash;
+  if (hash(a) != hash(same_instance) || hash(a) == hash(other_instance)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: ")
+      ACE_TEXT("%C_OpenDDS_KeyHash is inconsistent with its keys\n"),
+      get_type_name<T>()));
+    return true;
+  }
+  return false;
+}
+
 int ACE_TMAIN(int, ACE_TCHAR**)
 {
   bool failed = false;
@@ -218,6 +235,54 @@ int ACE_TMAIN(int, ACE_TCHAR**)
     failed |= c.failed();
   }
 
+  // Check the generated key hashes
+  {
+    SimpleKeyStruct a, b, c;
+    a.key = b.key = 1;
+    c.key = 2;
+    a.value = 10;
+    b.value = 20;
+    c.value = 10;
+    failed |= assert_key_hash(a, b, c);
+
+    NestedKeyStruct na, nb, nc;
+    na.non_nested_key = nb.non_nested_key = nc.non_nested_key = 3;
+    na.nested_key = a;
+    nb.nested_key = b;
+    nc.nested_key = c;
+    failed |= assert_key_hash(na, nb, nc);
+
+    KeyedUnionStruct ua, ub, uc;
+    ua.value.a(1);
+    ub.value.a(2);
+    uc.value.b('x');
+    ua.another_key = ub.another_key = uc.another_key = 4;
+    failed |= assert_key_hash(ua, ub, uc);
+  }
+
+#ifndef NONNATIVE_LONGDOUBLE
+  // Long double key members hash their value, not the padding around it
+  {
+    ACE_CDR::LongDouble ld1, ld2;
+    std::memset(&ld1, 0, sizeof ld1);
+    std::memset(&ld2, 0xff, sizeof ld2);
+    ld1 = ld2 = 1.5L;
+    size_t seed1 = 0, seed2 = 0;
+    OpenDDS::DCPS::key_hash(seed1, ld1);
+    OpenDDS::DCPS::key_hash(seed2, ld2);
+    ld1 = 0.0L;
+    ld2 = -0.0L;
+    size_t zero1 = 0, zero2 = 0;
+    OpenDDS::DCPS::key_hash(zero1, ld1);
+    OpenDDS::DCPS::key_hash(zero2, ld2);
+    if (seed1 != seed2 || zero1 != zero2) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: ")
+        ACE_TEXT("equal long double keys hash differently\n")));
+      failed = true;
+    }
+  }
+#endif
+
   // Check KeyOnly for Unions
   failed |= assert_key_only_size(UnkeyedUnion(), 0);
   failed |= assert_key_only_size(KeyedUnion(), 4);
@@ -16,6 +16,8 @@
 
 #include "MessengerTypeSupportImpl.h"
 
+#include "ace/OS_NS_unistd.h"
+
 #include <cstdlib>
 #include <iostream>
 
@@ -344,6 +346,140 @@ bool run_unsignedlonglong_test(const DomainParticipant_var& dp,
   return true;
 }
 
+/// Take samples from 'dr' until 'expected' of them arrived, checking
+/// that all of them pass 'filter'
+template <typename F>
+bool takeExpected(const DataReader_var& dr, F filter, size_t expected)
+{
+  size_t count = 0;
+  for (int i = 0; i < 50 && count < expected; ++i) {
+    const size_t taken = takeSamples(dr, filter);
+    if (!taken) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+    }
+    count += taken;
+  }
+  // Nothing more than expected arrives
+  ACE_OS::sleep(ACE_Time_Value(0, 200000));
+  count += takeSamples(dr, filter);
+  if (count != expected) {
+    cout << "ERROR: " << dr << " received " << count << " samples, expected "
+      << expected << endl;
+    return false;
+  }
+  return true;
+}
+
+bool writeKeys(const MessageDataWriter_var& mdw)
+{
+  for (Message sample = {0, 0}; sample.key < 10; ++sample.key) {
+    sample.ull = static_cast<CORBA::ULongLong>(1) << (30 + sample.key);
+    if (mdw->write(sample, HANDLE_NIL) != RETCODE_OK) return false;
+  }
+  return true;
+}
+
+/// The keys that "ull >= 1 << 39 OR key < 2" lets through, see writeKeys()
+bool passesUllFilter(CORBA::Long key)
+{
+  return key < 2 || key == 9;
+}
+
+/*
+ * Readers whose filters have the same expression and parameters share the
+ * writer's evaluation of it.  Readers with other parameters, or whose
+ * parameters changed, don't.  A durable reader joining later has the
+ * writer's history filtered in serialized form.
+ */
+bool run_shared_filter_test(const DomainParticipant_var& dp,
+  const MessageTypeSupport_var& ts, const Publisher_var& pub, const Subscriber_var& sub)
+{
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic("SharedFilter", type_name,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.durability.kind = TRANSIENT_LOCAL_DURABILITY_QOS;
+  DataWriter_var dw =
+    pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+
+  DDS::StringSeq params5(1), params7(1);
+  params5.length(1);
+  params5[0] = "5";
+  params7.length(1);
+  params7[0] = "7";
+  ContentFilteredTopic_var cft_a = dp->create_contentfilteredtopic(
+    "SharedFilter-A", topic, "key > %0", params5);
+  ContentFilteredTopic_var cft_b = dp->create_contentfilteredtopic(
+    "SharedFilter-B", topic, "key > %0", params5);
+  ContentFilteredTopic_var cft_c = dp->create_contentfilteredtopic(
+    "SharedFilter-C", topic, "key > %0", params7);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr_a =
+    sub->create_datareader(cft_a, dr_qos, 0, DEFAULT_STATUS_MASK);
+  DataReader_var dr_b =
+    sub->create_datareader(cft_b, dr_qos, 0, DEFAULT_STATUS_MASK);
+  DataReader_var dr_c =
+    sub->create_datareader(cft_c, dr_qos, 0, DEFAULT_STATUS_MASK);
+  if (!dw || !dr_a || !dr_b || !dr_c || waitForPublicationMatched(dw, 3)) {
+    cout << "ERROR: shared filter setup failed" << endl;
+    return false;
+  }
+
+  if (!writeKeys(mdw)) return false;
+  bool passed = takeExpected(dr_a, bind2nd(greater<CORBA::Long>(), 5), 4);
+  passed &= takeExpected(dr_b, bind2nd(greater<CORBA::Long>(), 5), 4);
+  passed &= takeExpected(dr_c, bind2nd(greater<CORBA::Long>(), 7), 2);
+
+  // The filter reads 'ull', which is aligned after 'key', from the
+  // serialized samples the writer keeps
+  DDS::StringSeq ull_params(1);
+  ull_params.length(1);
+  ull_params[0] = "549755813888"; // 1 << 39, the sample with key 9
+  ContentFilteredTopic_var cft_d = dp->create_contentfilteredtopic(
+    "SharedFilter-D", topic, "ull >= %0 OR key < 2", ull_params);
+  DataReaderQos dr_qos_durable = dr_qos;
+  dr_qos_durable.durability.kind = TRANSIENT_LOCAL_DURABILITY_QOS;
+  DataReader_var dr_d =
+    sub->create_datareader(cft_d, dr_qos_durable, 0, DEFAULT_STATUS_MASK);
+  if (!dr_d || waitForPublicationMatched(dw, 4)) {
+    cout << "ERROR: creating the durable reader failed" << endl;
+    return false;
+  }
+  passed &= takeExpected(dr_d, passesUllFilter, 3);
+
+  // B stops sharing A's filter
+  if (cft_b->set_expression_parameters(params7) != RETCODE_OK) {
+    cout << "ERROR: setting expression parameters failed" << endl;
+    return false;
+  }
+  if (!writeKeys(mdw)) return false;
+  passed &= takeExpected(dr_a, bind2nd(greater<CORBA::Long>(), 5), 4);
+  passed &= takeExpected(dr_b, bind2nd(greater<CORBA::Long>(), 7), 2);
+  passed &= takeExpected(dr_c, bind2nd(greater<CORBA::Long>(), 7), 2);
+
+  sub->delete_datareader(dr_a);
+  sub->delete_datareader(dr_b);
+  sub->delete_datareader(dr_c);
+  sub->delete_datareader(dr_d);
+  pub->delete_datawriter(dw);
+  dp->delete_contentfilteredtopic(cft_a);
+  dp->delete_contentfilteredtopic(cft_b);
+  dp->delete_contentfilteredtopic(cft_c);
+  dp->delete_contentfilteredtopic(cft_d);
+  dp->delete_topic(topic);
+  return passed;
+}
+
 /*
  * NOTE: There is a test almost exactly like this in the QueryConditon test to
  * test the same situation with QueryConditions.
@@ -529,6 +665,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
   bool passed = true;
   passed &= run_filtering_test(dp, ts, pub, sub, sub2);
   passed &= run_unsignedlonglong_test(dp, ts, pub, sub);
+  passed &= run_shared_filter_test(dp, ts, pub, sub);
   passed &= run_dispose_filter_tests(dp, ts, pub, sub);
 
   dp->delete_contained_entities();
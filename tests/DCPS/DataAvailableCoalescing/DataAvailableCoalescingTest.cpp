@@ -0,0 +1,282 @@
+#include "dds/DdsDcpsInfrastructureC.h"
+#include "dds/DCPS/WaitSet.h"
+#include "dds/DCPS/Service_Participant.h"
+#include "dds/DCPS/Marked_Default_Qos.h"
+#include "dds/DCPS/PublisherImpl.h"
+#include "dds/DCPS/SubscriberImpl.h"
+#include "dds/DCPS/StaticIncludes.h"
+#include "dds/DCPS/SafetyProfileStreams.h"
+#include "MessengerTypeSupportImpl.h"
+
+#include "tests/Utils/StatusMatching.h"
+
+#ifdef ACE_AS_STATIC_LIBS
+# include "dds/DCPS/RTPS/RtpsDiscovery.h"
+# include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
+#endif
+
+#include "ace/OS_NS_unistd.h"
+
+#include <iostream>
+#include <map>
+using namespace std;
+using namespace DDS;
+using namespace OpenDDS::DCPS;
+using namespace Messenger;
+
+const CORBA::Long samples_per_burst = 200;
+
+/// Instances the samples of a burst are spread over
+const CORBA::Long instances = 4;
+
+class CountingListener
+  : public virtual OpenDDS::DCPS::LocalObject<DDS::DataReaderListener>
+{
+public:
+  CountingListener()
+    : callbacks_(0)
+    , running_(0)
+    , samples_(0)
+    , in_order_(true)
+    , overlapped_(false)
+  {}
+
+  virtual void on_requested_deadline_missed(
+    DDS::DataReader_ptr /*reader*/,
+    const DDS::RequestedDeadlineMissedStatus & /*status*/) {}
+
+  virtual void on_requested_incompatible_qos(
+    DDS::DataReader_ptr /*reader*/,
+    const DDS::RequestedIncompatibleQosStatus & /*status*/) {}
+
+  virtual void on_liveliness_changed(
+    DDS::DataReader_ptr /*reader*/,
+    const DDS::LivelinessChangedStatus & /*status*/) {}
+
+  virtual void on_subscription_matched(
+    DDS::DataReader_ptr /*reader*/,
+    const DDS::SubscriptionMatchedStatus & /*status*/) {}
+
+  virtual void on_sample_rejected(
+    DDS::DataReader_ptr /*reader*/,
+    const DDS::SampleRejectedStatus& /*status*/) {}
+
+  virtual void on_data_available(DDS::DataReader_ptr reader)
+  {
+    // A reader's callbacks don't overlap, pooled or not
+    if (++running_ > 1) {
+      overlapped_ = true;
+    }
+    on_data_available_i(reader);
+    --running_;
+  }
+
+  void on_data_available_i(DDS::DataReader_ptr reader)
+  {
+    const bool first = ++callbacks_ == 1;
+    if (first) {
+      // Let the rest of the burst arrive while this callback is running
+      ACE_OS::sleep(ACE_Time_Value(0, 200000));
+    }
+
+    MessageDataReader_var mdr = MessageDataReader::_narrow(reader);
+    MessageSeq data;
+    SampleInfoSeq infoseq;
+    const ReturnCode_t rc = mdr->take(data, infoseq, LENGTH_UNLIMITED,
+      ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+    if (rc != RETCODE_OK && rc != RETCODE_NO_DATA) {
+      cerr << "ERROR: take failed: " << retcode_to_string(rc) << endl;
+      return;
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      if (!infoseq[i].valid_data) {
+        continue;
+      }
+      CORBA::Long& next = next_iteration_[data[i].key];
+      if (data[i].iteration != next) {
+        cerr << "ERROR: instance " << data[i].key << " expected iteration "
+          << next << " got " << data[i].iteration << endl;
+        in_order_ = false;
+      }
+      next = data[i].iteration + 1;
+      ++samples_;
+    }
+  }
+
+  virtual void on_sample_lost(DDS::DataReader_ptr /*reader*/,
+                              const DDS::SampleLostStatus& /*status*/) {}
+
+  long callbacks() const { return callbacks_.value(); }
+  long samples() const { return samples_.value(); }
+  bool in_order() const { return in_order_; }
+  bool overlapped() const { return overlapped_.value(); }
+
+private:
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> callbacks_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> running_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> samples_;
+  ACE_Thread_Mutex lock_;
+  /// Next iteration of each instance, by key
+  map<CORBA::Long, CORBA::Long> next_iteration_;
+  bool in_order_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, bool> overlapped_;
+};
+
+bool run_burst_test(const DomainParticipant_var& dp,
+  const MessageTypeSupport_var& ts, const Publisher_var& pub,
+  const Subscriber_var& sub, const char* topicName,
+  const Duration_t& latency_budget, bool coalesce, bool pooled)
+{
+  CORBA::String_var typeName = ts->get_type_name();
+  Topic_var topic = dp->create_topic(topicName, typeName,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+  if (!topic) {
+    cerr << "ERROR: " << topicName << ": create_topic failed" << endl;
+    return false;
+  }
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+  if (!dw) {
+    cerr << "ERROR: " << topicName << ": create_datawriter failed" << endl;
+    return false;
+  }
+
+  SubscriberImpl* const sub_impl = dynamic_cast<SubscriberImpl*>(sub.in());
+  sub_impl->coalesce_data_available() = coalesce;
+  sub_impl->pooled_dispatch() = pooled;
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.latency_budget.duration = latency_budget;
+  CountingListener* const listener_impl = new CountingListener;
+  DataReaderListener_var listener = listener_impl;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, listener,
+                                             DATA_AVAILABLE_STATUS);
+
+  sub_impl->coalesce_data_available() = false;
+  sub_impl->pooled_dispatch() = false;
+
+  if (!dr) {
+    cerr << "ERROR: " << topicName << ": create_datareader failed" << endl;
+    return false;
+  }
+
+  if (Utils::wait_match(dw, 1) != 0) {
+    cerr << "ERROR: " << topicName << ": wait for match failed" << endl;
+    return false;
+  }
+
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  Message sample;
+  for (CORBA::Long i = 0; i < samples_per_burst; ++i) {
+    sample.key = i % instances;
+    sample.iteration = i / instances;
+    const ReturnCode_t ret = mdw->write(sample, HANDLE_NIL);
+    if (ret != RETCODE_OK) {
+      cerr << "ERROR: " << topicName << ": write failed: "
+        << retcode_to_string(ret) << endl;
+      return false;
+    }
+  }
+
+  for (int i = 0; i < 100 && listener_impl->samples() < samples_per_burst; ++i) {
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+
+  bool passed = true;
+  if (listener_impl->samples() != samples_per_burst) {
+    cerr << "ERROR: " << topicName << ": received " << listener_impl->samples()
+      << " of " << samples_per_burst << " samples" << endl;
+    passed = false;
+  }
+  if (coalesce && listener_impl->callbacks() >= samples_per_burst) {
+    cerr << "ERROR: " << topicName << ": " << listener_impl->callbacks()
+      << " callbacks were not coalesced" << endl;
+    passed = false;
+  }
+  if (!listener_impl->in_order()) {
+    cerr << "ERROR: " << topicName << ": samples out of order" << endl;
+    passed = false;
+  }
+  if (listener_impl->overlapped()) {
+    cerr << "ERROR: " << topicName << ": callbacks ran concurrently" << endl;
+    passed = false;
+  }
+
+  // A burst after the first one raises a callback again, the in-flight
+  // and queued flags were cleared.
+  const long callbacks = listener_impl->callbacks();
+  sample.key = 0;
+  sample.iteration = samples_per_burst / instances;
+  mdw->write(sample, HANDLE_NIL);
+  for (int i = 0; i < 50 && listener_impl->callbacks() == callbacks; ++i) {
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+  if (listener_impl->callbacks() == callbacks) {
+    cerr << "ERROR: " << topicName << ": no callback after the burst" << endl;
+    passed = false;
+  }
+
+  sub->delete_datareader(dr);
+  pub->delete_datawriter(dw);
+  dp->delete_topic(topic);
+  return passed;
+}
+
+int run_test(int argc, ACE_TCHAR *argv[])
+{
+  DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  TheServiceParticipant->listener_dispatch_threads(4);
+  DomainParticipant_var dp =
+    dpf->create_participant(23, PARTICIPANT_QOS_DEFAULT, 0,
+                            DEFAULT_STATUS_MASK);
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+                                           DEFAULT_STATUS_MASK);
+
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+                                             DEFAULT_STATUS_MASK);
+
+  const Duration_t no_window = {0, 0};
+  const Duration_t window = {0, 50000000};
+
+  bool passed = true;
+  passed &= run_burst_test(dp, ts, pub, sub, "Inline", no_window, true, false);
+  passed &= run_burst_test(dp, ts, pub, sub, "Window", window, true, false);
+  passed &= run_burst_test(dp, ts, pub, sub, "Pooled", no_window, true, true);
+  // Pooled without coalescing, each instance's samples are still taken in
+  // order and the reader's callbacks don't overlap
+  passed &= run_burst_test(dp, ts, pub, sub, "PooledOrder", no_window, false, true);
+
+  dp->delete_contained_entities();
+  dpf->delete_participant(dp);
+  return passed ? 0 : 1;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
+{
+  int ret = 1;
+  try
+  {
+    ret = run_test(argc, argv);
+  }
+  catch (const CORBA::BAD_PARAM& ex) {
+    ex._tao_print_exception("Exception caught in DataAvailableCoalescingTest.cpp:");
+    return 1;
+  }
+
+  TheServiceParticipant->shutdown();
+  ACE_Thread_Manager::instance()->wait();
+  return ret;
+}
@@ -7,6 +7,7 @@
 #include "dds/DCPS/FilterExpressionGrammar.h"
 #include "dds/DCPS/yard/yard_parser.hpp"
 #include "dds/DCPS/FilterEvaluator.h"
+#include "dds/DCPS/SampleView.h"
 
 #include "ace/OS_main.h"
 #include "ace/OS_NS_string.h"
@@ -26,6 +27,10 @@ bool doEvalTest(const char* (&input)[N], bool expected, const T& sample,
       const bool result = fe.eval(sample, params);
       if (result != expected) pass = false;
       std::cout << input[i] << " => " << result << std::endl;
+      const bool compiled_result =
+        fe.compile(OpenDDS::DCPS::getMetaStruct<T>(), params)->eval(sample);
+      if (compiled_result != expected) pass = false;
+      std::cout << input[i] << " (compiled) => " << compiled_result << std::endl;
     } catch (const std::exception& e) {
       if (expected) pass = false;
       std::cout << input[i] << " => exception " << e.what() << std::endl;
@@ -75,6 +80,194 @@ bool testEval() {
 
 }
 
+Filtered::Record makeRecord()
+{
+  Filtered::Record sample;
+  sample.flag = 7;
+  sample.count = 42;
+  sample.total = ACE_INT64(1) << 40;
+  sample.origin.x = -3;
+  sample.origin.y = 123456789;
+  for (CORBA::ULong i = 0; i < 3; ++i) {
+    sample.values[i] = static_cast<CORBA::Long>(i);
+  }
+  sample.enabled = true;
+  sample.ratio = 0.25;
+  sample.label = "record";
+  sample.after_label = 17;
+  sample.after_origin.x = 5;
+  sample.after_origin.y = -9;
+  return sample;
+}
+
+/// 'sample' serialized as a writer would: CDR-aligned with an
+/// encapsulation header, byte-swapped, or unaligned
+OpenDDS::DCPS::SerializedPayload serializeRecord(const Filtered::Record& sample,
+                                                 bool swap, bool cdr)
+{
+  using namespace OpenDDS::DCPS;
+  SerializedPayload payload;
+  payload.data_ = Message_Block_Shared_Ptr(new ACE_Message_Block(512));
+  payload.swap_bytes_ = swap;
+  payload.cdr_encapsulation_ = cdr;
+  Serializer ser(payload.data_.get(), swap,
+                 cdr ? Serializer::ALIGN_CDR : Serializer::ALIGN_NONE);
+  if (cdr) {
+    const ACE_CDR::ULong header = 0;
+    ser << header;
+    ser.reset_alignment();
+  }
+  if (!(ser << sample)) {
+    payload.data_.reset();
+  }
+  return payload;
+}
+
+template<size_t N>
+bool doSerializedEvalTest(const char* (&input)[N], bool expected,
+                          const Filtered::Record& sample,
+                          const OpenDDS::DCPS::SerializedPayload& payload,
+                          const DDS::StringSeq& params)
+{
+  using namespace OpenDDS::DCPS;
+  const MetaStruct& meta = getMetaStruct<Filtered::Record>();
+  bool pass = true;
+  for (size_t i = 0; i < N; ++i) {
+    try {
+      FilterEvaluator fe(input[i], false);
+      const bool deserialized = fe.eval(sample, params);
+      const bool serialized = fe.eval(payload.data_.get(), payload.swap_bytes_,
+                                      payload.cdr_encapsulation_, meta, params);
+      const bool compiled = fe.compile(meta, params, true)->eval(
+        payload.data_.get(), payload.swap_bytes_, payload.cdr_encapsulation_);
+      if (deserialized != expected || serialized != expected
+          || compiled != expected) {
+        pass = false;
+      }
+      std::cout << input[i] << " => " << deserialized << " (serialized) => "
+        << serialized << " (compiled serialized) => " << compiled << std::endl;
+    } catch (const std::exception& e) {
+      pass = false;
+      std::cout << input[i] << " => exception " << e.what() << std::endl;
+    }
+  }
+  return pass;
+}
+
+/// getSerializedAccess() finds the members at a fixed offset, including
+/// the ones of nested structs, and reads them like the sample has them
+bool testSerializedAccess(const Filtered::Record& sample,
+                          const OpenDDS::DCPS::SerializedPayload& payload)
+{
+  using namespace OpenDDS::DCPS;
+  const MetaStruct& meta = getMetaStruct<Filtered::Record>();
+  bool pass = true;
+
+  struct Expected {
+    const char* field;
+    Value value;
+  };
+  const Expected fixed[] = {
+    {"flag", Value(static_cast<unsigned int>(sample.flag))},
+    {"count", Value(static_cast<int>(sample.count))},
+    {"total", Value(static_cast<ACE_INT64>(sample.total))},
+    {"origin.x", Value(static_cast<int>(sample.origin.x))},
+    {"origin.y", Value(static_cast<ACE_INT64>(sample.origin.y))},
+    {"enabled", Value(static_cast<bool>(sample.enabled))},
+    {"ratio", Value(sample.ratio)}
+  };
+  const size_t header =
+    payload.cdr_encapsulation_ ? SerializedPayload::encapsulation_header_size : 0;
+  for (size_t i = 0; i < sizeof fixed / sizeof fixed[0]; ++i) {
+    size_t aligned = 0, packed = 0;
+    MetaStruct::SerializedValueAccess access = 0;
+    if (!meta.getSerializedAccess(fixed[i].field, aligned, packed, access) || !access) {
+      std::cout << "getSerializedAccess(" << fixed[i].field << ") failed" << std::endl;
+      pass = false;
+      continue;
+    }
+    Value value = access(payload, aligned, packed);
+    Value expected = fixed[i].value;
+    Value::conversion(value, expected);
+    if (!(value == expected)) {
+      std::cout << "getSerializedAccess(" << fixed[i].field << ") read the wrong value"
+        << " at offset " << (payload.cdr_encapsulation_ ? header + aligned : packed)
+        << std::endl;
+      pass = false;
+    }
+  }
+
+  const char* const skipped[] = {"label", "after_label", "after_origin.x", "none"};
+  for (size_t i = 0; i < sizeof skipped / sizeof skipped[0]; ++i) {
+    size_t aligned = 0, packed = 0;
+    MetaStruct::SerializedValueAccess access = 0;
+    if (meta.getSerializedAccess(skipped[i], aligned, packed, access)) {
+      std::cout << "getSerializedAccess(" << skipped[i] << ") should fail" << std::endl;
+      pass = false;
+    }
+  }
+
+  // A nested struct of fixed size is skipped as a whole
+  size_t aligned = 0, packed = 0;
+  MetaStruct::SerializedValueAccess access = 0;
+  if (!getMetaStruct<Filtered::Point>().getSerializedAccess("", aligned, packed, access)
+      || aligned != 16 || packed != 10) {
+    std::cout << "getSerializedAccess() didn't skip Point" << std::endl;
+    pass = false;
+  }
+  return pass;
+}
+
+bool testSerializedEval()
+{
+  try {
+    const Filtered::Record sample = makeRecord();
+
+    DDS::StringSeq params;
+    params.length(1);
+    params[0] = "100";
+
+    static const char* filters_pass[] = {"flag = 7",
+                                         "count > 40 AND total > count",
+                                         "origin.x < 0 AND origin.y = 123456789",
+                                         "ratio < 0.5",
+                                         "label = 'record'",
+                                         "after_label = 17",
+                                         "after_origin.y < after_origin.x",
+                                         "count < %0 AND after_label < %0",
+                                         "MOD(count, 6) = 0"};
+
+    static const char* filters_fail[] = {"flag <> 7",
+                                         "total < count",
+                                         "origin.x > 0",
+                                         "ratio BETWEEN 0.5 AND 1",
+                                         "label LIKE 'x%'",
+                                         "after_label = 18",
+                                         "after_origin.x = after_origin.y",
+                                         "count > %0",
+                                         "MOD(count, 5) = 0"};
+
+    bool ok = true;
+    for (int pass = 0; pass < 3; ++pass) {
+      const bool swap = pass == 1, cdr = pass != 2;
+      const OpenDDS::DCPS::SerializedPayload payload = serializeRecord(sample, swap, cdr);
+      if (!payload.data_) {
+        std::cout << "serializing Record failed" << std::endl;
+        return false;
+      }
+      std::cout << "serialized " << (cdr ? "with" : "without")
+        << " CDR encapsulation" << (swap ? ", swapped" : "") << std::endl;
+      ok &= doSerializedEvalTest(filters_pass, true, sample, payload, params);
+      ok &= doSerializedEvalTest(filters_fail, false, sample, payload, params);
+      ok &= testSerializedAccess(sample, payload);
+    }
+    return ok;
+
+  } catch (const CORBA::BAD_PARAM&) {
+    return false;
+  }
+}
+
 // parsing test helpers
 namespace yard_test {
 
@@ -233,6 +426,7 @@ int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
 
   bool ok = testParsing();
   ok &= testEval();
+  ok &= testSerializedEval();
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
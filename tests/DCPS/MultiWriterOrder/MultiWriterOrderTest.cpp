@@ -0,0 +1,199 @@
+#include "dds/DdsDcpsInfrastructureC.h"
+#include "dds/DCPS/WaitSet.h"
+#include "dds/DCPS/Service_Participant.h"
+#include "dds/DCPS/Marked_Default_Qos.h"
+#include "dds/DCPS/PublisherImpl.h"
+#include "dds/DCPS/SubscriberImpl.h"
+#include "dds/DCPS/StaticIncludes.h"
+#include "dds/DCPS/SafetyProfileStreams.h"
+#include "MessengerTypeSupportImpl.h"
+
+#include "tests/Utils/StatusMatching.h"
+#include "tests/Utils/TakeSamples.h"
+
+#ifdef ACE_AS_STATIC_LIBS
+# include "dds/DCPS/RTPS/RtpsDiscovery.h"
+# include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
+#endif
+
+#include "ace/Task.h"
+
+#include <iostream>
+#include <map>
+using namespace std;
+using namespace DDS;
+using namespace OpenDDS::DCPS;
+using namespace Messenger;
+
+const int writer_count = 4;
+
+/// Written by each writer before the reader exists and redelivered to it
+/// as historic samples
+const CORBA::Long historic_samples = 20;
+
+/// Written by each writer, concurrently, once it matched the reader
+const CORBA::Long live_samples = 200;
+
+const CORBA::Long samples_per_writer = historic_samples + live_samples;
+
+bool write(const MessageDataWriter_var& mdw, int writer, CORBA::Long iteration)
+{
+  Message sample;
+  // Writers share instances, so instances receive samples from several
+  // writers at once
+  sample.key = writer % 2;
+  sample.iteration = iteration;
+  const ReturnCode_t ret = mdw->write(sample, HANDLE_NIL);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: writer " << writer << " iteration " << iteration
+      << " write failed: " << retcode_to_string(ret) << endl;
+    return false;
+  }
+  return true;
+}
+
+class WriterTask : public ACE_Task_Base {
+public:
+  WriterTask(const DataWriter_var& dw, int writer)
+    : mdw_(MessageDataWriter::_narrow(dw))
+    , writer_(writer)
+    , passed_(true)
+  {}
+
+  int svc()
+  {
+    for (CORBA::Long i = historic_samples; i < samples_per_writer; ++i) {
+      passed_ &= write(mdw_, writer_, i);
+    }
+    return 0;
+  }
+
+  bool passed() const { return passed_; }
+
+private:
+  MessageDataWriter_var mdw_;
+  const int writer_;
+  bool passed_;
+};
+
+/// Checks that every writer's samples, historic and live, are received
+/// once each and in the order that writer wrote them
+class OrderCheck {
+public:
+  bool operator()(const Message& sample, const SampleInfo& info)
+  {
+    CORBA::Long& next = next_iteration_[info.publication_handle];
+    const bool in_order = sample.iteration == next;
+    if (!in_order) {
+      cerr << "ERROR: writer " << info.publication_handle
+        << " expected iteration " << next << " got " << sample.iteration << endl;
+    }
+    next = sample.iteration + 1;
+    return in_order;
+  }
+
+  size_t writers() const { return next_iteration_.size(); }
+
+private:
+  map<InstanceHandle_t, CORBA::Long> next_iteration_;
+};
+
+int run_test(int argc, ACE_TCHAR *argv[])
+{
+  DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  DomainParticipant_var dp =
+    dpf->create_participant(23, PARTICIPANT_QOS_DEFAULT, 0,
+                            DEFAULT_STATUS_MASK);
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var typeName = ts->get_type_name();
+  Topic_var topic = dp->create_topic("MultiWriterOrder", typeName,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+                                           DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+                                             DEFAULT_STATUS_MASK);
+  if (!topic || !pub || !sub) {
+    cerr << "ERROR: setup failed" << endl;
+    return 1;
+  }
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.durability.kind = TRANSIENT_LOCAL_DURABILITY_QOS;
+
+  bool passed = true;
+  DataWriter_var writers[writer_count];
+  for (int w = 0; w < writer_count; ++w) {
+    writers[w] = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+    if (!writers[w]) {
+      cerr << "ERROR: create_datawriter failed" << endl;
+      return 1;
+    }
+    MessageDataWriter_var mdw = MessageDataWriter::_narrow(writers[w]);
+    for (CORBA::Long i = 0; i < historic_samples; ++i) {
+      passed &= write(mdw, w, i);
+    }
+  }
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.durability.kind = TRANSIENT_LOCAL_DURABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0, DEFAULT_STATUS_MASK);
+  if (!dr) {
+    cerr << "ERROR: create_datareader failed" << endl;
+    return 1;
+  }
+
+  // Live samples race the historic ones to the reader, which has to hold
+  // them back until each writer's history was delivered
+  WriterTask* tasks[writer_count];
+  for (int w = 0; w < writer_count; ++w) {
+    if (Utils::wait_match(writers[w], 1) != 0) {
+      cerr << "ERROR: writer " << w << " didn't match" << endl;
+      return 1;
+    }
+    tasks[w] = new WriterTask(writers[w], w);
+    tasks[w]->activate();
+  }
+
+  OrderCheck check;
+  passed &= Utils::take_samples<Message>(dr, writer_count * samples_per_writer,
+                                         check, "MultiWriterOrder", 200);
+  if (check.writers() != static_cast<size_t>(writer_count)) {
+    cerr << "ERROR: received samples from " << check.writers() << " writers" << endl;
+    passed = false;
+  }
+
+  for (int w = 0; w < writer_count; ++w) {
+    tasks[w]->wait();
+    passed &= tasks[w]->passed();
+    delete tasks[w];
+  }
+
+  dp->delete_contained_entities();
+  dpf->delete_participant(dp);
+  return passed ? 0 : 1;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
+{
+  int ret = 1;
+  try
+  {
+    ret = run_test(argc, argv);
+  }
+  catch (const CORBA::BAD_PARAM& ex) {
+    ex._tao_print_exception("Exception caught in MultiWriterOrderTest.cpp:");
+    return 1;
+  }
+
+  TheServiceParticipant->shutdown();
+  ACE_Thread_Manager::instance()->wait();
+  return ret;
+}
@@ -0,0 +1,165 @@
+#include "dds/DdsDcpsInfrastructureC.h"
+#include "dds/DCPS/Service_Participant.h"
+#include "dds/DCPS/Marked_Default_Qos.h"
+#include "dds/DCPS/PublisherImpl.h"
+#include "dds/DCPS/SubscriberImpl.h"
+#include "dds/DCPS/StaticIncludes.h"
+#include "dds/DCPS/SafetyProfileStreams.h"
+#include "MessengerTypeSupportImpl.h"
+
+#include "tests/Utils/StatusMatching.h"
+
+#ifdef ACE_AS_STATIC_LIBS
+# include "dds/DCPS/RTPS/RtpsDiscovery.h"
+# include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
+#endif
+
+#include "ace/OS_NS_unistd.h"
+
+#include <iostream>
+#include <set>
+using namespace std;
+using namespace DDS;
+using namespace OpenDDS::DCPS;
+using namespace Messenger;
+
+/// Instances the reader has before the walk starts
+const CORBA::Long initial_instances = 64;
+
+/// Instances added one per step of the walk, enough for a hash map to
+/// rehash at least once
+const CORBA::Long added_instances = 256;
+
+/// Write 'key' and wait until the reader has its instance
+InstanceHandle_t add_instance(const MessageDataWriter_var& mdw,
+                              const MessageDataReader_var& mdr, CORBA::Long key)
+{
+  Message sample;
+  sample.key = key;
+  sample.iteration = 0;
+  const ReturnCode_t ret = mdw->write(sample, HANDLE_NIL);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: write of key " << key << " failed: " << retcode_to_string(ret) << endl;
+    return HANDLE_NIL;
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const InstanceHandle_t handle = mdr->lookup_instance(sample);
+    if (handle != HANDLE_NIL) {
+      return handle;
+    }
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+  cerr << "ERROR: the reader didn't receive key " << key << endl;
+  return HANDLE_NIL;
+}
+
+int run_test(int argc, ACE_TCHAR *argv[])
+{
+  DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  DomainParticipant_var dp =
+    dpf->create_participant(23, PARTICIPANT_QOS_DEFAULT, 0,
+                            DEFAULT_STATUS_MASK);
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var typeName = ts->get_type_name();
+  Topic_var topic = dp->create_topic("NextInstance", typeName,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+                                           DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+                                             DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0, DEFAULT_STATUS_MASK);
+
+  if (!topic || !dw || !dr || Utils::wait_match(dw, 1) != 0) {
+    cerr << "ERROR: setup failed" << endl;
+    return 1;
+  }
+
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+  bool passed = true;
+
+  set<InstanceHandle_t> initial;
+  for (CORBA::Long key = 0; key < initial_instances; ++key) {
+    const InstanceHandle_t handle = add_instance(mdw, mdr, key);
+    if (handle == HANDLE_NIL) {
+      return 1;
+    }
+    initial.insert(handle);
+  }
+
+  // The reader's instances grow while read_next_instance walks them, the
+  // walk still has to visit each instance it started with exactly once
+  set<InstanceHandle_t> visited;
+  InstanceHandle_t handle = HANDLE_NIL;
+  CORBA::Long added = 0;
+  while (true) {
+    MessageSeq data;
+    SampleInfoSeq infoseq;
+    const ReturnCode_t ret = mdr->read_next_instance(data, infoseq, LENGTH_UNLIMITED,
+      handle, ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+    if (ret == RETCODE_NO_DATA) {
+      break;
+    } else if (ret != RETCODE_OK) {
+      cerr << "ERROR: read_next_instance failed: " << retcode_to_string(ret) << endl;
+      passed = false;
+      break;
+    }
+
+    handle = infoseq[0].instance_handle;
+    if (!visited.insert(handle).second) {
+      cerr << "ERROR: instance " << handle << " was visited twice" << endl;
+      passed = false;
+      break;
+    }
+
+    if (added < added_instances) {
+      if (add_instance(mdw, mdr, initial_instances + added) == HANDLE_NIL) {
+        passed = false;
+        break;
+      }
+      ++added;
+    }
+  }
+
+  for (set<InstanceHandle_t>::const_iterator it = initial.begin(); it != initial.end(); ++it) {
+    if (!visited.count(*it)) {
+      cerr << "ERROR: instance " << *it << " was skipped" << endl;
+      passed = false;
+    }
+  }
+
+  dp->delete_contained_entities();
+  dpf->delete_participant(dp);
+  return passed ? 0 : 1;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
+{
+  int ret = 1;
+  try
+  {
+    ret = run_test(argc, argv);
+  }
+  catch (const CORBA::BAD_PARAM& ex) {
+    ex._tao_print_exception("Exception caught in NextInstanceTest.cpp:");
+    return 1;
+  }
+
+  TheServiceParticipant->shutdown();
+  ACE_Thread_Manager::instance()->wait();
+  return ret;
+}
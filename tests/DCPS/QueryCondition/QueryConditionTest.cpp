@@ -13,6 +13,8 @@
 # include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
 #endif
 
+#include "ace/OS_NS_unistd.h"
+
 #include <cstdlib>
 #include <iostream>
 using namespace std;
@@ -803,6 +805,208 @@ bool run_dispose_filter_tests(const DomainParticipant_var& dp,
   return true;
 }
 
+/// Bit (1 << key) for each key read or taken with 'qc', -1 on error
+int query_keys(const MessageDataReader_var& mdr, const ReadCondition_var& qc,
+  bool take = false)
+{
+  MessageSeq data;
+  SampleInfoSeq infoseq;
+  const ReturnCode_t ret = take
+    ? mdr->take_w_condition(data, infoseq, LENGTH_UNLIMITED, qc)
+    : mdr->read_w_condition(data, infoseq, LENGTH_UNLIMITED, qc);
+  if (ret == RETCODE_NO_DATA) {
+    return 0;
+  } else if (ret != RETCODE_OK) {
+    cerr << "ERROR: query_keys: " << (take ? "take" : "read")
+      << "_w_condition failed: " << retcode_to_string(ret) << endl;
+    return -1;
+  }
+  int keys = 0;
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    keys |= 1 << data[i].key;
+  }
+  mdr->return_loan(data, infoseq);
+  return keys;
+}
+
+/// Wait until the reader has the sample 'key', 'iteration' (any sample
+/// if 'iteration' is negative) in an instance matching 'instance_states'
+bool wait_for_instance(const MessageDataReader_var& mdr, CORBA::Long key,
+  CORBA::Long iteration, InstanceStateMask instance_states = ANY_INSTANCE_STATE)
+{
+  Message sample;
+  sample.key = key;
+  for (int i = 0; i < 50; ++i) {
+    const InstanceHandle_t handle = mdr->lookup_instance(sample);
+    if (handle != HANDLE_NIL) {
+      MessageSeq data;
+      SampleInfoSeq infoseq;
+      if (mdr->read_instance(data, infoseq, LENGTH_UNLIMITED, handle,
+            ANY_SAMPLE_STATE, ANY_VIEW_STATE, instance_states) == RETCODE_OK) {
+        for (CORBA::ULong j = 0; j < data.length(); ++j) {
+          if (iteration < 0 || (infoseq[j].valid_data && data[j].iteration == iteration)) {
+            return true;
+          }
+        }
+      }
+    }
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+  cerr << "ERROR: wait_for_instance: no sample " << key << ", " << iteration << endl;
+  return false;
+}
+
+bool write_sample(const MessageDataWriter_var& mdw, CORBA::Long key,
+  CORBA::Long iteration)
+{
+  Message sample;
+  sample.key = key;
+  sample.iteration = iteration;
+  sample.name = "indexed";
+  sample.nest.value = A;
+  const ReturnCode_t ret = mdw->write(sample, HANDLE_NIL);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: write_sample: write failed: " << retcode_to_string(ret) << endl;
+    return false;
+  }
+  return true;
+}
+
+bool check_keys(const char* step, int keys, int expected)
+{
+  if (keys != expected) {
+    cerr << "ERROR: run_indexed_query_test: " << step << ": got keys " << keys
+      << ", expected " << expected << endl;
+    return false;
+  }
+  return true;
+}
+
+bool run_indexed_query_test(const DomainParticipant_var& dp,
+  const MessageTypeSupport_var& ts, const Publisher_var& pub,
+  const Subscriber_var& sub)
+{
+  CORBA::String_var typeName = ts->get_type_name();
+  Topic_var topic = dp->create_topic("IndexedQuery", typeName,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+
+  // Depth 1 so that a new sample evicts the previous one of the instance
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_LAST_HISTORY_QOS;
+  dr_qos.history.depth = 1;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0, DEFAULT_STATUS_MASK);
+  if (!topic || !dw || !dr) {
+    cerr << "ERROR: run_indexed_query_test: setup failed" << endl;
+    return false;
+  }
+
+  StatusCondition_var dw_sc = dw->get_statuscondition();
+  dw_sc->set_enabled_statuses(PUBLICATION_MATCHED_STATUS);
+  WaitSet_var ws = new WaitSet;
+  ws->attach_condition(dw_sc);
+  ConditionSeq active;
+  ws->wait(active, max_wait_time);
+  ws->detach_condition(dw_sc);
+
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+
+  DDS::StringSeq params(1);
+  params.length(1);
+  params[0] = "10";
+  ReadCondition_var dr_qc = dr->create_querycondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ALIVE_INSTANCE_STATE, "iteration > %0", params);
+  QueryCondition_var query_cond = QueryCondition::_narrow(dr_qc);
+  if (!query_cond) {
+    cerr << "ERROR: run_indexed_query_test: create_querycondition failed" << endl;
+    return false;
+  }
+
+  bool passed = true;
+
+  // Samples that arrive before the condition was ever used, and after its
+  // parameters changed, are found by read and take
+  if (!write_sample(mdw, 1, 20) || !write_sample(mdw, 2, 5)
+      || !wait_for_instance(mdr, 1, 20) || !wait_for_instance(mdr, 2, 5)) {
+    return false;
+  }
+  query_cond->set_query_parameters(params);
+  if (!write_sample(mdw, 3, 30) || !wait_for_instance(mdr, 3, 30)) {
+    return false;
+  }
+  passed &= check_keys("stored while invalid", query_keys(mdr, dr_qc), (1 << 1) | (1 << 3));
+  if (!query_cond->get_trigger_value()) {
+    cerr << "ERROR: run_indexed_query_test: trigger value should be true" << endl;
+    passed = false;
+  }
+
+  // New parameters invalidate the results cached with the samples
+  params[0] = "25";
+  query_cond->set_query_parameters(params);
+  passed &= check_keys("parameter 25", query_keys(mdr, dr_qc), 1 << 3);
+  params[0] = "0";
+  query_cond->set_query_parameters(params);
+  passed &= check_keys("parameter 0", query_keys(mdr, dr_qc), (1 << 1) | (1 << 2) | (1 << 3));
+  params[0] = "10";
+  query_cond->set_query_parameters(params);
+  passed &= check_keys("parameter 10", query_keys(mdr, dr_qc), (1 << 1) | (1 << 3));
+
+  // Evicting the only matching sample of instance 1
+  if (!write_sample(mdw, 1, 0) || !wait_for_instance(mdr, 1, 0)) {
+    return false;
+  }
+  passed &= check_keys("evicted", query_keys(mdr, dr_qc), 1 << 3);
+
+  // Taking the matching sample of instance 3, then a new one
+  passed &= check_keys("take", query_keys(mdr, dr_qc, true), 1 << 3);
+  if (query_cond->get_trigger_value()) {
+    cerr << "ERROR: run_indexed_query_test: trigger value should be false after take" << endl;
+    passed = false;
+  }
+  passed &= check_keys("after take", query_keys(mdr, dr_qc), 0);
+  if (!write_sample(mdw, 3, 40) || !wait_for_instance(mdr, 3, 40)) {
+    return false;
+  }
+  passed &= check_keys("after new sample", query_keys(mdr, dr_qc), 1 << 3);
+  if (!query_cond->get_trigger_value()) {
+    cerr << "ERROR: run_indexed_query_test: trigger value should be true after new sample" << endl;
+    passed = false;
+  }
+
+  // Disposing instance 3 takes it out of an ALIVE condition until it is
+  // written again
+  Message sample;
+  sample.key = 3;
+  if (mdw->dispose(sample, HANDLE_NIL) != RETCODE_OK
+      || !wait_for_instance(mdr, 3, -1, NOT_ALIVE_DISPOSED_INSTANCE_STATE)) {
+    cerr << "ERROR: run_indexed_query_test: dispose failed" << endl;
+    return false;
+  }
+  if (query_cond->get_trigger_value()) {
+    cerr << "ERROR: run_indexed_query_test: trigger value should be false after dispose" << endl;
+    passed = false;
+  }
+  passed &= check_keys("after dispose", query_keys(mdr, dr_qc), 0);
+  if (!write_sample(mdw, 3, 50) || !wait_for_instance(mdr, 3, 50, ALIVE_INSTANCE_STATE)) {
+    return false;
+  }
+  passed &= check_keys("after rewrite", query_keys(mdr, dr_qc), 1 << 3);
+
+  dr->delete_readcondition(dr_qc);
+  sub->delete_datareader(dr);
+  pub->delete_datawriter(dw);
+  dp->delete_topic(topic);
+  return passed;
+}
+
 int run_test(int argc, ACE_TCHAR *argv[])
 {
   DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
@@ -824,6 +1028,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
   passed &= run_change_parameter_test(dp, ts, pub, sub);
   passed &= run_complex_filtering_test(dp, ts, pub, sub);
   passed &= run_dispose_filter_tests(dp, ts, pub, sub);
+  passed &= run_indexed_query_test(dp, ts, pub, sub);
 
   dp->delete_contained_entities();
   dpf->delete_participant(dp);
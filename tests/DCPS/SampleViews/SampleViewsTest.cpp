@@ -0,0 +1,293 @@
+#include "dds/DdsDcpsInfrastructureC.h"
+#include "dds/DCPS/WaitSet.h"
+#include "dds/DCPS/Service_Participant.h"
+#include "dds/DCPS/Marked_Default_Qos.h"
+#include "dds/DCPS/PublisherImpl.h"
+#include "dds/DCPS/SubscriberImpl.h"
+#include "dds/DCPS/StaticIncludes.h"
+#include "dds/DCPS/SafetyProfileStreams.h"
+#include "MessengerTypeSupportImpl.h"
+
+#include "tests/Utils/StatusMatching.h"
+
+#ifdef ACE_AS_STATIC_LIBS
+# include "dds/DCPS/RTPS/RtpsDiscovery.h"
+# include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
+#endif
+
+#include "ace/OS_NS_unistd.h"
+
+#include <cstring>
+#include <iostream>
+using namespace std;
+using namespace DDS;
+using namespace OpenDDS::DCPS;
+using namespace Messenger;
+
+typedef MessageTypeSupportImpl::DataReaderImplType MessageDataReaderImpl;
+typedef SampleViewSeq<Message_OpenDDS_View> MessageViewSeq;
+
+/// Written after views were enabled
+const CORBA::Long viewed_samples = 10;
+
+const char* expected_text(CORBA::Long iteration)
+{
+  return iteration == 0 ? "before" : iteration % 2 ? "odd" : "even";
+}
+
+/// Read views until the reader has 'expected' samples
+bool wait_for_views(MessageDataReaderImpl* reader, CORBA::ULong expected,
+                    MessageViewSeq& views, SampleInfoSeq& infoseq)
+{
+  for (int i = 0; i < 100; ++i) {
+    MessageViewSeq read;
+    SampleInfoSeq read_info;
+    const ReturnCode_t ret = reader->read_views(read, read_info, LENGTH_UNLIMITED,
+      ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+    if (ret == RETCODE_OK && read.length() >= expected) {
+      views = read;
+      infoseq = read_info;
+      return true;
+    } else if (ret != RETCODE_OK && ret != RETCODE_NO_DATA) {
+      cerr << "ERROR: read_views failed: " << retcode_to_string(ret) << endl;
+      return false;
+    }
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+  cerr << "ERROR: timed out waiting for " << expected << " samples" << endl;
+  return false;
+}
+
+bool write(const MessageDataWriter_var& mdw, CORBA::Long iteration)
+{
+  Message sample;
+  sample.key = iteration % 2;
+  sample.iteration = iteration;
+  sample.text = expected_text(iteration);
+  const ReturnCode_t ret = mdw->write(sample, HANDLE_NIL);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: write failed: " << retcode_to_string(ret) << endl;
+    return false;
+  }
+  return true;
+}
+
+/// Views of the samples written after enable_views() have the members at
+/// a fixed offset and the rest through to_sample(), views of the one
+/// written before aren't valid().
+bool check_views(const MessageViewSeq& views, const SampleInfoSeq& infoseq)
+{
+  bool passed = true;
+  bool before_seen = false;
+  CORBA::Long viewed = 0;
+  for (CORBA::ULong i = 0; i < views.length(); ++i) {
+    if (!infoseq[i].valid_data) {
+      cerr << "ERROR: sample " << i << " has no valid data" << endl;
+      passed = false;
+      continue;
+    }
+    const Message_OpenDDS_View& view = views[i];
+    if (!view.valid()) {
+      if (before_seen) {
+        cerr << "ERROR: more than one view isn't valid" << endl;
+        passed = false;
+      }
+      before_seen = true;
+      continue;
+    }
+    ++viewed;
+
+    Message sample;
+    if (!view.to_sample(sample)) {
+      cerr << "ERROR: to_sample failed" << endl;
+      passed = false;
+      continue;
+    }
+    if (view.key() != sample.key || view.iteration() != sample.iteration
+        || view.key() != view.iteration() % 2
+        || std::strcmp(sample.text.in(), expected_text(view.iteration()))) {
+      cerr << "ERROR: view of iteration " << view.iteration()
+        << " doesn't match its sample" << endl;
+      passed = false;
+    }
+  }
+  if (!before_seen || viewed != viewed_samples) {
+    cerr << "ERROR: " << viewed << " valid views, expected " << viewed_samples
+      << " and one that isn't valid" << endl;
+    passed = false;
+  }
+  return passed;
+}
+
+/// Deferred samples are completed when they are read as Messages, either
+/// through a QueryCondition or through plain read()
+bool check_completion(const MessageDataReader_var& mdr)
+{
+  bool passed = true;
+
+  StringSeq params;
+  QueryCondition_var qc = mdr->create_querycondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ANY_INSTANCE_STATE, "text = 'odd'", params);
+  MessageSeq data;
+  SampleInfoSeq infoseq;
+  ReturnCode_t ret = mdr->read_w_condition(data, infoseq, LENGTH_UNLIMITED, qc);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: read_w_condition failed: " << retcode_to_string(ret) << endl;
+    passed = false;
+  } else if (data.length() != viewed_samples / 2) {
+    cerr << "ERROR: the query matched " << data.length() << " samples" << endl;
+    passed = false;
+  }
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    if (!infoseq[i].valid_data || data[i].iteration % 2 == 0
+        || std::strcmp(data[i].text.in(), "odd")) {
+      cerr << "ERROR: the query matched iteration " << data[i].iteration << endl;
+      passed = false;
+    }
+  }
+  mdr->delete_readcondition(qc);
+
+  data.length(0);
+  infoseq.length(0);
+  ret = mdr->read(data, infoseq, LENGTH_UNLIMITED,
+    ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  if (ret != RETCODE_OK || data.length() != viewed_samples + 1) {
+    cerr << "ERROR: read returned " << data.length() << " samples: "
+      << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    if (!infoseq[i].valid_data || data[i].key != data[i].iteration % 2
+        || std::strcmp(data[i].text.in(), expected_text(data[i].iteration))) {
+      cerr << "ERROR: iteration " << data[i].iteration << " wasn't completed" << endl;
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+/// 'taken' is left with the views taken from the reader, which stay valid
+/// after the reader is gone.
+int run_test(int argc, ACE_TCHAR *argv[], MessageViewSeq& taken,
+             SampleInfoSeq& taken_info)
+{
+  DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  DomainParticipant_var dp =
+    dpf->create_participant(23, PARTICIPANT_QOS_DEFAULT, 0,
+                            DEFAULT_STATUS_MASK);
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var typeName = ts->get_type_name();
+  Topic_var topic = dp->create_topic("SampleViews", typeName,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+                                           DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+                                             DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0, DEFAULT_STATUS_MASK);
+
+  if (!topic || !dw || !dr || Utils::wait_match(dw, 1) != 0) {
+    cerr << "ERROR: setup failed" << endl;
+    return 1;
+  }
+
+  MessageDataReaderImpl* const reader = dynamic_cast<MessageDataReaderImpl*>(dr.in());
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  bool passed = true;
+
+  // Received before views were enabled
+  MessageViewSeq views;
+  SampleInfoSeq infoseq;
+  if (!write(mdw, 0) || !wait_for_views(reader, 1, views, infoseq)) {
+    return 1;
+  }
+
+  reader->enable_views<Message_OpenDDS_View>();
+  for (CORBA::Long i = 1; i <= viewed_samples; ++i) {
+    passed &= write(mdw, i);
+  }
+  if (!wait_for_views(reader, viewed_samples + 1, views, infoseq)) {
+    return 1;
+  }
+  passed &= check_views(views, infoseq);
+
+  // The sequences have to match, like they do for read()
+  SampleInfoSeq empty_info;
+  ReturnCode_t ret = reader->read_views(views, empty_info, LENGTH_UNLIMITED,
+    ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  if (ret != RETCODE_PRECONDITION_NOT_MET) {
+    cerr << "ERROR: read_views with mismatched sequences returned "
+      << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+
+  passed &= check_completion(mdr);
+
+  ret = reader->take_views(taken, taken_info, LENGTH_UNLIMITED,
+    ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: take_views failed: " << retcode_to_string(ret) << endl;
+    passed = false;
+  } else {
+    passed &= check_views(taken, taken_info);
+  }
+
+  MessageViewSeq remaining;
+  SampleInfoSeq remaining_info;
+  ret = reader->read_views(remaining, remaining_info, LENGTH_UNLIMITED,
+    ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  if (ret != RETCODE_NO_DATA) {
+    cerr << "ERROR: read_views after take_views returned "
+      << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+
+  dp->delete_contained_entities();
+  dpf->delete_participant(dp);
+
+  // The views don't depend on the reader or its participant
+  if (passed && !check_views(taken, taken_info)) {
+    cerr << "ERROR: views changed when the participant was deleted" << endl;
+    passed = false;
+  }
+  return passed ? 0 : 1;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
+{
+  int ret = 1;
+  MessageViewSeq taken;
+  SampleInfoSeq taken_info;
+  try
+  {
+    ret = run_test(argc, argv, taken, taken_info);
+  }
+  catch (const CORBA::BAD_PARAM& ex) {
+    ex._tao_print_exception("Exception caught in SampleViewsTest.cpp:");
+    return 1;
+  }
+
+  TheServiceParticipant->shutdown();
+  ACE_Thread_Manager::instance()->wait();
+
+  // Nor on the transport that received them
+  if (ret == 0 && !check_views(taken, taken_info)) {
+    cerr << "ERROR: views changed when the transport was shut down" << endl;
+    ret = 1;
+  }
+  return ret;
+}
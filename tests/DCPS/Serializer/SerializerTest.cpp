@@ -421,12 +421,16 @@ checkArrayValues(const ArrayValues& expected, const ArrayValues& observed)
 }
 
 const int chaindefs[] = {2, 3, 4, 5, 6, 7, 8, 9, 10, 25, 30, 35, 40, 45, 50, 128, 256, 512, 1024};
+// A single block big enough for everything, which takes the fast paths.
+const int singledefs[] = {4096};
 
 void
 runTest(const Values& expected, const ArrayValues& expectedArray,
-        bool swap, Serializer::Alignment align)
+        bool swap, Serializer::Alignment align,
+        const int* defs = chaindefs,
+        size_t blocks = sizeof(chaindefs)/sizeof(chaindefs[0]))
 {
-  ACE_Message_Block* testchain = getchain(sizeof(chaindefs)/sizeof(chaindefs[0]), chaindefs);
+  ACE_Message_Block* testchain = getchain(blocks, defs);
   const char* out = swap ? "" : "OUT";
   std::cout << std::endl << "STARTING INSERTION OF SINGLE VALUES WITH" << out << " SWAPPING" << std::endl;
   insertions(testchain, expected, swap, align);
@@ -460,7 +464,7 @@ runTest(const Values& expected, const ArrayValues& expectedArray,
 #endif
   testchain->release();
 
-  testchain = getchain(sizeof(chaindefs)/sizeof(chaindefs[0]), chaindefs);
+  testchain = getchain(blocks, defs);
   std::cout << std::endl << "STARTING INSERTION OF ARRAY VALUES WITH" << out << " SWAPPING" << std::endl;
   array_insertions(testchain, expectedArray, ARRAYSIZE, swap, align);
   bytesWritten = testchain->total_length();
@@ -477,6 +481,179 @@ runTest(const Values& expected, const ArrayValues& expectedArray,
   testchain->release();
 }
 
+bool write_array(Serializer& s, const ACE_CDR::UShort* x, ACE_CDR::ULong length)
+{
+  return s.write_ushort_array(x, length);
+}
+
+bool write_array(Serializer& s, const ACE_CDR::ULong* x, ACE_CDR::ULong length)
+{
+  return s.write_ulong_array(x, length);
+}
+
+bool write_array(Serializer& s, const ACE_CDR::ULongLong* x, ACE_CDR::ULong length)
+{
+  return s.write_ulonglong_array(x, length);
+}
+
+bool write_array(Serializer& s, const ACE_CDR::Double* x, ACE_CDR::ULong length)
+{
+  return s.write_double_array(x, length);
+}
+
+bool read_array(Serializer& s, ACE_CDR::UShort* x, ACE_CDR::ULong length)
+{
+  return s.read_ushort_array(x, length);
+}
+
+bool read_array(Serializer& s, ACE_CDR::ULong* x, ACE_CDR::ULong length)
+{
+  return s.read_ulong_array(x, length);
+}
+
+bool read_array(Serializer& s, ACE_CDR::ULongLong* x, ACE_CDR::ULong length)
+{
+  return s.read_ulonglong_array(x, length);
+}
+
+bool read_array(Serializer& s, ACE_CDR::Double* x, ACE_CDR::ULong length)
+{
+  return s.read_double_array(x, length);
+}
+
+/// Swapped arrays long enough to use the vectorized swap, written to and
+/// read from both a single block and a chain.
+template <typename T>
+void runLongArrayTest(const char* name, const int* defs, size_t blocks)
+{
+  const ACE_CDR::ULong LENGTH = 1000;
+  T expected[LENGTH], observed[LENGTH];
+  for (ACE_CDR::ULong i = 0; i < LENGTH; ++i) {
+    expected[i] = static_cast<T>(i * 0x01020304u + 7);
+  }
+
+  ACE_Message_Block* chain = getchain(blocks, defs);
+  Serializer out(chain, true, Serializer::ALIGN_CDR);
+  Serializer in(chain, true, Serializer::ALIGN_CDR);
+  bool ok = (out << LENGTH) && write_array(out, expected, LENGTH);
+
+  if (blocks == 1) {
+    // The first element, after the length and any padding, must be in the
+    // opposite byte order.
+    const size_t offset = sizeof(T) > 4 ? 8 : 4;
+    const char* const value = reinterpret_cast<const char*>(&expected[0]);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      if (chain->rd_ptr()[offset + i] != value[sizeof(T) - 1 - i]) {
+        ok = false;
+      }
+    }
+  }
+
+  ACE_CDR::ULong length = 0;
+  ok = ok && (in >> length) && length == LENGTH && read_array(in, observed, LENGTH)
+    && ACE_OS::memcmp(expected, observed, sizeof expected) == 0;
+  if (!ok) {
+    std::cout << "ERROR: long " << name << " array failed with "
+              << blocks << " blocks" << std::endl;
+    failed = true;
+  }
+  chain->release();
+}
+
+const int bigchaindefs[] = {5, 13, 1000, 3, 2000, 7, 8192};
+const int bigsingledefs[] = {16384};
+
+void runLongArrayTests()
+{
+  std::cout << "\n\n*** Long swapped arrays" << std::endl;
+  const size_t chain_blocks = sizeof(bigchaindefs) / sizeof(bigchaindefs[0]);
+  runLongArrayTest<ACE_CDR::UShort>("ushort", bigsingledefs, 1);
+  runLongArrayTest<ACE_CDR::UShort>("ushort", bigchaindefs, chain_blocks);
+  runLongArrayTest<ACE_CDR::ULong>("ulong", bigsingledefs, 1);
+  runLongArrayTest<ACE_CDR::ULong>("ulong", bigchaindefs, chain_blocks);
+  runLongArrayTest<ACE_CDR::ULongLong>("ulonglong", bigsingledefs, 1);
+  runLongArrayTest<ACE_CDR::ULongLong>("ulonglong", bigchaindefs, chain_blocks);
+  runLongArrayTest<ACE_CDR::Double>("double", bigsingledefs, 1);
+  runLongArrayTest<ACE_CDR::Double>("double", bigchaindefs, chain_blocks);
+}
+
+/// Writes that run past the end of a growable chain append blocks.
+void runGrowableChainTest(bool swap, Serializer::Alignment align)
+{
+  std::cout << "\n\n*** Growable chain" << (swap ? " with swapping" : "")
+            << std::endl;
+  const ACE_CDR::ULong LENGTH = 100;
+  ACE_CDR::Double expected[LENGTH], observed[LENGTH];
+  for (ACE_CDR::ULong i = 0; i < LENGTH; ++i) {
+    expected[i] = 3.0 / (i + 1);
+  }
+  const char str[] = "growable chain";
+
+  ACE_Message_Block* chain = new ACE_Message_Block(3);
+  const Serializer::ChainGrowth growth = {16, 0, 0, 0, 0};
+  Serializer out(chain, swap, align);
+  out.grow_chain(&growth);
+  bool ok = (out << ACE_OutputCDR::from_octet(1))
+    && (out << str)
+    && (out << LENGTH)
+    && out.write_double_array(expected, LENGTH)
+    && (out << ACE_CDR::ULong(0xabcdef01));
+
+  size_t blocks = 0;
+  for (ACE_Message_Block* b = chain; b; b = b->cont()) {
+    ++blocks;
+    if (!b->length()) {
+      std::cout << "ERROR: growable chain has an empty block" << std::endl;
+      ok = false;
+    }
+  }
+  if (blocks < 2) {
+    ok = false;
+  }
+
+  Serializer in(chain, swap, align);
+  ACE_CDR::Octet octet = 0;
+  ACE_CDR::Char* strout = 0;
+  ACE_CDR::ULong length = 0, tail = 0;
+  ok = ok && (in >> ACE_InputCDR::to_octet(octet)) && octet == 1
+    && (in >> strout) && ACE_OS::strcmp(str, strout) == 0
+    && (in >> length) && length == LENGTH
+    && in.read_double_array(observed, LENGTH)
+    && ACE_OS::memcmp(expected, observed, sizeof expected) == 0
+    && (in >> tail) && tail == 0xabcdef01
+    && chain->total_length() == 0;
+  CORBA::string_free(strout);
+
+  if (!ok) {
+    std::cout << "ERROR: growable chain failed" << std::endl;
+    failed = true;
+  }
+  chain->release();
+}
+
+/// Padding that reaches the end of a growable chain doesn't extend it.
+void runGrowableChainPaddingTest()
+{
+  std::cout << "\n\n*** Growable chain padding" << std::endl;
+  ACE_Message_Block* chain = new ACE_Message_Block(4);
+  const Serializer::ChainGrowth growth = {16, 0, 0, 0, 0};
+  Serializer out(chain, false, Serializer::ALIGN_CDR);
+  out.grow_chain(&growth);
+  bool ok = (out << ACE_OutputCDR::from_octet(1))
+    && out.align_w(4) == 0 && out.good_bit()
+    && chain->length() == 4 && !chain->cont();
+
+  // The next write continues in a new block
+  ok = ok && (out << ACE_CDR::ULong(2))
+    && chain->cont() && chain->cont()->length() == 4;
+
+  if (!ok) {
+    std::cout << "ERROR: growable chain padding failed" << std::endl;
+    failed = true;
+  }
+  chain->release();
+}
+
 bool runAlignmentTest();
 bool runAlignmentResetTest();
 bool runAlignmentOverrunTest();
@@ -569,6 +746,19 @@ ACE_TMAIN(int, ACE_TCHAR*[])
   runTest(expected, expectedArray, true /*swap*/, align);
   runTest(expected, expectedArray, false /*swap*/, align);
 
+  runLongArrayTests();
+
+  std::cout << "\n\n*** Single block" << std::endl;
+  runTest(expected, expectedArray, true /*swap*/, Serializer::ALIGN_NONE, singledefs, 1);
+  runTest(expected, expectedArray, false /*swap*/, Serializer::ALIGN_NONE, singledefs, 1);
+  runTest(expected, expectedArray, true /*swap*/, Serializer::ALIGN_CDR, singledefs, 1);
+  runTest(expected, expectedArray, false /*swap*/, Serializer::ALIGN_CDR, singledefs, 1);
+
+  runGrowableChainTest(false, Serializer::ALIGN_CDR);
+  runGrowableChainTest(true, Serializer::ALIGN_CDR);
+  runGrowableChainTest(false, Serializer::ALIGN_NONE);
+  runGrowableChainPaddingTest();
+
   if (!runAlignmentTest() || !runAlignmentResetTest() || !runAlignmentOverrunTest()) {
     failed = true;
   }
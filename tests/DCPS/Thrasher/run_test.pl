@@ -69,8 +69,11 @@ if ($debug_level) {
 
 my $ini_file = "thrasher.ini";
 
-if (("rtps" eq $arg) || ("rtps" eq (shift || ""))) {
+my $transport = ("rtps" eq $arg || "rtps_batch" eq $arg) ? $arg : (shift || "");
+if ("rtps" eq $transport) {
   $ini_file = "thrasher_rtps.ini";
+} elsif ("rtps_batch" eq $transport) {
+  $ini_file = "thrasher_rtps_batch.ini";
 }
 
 $pub_opts .= " -DCPSConfigFile $ini_file";
@@ -0,0 +1,207 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+
+#include "dds/DCPS/BitmapDisjointSequence.h"
+#include "dds/DCPS/DisjointSequence.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+#include <cstring>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+  // Deterministic generator so failures are reproducible.
+  unsigned long lcg_state = 12345;
+  unsigned long next_random()
+  {
+    lcg_state = lcg_state * 1103515245ul + 12345ul;
+    return (lcg_state >> 16) & 0x7FFF;
+  }
+
+  void check_same(const DisjointSequence& expected,
+                  const BitmapDisjointSequence& actual)
+  {
+    TEST_CHECK(expected.empty() == actual.empty());
+    if (expected.empty()) {
+      return;
+    }
+    TEST_CHECK(expected.low() == actual.low());
+    TEST_CHECK(expected.high() == actual.high());
+    TEST_CHECK(expected.cumulative_ack() == actual.cumulative_ack());
+    TEST_CHECK(expected.last_ack() == actual.last_ack());
+    TEST_CHECK(expected.disjoint() == actual.disjoint());
+    TEST_CHECK(expected.present_sequence_ranges() == actual.present_sequence_ranges());
+    TEST_CHECK(expected.missing_sequence_ranges() == actual.missing_sequence_ranges());
+
+    for (int invert = 0; invert < 2; ++invert) {
+      for (CORBA::ULong length = 1; length <= 9; length += 4) {
+        CORBA::Long bitmap1[9], bitmap2[9];
+        std::memset(bitmap1, 0, sizeof bitmap1);
+        std::memset(bitmap2, 0, sizeof bitmap2);
+        CORBA::ULong num_bits1 = 0, num_bits2 = 0;
+        TEST_CHECK(expected.to_bitmap(bitmap1, length, num_bits1, invert)
+                   == actual.to_bitmap(bitmap2, length, num_bits2, invert));
+        TEST_CHECK(num_bits1 == num_bits2);
+        for (CORBA::ULong i = 0; i < num_bits1 / 32; ++i) {
+          TEST_CHECK(bitmap1[i] == bitmap2[i]);
+        }
+        if (num_bits1 % 32) {
+          const CORBA::ULong mask = ~(0xFFFFFFFFu >> (num_bits1 % 32));
+          TEST_CHECK((bitmap1[num_bits1 / 32] & mask) == (bitmap2[num_bits1 / 32] & mask));
+        }
+      }
+    }
+  }
+}
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    // Construction (default)
+    {
+      BitmapDisjointSequence sequence;
+      TEST_CHECK(sequence.empty());
+      TEST_CHECK(!sequence.disjoint());
+      TEST_CHECK(sequence.cumulative_ack() == SequenceNumber::SEQUENCENUMBER_UNKNOWN());
+    }
+
+    // Out of order values inside the window
+    {
+      BitmapDisjointSequence sequence;
+      TEST_CHECK(sequence.insert(1));
+      TEST_CHECK(sequence.insert(3));
+      TEST_CHECK(sequence.insert(5));
+      TEST_CHECK(!sequence.insert(3));
+      TEST_CHECK(sequence.disjoint());
+      TEST_CHECK(sequence.cumulative_ack() == 1);
+      TEST_CHECK(sequence.last_ack() == 5);
+      TEST_CHECK(sequence.high() == 5);
+      TEST_CHECK(sequence.insert(2));
+      TEST_CHECK(sequence.cumulative_ack() == 3);
+      TEST_CHECK(sequence.insert(4));
+      TEST_CHECK(!sequence.disjoint());
+      TEST_CHECK(sequence.cumulative_ack() == 5);
+    }
+
+    // Values beyond the window are pulled in as it slides
+    {
+      BitmapDisjointSequence sequence;
+      sequence.insert(SequenceRange(1, 10));
+      sequence.insert(SequenceRange(12, 1000));
+      sequence.insert(2000);
+      TEST_CHECK(sequence.high() == 2000);
+      TEST_CHECK(sequence.last_ack() == 2000);
+      TEST_CHECK(sequence.contains(500));
+      TEST_CHECK(!sequence.contains(11));
+      TEST_CHECK(!sequence.contains(1001));
+
+      OPENDDS_VECTOR(SequenceRange) missing = sequence.missing_sequence_ranges();
+      TEST_CHECK(missing.size() == 2);
+      TEST_CHECK(missing[0] == SequenceRange(11, 11));
+      TEST_CHECK(missing[1] == SequenceRange(1001, 1999));
+
+      TEST_CHECK(sequence.insert(11));
+      TEST_CHECK(sequence.cumulative_ack() == 1000);
+      TEST_CHECK(sequence.low() == 1);
+      TEST_CHECK(sequence.disjoint());
+    }
+
+    // Inserting below low()
+    {
+      BitmapDisjointSequence sequence;
+      sequence.insert(SequenceRange(10, 20));
+      sequence.insert(30);
+      OPENDDS_VECTOR(SequenceRange) added;
+      TEST_CHECK(sequence.insert(SequenceRange(5, 12), added));
+      TEST_CHECK(added.size() == 1);
+      TEST_CHECK(added[0] == SequenceRange(5, 9));
+      TEST_CHECK(sequence.low() == 5);
+      TEST_CHECK(sequence.cumulative_ack() == 20);
+
+      added.clear();
+      TEST_CHECK(sequence.insert(SequenceRange(1, 2), added));
+      TEST_CHECK(added.size() == 1);
+      TEST_CHECK(sequence.low() == 1);
+      TEST_CHECK(sequence.cumulative_ack() == 2);
+      TEST_CHECK(sequence.contains(30));
+      TEST_CHECK(sequence.missing_sequence_ranges().size() == 2);
+    }
+
+    // RTPS bitmap in and out
+    {
+      BitmapDisjointSequence sequence;
+      sequence.insert(SequenceRange(1, 5));
+      const CORBA::Long bits[] = { static_cast<CORBA::Long>(0xA0000001) };
+      TEST_CHECK(sequence.insert(7, 32, bits));
+      TEST_CHECK(sequence.contains(7));
+      TEST_CHECK(sequence.contains(9));
+      TEST_CHECK(sequence.contains(38));
+      TEST_CHECK(!sequence.contains(8));
+
+      CORBA::Long bitmap[8];
+      CORBA::ULong num_bits = 0;
+      TEST_CHECK(sequence.to_bitmap(bitmap, 8, num_bits));
+      TEST_CHECK(num_bits == 33);
+      TEST_CHECK(bitmap[0] == 0x50000000);
+      TEST_CHECK(bitmap[1] == static_cast<CORBA::Long>(0x80000000));
+
+      TEST_CHECK(sequence.to_bitmap(bitmap, 8, num_bits, true));
+      TEST_CHECK(num_bits == 32);
+      TEST_CHECK(bitmap[0] == static_cast<CORBA::Long>(0xAFFFFFFF));
+    }
+
+    // Same results as DisjointSequence for random inserts
+    for (int round = 0; round < 500; ++round) {
+      DisjointSequence expected;
+      BitmapDisjointSequence actual;
+      const long spread = round % 3 == 0 ? 2000 : round % 3 == 1 ? 300 : 60;
+      for (int op = 0; op < 100; ++op) {
+        const SequenceNumber::Value low = next_random() % spread;
+        switch (next_random() % 4) {
+        case 0:
+          TEST_CHECK(expected.insert(low) == actual.insert(low));
+          break;
+        case 1: {
+          const SequenceNumber::Value high = low + next_random() % (next_random() % 4 ? 8 : 400);
+          OPENDDS_VECTOR(SequenceRange) added1, added2;
+          TEST_CHECK(expected.insert(SequenceRange(low, high), added1)
+                     == actual.insert(SequenceRange(low, high), added2));
+          TEST_CHECK(added1 == added2);
+          break;
+        }
+        case 2: {
+          const CORBA::ULong num_bits = 1 + next_random() % 256;
+          CORBA::Long bits[8];
+          for (int i = 0; i < 8; ++i) {
+            const unsigned long r = next_random() % 3;
+            bits[i] = r == 0 ? -1 : r == 1 ? 0
+              : static_cast<CORBA::Long>((next_random() << 17) ^ next_random());
+          }
+          TEST_CHECK(expected.insert(low, num_bits, bits)
+                     == actual.insert(low, num_bits, bits));
+          break;
+        }
+        default:
+          TEST_CHECK(expected.contains(low) == actual.contains(low));
+        }
+        check_same(expected, actual);
+      }
+    }
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
@@ -922,6 +922,54 @@ int ACE_TMAIN(int, ACE_TCHAR*[])
       TEST_CHECK(bitmap[0] == 0x0402007F);
       TEST_CHECK(bitmap[1] == (int) 0xFFFFFFFF);
     }
+
+    // Insert with gaps overlapping the low end of the set
+    {
+      DisjointSequence sequence;
+      sequence.insert(SequenceRange(1, 5));
+      OPENDDS_VECTOR(SequenceRange) gaps;
+      TEST_CHECK(sequence.insert(SequenceRange(3, 10), gaps));
+      TEST_CHECK(gaps.size() == 1);
+      TEST_CHECK(gaps[0] == SequenceRange(6, 10));
+
+      gaps.clear();
+      sequence.insert(20);
+      TEST_CHECK(sequence.insert(SequenceRange(14, 15), gaps));
+      TEST_CHECK(gaps.size() == 1);
+      TEST_CHECK(gaps[0] == SequenceRange(14, 15));
+    }
+
+    // Insert with gaps spanning several ranges of the set: the gaps are the
+    // parts of the range that the set didn't have
+    {
+      DisjointSequence sequence;
+      sequence.insert(SequenceRange(3, 4));
+      sequence.insert(SequenceRange(8, 9));
+      sequence.insert(20);
+      OPENDDS_VECTOR(SequenceRange) gaps;
+      TEST_CHECK(sequence.insert(SequenceRange(1, 12), gaps));
+      TEST_CHECK(gaps.size() == 3);
+      TEST_CHECK(gaps[0] == SequenceRange(1, 2));
+      TEST_CHECK(gaps[1] == SequenceRange(5, 7));
+      TEST_CHECK(gaps[2] == SequenceRange(10, 12));
+
+      gaps.clear();
+      TEST_CHECK(!sequence.insert(SequenceRange(2, 11), gaps));
+      TEST_CHECK(gaps.empty());
+      TEST_CHECK(sequence.insert(SequenceRange(15, 25), gaps));
+      TEST_CHECK(gaps.size() == 2);
+      TEST_CHECK(gaps[0] == SequenceRange(15, 19));
+      TEST_CHECK(gaps[1] == SequenceRange(21, 25));
+    }
+
+    // Insert bitmap with a range ending at a word of zeros
+    {
+      DisjointSequence sequence;
+      const CORBA::Long bits[] = { -1, 0, 0 };
+      TEST_CHECK(sequence.insert(48, 70, bits));
+      TEST_CHECK(sequence.low() == 48);
+      TEST_CHECK(sequence.high() == 79);
+    }
   }
   catch (std::runtime_error& err)
   {
@@ -0,0 +1,101 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "dds/DCPS/Cached_Allocator_With_Overflow_T.h"
+
+#include "../common/TestSupport.h"
+
+#include <vector>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+  struct Chunk {
+    double value_[4];
+  };
+
+  typedef Cached_Allocator_With_Overflow<Chunk, ACE_Thread_Mutex> Allocator;
+
+  void test_occupancy()
+  {
+    Allocator allocator(4);
+    TEST_CHECK(allocator.n_chunks() == 4);
+    TEST_CHECK(allocator.in_use() == 0);
+    TEST_CHECK(allocator.heap_outstanding() == 0);
+
+    std::vector<void*> chunks;
+    for (int i = 0; i < 4; ++i) {
+      chunks.push_back(allocator.malloc());
+      TEST_CHECK(allocator.in_use() == chunks.size());
+    }
+    TEST_CHECK(allocator.heap_outstanding() == 0);
+
+    // The pool is exhausted, the rest come from the heap
+    chunks.push_back(allocator.malloc());
+    chunks.push_back(allocator.malloc());
+    TEST_CHECK(allocator.in_use() == 4);
+    TEST_CHECK(allocator.heap_outstanding() == 2);
+
+    allocator.free(chunks.back());
+    chunks.pop_back();
+    TEST_CHECK(allocator.heap_outstanding() == 1);
+
+    allocator.free(chunks.front());
+    TEST_CHECK(allocator.in_use() == 3);
+
+    for (size_t i = 1; i < chunks.size(); ++i) {
+      allocator.free(chunks[i]);
+    }
+    TEST_CHECK(allocator.in_use() == 0);
+    TEST_CHECK(allocator.heap_outstanding() == 0);
+    TEST_CHECK(allocator.n_chunks() == 4);
+  }
+
+  void test_reuse_order()
+  {
+    Allocator allocator(3);
+
+    // The first allocations ascend through the pool
+    unsigned char* const first = static_cast<unsigned char*>(allocator.malloc());
+    unsigned char* const second = static_cast<unsigned char*>(allocator.malloc());
+    TEST_CHECK(first < second);
+
+    // The chunk freed last is the one allocated next
+    allocator.free(first);
+    allocator.free(second);
+    TEST_CHECK(allocator.malloc() == second);
+    TEST_CHECK(allocator.malloc() == first);
+    TEST_CHECK(allocator.in_use() == 2);
+
+    allocator.free(first);
+    allocator.free(second);
+  }
+
+  void test_empty_pool()
+  {
+    Allocator allocator(0);
+    void* const chunk = allocator.malloc();
+    TEST_CHECK(chunk != 0);
+    TEST_CHECK(allocator.in_use() == 0);
+    TEST_CHECK(allocator.heap_outstanding() == 1);
+    allocator.free(chunk);
+    TEST_CHECK(allocator.heap_outstanding() == 0);
+
+    // Larger than a chunk
+    TEST_CHECK(allocator.malloc(sizeof(Chunk) + 1) == 0);
+  }
+}
+
+int
+ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  test_occupancy();
+  test_reuse_order();
+  test_empty_pool();
+  return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/Atomic_Op.h"
+#include "ace/OS_NS_unistd.h"
+
+#include "dds/DCPS/ListenerDispatcher.h"
+
+#include "../common/TestSupport.h"
+
+#include <map>
+#include <vector>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+  /// What the jobs did, shared by all of them
+  struct Record {
+    Record()
+      : running_(0)
+      , max_running_(0)
+      , overlapped_(false)
+      , executed_(0)
+    {}
+
+    ACE_Thread_Mutex lock_;
+    std::map<int, std::vector<int> > order_;
+    std::map<int, bool> key_running_;
+    int running_;
+    int max_running_;
+    bool overlapped_;
+    int executed_;
+  };
+
+  class RecordJob : public JobQueue::Job {
+  public:
+    RecordJob(Record& record, int key, int seq, int usec)
+      : record_(record), key_(key), seq_(seq), usec_(usec) {}
+
+    void execute()
+    {
+      {
+        ACE_GUARD(ACE_Thread_Mutex, guard, record_.lock_);
+        if (record_.key_running_[key_]) {
+          record_.overlapped_ = true;
+        }
+        record_.key_running_[key_] = true;
+        if (++record_.running_ > record_.max_running_) {
+          record_.max_running_ = record_.running_;
+        }
+        record_.order_[key_].push_back(seq_);
+      }
+
+      if (usec_) {
+        ACE_OS::sleep(ACE_Time_Value(0, usec_));
+      }
+
+      ACE_GUARD(ACE_Thread_Mutex, guard, record_.lock_);
+      record_.key_running_[key_] = false;
+      --record_.running_;
+      ++record_.executed_;
+    }
+
+  private:
+    Record& record_;
+    const int key_;
+    const int seq_;
+    const int usec_;
+  };
+
+  class ShutdownJob : public JobQueue::Job {
+  public:
+    explicit ShutdownJob(ListenerDispatcher& dispatcher)
+      : dispatcher_(dispatcher), done_(false) {}
+
+    void execute()
+    {
+      dispatcher_.shutdown();
+      done_ = true;
+    }
+
+    bool done() const { return done_.value(); }
+
+  private:
+    ListenerDispatcher& dispatcher_;
+    ACE_Atomic_Op<ACE_Thread_Mutex, bool> done_;
+  };
+
+  ListenerDispatcher::Key make_key(const Record& record, int key)
+  {
+    return ListenerDispatcher::Key(&record, key);
+  }
+
+  bool wait_for(Record& record, int executed)
+  {
+    for (int i = 0; i < 500; ++i) {
+      {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, record.lock_, false);
+        if (record.executed_ >= executed) {
+          return true;
+        }
+      }
+      ACE_OS::sleep(ACE_Time_Value(0, 10000));
+    }
+    return false;
+  }
+
+  void test_per_key_order()
+  {
+    ListenerDispatcher dispatcher(4);
+    TEST_CHECK(dispatcher.open() == 0);
+    Record record;
+
+    const int keys = 6, jobs = 50;
+    for (int seq = 0; seq < jobs; ++seq) {
+      for (int key = 0; key < keys; ++key) {
+        TEST_CHECK(dispatcher.enqueue(make_key(record, key),
+                                      make_rch<RecordJob>(ref(record), key, seq, seq % 5 ? 0 : 1000)));
+      }
+    }
+    TEST_CHECK(wait_for(record, keys * jobs));
+
+    // Jobs of a key ran one at a time, in the order they were enqueued
+    TEST_CHECK(!record.overlapped_);
+    for (int key = 0; key < keys; ++key) {
+      const std::vector<int>& order = record.order_[key];
+      TEST_CHECK(order.size() == static_cast<size_t>(jobs));
+      for (size_t i = 0; i < order.size(); ++i) {
+        TEST_CHECK(order[i] == static_cast<int>(i));
+      }
+    }
+
+    const ListenerDispatcher::Status status = dispatcher.status();
+    TEST_CHECK(status.threads == 4);
+    TEST_CHECK(status.queue_depth == 0);
+    TEST_CHECK(status.max_queue_depth > 0);
+    TEST_CHECK(status.latency.n() == static_cast<size_t>(keys * jobs));
+    dispatcher.shutdown();
+  }
+
+  void test_concurrent_keys()
+  {
+    ListenerDispatcher dispatcher(2);
+    TEST_CHECK(dispatcher.open() == 0);
+    Record record;
+
+    // Slow jobs of different keys overlap
+    for (int key = 0; key < 4; ++key) {
+      TEST_CHECK(dispatcher.enqueue(make_key(record, key),
+                                    make_rch<RecordJob>(ref(record), key, 0, 200000)));
+    }
+    TEST_CHECK(wait_for(record, 4));
+    TEST_CHECK(record.max_running_ == 2);
+    TEST_CHECK(!record.overlapped_);
+    dispatcher.shutdown();
+  }
+
+  void test_enqueue_after_shutdown()
+  {
+    ListenerDispatcher dispatcher(1);
+    Record record;
+    TEST_CHECK(dispatcher.open() == 0);
+    dispatcher.shutdown();
+    TEST_CHECK(dispatcher.is_shut_down());
+    TEST_CHECK(!dispatcher.enqueue(make_key(record, 0),
+                                   make_rch<RecordJob>(ref(record), 0, 0, 0)));
+
+    // Jobs that didn't start when it shut down are discarded
+    TEST_CHECK(dispatcher.open() == 0);
+    TEST_CHECK(dispatcher.enqueue(make_key(record, 0),
+                                  make_rch<RecordJob>(ref(record), 0, 0, 200000)));
+    TEST_CHECK(dispatcher.enqueue(make_key(record, 0),
+                                  make_rch<RecordJob>(ref(record), 0, 1, 0)));
+    ACE_OS::sleep(ACE_Time_Value(0, 50000));
+    dispatcher.shutdown();
+    TEST_CHECK(record.executed_ == 1);
+    TEST_CHECK(dispatcher.status().queue_depth == 0);
+
+    // It can be started again
+    TEST_CHECK(dispatcher.open() == 0);
+    TEST_CHECK(dispatcher.enqueue(make_key(record, 0),
+                                  make_rch<RecordJob>(ref(record), 0, 2, 0)));
+    TEST_CHECK(wait_for(record, 2));
+    dispatcher.shutdown();
+  }
+
+  void test_shutdown_from_worker()
+  {
+    ListenerDispatcher dispatcher(2);
+    TEST_CHECK(dispatcher.open() == 0);
+    Record record;
+
+    RcHandle<ShutdownJob> job = make_rch<ShutdownJob>(ref(dispatcher));
+    TEST_CHECK(dispatcher.enqueue(make_key(record, 0), job));
+    for (int i = 0; i < 500 && !job->done(); ++i) {
+      ACE_OS::sleep(ACE_Time_Value(0, 10000));
+    }
+    TEST_CHECK(job->done());
+    TEST_CHECK(dispatcher.is_shut_down());
+    TEST_CHECK(!dispatcher.enqueue(make_key(record, 1),
+                                   make_rch<RecordJob>(ref(record), 1, 0, 0)));
+
+    // Joins the workers that the job couldn't
+    dispatcher.shutdown();
+  }
+}
+
+int
+ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  test_per_key_order();
+  test_concurrent_keys();
+  test_enqueue_after_shutdown();
+  test_shutdown_from_worker();
+  return 0;
+}
@@ -6,6 +6,7 @@
 #include "dds/DCPS/transport/framework/TransportReassembly.h"
 #include "dds/DCPS/RepoIdGenerator.h"
 
+#include <algorithm>
 #include <string.h>
 
 using namespace OpenDDS::DCPS;
@@ -33,6 +34,26 @@ namespace {
     ReceivedDataSample sample;
   };
 
+  // Fragment(s) first-last of a sample of sample_size bytes split into
+  // frag_size byte fragments, byte i of the sample has the value i.
+  ReceivedDataSample fragment(const RepoId& pub_id, const SequenceNumber& msg_seq,
+                              ACE_UINT32 first, ACE_UINT32 last,
+                              ACE_UINT32 frag_size, ACE_UINT32 sample_size)
+  {
+    const size_t begin = (first - 1) * frag_size,
+      end = std::min(static_cast<size_t>(last * frag_size), static_cast<size_t>(sample_size));
+    ReceivedDataSample sample(new ACE_Message_Block(end - begin));
+    for (size_t i = begin; i < end; ++i) {
+      *sample.sample_->wr_ptr() = static_cast<char>(i);
+      sample.sample_->wr_ptr(1);
+    }
+    sample.header_.publication_id_ = pub_id;
+    sample.header_.sequence_ = msg_seq;
+    sample.header_.more_fragments_ = end < sample_size;
+    sample.header_.message_length_ = static_cast<ACE_UINT32>(end - begin);
+    return sample;
+  }
+
   enum Constants {
     BM_LENGTH = 8
   };
@@ -280,12 +301,141 @@ void test_fill_ltor()
   TEST_ASSERT(!gaps.check_gap(8));    // No gap
 }
 
+void test_contiguous()
+{
+  TransportReassembly tr(1024);
+  Gaps gaps;
+  SequenceNumber msg_seq(5);
+  RepoId pub_id = create_pub_id();
+  const ACE_UINT32 frag_size = 4, sample_size = 18, total = 5;
+
+  ReceivedDataSample data = fragment(pub_id, msg_seq, 5, 5, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(5, 5), data, total, frag_size, sample_size));
+  TEST_ASSERT(tr.has_frags(msg_seq, pub_id));
+  TEST_ASSERT(1 == gaps.get(tr, msg_seq, pub_id)); // Gap from 1-4
+  TEST_ASSERT(4 == gaps.result_bits);
+  TEST_ASSERT(gaps.check_gap(1));
+  TEST_ASSERT(gaps.check_gap(4));
+
+  data = fragment(pub_id, msg_seq, 1, 2, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 2), data, total, frag_size, sample_size));
+  TEST_ASSERT(3 == gaps.get(tr, msg_seq, pub_id)); // Gap from 3-4
+  TEST_ASSERT(2 == gaps.result_bits);
+  TEST_ASSERT(gaps.check_gap(3));
+  TEST_ASSERT(gaps.check_gap(4));
+
+  // Duplicates are dropped
+  data = fragment(pub_id, msg_seq, 5, 5, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(5, 5), data, total, frag_size, sample_size));
+
+  // So is a fragment with less data than its size says
+  data = fragment(pub_id, msg_seq, 3, 3, frag_size, sample_size);
+  data.sample_->wr_ptr(data.sample_->wr_ptr() - 1);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(3, 3), data, total, frag_size, sample_size));
+  TEST_ASSERT(3 == gaps.get(tr, msg_seq, pub_id));
+
+  data = fragment(pub_id, msg_seq, 4, 4, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(4, 4), data, total, frag_size, sample_size));
+  data = fragment(pub_id, msg_seq, 3, 3, frag_size, sample_size);
+  TEST_ASSERT(tr.reassemble(SequenceRange(3, 3), data, total, frag_size, sample_size));
+
+  // The sample is in a single message block
+  TEST_ASSERT(!tr.has_frags(msg_seq, pub_id));
+  TEST_ASSERT(data.sample_);
+  TEST_ASSERT(!data.sample_->cont());
+  TEST_ASSERT(sample_size == data.sample_->length());
+  for (ACE_UINT32 i = 0; i < sample_size; ++i) {
+    TEST_ASSERT(static_cast<char>(i) == data.sample_->rd_ptr()[i]);
+  }
+  TEST_ASSERT(!data.header_.more_fragments_);
+  TEST_ASSERT(sample_size == data.header_.message_length_);
+
+  // Completed samples aren't delivered again
+  data = fragment(pub_id, msg_seq, 1, 1, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 1), data, total, frag_size, sample_size));
+}
+
+void test_contiguous_too_large()
+{
+  // Over the maximum size the fragments are chained as before
+  TransportReassembly tr(16);
+  SequenceNumber msg_seq(6);
+  RepoId pub_id = create_pub_id();
+  const ACE_UINT32 frag_size = 4, sample_size = 18, total = 5;
+
+  ReceivedDataSample data = fragment(pub_id, msg_seq, 3, 5, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(3, 5), data, total, frag_size, sample_size));
+  data = fragment(pub_id, msg_seq, 1, 2, frag_size, sample_size);
+  TEST_ASSERT(tr.reassemble(SequenceRange(1, 2), data, total, frag_size, sample_size));
+  TEST_ASSERT(data.sample_->cont());
+  TEST_ASSERT(sample_size == data.sample_->total_length());
+}
+
+void test_contiguous_budget()
+{
+  // Contiguous buffers of incomplete samples share the maximum size
+  TransportReassembly tr(40);
+  const RepoId pub_id = create_pub_id();
+  const ACE_UINT32 frag_size = 4, sample_size = 18, total = 5;
+
+  ReceivedDataSample data = fragment(pub_id, 1, 1, 1, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 1), data, total, frag_size, sample_size));
+  data = fragment(pub_id, 2, 1, 1, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 1), data, total, frag_size, sample_size));
+
+  // The third one is chained
+  data = fragment(pub_id, 3, 1, 2, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 2), data, total, frag_size, sample_size));
+  data = fragment(pub_id, 3, 3, 5, frag_size, sample_size);
+  TEST_ASSERT(tr.reassemble(SequenceRange(3, 5), data, total, frag_size, sample_size));
+  TEST_ASSERT(data.sample_->cont());
+  TEST_ASSERT(sample_size == data.sample_->total_length());
+
+  // Dropping an incomplete sample frees its part
+  tr.data_unavailable(1, pub_id);
+  TEST_ASSERT(!tr.has_frags(1, pub_id));
+  data = fragment(pub_id, 4, 1, 2, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 2), data, total, frag_size, sample_size));
+  data = fragment(pub_id, 4, 3, 5, frag_size, sample_size);
+  TEST_ASSERT(tr.reassemble(SequenceRange(3, 5), data, total, frag_size, sample_size));
+  TEST_ASSERT(!data.sample_->cont());
+
+  // And so does completing one
+  data = fragment(pub_id, 5, 1, 5, frag_size, sample_size);
+  TEST_ASSERT(tr.reassemble(SequenceRange(1, 5), data, total, frag_size, sample_size));
+  TEST_ASSERT(!data.sample_->cont());
+}
+
+void test_contiguous_dropped()
+{
+  // Fragments lost at the transport level end contiguous samples
+  TransportReassembly tr(1024);
+  const RepoId pub_id = create_pub_id();
+  const SequenceNumber msg_seq(7);
+  const ACE_UINT32 frag_size = 4, sample_size = 18, total = 5;
+
+  ReceivedDataSample data = fragment(pub_id, msg_seq, 1, 2, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(1, 2), data, total, frag_size, sample_size));
+  TEST_ASSERT(tr.has_frags(msg_seq, pub_id));
+  tr.data_unavailable(SequenceRange(10, 12));
+  TEST_ASSERT(!tr.has_frags(msg_seq, pub_id));
+
+  // Fragments that don't fit the sample don't allocate anything
+  data = fragment(pub_id, msg_seq, 1, 1, frag_size, sample_size);
+  TEST_ASSERT(!tr.reassemble(SequenceRange(6, 6), data, total, frag_size, sample_size));
+  TEST_ASSERT(!tr.has_frags(msg_seq, pub_id));
+}
+
 int
 ACE_TMAIN(int, ACE_TCHAR*[])
 {
   try
   {
     test_empty();
+    test_contiguous();
+    test_contiguous_too_large();
+    test_contiguous_budget();
+    test_contiguous_dropped();
     /*
       test_insert_has_frag();
       test_first_insert_has_no_gaps();
@@ -0,0 +1,226 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/Message_Block.h"
+
+#include "dds/DCPS/transport/framework/TransportSendBuffer.h"
+
+#include "../common/TestSupport.h"
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+  void insert(SingleSendBuffer& buffer, SequenceNumber::Value seq)
+  {
+    TransportSendStrategy::QueueType queue;
+    ACE_Message_Block chain(8);
+    chain.wr_ptr(8);
+    buffer.insert(seq, &queue, &chain);
+  }
+
+  void insert_fragment(SingleSendBuffer& buffer, SequenceNumber::Value seq,
+                       SequenceNumber::Value fragment)
+  {
+    TransportSendStrategy::QueueType queue;
+    ACE_Message_Block chain(8);
+    chain.wr_ptr(8);
+    buffer.insert_fragment(seq, fragment, &queue, &chain);
+  }
+
+  bool retains(const SingleSendBuffer& buffer, SequenceNumber::Value low,
+               SequenceNumber::Value high)
+  {
+    return !buffer.empty() && buffer.low() == low && buffer.high() == high;
+  }
+
+  void test_wrap_around()
+  {
+    SingleSendBuffer buffer(16, 1);
+    TEST_CHECK(buffer.empty());
+    for (SequenceNumber::Value seq = 1; seq <= 16; ++seq) {
+      insert(buffer, seq);
+    }
+    TEST_CHECK(retains(buffer, 1, 16));
+
+    // The head moves past released sequence numbers and the new ones reuse
+    // their slots
+    for (SequenceNumber::Value seq = 1; seq <= 8; ++seq) {
+      buffer.release_acked(seq);
+    }
+    TEST_CHECK(retains(buffer, 9, 16));
+    for (SequenceNumber::Value seq = 17; seq <= 24; ++seq) {
+      insert(buffer, seq);
+    }
+    TEST_CHECK(retains(buffer, 9, 24));
+    for (SequenceNumber::Value seq = 1; seq <= 24; ++seq) {
+      TEST_CHECK(buffer.contains(seq) == (seq >= 9));
+    }
+
+    // Releasing a sequence number in the middle leaves a hole
+    buffer.release_acked(12);
+    TEST_CHECK(!buffer.contains(12));
+    TEST_CHECK(retains(buffer, 9, 24));
+
+    // At capacity the oldest is aged off
+    insert(buffer, 12);
+    insert(buffer, 25);
+    TEST_CHECK(retains(buffer, 10, 25));
+    TEST_CHECK(!buffer.contains(9));
+  }
+
+  void test_growth()
+  {
+    SingleSendBuffer buffer(1024, 1);
+    for (SequenceNumber::Value seq = 1; seq <= 200; seq += 2) {
+      insert(buffer, seq);
+    }
+    TEST_CHECK(retains(buffer, 1, 199));
+    for (SequenceNumber::Value seq = 1; seq <= 200; ++seq) {
+      TEST_CHECK(buffer.contains(seq) == (seq % 2 == 1));
+    }
+
+    // Emptying it starts the window over at the next sequence number
+    for (SequenceNumber::Value seq = 1; seq <= 200; seq += 2) {
+      buffer.release_acked(seq);
+    }
+    TEST_CHECK(buffer.empty());
+    insert(buffer, 500);
+    TEST_CHECK(retains(buffer, 500, 500));
+  }
+
+  void test_lower_sequence()
+  {
+    SingleSendBuffer buffer(8, 1);
+    insert(buffer, 5);
+    insert(buffer, 6);
+
+    // The window grows downwards
+    insert(buffer, 3);
+    TEST_CHECK(retains(buffer, 3, 6));
+    TEST_CHECK(buffer.contains(3));
+    TEST_CHECK(!buffer.contains(4));
+    TEST_CHECK(buffer.contains(5));
+
+    insert(buffer, 1);
+    TEST_CHECK(retains(buffer, 1, 6));
+
+    // but the window doesn't grow beyond the capacity in either direction
+    insert(buffer, 12);
+    TEST_CHECK(retains(buffer, 5, 12));
+    insert(buffer, 4);
+    TEST_CHECK(!buffer.contains(4));
+    TEST_CHECK(retains(buffer, 5, 12));
+  }
+
+  void test_large_jump()
+  {
+    SingleSendBuffer buffer(32, 1);
+    insert(buffer, 1);
+    insert(buffer, 2);
+
+    // Everything falls out of the window, which starts over at the jump
+    const SequenceNumber::Value far = 1000000000;
+    insert(buffer, far);
+    TEST_CHECK(retains(buffer, far, far));
+    TEST_CHECK(!buffer.contains(1));
+    TEST_CHECK(!buffer.contains(2));
+
+    // Only what is still within the capacity of the highest is kept
+    insert(buffer, far + 20);
+    insert(buffer, far + 40);
+    TEST_CHECK(retains(buffer, far + 20, far + 40));
+
+    // A sequence number that far behind isn't retained
+    insert(buffer, far);
+    TEST_CHECK(!buffer.contains(far));
+    TEST_CHECK(retains(buffer, far + 20, far + 40));
+  }
+
+  void test_fragments()
+  {
+    SingleSendBuffer buffer(4, 1);
+    insert_fragment(buffer, 1, 1);
+    insert_fragment(buffer, 1, 3);
+    insert_fragment(buffer, 1, 2);
+    insert_fragment(buffer, 1, 2);
+    TEST_CHECK(retains(buffer, 1, 1));
+
+    // A sequence number counts once, however many fragments it has
+    for (SequenceNumber::Value seq = 2; seq <= 4; ++seq) {
+      insert(buffer, seq);
+    }
+    TEST_CHECK(retains(buffer, 1, 4));
+    insert_fragment(buffer, 5, 1);
+    TEST_CHECK(retains(buffer, 2, 5));
+    TEST_CHECK(!buffer.contains(1));
+
+    // Whole samples and fragments replace each other
+    insert_fragment(buffer, 3, 1);
+    TEST_CHECK(buffer.contains(3));
+    insert(buffer, 5);
+    TEST_CHECK(buffer.contains(5));
+    TEST_CHECK(retains(buffer, 2, 5));
+
+    buffer.release_acked(5);
+    buffer.release_acked(4);
+    TEST_CHECK(retains(buffer, 2, 3));
+    buffer.release_all();
+    TEST_CHECK(buffer.empty());
+  }
+
+  void test_unlimited()
+  {
+    SingleSendBuffer buffer(SingleSendBuffer::UNLIMITED, 1);
+    const SequenceNumber::Value far = 1000000000;
+    insert(buffer, 1);
+    insert(buffer, 2);
+
+    // Nothing ages off, however far apart the sequence numbers are
+    insert(buffer, far);
+    TEST_CHECK(retains(buffer, 1, far));
+    TEST_CHECK(buffer.contains(1));
+    TEST_CHECK(buffer.contains(2));
+    TEST_CHECK(buffer.contains(far));
+    TEST_CHECK(!buffer.contains(3));
+    for (SequenceNumber::Value seq = 3; seq <= 1000; ++seq) {
+      insert(buffer, seq);
+    }
+    for (SequenceNumber::Value seq = 1; seq <= 1000; ++seq) {
+      TEST_CHECK(buffer.contains(seq));
+    }
+
+    // Releasing either end moves it to the next retained sequence number
+    buffer.release_acked(1);
+    TEST_CHECK(retains(buffer, 2, far));
+    buffer.release_acked(far);
+    TEST_CHECK(retains(buffer, 2, 1000));
+    buffer.release_acked(500);
+    TEST_CHECK(!buffer.contains(500));
+    TEST_CHECK(retains(buffer, 2, 1000));
+
+    insert_fragment(buffer, 1001, 1);
+    insert_fragment(buffer, 1001, 2);
+    TEST_CHECK(retains(buffer, 2, 1001));
+    buffer.release_all();
+    TEST_CHECK(buffer.empty());
+    insert(buffer, 7);
+    TEST_CHECK(retains(buffer, 7, 7));
+  }
+}
+
+int
+ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  test_wrap_around();
+  test_growth();
+  test_lower_sequence();
+  test_large_jump();
+  test_fragments();
+  test_unlimited();
+  return 0;
+}
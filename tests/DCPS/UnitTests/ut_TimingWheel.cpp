@@ -0,0 +1,132 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "dds/DCPS/Definitions.h"
+#include "dds/DCPS/TimingWheel_T.h"
+
+#include "../common/TestSupport.h"
+
+#include <algorithm>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  typedef TimingWheel<int> Wheel;
+
+  const MonotonicTimePoint start = MonotonicTimePoint::now();
+  const TimeDuration resolution = TimeDuration::from_msec(10);
+
+  MonotonicTimePoint at(ACE_UINT64 msec)
+  {
+    return start + TimeDuration::from_msec(msec);
+  }
+
+  bool contains(const Wheel::KeyVec& keys, int key)
+  {
+    return std::find(keys.begin(), keys.end(), key) != keys.end();
+  }
+}
+
+int
+ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  {
+    // Keys expire once their deadline has passed, and only once.
+    Wheel wheel(resolution, start);
+    wheel.schedule(1, at(50));
+    wheel.schedule(2, at(100));
+    wheel.schedule(3, at(100));
+    TEST_CHECK(wheel.size() == 3);
+
+    Wheel::KeyVec expired;
+    wheel.expire(at(40), expired);
+    TEST_CHECK(expired.empty());
+
+    wheel.expire(at(50), expired);
+    TEST_CHECK(expired.size() == 1 && expired[0] == 1);
+    TEST_CHECK(!wheel.is_scheduled(1));
+
+    expired.clear();
+    wheel.expire(at(99), expired);
+    TEST_CHECK(expired.empty());
+    wheel.expire(at(100), expired);
+    TEST_CHECK(expired.size() == 2 && contains(expired, 2) && contains(expired, 3));
+    TEST_CHECK(wheel.empty());
+
+    expired.clear();
+    wheel.expire(at(1000), expired);
+    TEST_CHECK(expired.empty());
+  }
+  {
+    // The earlier of two deadlines wins, cancel() removes the key.
+    Wheel wheel(resolution, start);
+    wheel.schedule(1, at(100));
+    TEST_CHECK(!wheel.schedule(1, at(200)));
+    TEST_CHECK(wheel.schedule(1, at(30)));
+    MonotonicTimePoint deadline;
+    TEST_CHECK(wheel.deadline(1, deadline) && deadline == at(30));
+
+    wheel.schedule(2, at(30));
+    TEST_CHECK(wheel.cancel(2));
+    TEST_CHECK(!wheel.cancel(2));
+
+    Wheel::KeyVec expired;
+    wheel.expire(at(30), expired);
+    TEST_CHECK(expired.size() == 1 && expired[0] == 1);
+  }
+  {
+    // Deadlines in the past expire on the next call.
+    Wheel wheel(resolution, start);
+    Wheel::KeyVec expired;
+    wheel.expire(at(500), expired);
+    wheel.schedule(1, at(100));
+    TEST_CHECK(expired.empty());
+    wheel.expire(at(510), expired);
+    TEST_CHECK(expired.size() == 1 && expired[0] == 1);
+  }
+  {
+    // Deadlines in the outer wheels (and beyond them) cascade inward and
+    // expire neither early nor late.
+    Wheel wheel(resolution, start);
+    const ACE_UINT64 deadlines[] = {
+      5, 640, 650, 12345, 40960, 41000, 2621440, 5000000, 200000000
+    };
+    const int count = sizeof deadlines / sizeof deadlines[0];
+    for (int i = 0; i < count; ++i) {
+      wheel.schedule(i, at(deadlines[i] * 10));
+    }
+    for (int i = 0; i < count; ++i) {
+      Wheel::KeyVec expired;
+      wheel.expire(at(deadlines[i] * 10 - 10), expired);
+      TEST_CHECK(expired.empty());
+      wheel.expire(at(deadlines[i] * 10), expired);
+      TEST_CHECK(expired.size() == 1 && expired[0] == i);
+    }
+    TEST_CHECK(wheel.empty());
+  }
+  {
+    // Many keys with periodic rescheduling, as the heartbeat scheduler does.
+    Wheel wheel(resolution, start);
+    const int keys = 5000;
+    for (int i = 0; i < keys; ++i) {
+      wheel.schedule(i, at(10 * (i % 100 + 1)));
+    }
+    size_t total = 0;
+    for (ACE_UINT64 now = 10; now <= 3000; now += 10) {
+      Wheel::KeyVec expired;
+      wheel.expire(at(now), expired);
+      TEST_CHECK(expired.size() == size_t(keys / 100));
+      total += expired.size();
+      for (size_t i = 0; i < expired.size(); ++i) {
+        wheel.schedule(expired[i], at(now + 1000));
+      }
+    }
+    TEST_CHECK(total == size_t(keys * 3));
+    TEST_CHECK(wheel.size() == size_t(keys));
+  }
+  return 0;
+}
@@ -0,0 +1,375 @@
+#include "dds/DdsDcpsInfrastructureC.h"
+#include "dds/DCPS/WaitSet.h"
+#include "dds/DCPS/Service_Participant.h"
+#include "dds/DCPS/Marked_Default_Qos.h"
+#include "dds/DCPS/PublisherImpl.h"
+#include "dds/DCPS/SubscriberImpl.h"
+#include "dds/DCPS/StaticIncludes.h"
+#include "dds/DCPS/SafetyProfileStreams.h"
+#include "MessengerTypeSupportImpl.h"
+
+#include "tests/Utils/StatusMatching.h"
+#include "tests/Utils/TakeSamples.h"
+
+#ifdef ACE_AS_STATIC_LIBS
+# include "dds/DCPS/RTPS/RtpsDiscovery.h"
+# include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
+#endif
+
+#include <cstring>
+#include <iostream>
+#include <map>
+using namespace std;
+using namespace DDS;
+using namespace OpenDDS::DCPS;
+using namespace Messenger;
+
+typedef MessageTypeSupportImpl::DataWriterImplType MessageDataWriterImpl;
+
+const CORBA::Long registered_keys = 3;
+const CORBA::Long registered_samples = 60;
+const CORBA::Long unregistered_samples = 30;
+const CORBA::Long batched_samples = registered_samples + unregistered_samples;
+
+/// Chunks in each writer's data allocator
+const size_t writer_chunks = 4;
+
+/// Loaned at once, which is more than the writer has chunks for
+const CORBA::Long loaned_samples = 10;
+
+/// Checks that each batched sample arrives once, that each instance's
+/// samples are in the order they were written and that their instance
+/// handles are the reader's handles for their keys
+class BatchCheck {
+public:
+  explicit BatchCheck(const MessageDataReader_var& mdr)
+    : mdr_(mdr)
+    , received_(batched_samples, false)
+  {}
+
+  bool operator()(const Message& sample, const SampleInfo& info)
+  {
+    if (sample.iteration < 0 || sample.iteration >= batched_samples
+        || received_[sample.iteration]) {
+      cerr << "ERROR: unexpected iteration " << sample.iteration << endl;
+      return false;
+    }
+    received_[sample.iteration] = true;
+    bool passed = true;
+
+    const map<CORBA::Long, CORBA::Long>::iterator last = last_iteration_.find(sample.key);
+    if (last != last_iteration_.end() && last->second > sample.iteration) {
+      cerr << "ERROR: key " << sample.key << " iteration " << sample.iteration
+        << " after " << last->second << endl;
+      passed = false;
+    }
+    last_iteration_[sample.key] = sample.iteration;
+
+    if (info.instance_handle != mdr_->lookup_instance(sample)) {
+      cerr << "ERROR: key " << sample.key << " has the wrong instance handle" << endl;
+      passed = false;
+    }
+    return passed;
+  }
+
+private:
+  MessageDataReader_var mdr_;
+  OPENDDS_VECTOR(bool) received_;
+  map<CORBA::Long, CORBA::Long> last_iteration_;
+};
+
+bool run_batch_test(const DomainParticipant_var& dp, const Publisher_var& pub,
+                    const Subscriber_var& sub)
+{
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var typeName = ts->get_type_name();
+  Topic_var topic = dp->create_topic("WriteBatch", typeName,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+
+  // A batch is much larger than the resource limits, queued samples have to
+  // be sent for the rest of it to be written
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.reliability.max_blocking_time.sec = 5;
+  dw_qos.reliability.max_blocking_time.nanosec = 0;
+  dw_qos.resource_limits.max_samples = 8;
+  dw_qos.resource_limits.max_samples_per_instance = 4;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0, DEFAULT_STATUS_MASK);
+
+  if (!topic || !dw || !dr || Utils::wait_match(dw, 1) != 0) {
+    cerr << "ERROR: WriteBatch: setup failed" << endl;
+    return false;
+  }
+
+  MessageDataWriterImpl* const writer = dynamic_cast<MessageDataWriterImpl*>(dw.in());
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  bool passed = true;
+
+  // Mismatched handles are rejected
+  MessageSeq samples(registered_samples);
+  samples.length(registered_samples);
+  DDS::InstanceHandleSeq handles(1);
+  handles.length(1);
+  const OPENDDS_VECTOR(DDS::Time_t) no_timestamps;
+  if (writer->write_batch(samples, handles, no_timestamps) != RETCODE_BAD_PARAMETER) {
+    cerr << "ERROR: write_batch with too few handles should have failed" << endl;
+    passed = false;
+  }
+
+  // Registered instances, interleaved
+  InstanceHandle_t registered[registered_keys];
+  for (CORBA::Long key = 0; key < registered_keys; ++key) {
+    Message sample;
+    sample.key = key;
+    registered[key] = mdw->register_instance(sample);
+  }
+  handles.length(registered_samples);
+  for (CORBA::Long i = 0; i < registered_samples; ++i) {
+    samples[i].key = i % registered_keys;
+    samples[i].iteration = i;
+    handles[i] = registered[i % registered_keys];
+  }
+  ReturnCode_t ret = writer->write_batch(samples, handles, no_timestamps);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: write_batch with handles failed: " << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+
+  // A new instance registered by write_batch
+  samples.length(unregistered_samples);
+  handles.length(0);
+  for (CORBA::Long i = 0; i < unregistered_samples; ++i) {
+    samples[i].key = registered_keys;
+    samples[i].iteration = registered_samples + i;
+  }
+  ret = writer->write_batch(samples, handles, no_timestamps);
+  if (ret != RETCODE_OK) {
+    cerr << "ERROR: write_batch without handles failed: " << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+  if (mdw->lookup_instance(samples[0]) == HANDLE_NIL) {
+    cerr << "ERROR: write_batch didn't register the instance" << endl;
+    passed = false;
+  }
+
+  BatchCheck check(mdr);
+  passed &= Utils::take_samples<Message>(dr, batched_samples, check, "WriteBatch");
+
+  sub->delete_datareader(dr);
+  pub->delete_datawriter(dw);
+  dp->delete_topic(topic);
+  return passed;
+}
+
+void fill(Message& sample, CORBA::Long iteration)
+{
+  sample.key = iteration % 2;
+  sample.iteration = iteration;
+}
+
+void fill(TextMessage& sample, CORBA::Long iteration)
+{
+  sample.key = iteration % 2;
+  sample.iteration = iteration;
+  sample.text = iteration < 0 ? "returned" : "loaned";
+}
+
+bool is_default(const Message& sample)
+{
+  return sample.key == 0 && sample.iteration == 0;
+}
+
+bool is_default(const TextMessage& sample)
+{
+  return sample.key == 0 && sample.iteration == 0 && !*sample.text.in();
+}
+
+bool is_filled(const Message& sample)
+{
+  return sample.key == sample.iteration % 2;
+}
+
+bool is_filled(const TextMessage& sample)
+{
+  return sample.key == sample.iteration % 2
+    && !std::strcmp(sample.text.in(), "loaned");
+}
+
+/// Checks that each loaned sample was written once and has the contents
+/// it was loaned with
+class LoanCheck {
+public:
+  explicit LoanCheck(const char* topic_name)
+    : topic_name_(topic_name)
+    , received_(loaned_samples + 1, false)
+  {}
+
+  template <typename Sample>
+  bool operator()(const Sample& sample, const SampleInfo&)
+  {
+    if (sample.iteration < 0 || sample.iteration > loaned_samples
+        || received_[sample.iteration] || !is_filled(sample)) {
+      cerr << "ERROR: " << topic_name_ << ": unexpected sample, iteration "
+        << sample.iteration << endl;
+      return false;
+    }
+    received_[sample.iteration] = true;
+    return true;
+  }
+
+private:
+  const char* topic_name_;
+  OPENDDS_VECTOR(bool) received_;
+};
+
+template <typename Sample>
+bool run_loan_test(const DomainParticipant_var& dp, const Publisher_var& pub,
+                   const Subscriber_var& sub, const char* topic_name)
+{
+  typedef DDSTraits<Sample> Traits;
+  typedef DataWriterImpl_T<Sample> WriterImpl;
+
+  TypeSupport_var ts = new typename Traits::TypeSupportTypeImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic(topic_name, type_name,
+                                     TOPIC_QOS_DEFAULT, 0,
+                                     DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0, DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0, DEFAULT_STATUS_MASK);
+
+  if (!topic || !dw || !dr || Utils::wait_match(dw, 1) != 0) {
+    cerr << "ERROR: " << topic_name << ": setup failed" << endl;
+    return false;
+  }
+
+  WriterImpl* const writer = dynamic_cast<WriterImpl*>(dw.in());
+  bool passed = true;
+
+  // More loans than the writer has chunks
+  Sample* samples[loaned_samples];
+  for (CORBA::Long i = 0; i < loaned_samples; ++i) {
+    const ReturnCode_t ret = writer->loan_sample(samples[i]);
+    if (ret != RETCODE_OK || !samples[i]) {
+      cerr << "ERROR: " << topic_name << ": loan " << i << " failed: "
+        << retcode_to_string(ret) << endl;
+      return false;
+    }
+    if (!is_default(*samples[i])) {
+      cerr << "ERROR: " << topic_name << ": loan " << i << " isn't default" << endl;
+      passed = false;
+    }
+    fill(*samples[i], i);
+  }
+  for (CORBA::Long i = 0; i < loaned_samples; ++i) {
+    const ReturnCode_t ret = writer->write_loaned(samples[i], HANDLE_NIL);
+    if (ret != RETCODE_OK) {
+      cerr << "ERROR: " << topic_name << ": write_loaned " << i << " failed: "
+        << retcode_to_string(ret) << endl;
+      passed = false;
+    }
+  }
+
+  // A returned sample isn't written and its contents don't carry over to
+  // the next loan
+  Sample* returned;
+  if (writer->loan_sample(returned) != RETCODE_OK) {
+    cerr << "ERROR: " << topic_name << ": loan to return failed" << endl;
+    return false;
+  }
+  fill(*returned, -1);
+  if (writer->return_loan(returned) != RETCODE_OK) {
+    cerr << "ERROR: " << topic_name << ": return_loan failed" << endl;
+    passed = false;
+  }
+  Sample* last;
+  if (writer->loan_sample(last) != RETCODE_OK) {
+    cerr << "ERROR: " << topic_name << ": loan after return failed" << endl;
+    return false;
+  }
+  if (!is_default(*last)) {
+    cerr << "ERROR: " << topic_name << ": loan after return isn't default" << endl;
+    passed = false;
+  }
+  fill(*last, loaned_samples);
+  if (writer->write_loaned(last, HANDLE_NIL) != RETCODE_OK) {
+    cerr << "ERROR: " << topic_name << ": write_loaned after return failed" << endl;
+    passed = false;
+  }
+
+  if (writer->write_loaned(0, HANDLE_NIL) != RETCODE_BAD_PARAMETER
+      || writer->return_loan(0) != RETCODE_BAD_PARAMETER) {
+    cerr << "ERROR: " << topic_name << ": null samples should be rejected" << endl;
+    passed = false;
+  }
+
+  LoanCheck check(topic_name);
+  passed &= Utils::take_samples<Sample>(dr, loaned_samples + 1, check, topic_name);
+
+  sub->delete_datareader(dr);
+  pub->delete_datawriter(dw);
+  dp->delete_topic(topic);
+  return passed;
+}
+
+int run_test(int argc, ACE_TCHAR *argv[])
+{
+  DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  TheServiceParticipant->n_chunks(writer_chunks);
+  DomainParticipant_var dp =
+    dpf->create_participant(23, PARTICIPANT_QOS_DEFAULT, 0,
+                            DEFAULT_STATUS_MASK);
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+                                           DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+                                             DEFAULT_STATUS_MASK);
+
+  bool passed = true;
+  passed &= run_batch_test(dp, pub, sub);
+  // Loaned in place, at least with the native byte order
+  passed &= run_loan_test<Message>(dp, pub, sub, "InPlace");
+  // Loaned from the sample pool and serialized
+  passed &= run_loan_test<TextMessage>(dp, pub, sub, "Pooled");
+
+  dp->delete_contained_entities();
+  dpf->delete_participant(dp);
+  return passed ? 0 : 1;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
+{
+  int ret = 1;
+  try
+  {
+    ret = run_test(argc, argv);
+  }
+  catch (const CORBA::BAD_PARAM& ex) {
+    ex._tao_print_exception("Exception caught in WriterExtensionsTest.cpp:");
+    return 1;
+  }
+
+  TheServiceParticipant->shutdown();
+  ACE_Thread_Manager::instance()->wait();
+  return ret;
+}
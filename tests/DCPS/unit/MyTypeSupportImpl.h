@@ -87,9 +87,9 @@ public:
                              OpenDDS::DCPS::MarshalingType) {}
   virtual void dec_ref_data_element(OpenDDS::DCPS::ReceivedDataElement *) {}
   virtual void delete_instance_map (void *) {}
-  bool contains_sample_filtered(DDS::SampleStateMask, DDS::ViewStateMask,
-    DDS::InstanceStateMask, const OpenDDS::DCPS::FilterEvaluator&,
-    const DDS::StringSeq&) { return true; }
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  bool contains_sample_filtered(OpenDDS::DCPS::QueryConditionImpl&) { return true; }
+#endif
   virtual void lookup_instance(const OpenDDS::DCPS::ReceivedDataSample&,
                                OpenDDS::DCPS::SubscriptionInstance_rch&) {}
 
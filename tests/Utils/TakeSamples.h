@@ -0,0 +1,67 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef TestUtils_TakeSamples_H
+#define TestUtils_TakeSamples_H
+
+#include "dds/DCPS/TypeSupportImpl.h"
+#include "dds/DCPS/SafetyProfileStreams.h"
+
+#include "ace/OS_NS_unistd.h"
+
+#include <iostream>
+
+namespace Utils {
+
+/// Take from 'dr' until 'expected' valid samples arrived, polling every
+/// 100ms for up to 'attempts' takes.  Each valid sample is passed to
+/// 'check' as check(sample, info), which returns false if the sample is
+/// wrong.  Returns true when all samples arrived and passed the check.
+template <typename Sample, typename Check>
+bool take_samples(DDS::DataReader_ptr dr, CORBA::Long expected, Check& check,
+                  const char* label, int attempts = 100)
+{
+  typedef OpenDDS::DCPS::DDSTraits<Sample> Traits;
+  typename Traits::DataReaderType::_var_type reader =
+    Traits::DataReaderType::_narrow(dr);
+  CORBA::Long count = 0;
+  bool passed = true;
+
+  for (int i = 0; i < attempts && count < expected; ++i) {
+    typename Traits::MessageSequenceType data;
+    DDS::SampleInfoSeq infoseq;
+    const DDS::ReturnCode_t ret = reader->take(data, infoseq, DDS::LENGTH_UNLIMITED,
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    if (ret == DDS::RETCODE_NO_DATA) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+      continue;
+    } else if (ret != DDS::RETCODE_OK) {
+      std::cerr << "ERROR: " << label << ": take failed: "
+        << OpenDDS::DCPS::retcode_to_string(ret) << std::endl;
+      return false;
+    }
+
+    for (CORBA::ULong j = 0; j < data.length(); ++j) {
+      if (!infoseq[j].valid_data) {
+        continue;
+      }
+      ++count;
+      if (!check(data[j], infoseq[j])) {
+        passed = false;
+      }
+    }
+  }
+
+  if (count != expected) {
+    std::cerr << "ERROR: " << label << ": received " << count << " of "
+      << expected << " samples" << std::endl;
+    return false;
+  }
+  return passed;
+}
+
+}
+
+#endif